@@ -9,11 +9,14 @@
 #include <concepts>
 #include <deque>
 #include <exception>
+#include <execution>
 #include <filesystem>
 #include <format>
 #include <fstream>
 #include <functional>
 #include <iterator>
+#include <limits>
+#include <list>
 #include <iostream>		// <-- Can probably remove this for distribution builds
 #include <memory>
 #include <numbers>
@@ -30,6 +33,7 @@
 #include <thread>
 #include <tuple>
 #include <type_traits>
+#include <typeindex>
 #include <unordered_map>
 #include <utility>
 #include <variant>
@@ -88,6 +92,7 @@
 #include <DirectXPackedVector.h>
 #include <DirectXColors.h>
 #include <DirectXCollision.h>
+#include <dwrite_2.h>
 
 // #include "utils/Constants.h"
 #include "topo/utils/d3dx12.h"
@@ -98,6 +103,7 @@
 #pragma comment(lib, "d3dcompiler.lib")
 #pragma comment(lib, "D3D12.lib")
 #pragma comment(lib, "dxgi.lib")
+#pragma comment(lib, "dwrite.lib")
 
 #pragma comment(lib, "dxguid.lib")
 
@@ -197,6 +197,7 @@ void DeviceResources::CreateSwapChain()
 {
 	// Release the previous swapchain we will be recreating.
 	m_swapChain.Reset();
+	m_fullPresentPending = true;
 
 	// If we are using an HWND create the SwapChainDesc for a specific window
 	// otherwise we are creating it for composition (UWP)
@@ -216,7 +217,7 @@ void DeviceResources::CreateSwapChain()
 		sd.BufferCount = SwapChainBufferCount;
 		sd.OutputWindow = m_hWnd;
 		sd.Windowed = true;
-		sd.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+		sd.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL; // Keeps the contents of the back buffers, which partial redraw relies on
 		sd.Flags = DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
 
 		// Note: Swap chain uses queue to perform flush.
@@ -347,6 +348,7 @@ void DeviceResources::OnResize(int width, int height)
 	);
 
 	m_currBackBuffer = 0;
+	m_fullPresentPending = true;
 
 	CD3DX12_CPU_DESCRIPTOR_HANDLE rtvHeapHandle(m_rtvHeap->GetCPUDescriptorHandleForHeapStart());
 	for (UINT i = 0; i < SwapChainBufferCount; i++)
@@ -475,7 +477,7 @@ void DeviceResources::Update()
 		m_commandList->SetDescriptorHeaps(_countof(descriptorHeaps), descriptorHeaps)
 	);
 }
-void DeviceResources::PreRender()
+void DeviceResources::PreRender(std::span<const D3D12_RECT> clearRects)
 {
 	// Indicate a state transition on the resource usage.
 	auto transition = CD3DX12_RESOURCE_BARRIER::Transition(
@@ -485,10 +487,15 @@ void DeviceResources::PreRender()
 	);
 	GFX_THROW_INFO_ONLY(m_commandList->ResourceBarrier(1, &transition));
 
-	// Clear the back buffer and depth buffer.
-	FLOAT color[4] = { 1.0f, 0.0f, 1.0f, 1.0f };
-	GFX_THROW_INFO_ONLY(m_commandList->ClearRenderTargetView(CurrentBackBufferView(), color, 0, nullptr));
-	GFX_THROW_INFO_ONLY(m_commandList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, 0, nullptr));
+	// Clear the parts of the back buffer and depth buffer that are about to be redrawn. NOTE: Passing 0 rects to the
+	// Clear functions would clear the entire view, so an empty span has to skip them
+	if (!clearRects.empty())
+	{
+		const UINT rectCount = static_cast<UINT>(clearRects.size());
+		FLOAT color[4] = { 1.0f, 0.0f, 1.0f, 1.0f };
+		GFX_THROW_INFO_ONLY(m_commandList->ClearRenderTargetView(CurrentBackBufferView(), color, rectCount, clearRects.data()));
+		GFX_THROW_INFO_ONLY(m_commandList->ClearDepthStencilView(DepthStencilView(), D3D12_CLEAR_FLAG_DEPTH | D3D12_CLEAR_FLAG_STENCIL, 1.0f, 0, rectCount, clearRects.data()));
+	}
 
 	// Specify the buffers we are going to render to.
 	auto currentBackBufferView = CurrentBackBufferView();
@@ -516,12 +523,20 @@ void DeviceResources::PostRender()
 		m_commandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists)
 	);
 }
-void DeviceResources::Present()
+void DeviceResources::Present(std::span<const RECT> dirtyRects)
 {
 	// PROFILE_SCOPE("m_swapChain->Present()");
 
-	// swap the back and front buffers
-	GFX_THROW_INFO(m_swapChain->Present(0, 0));
+	// swap the back and front buffers. The dirty rects let DXGI/DWM only copy/compose the parts that changed
+	DXGI_PRESENT_PARAMETERS parameters = {};
+	if (!m_fullPresentPending && !dirtyRects.empty())
+	{
+		parameters.DirtyRectsCount = static_cast<UINT>(dirtyRects.size());
+		parameters.pDirtyRects = const_cast<RECT*>(dirtyRects.data());
+	}
+	m_fullPresentPending = false;
+
+	GFX_THROW_INFO(m_swapChain->Present1(0, 0, &parameters));
 	m_currBackBuffer = (m_currBackBuffer + 1) % SwapChainBufferCount;
 
 	// Wait until frame commands are complete.  This waiting is inefficient and is
@@ -548,6 +563,28 @@ void DeviceResources::Present()
 	// passed to DeviceResources::DelayedDelete()
 	CleanupResources();
 }
+void DeviceResources::SkipFrame()
+{
+	// When a frame is not going to be rendered, Update() has still reset the command list and any commands
+	// issued while processing input (resource uploads, etc.) must still be executed. So close/execute the
+	// command list just as PostRender() would, but without touching the back buffer or presenting.
+	GFX_THROW_INFO(m_commandList->Close());
+
+	ID3D12CommandList* cmdsLists[] = { m_commandList.Get() };
+	GFX_THROW_INFO_ONLY(
+		m_commandQueue->ExecuteCommandLists(_countof(cmdsLists), cmdsLists)
+	);
+
+	// The frame resource must still be fenced so that the next time Update() lands on this frame index, it 
+	// will not reset the allocator while the GPU could still be using it
+	++m_currentFence;
+	m_fences[m_currentFrameIndex] = m_currentFence;
+	GFX_THROW_INFO(
+		m_commandQueue->Signal(m_fence.Get(), m_fences[m_currentFrameIndex])
+	);
+
+	CleanupResources();
+}
 
 void DeviceResources::DelayedDelete(Microsoft::WRL::ComPtr<ID3D12Resource> resource) noexcept
 {
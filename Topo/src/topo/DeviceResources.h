@@ -78,19 +78,28 @@ public:
 	ND inline UINT GetCBVSRVUAVDescriptorSize() const noexcept { return m_cbvSrvUavDescriptorSize; }
 
 	ND constexpr int GetCurrentFrameIndex() const noexcept { return m_currentFrameIndex; }
+	ND constexpr int GetCurrentBackBufferIndex() const noexcept { return m_currBackBuffer; }
 
 	ND inline DescriptorVector* GetDescriptorVector() const noexcept { return m_descriptorVector.get(); }
 
 	void PrepareToRun();
 	void Update();
-	void PreRender();
+	// Partial redraw: The swap chain keeps the contents of its buffers (flip sequential), so PreRender() only clears
+	// clearRects (nothing at all if it is empty) and Present() only tells DXGI about dirtyRects. The caller has
+	// to make sure that everything outside of those rects is the same as what was last presented. Passing no dirty
+	// rects presents the whole buffer
+	void PreRender(std::span<const D3D12_RECT> clearRects);
 	void PostRender();
-	void Present();
+	void Present(std::span<const RECT> dirtyRects = {});
+	void SkipFrame();
 
 	void DelayedDelete(Microsoft::WRL::ComPtr<ID3D12Resource> resource) noexcept;
 	void CleanupResources() noexcept;
 
 	ND inline const std::string& Name() const noexcept { return m_name; }
+
+	static constexpr int SwapChainBufferCount = 2;
+
 private:
 	void CreateDevice();
 	void CreateCommandObjects();
@@ -123,8 +132,8 @@ private:
 	Microsoft::WRL::ComPtr<ID3D12CommandQueue>			m_commandQueue;
 	Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList>	m_commandList;
 
-	static const int SwapChainBufferCount = 2;
 	int m_currBackBuffer = 0;
+	bool m_fullPresentPending = true; // The first present after creating/resizing the swap chain must not use dirty rects
 	Microsoft::WRL::ComPtr<ID3D12Resource> m_swapChainBuffer[SwapChainBufferCount];
 	Microsoft::WRL::ComPtr<ID3D12Resource> m_depthStencilBuffer;
 
@@ -10,12 +10,22 @@ namespace topo
 {
 void Layout::Update(const Timer& timer)
 {
+	if (m_parallelCommit)
+	{
+		UpdateControls(timer);
+		CommitVisualsInParallel();
+		return;
+	}
+
 	OnUpdate(this, timer);
 
-	// Update controls
+	// Update controls and then commit any visual changes they have accumulated (this frame or since the last
+	// frame) so that each control touches its render data at most once per frame
 	for (auto& pair : m_controls)
 	{
-		std::get<0>(pair)->Update(timer);
+		Control* control = std::get<0>(pair).get();
+		control->Update(timer);
+		control->CommitVisual();
 	}
 
 	// Update sublayouts
@@ -86,6 +96,8 @@ Layout* Layout::AddSubLayout(unsigned int rowIndex, unsigned int columnIndex, un
 
 	ControlPosition cp = { rowIndex, columnIndex, rowSpan, columnSpan };
 
+	// The sublayout's clip rect is nested in this layout's clip rect
+	UIRenderer::ClipScope clipScope(*m_renderer, m_clip);
 	Layout* sublayout = new Layout(
 		m_renderer,
 		m_columns[columnIndex].Rect.Left,
@@ -94,7 +106,11 @@ Layout* Layout::AddSubLayout(unsigned int rowIndex, unsigned int columnIndex, un
 		m_rows[rowIndex + rowSpan - 1].Rect.Bottom
 	);
 
+	sublayout->SetControlPool(m_controlPool);
+	sublayout->SetRenderLayer(m_renderLayer);
+	sublayout->m_parentHitTestVersion = &m_hitTestVersion;
 	m_sublayouts.emplace_back(sublayout, cp);
+	InvalidateHitTesting();
 
 	// If the sublayout resides (either partially or completely) within an AUTO row/column
 	// the layout needs updating
@@ -118,11 +134,124 @@ Layout* Layout::AddSubLayout(unsigned int rowIndex, unsigned int columnIndex, un
 	return sublayout;
 }
 
+void Layout::RemoveControl(Control* control)
+{
+	for (auto iter = m_controls.begin(); iter != m_controls.end(); ++iter)
+	{
+		if (std::get<0>(*iter).get() == control)
+		{
+			ReleaseControl(std::move(std::get<0>(*iter)));
+			m_controls.erase(iter);
+			InvalidateHitTesting();
+			return;
+		}
+	}
+
+	LOG_WARN("[Layout: {0}] RemoveControl: control is not a direct child of this layout", m_name);
+}
+void Layout::ReleaseControl(std::unique_ptr<Control> control)
+{
+	// The control no longer belongs to this layout (parked controls are not in any layout)
+	control->m_parentHitTestVersion = nullptr;
+	++m_childrenVersion;
+
+	// Without a pool, the control just gets destroyed
+	if (m_controlPool != nullptr)
+		m_controlPool->Release(std::move(control));
+}
+void Layout::UpdateControls(const Timer& timer)
+{
+	OnUpdate(this, timer);
+
+	for (auto& pair : m_controls)
+		std::get<0>(pair)->Update(timer);
+
+	for (auto& pair : m_sublayouts)
+		std::get<0>(pair)->UpdateControls(timer);
+}
+void Layout::CommitVisuals()
+{
+	for (auto& pair : m_controls)
+		std::get<0>(pair)->CommitVisual();
+
+	for (auto& pair : m_sublayouts)
+		std::get<0>(pair)->CommitVisuals();
+}
+void Layout::CommitVisualsInParallel()
+{
+	// Our own controls go first, just like they would on a single thread
+	for (auto& pair : m_controls)
+		std::get<0>(pair)->CommitVisual();
+
+	m_sublayoutCommits.resize(m_sublayouts.size());
+	for (size_t iii = 0; iii < m_sublayouts.size(); ++iii)
+	{
+		SublayoutCommit& commit = m_sublayoutCommits[iii];
+		commit.Sublayout = std::get<0>(m_sublayouts[iii]).get();
+		commit.Parallel = commit.Sublayout->CanCommitVisualsInParallel();
+	}
+
+	// Workers only record into their own draw list, so they never touch the renderer (or each other). Controls that
+	// move while committing only invalidate the hit testing of layouts within the worker's own sublayout
+	std::for_each(std::execution::par, m_sublayoutCommits.begin(), m_sublayoutCommits.end(),
+		[this](SublayoutCommit& commit)
+		{
+			if (!commit.Parallel)
+				return;
+
+			commit.DrawList.Clear();
+			UIRenderer::DrawListScope scope(*m_renderer, commit.DrawList);
+			commit.Sublayout->CommitVisuals();
+		}
+	);
+
+	// Apply everything in sublayout order. Sublayouts that could not be recorded are committed at their spot in
+	// that order, so the renderer sees the exact same sequence of changes as it would on a single thread
+	for (SublayoutCommit& commit : m_sublayoutCommits)
+	{
+		if (commit.Parallel)
+			m_renderer->SubmitDrawList(commit.DrawList);
+		else
+			commit.Sublayout->CommitVisuals();
+	}
+}
+bool Layout::CanCommitVisualsInParallel() const noexcept
+{
+	for (const auto& pair : m_controls)
+	{
+		if (!std::get<0>(pair)->CanCommitVisualInParallel())
+			return false;
+	}
+	for (const auto& pair : m_sublayouts)
+	{
+		if (!std::get<0>(pair)->CanCommitVisualsInParallel())
+			return false;
+	}
+	return true;
+}
+
+void Layout::SetControlPool(ControlPool* pool) noexcept
+{
+	m_controlPool = pool;
+	for (auto& pair : m_sublayouts)
+		std::get<0>(pair)->SetControlPool(pool);
+}
+void Layout::SetRenderLayer(RenderLayer2D layer) noexcept
+{
+	// NOTE: This only affects controls that are added after this call
+	m_renderLayer = layer;
+	for (auto& pair : m_sublayouts)
+		std::get<0>(pair)->SetRenderLayer(layer);
+}
+
 
 void Layout::ReadjustRows(bool readjustControlsAndSublayouts) noexcept
 {
 	ASSERT(m_rect.Bottom > m_rect.Top, "Cannot have negative height");
 
+	// Row rects are about to change, which invalidates any cached hit testing
+	InvalidateHitTesting();
+
 	// Before we can compute what one star height should equal, we need to 
 	// make sure all AUTO sized rows have the correct height
 	UpdateAutoRowHeights();
@@ -175,6 +304,9 @@ void Layout::ReadjustColumns(bool readjustControlsAndSublayouts) noexcept
 {
 	ASSERT(m_rect.Right > m_rect.Left, "Cannot have negative width");
 
+	// Column rects are about to change, which invalidates any cached hit testing
+	InvalidateHitTesting();
+
 	// Before we can compute what one star height should equal, we need to 
 	// make sure all AUTO sized rows have the correct height
 	UpdateAutoColumnWidths();
@@ -390,6 +522,9 @@ void Layout::ResetRows(std::span<Row> rows) noexcept
 	// rows that will no longer exist
 	bool controlLocationsNeedAdjusting = (rows.size() < m_rows.size());
 
+	// Row/column indices are about to mean something else
+	CancelRowAnimations();
+
 	m_rows.clear();
 	m_rows.assign_range(rows);
 
@@ -415,6 +550,9 @@ void Layout::ResetRows(std::vector<Row>&& rows) noexcept
 	// rows that will no longer exist
 	bool controlLocationsNeedAdjusting = (rows.size() < m_rows.size());
 
+	// Row/column indices are about to mean something else
+	CancelRowAnimations();
+
 	m_rows.clear();
 	m_rows = std::move(rows);
 
@@ -442,6 +580,9 @@ void Layout::RemoveRow(unsigned int rowIndex, bool deleteContainedControlsAndSub
 		return;
 	}
 
+	// Any tween on this row (or one of the following rows, whose indices are about to shift) no longer makes sense
+	CancelRowAnimations();
+
 	std::vector<unsigned int> indicesToDelete;
 
 	// Delete any controls/sublayouts that reside soley within the row
@@ -455,7 +596,10 @@ void Layout::RemoveRow(unsigned int rowIndex, bool deleteContainedControlsAndSub
 		}
 
 		for (std::vector<unsigned int>::reverse_iterator riter = indicesToDelete.rbegin(); riter != indicesToDelete.rend(); ++riter)
+		{
+			ReleaseControl(std::move(std::get<0>(m_controls[*riter])));
 			m_controls.erase(m_controls.begin() + *riter);
+		}
 
 		indicesToDelete.clear();
 
@@ -488,7 +632,10 @@ void Layout::RemoveRow(unsigned int rowIndex, bool deleteContainedControlsAndSub
 	if (deleteOverlappingControlsAndSublayouts)
 	{
 		for (std::vector<unsigned int>::reverse_iterator riter = indicesToDelete.rbegin(); riter != indicesToDelete.rend(); ++riter)
+		{
+			ReleaseControl(std::move(std::get<0>(m_controls[*riter])));
 			m_controls.erase(m_controls.begin() + *riter);
+		}
 
 		indicesToDelete.clear();
 	}
@@ -525,8 +672,10 @@ void Layout::RemoveRow(unsigned int rowIndex, bool deleteContainedControlsAndSub
 			cp.RowIndex -= 1;
 	}
 
-	// Delete the row
+	// Delete the row. Sublayouts in it may have been deleted as well
 	m_rows.erase(m_rows.begin() + rowIndex);
+	InvalidateHitTesting();
+	++m_childrenVersion;
 }
 
 void Layout::ResetColumns(std::span<Column> columns) noexcept
@@ -535,6 +684,9 @@ void Layout::ResetColumns(std::span<Column> columns) noexcept
 	// columns that will no longer exist
 	bool controlLocationsNeedAdjusting = (columns.size() < m_columns.size());
 
+	// Row/column indices are about to mean something else
+	CancelColumnAnimations();
+
 	m_columns.clear();
 	m_columns.assign_range(columns);
 
@@ -560,6 +712,9 @@ void Layout::ResetColumns(std::vector<Column>&& columns) noexcept
 	// columns that will no longer exist
 	bool controlLocationsNeedAdjusting = (columns.size() < m_columns.size());
 
+	// Row/column indices are about to mean something else
+	CancelColumnAnimations();
+
 	m_columns.clear();
 	m_columns = std::move(columns);
 
@@ -587,6 +742,9 @@ void Layout::RemoveColumn(unsigned int columnIndex, bool deleteContainedControls
 		return;
 	}
 
+	// Any tween on this column (or one of the following columns, whose indices are about to shift) no longer makes sense
+	CancelColumnAnimations();
+
 	std::vector<unsigned int> indicesToDelete;
 
 	// Delete any controls/sublayouts that reside soley within the column
@@ -600,7 +758,10 @@ void Layout::RemoveColumn(unsigned int columnIndex, bool deleteContainedControls
 		}
 
 		for (std::vector<unsigned int>::reverse_iterator riter = indicesToDelete.rbegin(); riter != indicesToDelete.rend(); ++riter)
+		{
+			ReleaseControl(std::move(std::get<0>(m_controls[*riter])));
 			m_controls.erase(m_controls.begin() + *riter);
+		}
 
 		indicesToDelete.clear();
 
@@ -633,7 +794,10 @@ void Layout::RemoveColumn(unsigned int columnIndex, bool deleteContainedControls
 	if (deleteOverlappingControlsAndSublayouts)
 	{
 		for (std::vector<unsigned int>::reverse_iterator riter = indicesToDelete.rbegin(); riter != indicesToDelete.rend(); ++riter)
+		{
+			ReleaseControl(std::move(std::get<0>(m_controls[*riter])));
 			m_controls.erase(m_controls.begin() + *riter);
+		}
 
 		indicesToDelete.clear();
 	}
@@ -670,11 +834,73 @@ void Layout::RemoveColumn(unsigned int columnIndex, bool deleteContainedControls
 			cp.ColumnIndex -= 1;
 	}
 
-	// Delete the row
+	// Delete the column. Sublayouts in it may have been deleted as well
 	m_columns.erase(m_columns.begin() + columnIndex);
+	InvalidateHitTesting();
+	++m_childrenVersion;
 }
 
 
+AnimationId Layout::AnimateRow(unsigned int rowIndex, float end, float duration, Easing easing)
+{
+	if (rowIndex >= m_rows.size()) [[unlikely]]
+	{
+		LOG_ERROR("[Layout: {0}] Cannot animate row at index {1} - there are only {2} rows.", m_name, rowIndex, m_rows.size());
+		return 0;
+	}
+	if (m_rows[rowIndex].Type == RowColumnType::AUTO) [[unlikely]]
+		LOG_WARN("[Layout: {0}] Animating AUTO row {1} has no effect - its height is determined by its controls.", m_name, rowIndex);
+
+	// Forget the tweens that have finished so that the list does not keep growing
+	std::erase_if(m_rowAnimations, [this](AnimationId id) { return !m_renderer->IsAnimating(id); });
+
+	const AnimationId id = m_renderer->AnimateCallback(&Layout::ApplyRowAnimation, this, rowIndex, m_rows[rowIndex].Value, end, duration, easing);
+	m_rowAnimations.push_back(id);
+	return id;
+}
+AnimationId Layout::AnimateColumn(unsigned int columnIndex, float end, float duration, Easing easing)
+{
+	if (columnIndex >= m_columns.size()) [[unlikely]]
+	{
+		LOG_ERROR("[Layout: {0}] Cannot animate column at index {1} - there are only {2} columns.", m_name, columnIndex, m_columns.size());
+		return 0;
+	}
+	if (m_columns[columnIndex].Type == RowColumnType::AUTO) [[unlikely]]
+		LOG_WARN("[Layout: {0}] Animating AUTO column {1} has no effect - its width is determined by its controls.", m_name, columnIndex);
+
+	// Forget the tweens that have finished so that the list does not keep growing
+	std::erase_if(m_columnAnimations, [this](AnimationId id) { return !m_renderer->IsAnimating(id); });
+
+	const AnimationId id = m_renderer->AnimateCallback(&Layout::ApplyColumnAnimation, this, columnIndex, m_columns[columnIndex].Value, end, duration, easing);
+	m_columnAnimations.push_back(id);
+	return id;
+}
+void Layout::ApplyRowAnimation(void* layout, unsigned int rowIndex, float value) noexcept
+{
+	// The new Value only takes effect once the rows are readjusted (which also moves the controls in them)
+	Layout* self = static_cast<Layout*>(layout);
+	self->m_rows[rowIndex].Value = value;
+	self->ReadjustRows(true);
+}
+void Layout::ApplyColumnAnimation(void* layout, unsigned int columnIndex, float value) noexcept
+{
+	Layout* self = static_cast<Layout*>(layout);
+	self->m_columns[columnIndex].Value = value;
+	self->ReadjustColumns(true);
+}
+void Layout::CancelRowAnimations() noexcept
+{
+	for (AnimationId id : m_rowAnimations)
+		m_renderer->CancelAnimation(id);
+	m_rowAnimations.clear();
+}
+void Layout::CancelColumnAnimations() noexcept
+{
+	for (AnimationId id : m_columnAnimations)
+		m_renderer->CancelAnimation(id);
+	m_columnAnimations.clear();
+}
+
 void Layout::UpdateAutoRowHeights() noexcept
 {
 	// Create a vector the same size as the number of total rows that will hold the required
@@ -1003,6 +1229,80 @@ bool Layout::CheckMouseOverDraggableRowOrColumn(float x, float y) noexcept
 	return false;
 }
 
+void Layout::HitTest(float x, float y, std::vector<HoverPathEntry>& path, Rect& leafRect) const noexcept
+{
+	path.emplace_back(const_cast<Layout*>(this), const_cast<Layout*>(this), m_rect, m_hitTestVersion, m_childrenVersion);
+
+	// Controls get priority over sublayouts (this matches the order that mouse events get dispatched)
+	for (const auto& pair : m_controls)
+	{
+		Control* control = std::get<0>(pair).get();
+		if (control->IsVisible() && control->GetPositionRect().ContainsPoint(x, y))
+		{
+			path.emplace_back(control, nullptr, control->GetPositionRect());
+			leafRect = control->GetPositionRect();
+			return;
+		}
+	}
+	for (const auto& pair : m_sublayouts)
+	{
+		const Layout* sublayout = std::get<0>(pair).get();
+		if (sublayout->ContainsPoint(x, y))
+		{
+			sublayout->HitTest(x, y, path, leafRect);
+			return;
+		}
+	}
+
+	// The point is not over any child, so this layout is the leaf. Controls/sublayouts always occupy entire cells,
+	// so the result stays valid for as long as the mouse remains within the same cell
+	leafRect = m_rect;
+	for (const Row& row : m_rows)
+	{
+		if (y >= row.Rect.Top && y <= row.Rect.Bottom)
+		{
+			leafRect.Top = std::max(leafRect.Top, row.Rect.Top);
+			leafRect.Bottom = std::min(leafRect.Bottom, row.Rect.Bottom);
+			break;
+		}
+	}
+	for (const Column& column : m_columns)
+	{
+		if (x >= column.Rect.Left && x <= column.Rect.Right)
+		{
+			leafRect.Left = std::max(leafRect.Left, column.Rect.Left);
+			leafRect.Right = std::min(leafRect.Right, column.Rect.Right);
+			break;
+		}
+	}
+}
+bool Layout::ContainsChild(const IEventReceiver* receiver) const noexcept
+{
+	for (const auto& pair : m_controls)
+	{
+		if (std::get<0>(pair).get() == receiver)
+			return true;
+	}
+	for (const auto& pair : m_sublayouts)
+	{
+		if (std::get<0>(pair).get() == receiver)
+			return true;
+	}
+	return false;
+}
+bool Layout::ContainsDescendant(const IEventReceiver* receiver) const noexcept
+{
+	if (ContainsChild(receiver))
+		return true;
+
+	for (const auto& pair : m_sublayouts)
+	{
+		if (std::get<0>(pair)->ContainsDescendant(receiver))
+			return true;
+	}
+	return false;
+}
+
 float Layout::GetAutoHeight() const noexcept 
 { 
 	float requiredHeight = 0.0f;
@@ -1293,7 +1593,7 @@ IEventReceiver* Layout::OnX2ButtonDoubleClick(float mouseX, float mouseY, MouseB
 {
 	return nullptr;
 }
-IEventReceiver* Layout::OnMouseMoved(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
+IEventReceiver* Layout::OnMouseMovedNonRecursive(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
 	// NOTE: When rows/columns are dragged, we need a way to make sure the layout doesn't snap back to original values. 
 	// For example, suppose we have two rows, each with height 100, then we drag the dividing line so that they become 
@@ -1437,6 +1737,14 @@ IEventReceiver* Layout::OnMouseMoved(float mouseX, float mouseY, MouseButtonEven
 	if (CheckMouseOverDraggableRowOrColumn(mouseX, mouseY))
 		return this;
 
+	return nullptr;
+}
+IEventReceiver* Layout::OnMouseMoved(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
+{
+	// Dragging a row/column (or hovering over a draggable divider) takes precedence over the children
+	if (OnMouseMovedNonRecursive(mouseX, mouseY, keyStates) != nullptr)
+		return this;
+
 	// Don't pass event to child controls/sublayouts if the mouse is not over the layout
 	if (ContainsPoint(mouseX, mouseY))
 	{
@@ -1465,6 +1773,13 @@ IEventReceiver* Layout::OnMouseEntered(float mouseX, float mouseY, MouseButtonEv
 }
 IEventReceiver* Layout::OnMouseLeave()
 {
+	// The mouse can no longer be hovering over one of our dividers. However, if a divider is actively being
+	// dragged, keep the dragging state so the drag continues until the button is released
+	if (!m_activelyDragging)
+	{
+		m_rowDraggingIndex = std::nullopt;
+		m_columnDraggingIndex = std::nullopt;
+	}
 	return nullptr;
 }
 IEventReceiver* Layout::OnMouseWheel(float wheelDelta, float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
@@ -1,6 +1,7 @@
 #pragma once
 #include "Core.h"
 #include "controls/Control.h"
+#include "controls/ControlPool.h"
 #include "topo/Log.h"
 #include "topo/utils/Concepts.h"
 #include "topo/utils/Rect.h"
@@ -41,24 +42,83 @@ struct ControlPosition
 	unsigned int ColumnSpan = 1;
 };
 
+class Layout;
+
+// A single element along the path from the root layout down to the element that is under the mouse
+struct HoverPathEntry
+{
+	IEventReceiver* Receiver = nullptr;
+	Layout*			Layout = nullptr; // Only non-null if the receiver is a layout
+	Rect			Rect = {};
+	unsigned int	Version = 0;	  // The layout's hit testing version when the path was hit tested (see Layout::HitTestVersion)
+	unsigned int	ChildrenVersion = 0; // The layout's children version when the path was hit tested (see Layout::ChildrenVersion)
+};
+
 
 class Layout : public IEventReceiver
 {
 public:
 	Layout(const std::shared_ptr<UIRenderer>& renderer, float left, float top, float right, float bottom) :
 		m_renderer(renderer),
-		m_rect{ left, top, right, bottom }
+		m_rect{ left, top, right, bottom },
+		m_clip(renderer->RegisterClip(m_rect))
 	{}
-	Layout(Layout&&) = default;
-	Layout& operator=(Layout&&) = default;
+	inline ~Layout() noexcept
+	{
+		CancelAnimations();
+		m_renderer->UnregisterClip(m_clip);
+	}
+	// Children (and running row/column tweens) keep pointers to their layout, so a layout cannot be moved
+	Layout(Layout&&) = delete;
+	Layout& operator=(Layout&&) = delete;
 
 	void Update(const Timer& timer);
 
 	template<typename T> requires std::derived_from<T, ::topo::Control>
 	T* AddControl(unsigned int rowIndex = 0, unsigned int columnIndex = 0, unsigned int rowSpan = 1, unsigned int columnSpan = 1);
 	Layout* AddSubLayout(unsigned int rowIndex = 0, unsigned int columnIndex = 0, unsigned int rowSpan = 1, unsigned int columnSpan = 1);
-
-	inline void SetPosition(float left, float top, float right, float bottom) noexcept { m_rect = { left, top, right, bottom }; ReadjustRowsAndColumns(); }
+	void RemoveControl(Control* control);
+
+	// When a control pool is set, removed controls are parked in the pool instead of being destroyed, and AddControl<T>
+	// will reuse parked controls of type T before creating new ones. The pool is shared with all sublayouts
+	void SetControlPool(ControlPool* pool) noexcept;
+	ND constexpr ControlPool* GetControlPool() const noexcept { return m_controlPool; }
+
+	// Renderer layer that controls added to this layout (and its sublayouts) get drawn in
+	void SetRenderLayer(RenderLayer2D layer) noexcept;
+	ND constexpr RenderLayer2D GetRenderLayer() const noexcept { return m_renderLayer; }
+
+	// With parallel commit enabled, Update() first updates every control in this layout and its sublayouts (on the
+	// calling thread, because update callbacks can do anything), and then commits the visuals of each sublayout on
+	// a thread of its own. Each sublayout records into its own draw list (see DrawList2D), and the lists are
+	// submitted in sublayout order, so the result is the same as committing everything on one thread. Sublayouts
+	// that contain a control that cannot be committed in parallel (see Control::CanCommitVisualInParallel) are
+	// committed on the calling thread, in order. Meant for the root layout of large pages.
+	// NOTE: Only this layout's direct sublayouts are spread across threads - the setting of nested layouts is ignored
+	constexpr void SetParallelCommit(bool enabled) noexcept { m_parallelCommit = enabled; }
+	ND constexpr bool GetParallelCommit() const noexcept { return m_parallelCommit; }
+
+	// A cached layout (and everything in it) is rendered once into the renderer's layer cache and then drawn as a
+	// single quad until anything in it changes (see UIRenderer::SetClipCached). Meant for parts of a page that are
+	// expensive to draw but rarely change (legends, toolbars, static grids). NOTE: Moving or scrolling the layout
+	// changes where its content is drawn, so it gets rendered into the cache again once it stops moving
+	inline void SetCached(bool cached) { m_renderer->SetClipCached(m_clip, cached); }
+	ND inline bool IsCached() const noexcept { return m_renderer->IsClipCached(m_clip); }
+
+	// The clip everything in this layout is culled against, and the clip it is nested in. Layouts nest their clip in
+	// the clip that was current when they were created, so only layouts owned by pooled controls need to move
+	ND constexpr unsigned int GetClip() const noexcept { return m_clip; }
+	inline void SetParentClip(unsigned int clip) { m_renderer->SetClipParent(m_clip, clip); }
+
+	inline void SetPosition(float left, float top, float right, float bottom) noexcept 
+	{ 
+		m_rect = { left, top, right, bottom }; 
+		m_renderer->SetClipRect(m_clip, m_rect);
+		if (m_parentHitTestVersion != nullptr)
+			++(*m_parentHitTestVersion);
+		ReadjustRowsAndColumns(); 
+	}
+	ND constexpr const Rect& GetRect() const noexcept { return m_rect; }
 
 	// Rows
 	inline void AddRow(RowColumnType type, float value, bool adjustable = false, std::optional<float> minHeight = std::nullopt, std::optional<float> maxHeight = std::nullopt) noexcept
@@ -92,6 +152,10 @@ public:
 	void ResetRows(std::vector<Row>&& rows) noexcept;
 	void RemoveRow(unsigned int rowIndex, bool deleteContainedControlsAndSublayouts = true, bool deleteOverlappingControlsAndSublayouts = false) noexcept;
 
+	// Tweens the Value of a row from its current value to 'end', readjusting the layout every frame. The tween gets
+	// cancelled if the rows are reset or removed
+	AnimationId AnimateRow(unsigned int rowIndex, float end, float duration, Easing easing = Easing::Linear);
+
 	// Columns
 	inline void AddColumn(RowColumnType type, float value, bool adjustable = false, std::optional<float> minWidth = std::nullopt, std::optional<float> maxWidth = std::nullopt) noexcept
 	{
@@ -124,11 +188,38 @@ public:
 	void ResetColumns(std::vector<Column>&& columns) noexcept;
 	void RemoveColumn(unsigned int columnIndex, bool deleteContainedControlsAndSublayouts = true, bool deleteOverlappingControlsAndSublayouts = false) noexcept;
 
+	// Same as AnimateRow, but for a column
+	AnimationId AnimateColumn(unsigned int columnIndex, float end, float duration, Easing easing = Easing::Linear);
+
 
 	ND float GetAutoHeight() const noexcept;
 	ND float GetAutoWidth() const noexcept;
 
 	ND constexpr bool ContainsPoint(float x, float y) const noexcept { return m_rect.ContainsPoint(x, y); }
+	ND constexpr bool IsActivelyDragging() const noexcept { return m_activelyDragging; }
+
+	// Hit Testing
+	// HitTest appends this layout and then every descendant under the point (root first) to path. leafRect is set
+	// to the region around the point for which the result is guaranteed to stay the same (assuming none of the
+	// layouts along the path change - see HitTestVersion())
+	void HitTest(float x, float y, std::vector<HoverPathEntry>& path, Rect& leafRect) const noexcept;
+
+	// Bumped by anything that could change which of this layout's direct children is under a point: children being
+	// added, removed or repositioned, and rows/columns changing. A cached hit testing result is still valid as long
+	// as every layout along it has the version it had when it was hit tested, so a change only invalidates the
+	// results that pass through the layout it happened in
+	ND constexpr unsigned int HitTestVersion() const noexcept { return m_hitTestVersion; }
+	constexpr void InvalidateHitTesting() noexcept { ++m_hitTestVersion; }
+
+	// Bumped whenever one of this layout's direct children is removed (destroyed or parked). As long as a layout's
+	// children version is unchanged, every child it had back then is still alive - unlike HitTestVersion(), moving
+	// children around does not bump it, so a hover path survives a resize
+	ND constexpr unsigned int ChildrenVersion() const noexcept { return m_childrenVersion; }
+	ND bool ContainsChild(const IEventReceiver* receiver) const noexcept;
+	ND bool ContainsDescendant(const IEventReceiver* receiver) const noexcept;
+
+	// Handles dragging of row/column dividers only - the event is NOT passed on to child controls/sublayouts
+	IEventReceiver* OnMouseMovedNonRecursive(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates);
 
 
 	// Window Event Methods
@@ -185,6 +276,12 @@ private:
 	void ReadjustControlsAndSublayoutsInRow(unsigned int rowIndex) noexcept;
 	void ReadjustControlsAndSublayoutsInColumn(unsigned int columnIndex) noexcept;
 	ND float CalculateRowStarHeight() const noexcept;
+
+	static void ApplyRowAnimation(void* layout, unsigned int rowIndex, float value) noexcept;
+	static void ApplyColumnAnimation(void* layout, unsigned int columnIndex, float value) noexcept;
+	void CancelRowAnimations() noexcept;
+	void CancelColumnAnimations() noexcept;
+	inline void CancelAnimations() noexcept { CancelRowAnimations(); CancelColumnAnimations(); }
 	ND float CalculateColumnStarWidth() const noexcept;
 	void UpdateAutoRowHeights() noexcept;
 	void UpdateAutoColumnWidths() noexcept;
@@ -194,12 +291,34 @@ private:
 
 	bool CheckMouseOverDraggableRowOrColumn(float x, float y) noexcept;
 
+	void ReleaseControl(std::unique_ptr<Control> control);
+
+	// The two halves of Update() for parallel commit
+	void UpdateControls(const Timer& timer);
+	void CommitVisuals();
+	void CommitVisualsInParallel();
+	ND bool CanCommitVisualsInParallel() const noexcept;
+
 	std::shared_ptr<UIRenderer> m_renderer;
+	ControlPool* m_controlPool = nullptr;
+	RenderLayer2D m_renderLayer = RenderLayer2D::Main;
 	Rect m_rect;
+
+	// Everything in this layout (and its sublayouts) is culled against this clip rect (see UIRenderer::RegisterClip)
+	unsigned int m_clip = UIRenderer::WindowClip;
+
+	// See HitTestVersion(). Children keep a pointer to it so that they can invalidate it when they move.
+	// m_parentHitTestVersion is the parent layout's version
+	unsigned int m_hitTestVersion = 0;
+	unsigned int* m_parentHitTestVersion = nullptr;
+	unsigned int m_childrenVersion = 0; // See ChildrenVersion()
+
 	std::vector<std::pair<std::unique_ptr<Control>, ControlPosition>> m_controls;
 	std::vector<std::pair<std::unique_ptr<Layout>, ControlPosition>> m_sublayouts;
 	std::vector<Row> m_rows;
 	std::vector<Column> m_columns;
+	std::vector<AnimationId> m_rowAnimations;	 // See AnimateRow. Includes tweens that have since finished
+	std::vector<AnimationId> m_columnAnimations;
 	bool m_canScrollVertically = true;
 	bool m_canScrollHorizontally = true;
 	float m_verticalScrollOffset = 0.0f;
@@ -209,6 +328,17 @@ private:
 	std::optional<unsigned int> m_rowDraggingIndex = std::nullopt;
 	std::optional<unsigned int> m_columnDraggingIndex = std::nullopt;
 
+	// Parallel commit (see SetParallelCommit). There is one entry per sublayout, which keeps its draw list (and the
+	// memory it has allocated) from one frame to the next
+	struct SublayoutCommit
+	{
+		Layout* Sublayout = nullptr;
+		DrawList2D DrawList;
+		bool Parallel = false;
+	};
+	bool m_parallelCommit = false;
+	std::vector<SublayoutCommit> m_sublayoutCommits;
+
 
 // In DIST builds, we don't name the object
 #ifndef TOPO_DIST
@@ -271,15 +401,37 @@ T* Layout::AddControl(unsigned int rowIndex, unsigned int columnIndex, unsigned
 
 	ControlPosition cp = { rowIndex, columnIndex, rowSpan, columnSpan };
 
-	Control* control = new T(
-		m_renderer,
-		m_columns[columnIndex].Rect.Left,
-		m_rows[rowIndex].Rect.Top,
-		m_columns[columnIndex + columnSpan - 1].Rect.Right,
-		m_rows[rowIndex + rowSpan - 1].Rect.Bottom
-	);
+	// Reuse a parked control if possible - this avoids allocating a new control and registering new renderer objects
+	std::unique_ptr<T> pooled = (m_controlPool != nullptr) ? m_controlPool->Acquire<T>(m_clip) : nullptr;
+
+	Control* control = nullptr;
+	if (pooled != nullptr)
+	{
+		control = pooled.release();
+		control->SetPositionRect(
+			m_columns[columnIndex].Rect.Left,
+			m_rows[rowIndex].Rect.Top,
+			m_columns[columnIndex + columnSpan - 1].Rect.Right,
+			m_rows[rowIndex + rowSpan - 1].Rect.Bottom
+		);
+	}
+	else
+	{
+		// Any renderer objects the control creates must be placed in this layout's layer and clipped by this layout
+		UIRenderer::LayerScope scope(*m_renderer, m_renderLayer);
+		UIRenderer::ClipScope clipScope(*m_renderer, m_clip);
+		control = new T(
+			m_renderer,
+			m_columns[columnIndex].Rect.Left,
+			m_rows[rowIndex].Rect.Top,
+			m_columns[columnIndex + columnSpan - 1].Rect.Right,
+			m_rows[rowIndex + rowSpan - 1].Rect.Bottom
+		);
+	}
 
+	control->m_parentHitTestVersion = &m_hitTestVersion;
 	m_controls.emplace_back(control, cp);
+	InvalidateHitTesting();
 
 	// If the control resides (either partially or completely) within an AUTO row/column
 	// the layout needs updating
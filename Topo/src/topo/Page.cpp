@@ -7,17 +7,176 @@ Page::Page(const std::shared_ptr<UIRenderer>& renderer, float width, float heigh
 	m_renderer(renderer),
 	m_layout(renderer, 0.0f, 0.0f, width, height)
 {
+	m_layout.SetControlPool(&m_controlPool);
+}
+
+namespace
+{
+// A layout entry is unchanged if nothing that could change which of the layout's children is under the mouse has
+// happened since it was hit tested. Control entries are always leaves, so their parent's entry covers them
+ND inline bool IsUnchanged(const HoverPathEntry& entry) noexcept
+{
+	return entry.Layout == nullptr || entry.Layout->HitTestVersion() == entry.Version;
+}
+}
+
+void Page::UpdateHoverPath(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
+{
+	// Popups are on top of the page's layout, so they determine the root of the path. This check is per popup
+	// (not per control), so it stays cheap
+	Layout* root = PopupAt(mouseX, mouseY);
+	if (root == nullptr && m_layout.ContainsPoint(mouseX, mouseY))
+		root = &m_layout;
+
+	// Entries that no longer exist are dropped without a leave event
+	const size_t alive = ValidHoverPathLength();
+	const bool sameRoot = alive > 0 && m_hoverPath[0].Layout == root;
+
+	// Steady state: none of the layouts along the path have changed and the mouse is still within the region for
+	// which the cached path is known to be valid, so there is nothing to do. Changes anywhere else on the page (i.e.
+	// an animation in another layout) do not affect the path
+	if (sameRoot && alive == m_hoverPath.size() && std::ranges::all_of(m_hoverPath, IsUnchanged) && m_hoverLeafRect.ContainsPoint(mouseX, mouseY))
+		return;
+
+	m_hoverPath.resize(alive);
+
+	// Keep the layouts that have not changed and still contain the mouse, and hit test from the deepest of them
+	size_t keep = 0;
+	if (sameRoot)
+	{
+		while (keep < m_hoverPath.size() && m_hoverPath[keep].Layout != nullptr && IsUnchanged(m_hoverPath[keep]) && m_hoverPath[keep].Rect.ContainsPoint(mouseX, mouseY))
+			++keep;
+	}
+
+	m_newHoverPath.assign(m_hoverPath.begin(), m_hoverPath.begin() + (keep > 0 ? keep - 1 : 0));
+	if (keep > 0)
+		m_hoverPath[keep - 1].Layout->HitTest(mouseX, mouseY, m_newHoverPath, m_hoverLeafRect);
+	else if (root != nullptr)
+		root->HitTest(mouseX, mouseY, m_newHoverPath, m_hoverLeafRect);
+
+	// Find where the old and new paths diverge
+	size_t common = 0;
+	while (common < m_hoverPath.size() && common < m_newHoverPath.size() && m_hoverPath[common].Receiver == m_newHoverPath[common].Receiver)
+		++common;
+
+	// Leave events go deepest first, enter events go root first
+	for (size_t iii = m_hoverPath.size(); iii > common; --iii)
+		m_hoverPath[iii - 1].Receiver->OnMouseLeave();
+	for (size_t iii = common; iii < m_newHoverPath.size(); ++iii)
+		m_newHoverPath[iii].Receiver->OnMouseEntered(mouseX, mouseY, keyStates);
+
+	std::swap(m_hoverPath, m_newHoverPath);
+}
+void Page::ClearHoverPath()
+{
+	m_hoverPath.resize(ValidHoverPathLength());
+
+	for (size_t iii = m_hoverPath.size(); iii > 0; --iii)
+		m_hoverPath[iii - 1].Receiver->OnMouseLeave();
+
+	m_hoverPath.clear();
+	m_mouseHandlingControl = nullptr;
+}
+size_t Page::ValidHoverPathLength() const noexcept
+{
+	// The root is either the page's layout or an open popup. Going down from there, a layout whose children version
+	// has not changed since the path was hit tested still has every child it had back then, so the next entry is
+	// alive as well. The first layout that has lost a child ends the known-alive part of the path - the entries below
+	// it may be gone, so they are never dereferenced
+	if (m_hoverPath.empty())
+		return 0;
+
+	const Layout* root = m_hoverPath[0].Layout;
+	if (root != &m_layout && std::ranges::find_if(m_popups, [root](const std::unique_ptr<Layout>& popup) { return popup.get() == root; }) == m_popups.end())
+		return 0;
+
+	size_t length = 1;
+	while (length < m_hoverPath.size() && m_hoverPath[length - 1].Layout->ChildrenVersion() == m_hoverPath[length - 1].ChildrenVersion)
+		++length;
+	return length;
+}
+bool Page::IsAttached(const IEventReceiver* receiver) const noexcept
+{
+	if (receiver == &m_layout || m_layout.ContainsDescendant(receiver))
+		return true;
 
+	return std::ranges::any_of(m_popups, [receiver](const std::unique_ptr<Layout>& popup) { return popup.get() == receiver || popup->ContainsDescendant(receiver); });
 }
 
 
 
 
+Layout* Page::OpenPopup(float left, float top, float right, float bottom)
+{
+	// The popup is its own layout root. Nothing about it is connected to m_layout, so the page's layout never gets
+	// readjusted because of it. Its controls register with the overlay render layer and are recycled through a
+	// separate pool so that they never end up in the main layer
+	std::unique_ptr<Layout>& popup = m_popups.emplace_back(std::make_unique<Layout>(m_renderer, left, top, right, bottom));
+	popup->SetRenderLayer(RenderLayer2D::Overlay);
+	popup->SetControlPool(&m_overlayControlPool);
+#ifndef TOPO_DIST
+	popup->SetDebugName(std::format("Popup {0}", m_popups.size() - 1));
+#endif
+
+	// The popup may now be covering whatever the mouse was over, but the hover path picks that up on its own (its
+	// root is re-determined on every move)
+	m_renderer->MarkDirty();
+
+	return popup.get();
+}
+void Page::ClosePopup(Layout* popup) noexcept
+{
+	auto iter = std::ranges::find_if(m_popups, [popup](const std::unique_ptr<Layout>& p) { return p.get() == popup; });
+	if (iter == m_popups.end()) [[unlikely]]
+	{
+		LOG_WARN("Page::ClosePopup: the layout is not an open popup");
+		return;
+	}
+
+	// Send leave events while the popup's controls are still alive
+	if (!m_hoverPath.empty() && m_hoverPath[0].Layout == popup)
+		ClearHoverPath();
+
+	// Don't leave any dangling pointers into the popup
+	if (m_mouseHandlingControl != nullptr && (m_mouseHandlingControl == popup || popup->ContainsDescendant(m_mouseHandlingControl)))
+		m_mouseHandlingControl = nullptr;
+	if (m_mouseCaptureControl != nullptr && (m_mouseCaptureControl == popup || popup->ContainsDescendant(m_mouseCaptureControl)))
+		m_mouseCaptureControl = nullptr;
+	if (m_keyboardHandlingControl != nullptr && (m_keyboardHandlingControl == popup || popup->ContainsDescendant(m_keyboardHandlingControl)))
+		m_keyboardHandlingControl = nullptr;
+	if (m_draggingLayout != nullptr && (m_draggingLayout == popup || popup->ContainsDescendant(m_draggingLayout)))
+		m_draggingLayout = nullptr;
+
+	m_popups.erase(iter);
+	m_renderer->MarkDirty();
+}
+void Page::CloseAllPopups() noexcept
+{
+	while (!m_popups.empty())
+		ClosePopup(m_popups.back().get());
+}
+Layout* Page::PopupAt(float x, float y) const noexcept
+{
+	// A layout that is dragging a row/column divider keeps receiving the mouse, even if it passes over a popup
+	if (m_draggingLayout != nullptr && m_draggingLayout->IsActivelyDragging())
+		return nullptr;
+
+	// The last popup is the topmost one
+	for (auto iter = m_popups.rbegin(); iter != m_popups.rend(); ++iter)
+	{
+		if ((*iter)->ContainsPoint(x, y))
+			return iter->get();
+	}
+	return nullptr;
+}
+
 
 // Window Event Handlers
 bool Page::OnWindowClosed()
 {
 	m_layout.OnWindowClosed();
+	for (auto& popup : m_popups)
+		popup->OnWindowClosed();
 	PostQuitMessage(0);
 	return true;
 }
@@ -29,6 +188,8 @@ bool Page::OnWindowResized(float width, float height)
 bool Page::OnKillFocus()
 {
 	m_layout.OnKillFocus();
+	for (auto& popup : m_popups)
+		popup->OnKillFocus();
 	return true;
 }
 bool Page::OnDPIChanged()
@@ -39,267 +200,169 @@ bool Page::OnDPIChanged()
 // Mouse Event Handlers
 bool Page::OnLButtonDown(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnLButtonDown(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnLButtonDown(mouseX, mouseY, keyStates);
-
-	// With mouse button down events, if there is a handling control, we set keyboard handling control 
-	// to be the same, otherwise, we leave it as it was
-	if (m_mouseHandlingControl != nullptr)
-		m_keyboardHandlingControl = m_mouseHandlingControl;
-
+	DispatchButtonDown(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnLButtonDown(mouseX, mouseY, keyStates); });
 	return true;
 }
 bool Page::OnLButtonUp(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnLButtonUp(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnLButtonUp(mouseX, mouseY, keyStates);
+	// The element that the button went down on gets the release, wherever the mouse is now
+	if (DispatchToMouseCapture(keyStates, [&](IEventReceiver& receiver) { return receiver.OnLButtonUp(mouseX, mouseY, keyStates); }))
+		return true;
 
+	DispatchToPopupFirst(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnLButtonUp(mouseX, mouseY, keyStates); });
 	return true;
 }
 bool Page::OnLButtonDoubleClick(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnLButtonDoubleClick(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnLButtonDoubleClick(mouseX, mouseY, keyStates);
-
+	DispatchToPopupFirst(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnLButtonDoubleClick(mouseX, mouseY, keyStates); });
 	return true;
 }
 bool Page::OnMButtonDown(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnMButtonDown(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnMButtonDown(mouseX, mouseY, keyStates);
-
-	// With mouse button down events, if there is a handling control, we set keyboard handling control 
-	// to be the same, otherwise, we leave it as it was
-	if (m_mouseHandlingControl != nullptr)
-		m_keyboardHandlingControl = m_mouseHandlingControl;
-
+	DispatchButtonDown(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnMButtonDown(mouseX, mouseY, keyStates); });
 	return true;
 }
 bool Page::OnMButtonUp(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnMButtonUp(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnMButtonUp(mouseX, mouseY, keyStates);
+	// The element that the button went down on gets the release, wherever the mouse is now
+	if (DispatchToMouseCapture(keyStates, [&](IEventReceiver& receiver) { return receiver.OnMButtonUp(mouseX, mouseY, keyStates); }))
+		return true;
 
+	DispatchToPopupFirst(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnMButtonUp(mouseX, mouseY, keyStates); });
 	return true;
 }
 bool Page::OnMButtonDoubleClick(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnMButtonDoubleClick(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnMButtonDoubleClick(mouseX, mouseY, keyStates);
-
+	DispatchToPopupFirst(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnMButtonDoubleClick(mouseX, mouseY, keyStates); });
 	return true;
 }
 bool Page::OnRButtonDown(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnRButtonDown(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnRButtonDown(mouseX, mouseY, keyStates);
-
-	// With mouse button down events, if there is a handling control, we set keyboard handling control 
-	// to be the same, otherwise, we leave it as it was
-	if (m_mouseHandlingControl != nullptr)
-		m_keyboardHandlingControl = m_mouseHandlingControl;
-
+	DispatchButtonDown(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnRButtonDown(mouseX, mouseY, keyStates); });
 	return true;
 }
 bool Page::OnRButtonUp(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnRButtonUp(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnRButtonUp(mouseX, mouseY, keyStates);
+	// The element that the button went down on gets the release, wherever the mouse is now
+	if (DispatchToMouseCapture(keyStates, [&](IEventReceiver& receiver) { return receiver.OnRButtonUp(mouseX, mouseY, keyStates); }))
+		return true;
 
+	DispatchToPopupFirst(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnRButtonUp(mouseX, mouseY, keyStates); });
 	return true;
 }
 bool Page::OnRButtonDoubleClick(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnRButtonDoubleClick(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnRButtonDoubleClick(mouseX, mouseY, keyStates);
-
+	DispatchToPopupFirst(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnRButtonDoubleClick(mouseX, mouseY, keyStates); });
 	return true;
 }
 bool Page::OnX1ButtonDown(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnX1ButtonDown(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnX1ButtonDown(mouseX, mouseY, keyStates);
-
-	// With mouse button down events, if there is a handling control, we set keyboard handling control 
-	// to be the same, otherwise, we leave it as it was
-	if (m_mouseHandlingControl != nullptr)
-		m_keyboardHandlingControl = m_mouseHandlingControl;
-
+	DispatchButtonDown(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnX1ButtonDown(mouseX, mouseY, keyStates); });
 	return true;
 }
 bool Page::OnX1ButtonUp(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnX1ButtonUp(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnX1ButtonUp(mouseX, mouseY, keyStates);
+	// The element that the button went down on gets the release, wherever the mouse is now
+	if (DispatchToMouseCapture(keyStates, [&](IEventReceiver& receiver) { return receiver.OnX1ButtonUp(mouseX, mouseY, keyStates); }))
+		return true;
 
+	DispatchToPopupFirst(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnX1ButtonUp(mouseX, mouseY, keyStates); });
 	return true;
 }
 bool Page::OnX1ButtonDoubleClick(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnX1ButtonDoubleClick(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnX1ButtonDoubleClick(mouseX, mouseY, keyStates);
-
+	DispatchToPopupFirst(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnX1ButtonDoubleClick(mouseX, mouseY, keyStates); });
 	return true;
 }
 bool Page::OnX2ButtonDown(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnX2ButtonDown(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnX2ButtonDown(mouseX, mouseY, keyStates);
-
-	// With mouse button down events, if there is a handling control, we set keyboard handling control 
-	// to be the same, otherwise, we leave it as it was
-	if (m_mouseHandlingControl != nullptr)
-		m_keyboardHandlingControl = m_mouseHandlingControl;
-
+	DispatchButtonDown(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnX2ButtonDown(mouseX, mouseY, keyStates); });
 	return true;
 }
 bool Page::OnX2ButtonUp(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnX2ButtonUp(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnX2ButtonUp(mouseX, mouseY, keyStates);
+	// The element that the button went down on gets the release, wherever the mouse is now
+	if (DispatchToMouseCapture(keyStates, [&](IEventReceiver& receiver) { return receiver.OnX2ButtonUp(mouseX, mouseY, keyStates); }))
+		return true;
 
+	DispatchToPopupFirst(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnX2ButtonUp(mouseX, mouseY, keyStates); });
 	return true;
 }
 bool Page::OnX2ButtonDoubleClick(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnX2ButtonDoubleClick(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnX2ButtonDoubleClick(mouseX, mouseY, keyStates);
-
+	DispatchToPopupFirst(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnX2ButtonDoubleClick(mouseX, mouseY, keyStates); });
 	return true;
 }
 bool Page::OnMouseMoved(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnMouseMoved(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnMouseMoved(mouseX, mouseY, keyStates);
+	// If a layout is dragging a row/column divider, it captures the mouse until the drag ends
+	if (m_draggingLayout != nullptr)
+	{
+		if (m_draggingLayout->IsActivelyDragging())
+		{
+			m_draggingLayout->OnMouseMovedNonRecursive(mouseX, mouseY, keyStates);
+			return true;
+		}
+		m_draggingLayout = nullptr;
+	}
+
+	UpdateHoverPath(mouseX, mouseY, keyStates);
+
+	// While a button is held, moves go to the element the button went down on
+	if (DispatchToMouseCapture(keyStates, [&](IEventReceiver& receiver) { return receiver.OnMouseMoved(mouseX, mouseY, keyStates); }))
+		return true;
+
+	// Only the elements along the hover path can possibly care about the move, so instead of walking the entire
+	// layout tree, just walk down the path. Layouts only need to check their own row/column dividers
+	m_mouseHandlingControl = nullptr;
+	for (const HoverPathEntry& entry : m_hoverPath)
+	{
+		if (entry.Layout != nullptr)
+		{
+			if (entry.Layout->OnMouseMovedNonRecursive(mouseX, mouseY, keyStates) != nullptr)
+			{
+				if (entry.Layout->IsActivelyDragging())
+					m_draggingLayout = entry.Layout;
+
+				m_mouseHandlingControl = entry.Layout;
+				return true;
+			}
+
+			// Same as the recursive Layout::OnMouseMoved - if no child handles the event, the deepest layout
+			// under the mouse becomes the handling control
+			m_mouseHandlingControl = entry.Layout;
+		}
+		else
+		{
+			IEventReceiver* ret = entry.Receiver->OnMouseMoved(mouseX, mouseY, keyStates);
+			if (ret != nullptr)
+				m_mouseHandlingControl = ret;
+		}
+	}
 
 	return true;
 }
 bool Page::OnMouseEntered(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnMouseEntered(mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnMouseEntered(mouseX, mouseY, keyStates);
-
-	return true;
+	// Entering the window is no different than moving - the hover path will emit the necessary enter events
+	return OnMouseMoved(mouseX, mouseY, keyStates);
 }
 bool Page::OnMouseLeave()
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnMouseLeave();
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnMouseLeave();
+	// Don't end a drag just because the mouse briefly left the window
+	if (m_draggingLayout == nullptr || !m_draggingLayout->IsActivelyDragging())
+		ClearHoverPath();
 
 	return true;
 }
 bool Page::OnMouseWheel(float wheelDelta, float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnMouseWheel(wheelDelta, mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnMouseWheel(wheelDelta, mouseX, mouseY, keyStates);
-
+	DispatchToPopupFirst(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnMouseWheel(wheelDelta, mouseX, mouseY, keyStates); });
 	return true;
 }
 bool Page::OnMouseHWheel(float wheelDelta, float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
 {
-	// Try passing the event to the handling control
-	if (m_mouseHandlingControl != nullptr)
-		m_mouseHandlingControl = m_mouseHandlingControl->OnMouseHWheel(wheelDelta, mouseX, mouseY, keyStates);
-
-	// If no handling control, pass event to the layout
-	if (m_mouseHandlingControl == nullptr)
-		m_mouseHandlingControl = m_layout.OnMouseHWheel(wheelDelta, mouseX, mouseY, keyStates);
-
+	DispatchToPopupFirst(mouseX, mouseY, [&](IEventReceiver& receiver) { return receiver.OnMouseHWheel(wheelDelta, mouseX, mouseY, keyStates); });
 	return true;
 }
 
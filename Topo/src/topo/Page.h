@@ -14,7 +14,20 @@ class Page
 public:
 	Page(const std::shared_ptr<UIRenderer>& renderer, float width, float height);
 
-	inline void Update(const Timer& timer) { m_layout.Update(timer); }
+	inline void Update(const Timer& timer) 
+	{ 
+		m_layout.Update(timer); 
+		for (auto& popup : m_popups)
+			popup->Update(timer);
+	}
+
+	// Popups (tooltips, dropdowns, context menus, etc) live in an overlay above the page's layout. Each popup is its
+	// own layout root that is drawn in the overlay render layer, so opening/closing/changing a popup only costs the
+	// popup's own layout and draw. Popups get the first chance to handle mouse input (topmost popup first)
+	Layout* OpenPopup(float left, float top, float right, float bottom);
+	void ClosePopup(Layout* popup) noexcept;
+	void CloseAllPopups() noexcept;
+	ND constexpr size_t PopupCount() const noexcept { return m_popups.size(); }
 
 	// Window Event Handlers
 	bool OnWindowClosed();
@@ -52,11 +65,109 @@ public:
 	bool OnSysKeyUp(KeyCode keyCode, unsigned int repeatCount);	
 
 protected:
+	void UpdateHoverPath(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates);
+	void ClearHoverPath();
+	ND size_t ValidHoverPathLength() const noexcept;
+	ND Layout* PopupAt(float x, float y) const noexcept;
+	ND bool IsAttached(const IEventReceiver* receiver) const noexcept;
+
+	// Mouse event dispatch. F is called as dispatch(IEventReceiver&) and returns the receiver that handled the event
+	// (or nullptr), which becomes the new mouse handling control
+
+	// Popups are on top of the page, so they get the first chance to handle the event. Otherwise, the handling
+	// control gets the first chance, and if it does not handle the event, it goes to the layout
+	template<typename F>
+	void DispatchToPopupFirst(float mouseX, float mouseY, F&& dispatch)
+	{
+		if (Layout* popup = PopupAt(mouseX, mouseY); popup != nullptr)
+		{
+			m_mouseHandlingControl = dispatch(static_cast<IEventReceiver&>(*popup));
+			return;
+		}
+
+		if (m_mouseHandlingControl != nullptr)
+			m_mouseHandlingControl = dispatch(*m_mouseHandlingControl);
+
+		if (m_mouseHandlingControl == nullptr)
+			m_mouseHandlingControl = dispatch(static_cast<IEventReceiver&>(m_layout));
+	}
+
+	// Same as DispatchToPopupFirst, but the control that handles a button down also becomes the keyboard handling
+	// control (otherwise, the keyboard handling control is left as it was) and captures the mouse. The captured
+	// control receives the button up (and all moves in between), even if the mouse is no longer over it. Otherwise,
+	// dragging off of a control would lose the release
+	template<typename F>
+	void DispatchButtonDown(float mouseX, float mouseY, F&& dispatch)
+	{
+		DispatchToPopupFirst(mouseX, mouseY, std::forward<F>(dispatch));
+
+		if (m_mouseHandlingControl != nullptr)
+		{
+			m_keyboardHandlingControl = m_mouseHandlingControl;
+			m_mouseCaptureControl = m_mouseHandlingControl;
+			m_mouseCaptureGeneration = IEventReceiver::DetachGeneration();
+		}
+	}
+
+	// Returns false if nothing has captured the mouse (in which case the event was not dispatched)
+	template<typename F>
+	bool DispatchToMouseCapture(MouseButtonEventKeyStates keyStates, F&& dispatch)
+	{
+		if (m_mouseCaptureControl == nullptr)
+			return false;
+
+		// The captured element may have been removed from the page since the button went down. Nothing has been
+		// removed from any layout as long as the detach generation has not moved, so the tree only gets searched for
+		// the element after something was removed (and not on every move of a drag)
+		if (m_mouseCaptureGeneration != IEventReceiver::DetachGeneration()) [[unlikely]]
+		{
+			if (!IsAttached(m_mouseCaptureControl))
+			{
+				m_mouseCaptureControl = nullptr;
+				return false;
+			}
+			m_mouseCaptureGeneration = IEventReceiver::DetachGeneration();
+		}
+
+		m_mouseHandlingControl = dispatch(*m_mouseCaptureControl);
+
+		// Capture lasts until every button has been released
+		if (!keyStates.LButtonIsDown() && !keyStates.MButtonIsDown() && !keyStates.RButtonIsDown() && !keyStates.X1ButtonIsDown() && !keyStates.X2ButtonIsDown())
+			m_mouseCaptureControl = nullptr;
+
+		return true;
+	}
+
 	std::shared_ptr<UIRenderer> m_renderer;
+
+	// Controls removed from any layout on the page get parked here for reuse. Must be declared before m_layout
+	// so that it outlives every layout that references it
+	ControlPool     m_controlPool;
 	Layout          m_layout;
+
+	// Overlay: open popups in z-order (the last one is the topmost). Declared after the pools so that each pool
+	// outlives the layouts that reference it
+	ControlPool     m_overlayControlPool;
+	std::vector<std::unique_ptr<Layout>> m_popups;
 	IEventReceiver* m_mouseHandlingControl    = nullptr;
 	IEventReceiver* m_keyboardHandlingControl = nullptr;
 
+	// The element that handled the last button down. It receives every mouse move and button up until all mouse
+	// buttons have been released
+	IEventReceiver* m_mouseCaptureControl	  = nullptr;
+	unsigned int	m_mouseCaptureGeneration  = 0; // See IEventReceiver::DetachGeneration
+
+	// The path (root layout first) to the element currently under the mouse. As long as none of the layouts along
+	// the path have changed (see Layout::HitTestVersion) and the mouse remains within m_hoverLeafRect, the path
+	// cannot have changed. Whether its entries are still alive is tracked by Layout::ChildrenVersion
+	std::vector<HoverPathEntry> m_hoverPath;
+	std::vector<HoverPathEntry> m_newHoverPath; // Scratch space so that updating the path does not allocate
+	Rect			m_hoverLeafRect = {};
+
+	// Layout that is currently dragging one of its row/column dividers. It receives all mouse move events until
+	// the drag ends
+	Layout*			m_draggingLayout = nullptr;
+
 
 };
 
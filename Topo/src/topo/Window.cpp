@@ -394,13 +394,17 @@ void Window::Update(const Timer& timer)
 {
 	// Must call deviceResources->Update() first because it will reset the commandlist so new commands can be issued
 	m_deviceResources->Update();
-	m_uiRenderer->Update(timer, m_deviceResources->GetCurrentFrameIndex());
+
+	// Update the page before the renderer so that any visual changes made during the page update are
+	// committed and copied to the GPU for this frame
 	m_page->Update(timer); 
+	m_uiRenderer->Update(timer, m_deviceResources->GetCurrentFrameIndex());
 //	m_renderer->Update(timer, m_deviceResources->GetCurrentFrameIndex());
 }
 void Window::Render(const Timer& timer) 
 {
-	m_deviceResources->PreRender();
+	// Only the damaged parts of the back buffer are cleared and redrawn (see UIRenderer::PrepareRedraw)
+	m_deviceResources->PreRender(m_uiRenderer->PrepareRedraw(m_deviceResources->GetCurrentBackBufferIndex()));
 
 	m_uiRenderer->Render(m_deviceResources->GetCurrentFrameIndex());
 
@@ -410,7 +414,29 @@ void Window::Render(const Timer& timer)
 }
 void Window::Present() 
 {
-	m_deviceResources->Present();
+	m_deviceResources->Present(m_uiRenderer->GetPresentRects());
+}
+bool Window::NeedsRender() const noexcept
+{
+	// Frames without damage are never rendered, no matter if we render on demand or not
+	return m_uiRenderer->NeedsRender();
+}
+bool Window::NeedsUpdate() const noexcept
+{
+	// Not rendering on demand only means the loop never blocks: it keeps updating every frame
+	return !m_renderOnDemand || m_uiRenderer->NeedsUpdate();
+}
+void Window::SkipFrame()
+{
+	m_deviceResources->SkipFrame();
+}
+void Window::WaitForMessages(HANDLE additionalHandle) const noexcept
+{
+	// Block until there is at least one message in the queue (this includes WM_TIMER messages) or the additional
+	// handle is signaled. MWMO_INPUTAVAILABLE makes sure we return immediately if there are messages that are 
+	// already sitting in the queue, but were seen by a previous PeekMessage call (and therefore not "new")
+	const DWORD handleCount = additionalHandle != nullptr ? 1 : 0;
+	MsgWaitForMultipleObjectsEx(handleCount, handleCount > 0 ? &additionalHandle : nullptr, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
 }
 
 void Window::InitializeRenderer()
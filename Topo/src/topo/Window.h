@@ -23,13 +23,17 @@ namespace topo
 {
 struct WindowProperties
 {
-	constexpr WindowProperties(std::string_view title = "Topo Window", unsigned int width = 1280, unsigned int height = 720) noexcept :
-		Title(title), Width(width), Height(height)
+	constexpr WindowProperties(std::string_view title = "Topo Window", unsigned int width = 1280, unsigned int height = 720, bool renderOnDemand = false) noexcept :
+		Title(title), Width(width), Height(height), RenderOnDemand(renderOnDemand)
 	{}
 
 	std::string_view Title = "Topo Window";
 	unsigned int Width = 1280;
 	unsigned int Height = 720;
+
+	// Frames are only rendered when part of the window was damaged, either way. When true, the run loop also blocks
+	// waiting for input/timer messages when nothing has changed (and no animation is active) instead of spinning
+	bool RenderOnDemand = false;
 };
 
 #ifdef TOPO_PLATFORM_WINDOWS
@@ -51,7 +55,8 @@ public:
 		m_hInst(GetModuleHandle(nullptr)), // I believe GetModuleHandle should not ever throw, even though it is not marked noexcept
 		m_mouseX(0),
 		m_mouseY(0),
-		m_mouseIsInWindow(false)
+		m_mouseIsInWindow(false),
+		m_renderOnDemand(props.RenderOnDemand)
 	{
 		// Create a default page so it is guaranteed to not be null
 		m_page = std::make_unique<Page>(m_uiRenderer, static_cast<float>(props.Width), static_cast<float>(props.Height));
@@ -132,6 +137,7 @@ public:
 	ND constexpr float GetMouseX() const noexcept { return m_mouseX; }
 	ND constexpr float GetMouseY() const noexcept { return m_mouseY; }
 	ND constexpr bool MouseIsInWindow() const noexcept { return m_mouseIsInWindow; }
+	ND constexpr bool RenderOnDemand() const noexcept { return m_renderOnDemand; }
 
 	inline void BringToForeground() const noexcept { if (m_hWnd != ::GetForegroundWindow()) ::SetForegroundWindow(m_hWnd); }
 
@@ -181,6 +187,7 @@ protected:
 	float		m_mouseX;
 	float		m_mouseY;
 	bool		m_mouseIsInWindow;
+	bool		m_renderOnDemand;
 };
 
 template<typename T>
@@ -240,6 +247,17 @@ public:
 	void Render(const Timer& timer);
 	void Present();
 
+	// Damage-driven rendering. NeedsRender() returns true when a frame must be drawn (part of the window was
+	// damaged), whether or not the window renders on demand. SkipFrame() must be called in place of Render()/Present()
+	// when a frame is not drawn so the command list is closed/executed. NeedsUpdate() returns true while there are
+	// changes that the next Update() still has to pick up (and always when not rendering on demand), in which case the
+	// loop must not block. WaitForMessages() blocks until a message (input, timer, etc) arrives or the optional handle
+	// is signaled
+	ND bool NeedsRender() const noexcept;
+	ND bool NeedsUpdate() const noexcept;
+	void SkipFrame();
+	void WaitForMessages(HANDLE additionalHandle = nullptr) const noexcept;
+
 private:	
 	WPARAM MapLeftRightKeys(WPARAM vk, LPARAM lParam);
 	void InitializeRenderer();
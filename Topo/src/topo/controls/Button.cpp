@@ -5,8 +5,9 @@
 namespace topo
 {
 Button::Button(const std::shared_ptr<UIRenderer>& renderer, float left, float top, float right, float bottom) :
-	Control(left, top, right, bottom),
-	m_renderRect(renderer, left, top, right, bottom, { 0.0f, 0.0f, 1.0f, 1.0f }),
+	Control(renderer, left, top, right, bottom),
+	m_renderRect(renderer, left, top, right, bottom, m_color),
+	m_label(renderer, "", left, top, m_textColor),
 	m_layout(renderer, left, top, right, bottom)
 {
 	m_layout.AddRow(topo::RowColumnType::STAR, 1.0f);
@@ -20,4 +21,56 @@ void Button::Update(const Timer& timer)
 	m_layout.Update(timer);
 }
 
+void Button::OnReleasedToPool()
+{
+	// Don't let the next user of this button inherit the previous user's callback or appearance
+	OnUpdate = [](Button*, const Timer&) {};
+	m_margin = {};
+	m_padding = {};
+	m_color = { 0.0f, 0.0f, 1.0f, 1.0f };
+	m_textColor = { 1.0f, 1.0f, 1.0f, 1.0f };
+	m_label.SetText("");
+}
+
+void Button::SetClip(unsigned int clip)
+{
+	m_renderRect.SetClip(clip);
+	m_label.SetClip(clip);
+	m_layout.SetParentClip(clip);
+}
+
+void Button::OnCommitVisual()
+{
+	// All changes to the position/margin/padding/color since the last frame get written here exactly once
+	if (!m_visible)
+	{
+		// Collapse the rectangle so it keeps its renderer slot, but does not draw anything
+		m_renderRect.SetRectAndColor(0.0f, 0.0f, 0.0f, 0.0f, m_color);
+		m_label.SetVisible(false);
+		return;
+	}
+
+	m_renderRect.SetRectAndColor(
+		m_positionRect.Left + m_margin.Left,
+		m_positionRect.Top + m_margin.Top,
+		m_positionRect.Right - m_margin.Right,
+		m_positionRect.Bottom - m_margin.Bottom,
+		m_color
+	);
+
+	const float contentLeft = m_positionRect.Left + m_margin.Left + m_padding.Left;
+	const float contentTop = m_positionRect.Top + m_margin.Top + m_padding.Top;
+	const float contentRight = m_positionRect.Right - m_margin.Right - m_padding.Right;
+	const float contentBottom = m_positionRect.Bottom - m_margin.Bottom - m_padding.Bottom;
+
+	m_label.Set(
+		(contentLeft + contentRight - m_label.GetWidth()) / 2,
+		(contentTop + contentBottom - m_label.GetHeight()) / 2,
+		m_textColor,
+		true
+	);
+
+	m_layout.SetPosition(contentLeft, contentTop, contentRight, contentBottom);
+}
+
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Control.h"
 #include "topo/Layout.h"
 #include "geometry/RenderRectangle2D.h"
+#include "geometry/RenderText2D.h"
 
 
 namespace topo
@@ -21,43 +22,44 @@ public:
 	ND virtual float GetAutoHeight() const noexcept override { return 20.0f; }
 	ND virtual float GetAutoWidth() const noexcept override { return 20.0f; }
 
-	inline void SetMargin(const Margin& margin) noexcept { m_margin = margin; UpdatePosition(); }
-	inline void SetMargin(float left, float top, float right, float bottom) noexcept { m_margin = { left, top, right, bottom }; UpdatePosition(); }
-	inline void SetMargin(float leftright, float topbottom) noexcept { m_margin = { leftright, topbottom, leftright, topbottom }; UpdatePosition(); }
-	inline void SetMargin(float all) noexcept { m_margin = { all, all, all, all }; UpdatePosition(); }
+	// Committing only moves/recolors the rectangle and label
+	ND virtual bool CanCommitVisualInParallel() const noexcept override { return true; }
 
-	inline void SetPadding(const Padding& padding) noexcept { m_padding = padding; UpdatePosition(); }
-	inline void SetPadding(float left, float top, float right, float bottom) noexcept { m_padding = { left, top, right, bottom }; UpdatePosition(); }
-	inline void SetPadding(float leftright, float topbottom) noexcept { m_padding = { leftright, topbottom, leftright, topbottom }; UpdatePosition(); }
-	inline void SetPadding(float all) noexcept { m_padding = { all, all, all, all }; UpdatePosition(); }
+	inline void SetMargin(const Margin& margin) noexcept { m_margin = margin; InvalidateVisual(); }
+	inline void SetMargin(float left, float top, float right, float bottom) noexcept { m_margin = { left, top, right, bottom }; InvalidateVisual(); }
+	inline void SetMargin(float leftright, float topbottom) noexcept { m_margin = { leftright, topbottom, leftright, topbottom }; InvalidateVisual(); }
+	inline void SetMargin(float all) noexcept { m_margin = { all, all, all, all }; InvalidateVisual(); }
 
-	inline void SetColor(const Color& color) { m_renderRect.SetColor(color); }
+	inline void SetPadding(const Padding& padding) noexcept { m_padding = padding; InvalidateVisual(); }
+	inline void SetPadding(float left, float top, float right, float bottom) noexcept { m_padding = { left, top, right, bottom }; InvalidateVisual(); }
+	inline void SetPadding(float leftright, float topbottom) noexcept { m_padding = { leftright, topbottom, leftright, topbottom }; InvalidateVisual(); }
+	inline void SetPadding(float all) noexcept { m_padding = { all, all, all, all }; InvalidateVisual(); }
+
+	inline void SetColor(const Color& color) noexcept { m_color = color; InvalidateVisual(); }
+
+	// Label - centered within the padding
+	inline void SetText(std::string_view text) { m_label.SetText(text); InvalidateVisual(); }
+	inline void SetTextColor(const Color& color) noexcept { m_textColor = color; InvalidateVisual(); }
+	ND constexpr const std::string& GetText() const noexcept { return m_label.GetText(); }
+
+	// Control pooling
+	virtual void OnReleasedToPool() override;
+	virtual void SetClip(unsigned int clip) override;
 
 	// Event Callbacks
 	std::function<void(Button*, const Timer&)> OnUpdate = [](Button*, const Timer&) {};
 
-private:
-	inline void UpdatePosition() noexcept
-	{
-		m_renderRect.SetRect(
-			m_positionRect.Left + m_margin.Left,
-			m_positionRect.Top + m_margin.Top,
-			m_positionRect.Right - m_margin.Right,
-			m_positionRect.Bottom - m_margin.Bottom
-		);
-
-		m_layout.SetPosition(
-			m_positionRect.Left + m_margin.Left + m_padding.Left,
-			m_positionRect.Top + m_margin.Top + m_padding.Top,
-			m_positionRect.Right - m_margin.Right - m_padding.Right,
-			m_positionRect.Bottom - m_margin.Bottom - m_padding.Bottom
-		);
-	}
+protected:
+	virtual void OnCommitVisual() override;
 
+private:
 	Margin m_margin = {};
 	Padding m_padding = {};
+	Color m_color = { 0.0f, 0.0f, 1.0f, 1.0f };
+	Color m_textColor = { 1.0f, 1.0f, 1.0f, 1.0f };
 	Layout m_layout;
 	RenderRectangle2D m_renderRect;
+	RenderText2D m_label;
 
 };
 
@@ -26,6 +26,14 @@ struct Padding
 class IEventReceiver
 {
 public:
+	virtual ~IEventReceiver() noexcept { ++s_detachGeneration; }
+
+	// Bumped whenever a receiver is destroyed or taken out of its layout (i.e. parked in a ControlPool). A pointer
+	// to a receiver that was attached at some generation is still attached as long as the generation has not moved,
+	// so holders of such pointers (see Page's mouse capture) only have to look for it again after it changed
+	ND static unsigned int DetachGeneration() noexcept { return s_detachGeneration; }
+	static void NotifyDetached() noexcept { ++s_detachGeneration; }
+
 	// Window Event Methods
 	virtual void OnWindowClosed() = 0;
 	virtual void OnKillFocus() = 0;
@@ -58,23 +66,70 @@ public:
 	virtual IEventReceiver* OnKeyUp(KeyCode keyCode, unsigned int repeatCount) = 0;
 	virtual IEventReceiver* OnSysKeyDown(KeyCode keyCode, unsigned int repeatCount) = 0;
 	virtual IEventReceiver* OnSysKeyUp(KeyCode keyCode, unsigned int repeatCount) = 0;
+
+private:
+	static inline unsigned int s_detachGeneration = 0;
 };
 
 
 class Control : public IEventReceiver
 {
 public:
-	constexpr Control(float left, float top, float right, float bottom) noexcept :
+	Control(const std::shared_ptr<UIRenderer>& renderer, float left, float top, float right, float bottom) noexcept :
+		m_renderer(renderer),
 		m_positionRect{ left, top, right, bottom }
 	{}
 	Control(const Control&) = default;
 	Control(Control&&) noexcept = default;
 	Control& operator=(const Control&) = default;
 	Control& operator=(Control&&) noexcept = default;
+	virtual ~Control() noexcept = default;
 
 	virtual void Update(const Timer& timer) = 0;
 
-	ND constexpr void SetPositionRect(float left, float top, float right, float bottom) noexcept { m_positionRect = { left, top, right, bottom }; }
+	inline void SetPositionRect(float left, float top, float right, float bottom) noexcept { m_positionRect = { left, top, right, bottom }; InvalidateVisual(); InvalidateHitTesting(); }
+	ND constexpr const Rect& GetPositionRect() const noexcept { return m_positionRect; }
+	inline void SetVisible(bool visible) noexcept { if (m_visible != visible) { m_visible = visible; InvalidateVisual(); InvalidateHitTesting(); } }
+	ND constexpr bool IsVisible() const noexcept { return m_visible; }
+
+	// Visual property changes (position, margin, color, etc) should only call InvalidateVisual(). The parent
+	// layout will then call CommitVisual() once per frame (after Update) so that OnCommitVisual() can push all
+	// of the changes to the renderer at once, rather than every setter touching the renderer individually
+	inline void CommitVisual()
+	{
+		if (m_visualDirty)
+		{
+			m_visualDirty = false;
+			OnCommitVisual();
+		}
+	}
+	ND constexpr bool VisualIsDirty() const noexcept { return m_visualDirty; }
+
+	// Layouts can commit the visuals of their sublayouts on several threads at once (see Layout::SetParallelCommit),
+	// in which case OnCommitVisual() may only change existing render objects (see UIRenderer::DrawListScope). Controls
+	// that do not register/unregister render objects or run user code while committing can return true. The default
+	// is false, which keeps the whole sublayout the control is in on the layout's own thread
+	ND virtual bool CanCommitVisualInParallel() const noexcept { return false; }
+
+	// Control pooling (see ControlPool). When a control is removed from a layout, it may be parked (hidden, but
+	// still holding its renderer slots) and later handed back out by AddControl<T>. Override these to reset any
+	// state that should not carry over to the next use of the control (callbacks, text, etc)
+	virtual void OnReleasedToPool() {}
+	virtual void OnAcquiredFromPool() {}
+
+	// Moves every render object of the control into the clip (see UIRenderer::SetObjectClip). A control's objects
+	// are registered in the clip of the layout that created it, so the pool calls this whenever it parks a control
+	// or hands it out to a (possibly different) layout. Controls that own render objects must override it
+	virtual void SetClip(unsigned int clip) {}
+
+	// Lets the layout this control is in know that the control may now cover different points, which makes hit
+	// testing results cached for that layout stale (see Layout::HitTestVersion). Controls that are not in a layout
+	// have nothing to invalidate
+	inline void InvalidateHitTesting() noexcept
+	{
+		if (m_parentHitTestVersion != nullptr)
+			++(*m_parentHitTestVersion);
+	}
 
 	ND virtual float GetAutoHeight() const noexcept { return 0.0f; }
 	ND virtual float GetAutoWidth() const noexcept { return 0.0f; }
@@ -113,8 +168,22 @@ public:
 	virtual IEventReceiver* OnSysKeyUp(KeyCode keyCode, unsigned int repeatCount) override { return nullptr; }
 
 protected:
+	inline void InvalidateVisual() noexcept 
+	{ 
+		m_visualDirty = true; 
+		m_renderer->MarkDirty(); 
+	}
+	virtual void OnCommitVisual() {}
+
+	std::shared_ptr<UIRenderer> m_renderer;
 	Rect m_positionRect;
+	bool m_visualDirty = true;
+	bool m_visible = true;
 
+private:
+	// Set by the layout that owns the control (see Layout::AddControl)
+	friend class Layout;
+	unsigned int* m_parentHitTestVersion = nullptr;
 
 
 // In DIST builds, we don't name the object
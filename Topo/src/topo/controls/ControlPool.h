@@ -0,0 +1,78 @@
+#pragma once
+#include "topo/Core.h"
+#include "Control.h"
+#include "topo/Log.h"
+
+
+namespace topo
+{
+// ControlPool parks controls that have been removed from a layout so they can be handed out again by the next
+// call to Layout::AddControl<T> for the same type. A parked control is hidden (so it draws nothing), but it keeps
+// all of its renderer slots. This means UIs that constantly create/destroy controls (popups, list items, etc)
+// reach a steady state where adding/removing controls neither allocates nor grows the renderer's instance data.
+//
+// Controls are pooled by their exact type. Controls that get reused are notified via OnReleasedToPool() and
+// OnAcquiredFromPool() so they can reset any per-use state (callbacks, text, etc).
+class ControlPool
+{
+public:
+	ControlPool() noexcept = default;
+	ControlPool(const ControlPool&) = delete;
+	ControlPool(ControlPool&&) = delete;
+	ControlPool& operator=(const ControlPool&) = delete;
+	ControlPool& operator=(ControlPool&&) = delete;
+
+	// Returns a parked control of type T (moved into the clip, see Control::SetClip) or nullptr if there are none
+	template<typename T> requires std::derived_from<T, ::topo::Control>
+	ND std::unique_ptr<T> Acquire(unsigned int clip)
+	{
+		auto iter = m_parked.find(std::type_index(typeid(T)));
+		if (iter == m_parked.end() || iter->second.empty())
+			return nullptr;
+
+		std::unique_ptr<Control> control = std::move(iter->second.back());
+		iter->second.pop_back();
+		--m_parkedCount;
+
+		control->SetClip(clip);
+		control->SetVisible(true);
+		control->OnAcquiredFromPool();
+		return std::unique_ptr<T>(static_cast<T*>(control.release()));
+	}
+
+	// Hides the control and parks it. If the pool already holds the maximum number of controls of this type,
+	// the control is destroyed instead
+	void Release(std::unique_ptr<Control> control)
+	{
+		ASSERT(control != nullptr, "Cannot release a nullptr control");
+
+		std::vector<std::unique_ptr<Control>>& parked = m_parked[std::type_index(typeid(*control))];
+		if (parked.size() >= m_maxParkedPerType)
+			return;
+
+		// Parked controls are not part of any layout, so they will not get a CommitVisual() call from a
+		// layout. Therefore, we must commit the hidden state right away. They are also moved out of the clip of
+		// their layout, which may be unregistered (and its slot reused) while they are parked
+		control->SetVisible(false);
+		control->OnReleasedToPool();
+		control->CommitVisual();
+		control->SetClip(UIRenderer::WindowClip);
+		IEventReceiver::NotifyDetached();
+
+		parked.push_back(std::move(control));
+		++m_parkedCount;
+	}
+
+	// Destroys all parked controls (this is the only time the pool gives renderer slots back)
+	inline void Clear() noexcept { m_parked.clear(); m_parkedCount = 0; }
+
+	inline void SetMaxParkedPerType(size_t max) noexcept { m_maxParkedPerType = max; }
+	ND constexpr size_t GetMaxParkedPerType() const noexcept { return m_maxParkedPerType; }
+	ND constexpr size_t ParkedCount() const noexcept { return m_parkedCount; }
+
+private:
+	std::unordered_map<std::type_index, std::vector<std::unique_ptr<Control>>> m_parked;
+	size_t m_parkedCount = 0;
+	size_t m_maxParkedPerType = 256;
+};
+}
@@ -0,0 +1,422 @@
+#pragma once
+#include "topo/Core.h"
+#include "Control.h"
+#include "ControlPool.h"
+#include "topo/utils/ObservableCollection.h"
+
+
+namespace topo
+{
+// ItemsControl displays the items of an ObservableCollection as a vertical list of fixed height rows. Only
+// the rows that are currently visible are realized as TItemControl's, so the number of controls (and renderer
+// slots) is proportional to the height of the control, not the number of items. When the collection changes,
+// only the change set is applied: rows are inserted/removed from the realized window as needed, controls that
+// fall out of the window are parked in a ControlPool for reuse, and only rows that now display a different item are
+// re-bound via the BindItem callback. Changes that occur entirely outside of the visible window only adjust
+// indices, so streaming items into a large list costs proportional to the size of the change. The rows are
+// realized in a clip of the control's own (nested in the clip the control was created in), so rows that are
+// partially scrolled out of view are clipped to the control's rect.
+//
+// NOTE: The collection must outlive the ItemsControl (or call SetItemsSource(nullptr) before destroying it)
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+class ItemsControl : public Control
+{
+public:
+	ItemsControl(const std::shared_ptr<UIRenderer>& renderer, float left, float top, float right, float bottom) :
+		Control(renderer, left, top, right, bottom),
+		m_clip(renderer->RegisterClip(m_positionRect)),
+		m_clipRect(m_positionRect)
+	{}
+	ItemsControl(const ItemsControl&) = delete;
+	ItemsControl(ItemsControl&&) = delete;
+	ItemsControl& operator=(const ItemsControl&) = delete;
+	ItemsControl& operator=(ItemsControl&&) = delete;
+	virtual ~ItemsControl() override
+	{
+		SetItemsSource(nullptr);
+		m_renderer->UnregisterClip(m_clip);
+	}
+
+	virtual void Update(const Timer& timer) override;
+
+	void SetItemsSource(ObservableCollection<T>* itemsSource);
+	ND constexpr ObservableCollection<T>* GetItemsSource() const noexcept { return m_itemsSource; }
+
+	inline void SetItemHeight(float height) noexcept
+	{
+		m_itemHeight = std::max(height, 1.0f);
+		SetScrollOffset(m_scrollOffset);
+	}
+	ND constexpr float GetItemHeight() const noexcept { return m_itemHeight; }
+
+	void SetScrollOffset(float offset);
+	ND constexpr float GetScrollOffset() const noexcept { return m_scrollOffset; }
+
+	ND constexpr size_t GetFirstRealizedIndex() const noexcept { return m_firstRealized; }
+	ND constexpr size_t GetRealizedCount() const noexcept { return m_realized.size(); }
+
+	// Rows are realized in the control's own clip, which is nested in the clip that was current when the
+	// ItemsControl was created (or the one given here)
+	virtual void SetClip(unsigned int clip) override { m_renderer->SetClipParent(m_clip, clip); }
+	ND constexpr unsigned int GetClip() const noexcept { return m_clip; }
+
+	// BindItem is called whenever a realized control needs to display a (different) item. It is called during
+	// the control's commit pass, so it is called at most once per row per frame. Recycled controls have been reset
+	// by OnReleasedToPool(), so BindItem should set up everything about the control that depends on the item
+	std::function<void(TItemControl*, const T&, size_t)> BindItem = [](TItemControl*, const T&, size_t) {};
+	std::function<void(ItemsControl*, const Timer&)> OnUpdate = [](ItemsControl*, const Timer&) {};
+
+	// Mouse events are forwarded to the realized item controls
+	virtual IEventReceiver* OnLButtonDown(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates) override;
+	virtual IEventReceiver* OnLButtonUp(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates) override;
+	virtual IEventReceiver* OnMouseMoved(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates) override;
+	virtual IEventReceiver* OnMouseWheel(float wheelDelta, float mouseX, float mouseY, MouseButtonEventKeyStates keyStates) override;
+
+protected:
+	virtual void OnCommitVisual() override;
+
+private:
+	struct RealizedItem
+	{
+		std::unique_ptr<TItemControl> Control = nullptr;
+		bool NeedsBind = true;
+	};
+
+	void OnCollectionChanged(std::span<const CollectionChange> changes);
+	void ApplyInsert(size_t index, size_t count);
+	void ApplyRemove(size_t index, size_t count);
+	void ApplyUpdate(size_t index, size_t count) noexcept;
+	void ReleaseAll();
+	void EnsureRealizedRange();
+
+	ND std::unique_ptr<TItemControl> AcquireControl();
+	void ReleaseControl(std::unique_ptr<TItemControl> control);
+
+	ND constexpr size_t ItemCount() const noexcept { return m_itemsSource != nullptr ? m_itemsSource->Size() : 0; }
+	ND inline size_t VisibleCapacity() const noexcept
+	{
+		// +1 because the first and last rows can both be partially visible
+		return static_cast<size_t>(std::ceil(std::max(m_positionRect.Height(), 0.0f) / m_itemHeight)) + 1;
+	}
+	ND inline float MaxScrollOffset() const noexcept
+	{
+		return std::max(0.0f, static_cast<float>(ItemCount()) * m_itemHeight - m_positionRect.Height());
+	}
+
+	ObservableCollection<T>* m_itemsSource = nullptr;
+	unsigned int m_subscriptionToken = 0;
+
+	// m_realized[iii] displays the item at index m_firstRealized + iii
+	std::vector<RealizedItem> m_realized;
+	ControlPool m_recycled;
+
+	// The clip the rows are realized in, and the rect it was last given
+	unsigned int m_clip = UIRenderer::WindowClip;
+	Rect m_clipRect;
+	size_t m_firstRealized = 0;
+	size_t m_lastRealizedCapacity = 0;
+
+	float m_scrollOffset = 0.0f;
+	float m_itemHeight = 20.0f;
+};
+
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+void ItemsControl<T, TItemControl>::Update(const Timer& timer)
+{
+	OnUpdate(this, timer);
+
+	// Commit our own changes first so that any rows that were moved/re-bound get committed below this same frame
+	CommitVisual();
+
+	for (RealizedItem& item : m_realized)
+	{
+		item.Control->Update(timer);
+		item.Control->CommitVisual();
+	}
+}
+
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+void ItemsControl<T, TItemControl>::SetItemsSource(ObservableCollection<T>* itemsSource)
+{
+	if (m_itemsSource != nullptr)
+		m_itemsSource->Unsubscribe(m_subscriptionToken);
+
+	m_itemsSource = itemsSource;
+	ReleaseAll();
+	m_firstRealized = 0;
+	m_scrollOffset = 0.0f;
+
+	if (m_itemsSource != nullptr)
+	{
+		m_subscriptionToken = m_itemsSource->Subscribe(
+			[this](std::span<const CollectionChange> changes) { OnCollectionChanged(changes); }
+		);
+	}
+
+	EnsureRealizedRange();
+	InvalidateVisual();
+}
+
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+void ItemsControl<T, TItemControl>::SetScrollOffset(float offset)
+{
+	m_scrollOffset = std::clamp(offset, 0.0f, MaxScrollOffset());
+	const size_t newFirst = static_cast<size_t>(m_scrollOffset / m_itemHeight);
+
+	if (newFirst > m_firstRealized)
+	{
+		// Scrolled down - release the rows that scrolled off the top
+		const size_t shift = std::min(newFirst - m_firstRealized, m_realized.size());
+		for (size_t iii = 0; iii < shift; ++iii)
+			ReleaseControl(std::move(m_realized[iii].Control));
+		m_realized.erase(m_realized.begin(), m_realized.begin() + shift);
+	}
+	else if (newFirst < m_firstRealized)
+	{
+		// Scrolled up - realize the rows that scrolled in at the top (EnsureRealizedRange() will trim the bottom)
+		const size_t shift = std::min(m_firstRealized - newFirst, VisibleCapacity());
+		if (shift >= m_realized.size())
+			ReleaseAll();
+		else
+		{
+			std::vector<RealizedItem> newRows(shift);
+			for (RealizedItem& row : newRows)
+				row.Control = AcquireControl();
+			m_realized.insert(m_realized.begin(), std::make_move_iterator(newRows.begin()), std::make_move_iterator(newRows.end()));
+		}
+	}
+
+	m_firstRealized = newFirst;
+	EnsureRealizedRange();
+	InvalidateVisual();
+}
+
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+void ItemsControl<T, TItemControl>::OnCollectionChanged(std::span<const CollectionChange> changes)
+{
+	for (const CollectionChange& change : changes)
+	{
+		switch (change.Type)
+		{
+		case CollectionChangeType::Insert: ApplyInsert(change.Index, change.Count); break;
+		case CollectionChangeType::Remove: ApplyRemove(change.Index, change.Count); break;
+		case CollectionChangeType::Update: ApplyUpdate(change.Index, change.Count); break;
+		case CollectionChangeType::Move:
+			ApplyRemove(change.Index, 1);
+			ApplyInsert(change.NewIndex, 1);
+			break;
+		case CollectionChangeType::Reset:
+			ReleaseAll();
+			m_firstRealized = 0;
+			m_scrollOffset = 0.0f;
+			break;
+		}
+	}
+
+	// Removing items may mean we are now scrolled beyond the end of the list
+	if (m_scrollOffset > MaxScrollOffset())
+		SetScrollOffset(m_scrollOffset);
+
+	EnsureRealizedRange();
+	InvalidateVisual();
+}
+
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+void ItemsControl<T, TItemControl>::ApplyInsert(size_t index, size_t count)
+{
+	if (index < m_firstRealized)
+	{
+		// Inserted above the visible window - keep showing the same items by shifting the window down
+		m_firstRealized += count;
+		m_scrollOffset += static_cast<float>(count) * m_itemHeight;
+		return;
+	}
+
+	const size_t relativeIndex = index - m_firstRealized;
+	const size_t capacity = VisibleCapacity();
+	if (relativeIndex > m_realized.size() || relativeIndex >= capacity)
+		return; // Inserted below the visible window - nothing to do
+
+	// Only realize as many of the new rows as can actually be seen
+	const size_t newRowCount = std::min(count, capacity - relativeIndex);
+	std::vector<RealizedItem> newRows(newRowCount);
+	for (RealizedItem& row : newRows)
+		row.Control = AcquireControl();
+	m_realized.insert(m_realized.begin() + relativeIndex, std::make_move_iterator(newRows.begin()), std::make_move_iterator(newRows.end()));
+
+	// Rows that were pushed out of the bottom of the window get released
+	while (m_realized.size() > capacity)
+	{
+		ReleaseControl(std::move(m_realized.back().Control));
+		m_realized.pop_back();
+	}
+}
+
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+void ItemsControl<T, TItemControl>::ApplyRemove(size_t index, size_t count)
+{
+	const size_t removeEnd = index + count;
+	const size_t realizedEnd = m_firstRealized + m_realized.size();
+
+	// Number of removed items that were above the visible window
+	const size_t removedAbove = std::min(removeEnd, m_firstRealized) - std::min(index, m_firstRealized);
+
+	// Removed items that were within the visible window
+	const size_t first = std::max(index, m_firstRealized);
+	const size_t last = std::min(removeEnd, realizedEnd);
+	if (first < last)
+	{
+		const size_t relativeFirst = first - m_firstRealized;
+		const size_t relativeLast = last - m_firstRealized;
+		for (size_t iii = relativeFirst; iii < relativeLast; ++iii)
+			ReleaseControl(std::move(m_realized[iii].Control));
+		m_realized.erase(m_realized.begin() + relativeFirst, m_realized.begin() + relativeLast);
+	}
+
+	m_firstRealized -= removedAbove;
+	m_scrollOffset = std::max(0.0f, m_scrollOffset - static_cast<float>(removedAbove) * m_itemHeight);
+}
+
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+void ItemsControl<T, TItemControl>::ApplyUpdate(size_t index, size_t count) noexcept
+{
+	const size_t first = std::max(index, m_firstRealized);
+	const size_t last = std::min(index + count, m_firstRealized + m_realized.size());
+	for (size_t iii = first; iii < last; ++iii)
+		m_realized[iii - m_firstRealized].NeedsBind = true;
+}
+
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+void ItemsControl<T, TItemControl>::ReleaseAll()
+{
+	for (RealizedItem& row : m_realized)
+		ReleaseControl(std::move(row.Control));
+	m_realized.clear();
+}
+
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+void ItemsControl<T, TItemControl>::EnsureRealizedRange()
+{
+	const size_t itemCount = ItemCount();
+	const size_t end = std::min(m_firstRealized + VisibleCapacity(), itemCount);
+	const size_t desiredCount = end > m_firstRealized ? end - m_firstRealized : 0;
+
+	while (m_realized.size() > desiredCount)
+	{
+		ReleaseControl(std::move(m_realized.back().Control));
+		m_realized.pop_back();
+	}
+	while (m_realized.size() < desiredCount)
+		m_realized.emplace_back(AcquireControl(), true);
+}
+
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+std::unique_ptr<TItemControl> ItemsControl<T, TItemControl>::AcquireControl()
+{
+	if (std::unique_ptr<TItemControl> control = m_recycled.Acquire<TItemControl>(m_clip))
+		return control;
+
+	UIRenderer::ClipScope clipScope(*m_renderer, m_clip);
+	return std::make_unique<TItemControl>(m_renderer, 0.0f, 0.0f, 0.0f, 0.0f);
+}
+
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+void ItemsControl<T, TItemControl>::ReleaseControl(std::unique_ptr<TItemControl> control)
+{
+	// Keep the control (and its renderer slots) around, but hidden (the pool commits the hidden state, because
+	// released controls are no longer updated)
+	m_recycled.Release(std::move(control));
+}
+
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+void ItemsControl<T, TItemControl>::OnCommitVisual()
+{
+	// The control may have moved, which moves the clip its rows are cut to
+	if (m_clipRect != m_positionRect)
+	{
+		m_clipRect = m_positionRect;
+		m_renderer->SetClipRect(m_clip, m_clipRect);
+	}
+
+	// The size of the control may have changed, which changes how many rows can be visible
+	const size_t capacity = VisibleCapacity();
+	if (capacity != m_lastRealizedCapacity)
+	{
+		m_lastRealizedCapacity = capacity;
+		SetScrollOffset(m_scrollOffset);
+	}
+
+	// Position each realized row and bind any row that is now displaying a different item. Rows whose position
+	// and item did not change are left alone so they do not touch the renderer
+	for (size_t iii = 0; iii < m_realized.size(); ++iii)
+	{
+		RealizedItem& row = m_realized[iii];
+		const size_t itemIndex = m_firstRealized + iii;
+
+		const float top = m_positionRect.Top + static_cast<float>(itemIndex) * m_itemHeight - m_scrollOffset;
+		const Rect rect = { m_positionRect.Left, top, m_positionRect.Right, top + m_itemHeight };
+		if (row.Control->GetPositionRect() != rect)
+			row.Control->SetPositionRect(rect.Left, rect.Top, rect.Right, rect.Bottom);
+
+		if (row.NeedsBind)
+		{
+			row.NeedsBind = false;
+			BindItem(row.Control.get(), (*m_itemsSource)[itemIndex], itemIndex);
+		}
+	}
+
+	// SetScrollOffset() above may have invalidated us again, but everything has now been committed
+	m_visualDirty = false;
+}
+
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+IEventReceiver* ItemsControl<T, TItemControl>::OnLButtonDown(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
+{
+	if (!m_positionRect.ContainsPoint(mouseX, mouseY))
+		return nullptr;
+
+	for (RealizedItem& row : m_realized)
+	{
+		if (IEventReceiver* ret = row.Control->OnLButtonDown(mouseX, mouseY, keyStates))
+			return ret;
+	}
+	return this;
+}
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+IEventReceiver* ItemsControl<T, TItemControl>::OnLButtonUp(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
+{
+	if (!m_positionRect.ContainsPoint(mouseX, mouseY))
+		return nullptr;
+
+	for (RealizedItem& row : m_realized)
+	{
+		if (IEventReceiver* ret = row.Control->OnLButtonUp(mouseX, mouseY, keyStates))
+			return ret;
+	}
+	return this;
+}
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+IEventReceiver* ItemsControl<T, TItemControl>::OnMouseMoved(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
+{
+	if (!m_positionRect.ContainsPoint(mouseX, mouseY))
+		return nullptr;
+
+	for (RealizedItem& row : m_realized)
+	{
+		if (IEventReceiver* ret = row.Control->OnMouseMoved(mouseX, mouseY, keyStates))
+			return ret;
+	}
+	return nullptr;
+}
+template<typename T, typename TItemControl> requires std::derived_from<TItemControl, ::topo::Control>
+IEventReceiver* ItemsControl<T, TItemControl>::OnMouseWheel(float wheelDelta, float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
+{
+	if (!m_positionRect.ContainsPoint(mouseX, mouseY))
+		return nullptr;
+
+	// WHEEL_DELTA (120) per notch - scroll 3 rows per notch
+	SetScrollOffset(m_scrollOffset - (wheelDelta / 120.0f) * 3.0f * m_itemHeight);
+	return this;
+}
+
+}
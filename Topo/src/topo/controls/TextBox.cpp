@@ -0,0 +1,416 @@
+#include "pch.h"
+#include "TextBox.h"
+
+#ifdef TOPO_PLATFORM_WINDOWS
+#pragma push_macro("DELETE")
+#undef DELETE
+#endif
+
+namespace topo
+{
+TextBox::TextBox(const std::shared_ptr<UIRenderer>& renderer, float left, float top, float right, float bottom) :
+	Control(renderer, left, top, right, bottom),
+	m_layer(renderer->GetCurrentLayer()),
+	m_clip(renderer->GetCurrentClip()),
+	m_backgroundRect(renderer, left, top, right, bottom, m_backgroundColor),
+	m_caretRect(renderer, left, top, left, top, m_caretColor)
+{
+	GlyphCache& cache = m_renderer->GetGlyphCache();
+	m_font = cache.LoadFont(m_fontFamily);
+	m_lineHeight = std::max(std::ceil(cache.GetFontMetrics(m_font, m_fontSize).LineHeight()), 1.0f);
+}
+
+void TextBox::Update(const Timer& timer)
+{
+	OnUpdate(this, timer);
+
+	// Apply all of the characters that were typed since the last frame as a single edit
+	CommitPendingInput();
+}
+
+void TextBox::SetText(std::string text)
+{
+	m_pendingInput.clear();
+	m_pendingBackspaces = 0;
+	m_pendingHighSurrogate = 0;
+
+	m_document = PieceTable(std::move(text));
+	m_caret = 0;
+	m_firstVisibleLine = 0;
+	InvalidateLines(0);
+
+	OnTextChanged(this);
+}
+
+void TextBox::SetFont(std::string_view fontFamily, float size)
+{
+	GlyphCache& cache = m_renderer->GetGlyphCache();
+	m_fontFamily = fontFamily;
+	m_fontSize = size;
+	m_font = cache.LoadFont(m_fontFamily);
+	m_lineHeight = std::max(std::ceil(cache.GetFontMetrics(m_font, m_fontSize).LineHeight()), 1.0f);
+
+	for (RenderText2D& text : m_lineTexts)
+		text.SetFont(m_fontFamily, m_fontSize);
+	InvalidateVisual();
+}
+
+void TextBox::OnReleasedToPool()
+{
+	// Reset the callbacks first so that clearing the text does not notify the previous user
+	OnUpdate = [](TextBox*, const Timer&) {};
+	OnTextChanged = [](TextBox*) {};
+
+	m_pendingInput.clear();
+	m_pendingBackspaces = 0;
+	m_pendingHighSurrogate = 0;
+	m_document = PieceTable();
+	m_caret = 0;
+	m_firstVisibleLine = 0;
+	InvalidateLines(0);
+
+	// Pooled controls should not keep their glyph objects (and the glyphs they pin in the atlas) around
+	m_visibleLines.clear();
+	m_extractedLines.clear();
+	m_lineTexts.clear();
+}
+void TextBox::SetClip(unsigned int clip)
+{
+	m_clip = clip;
+	m_backgroundRect.SetClip(clip);
+	m_caretRect.SetClip(clip);
+	for (RenderText2D& text : m_lineTexts)
+		text.SetClip(clip);
+}
+
+void TextBox::SetCaretPosition(size_t position)
+{
+	CommitPendingInput();
+	m_caret = std::min(position, m_document.Length());
+	EnsureCaretVisible();
+	InvalidateVisual();
+}
+void TextBox::ScrollToLine(size_t line)
+{
+	line = std::min(line, m_document.LineCount() - 1);
+	if (line == m_firstVisibleLine)
+		return;
+
+	// Lines that stay in view keep their text and RenderText2D, they just move to the slot of their new position
+	const size_t count = m_visibleLines.size();
+	const auto rotate = [this](size_t middle)
+	{
+		std::rotate(m_visibleLines.begin(), m_visibleLines.begin() + middle, m_visibleLines.end());
+		std::rotate(m_extractedLines.begin(), m_extractedLines.begin() + middle, m_extractedLines.end());
+		std::rotate(m_lineTexts.begin(), m_lineTexts.begin() + middle, m_lineTexts.end());
+	};
+	if (line > m_firstVisibleLine && line - m_firstVisibleLine < count)
+		rotate(line - m_firstVisibleLine);
+	else if (line < m_firstVisibleLine && m_firstVisibleLine - line < count)
+		rotate(count - (m_firstVisibleLine - line));
+
+	m_firstVisibleLine = line;
+	InvalidateVisual();
+}
+
+void TextBox::CommitPendingInput()
+{
+	if (m_pendingBackspaces == 0 && m_pendingInput.empty())
+		return;
+
+	// Line of the edit - every visible line at or after this line may have changed
+	size_t editLine = m_document.LineFromPosition(m_caret);
+
+	if (m_pendingBackspaces > 0)
+	{
+		size_t start = m_caret;
+		for (size_t iii = 0; iii < m_pendingBackspaces && start > 0; ++iii)
+			start = PreviousCodepoint(start);
+
+		const size_t count = m_caret - start;
+		m_caret = start;
+		m_document.Erase(m_caret, count);
+		editLine = m_document.LineFromPosition(m_caret);
+		m_pendingBackspaces = 0;
+	}
+
+	if (!m_pendingInput.empty())
+	{
+		m_document.Insert(m_caret, m_pendingInput);
+		m_caret += m_pendingInput.size();
+		m_pendingInput.clear();
+	}
+
+	InvalidateLines(editLine);
+	EnsureCaretVisible();
+
+	OnTextChanged(this);
+}
+void TextBox::EnsureCaretVisible()
+{
+	const size_t caretLine = m_document.LineFromPosition(m_caret);
+	const size_t capacity = std::max(VisibleLineCapacity(), static_cast<size_t>(1));
+
+	if (caretLine < m_firstVisibleLine)
+		ScrollToLine(caretLine);
+	else if (caretLine >= m_firstVisibleLine + capacity)
+		ScrollToLine(caretLine - capacity + 1);
+}
+void TextBox::RefreshVisibleLines()
+{
+	const size_t lineCount = m_document.LineCount();
+	const size_t visibleCount = std::min(VisibleLineCapacity(), lineCount - std::min(m_firstVisibleLine, lineCount));
+
+	m_visibleLines.resize(visibleCount);
+	m_extractedLines.resize(visibleCount, NoLine);
+	if (m_lineTexts.size() > visibleCount)
+		m_lineTexts.erase(m_lineTexts.begin() + visibleCount, m_lineTexts.end());
+	else if (m_lineTexts.size() < visibleCount)
+	{
+		UIRenderer::LayerScope layerScope(*m_renderer, m_layer);
+		UIRenderer::ClipScope clipScope(*m_renderer, m_clip);
+		while (m_lineTexts.size() < visibleCount)
+			m_lineTexts.emplace_back(m_renderer, "", 0.0f, 0.0f, m_textColor, m_fontFamily, m_fontSize);
+	}
+
+	// Only re-extract (and reshape) the lines that could have changed or that scrolled into view
+	for (size_t iii = 0; iii < visibleCount; ++iii)
+	{
+		const size_t line = m_firstVisibleLine + iii;
+		if (line < m_firstDirtyLine && m_extractedLines[iii] == line)
+			continue;
+
+		m_visibleLines[iii] = m_document.GetLine(line);
+		m_extractedLines[iii] = line;
+		m_lineTexts[iii].SetText(m_visibleLines[iii]);
+	}
+
+	m_firstDirtyLine = std::numeric_limits<size_t>::max();
+}
+
+size_t TextBox::PreviousCodepoint(size_t position) const noexcept
+{
+	if (position == 0)
+		return 0;
+
+	// Step back over the continuation bytes to the lead byte
+	--position;
+	while (position > 0 && is_utf8_continuation(m_document.CharAt(position)))
+		--position;
+	return position;
+}
+size_t TextBox::NextCodepoint(size_t position) const noexcept
+{
+	const size_t length = m_document.Length();
+	if (position >= length)
+		return length;
+
+	++position;
+	while (position < length && is_utf8_continuation(m_document.CharAt(position)))
+		++position;
+	return position;
+}
+size_t TextBox::ColumnFromPosition(size_t position) const
+{
+	const size_t lineStart = m_document.LineStart(m_document.LineFromPosition(position));
+	const std::string text = m_document.GetText(lineStart, position - lineStart);
+	return static_cast<size_t>(std::ranges::count_if(text, [](char c) { return !is_utf8_continuation(c); }));
+}
+size_t TextBox::PositionFromColumn(size_t line, size_t column) const
+{
+	const size_t lineStart = m_document.LineStart(line);
+	const std::string text = m_document.GetText(lineStart, m_document.LineEnd(line) - lineStart);
+
+	// Walk the lead bytes until we have passed 'column' codepoints (or hit the end of the line)
+	size_t offset = 0;
+	for (; offset < text.size(); ++offset)
+	{
+		if (!is_utf8_continuation(text[offset]))
+		{
+			if (column == 0)
+				break;
+			--column;
+		}
+	}
+	return lineStart + offset;
+}
+float TextBox::OffsetFromColumn(std::string_view line, size_t column) const
+{
+	// The line was shaped when it was drawn, so this hits the run cache
+	const ShapedRun& run = m_renderer->GetGlyphCache().ShapeText(line, m_font, m_fontSize);
+	return column < run.Glyphs.size() ? run.Glyphs[column].X : run.Width;
+}
+size_t TextBox::ColumnFromOffset(std::string_view line, float offset) const
+{
+	// The caret goes in front of the first glyph whose center is past the offset
+	const ShapedRun& run = m_renderer->GetGlyphCache().ShapeText(line, m_font, m_fontSize);
+	for (size_t iii = 0; iii < run.Glyphs.size(); ++iii)
+	{
+		const float right = iii + 1 < run.Glyphs.size() ? run.Glyphs[iii + 1].X : run.Width;
+		if (offset < (run.Glyphs[iii].X + right) / 2)
+			return iii;
+	}
+	return run.Glyphs.size();
+}
+
+void TextBox::OnCommitVisual()
+{
+	// Only the lines that were edited or scrolled into view get extracted and shaped
+	RefreshVisibleLines();
+
+	m_backgroundRect.SetRectAndColor(
+		m_positionRect.Left, m_positionRect.Top, m_positionRect.Right, m_positionRect.Bottom,
+		m_visible ? m_backgroundColor : Color{}
+	);
+
+	const float textLeft = m_positionRect.Left + m_padding.Left;
+	const float textTop = m_positionRect.Top + m_padding.Top;
+	for (size_t iii = 0; iii < m_lineTexts.size(); ++iii)
+		m_lineTexts[iii].Set(textLeft, textTop + static_cast<float>(iii) * m_lineHeight, m_textColor, m_visible);
+
+	// Position the caret. If it is not within the visible lines, collapse it
+	const size_t caretLine = m_document.LineFromPosition(m_caret);
+	if (!m_visible || caretLine < m_firstVisibleLine || caretLine >= m_firstVisibleLine + m_visibleLines.size())
+	{
+		m_caretRect.SetRectAndColor(0.0f, 0.0f, 0.0f, 0.0f, m_caretColor);
+		return;
+	}
+
+	const size_t slot = caretLine - m_firstVisibleLine;
+	const size_t column = ColumnFromPosition(m_caret);
+	const float left = textLeft + OffsetFromColumn(m_visibleLines[slot], column);
+	const float top = textTop + static_cast<float>(slot) * m_lineHeight;
+	m_caretRect.SetRectAndColor(left, top, left + 1.0f, top + m_lineHeight, m_caretColor);
+}
+
+IEventReceiver* TextBox::OnLButtonDown(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
+{
+	if (!m_positionRect.ContainsPoint(mouseX, mouseY))
+		return nullptr;
+
+	CommitPendingInput();
+
+	// Move the caret to the character closest to the mouse
+	const float localY = mouseY - m_positionRect.Top - m_padding.Top;
+	const size_t line = std::min(m_firstVisibleLine + static_cast<size_t>(std::max(localY, 0.0f) / m_lineHeight), m_document.LineCount() - 1);
+
+	const float localX = mouseX - m_positionRect.Left - m_padding.Left;
+	SetCaretPosition(PositionFromColumn(line, ColumnFromOffset(m_document.GetLine(line), localX)));
+
+	// Returning this makes the Page route keyboard input to us
+	return this;
+}
+IEventReceiver* TextBox::OnMouseWheel(float wheelDelta, float mouseX, float mouseY, MouseButtonEventKeyStates keyStates)
+{
+	if (!m_positionRect.ContainsPoint(mouseX, mouseY))
+		return nullptr;
+
+	// WHEEL_DELTA (120) per notch - scroll 3 lines per notch
+	const long long delta = -static_cast<long long>(wheelDelta / 120.0f * 3.0f);
+	const long long line = std::max(static_cast<long long>(m_firstVisibleLine) + delta, 0LL);
+	ScrollToLine(static_cast<size_t>(line));
+	return this;
+}
+IEventReceiver* TextBox::OnChar(unsigned int character, unsigned int repeatCount)
+{
+	// The first half of a surrogate pair just gets held on to until the second half arrives
+	if (character >= 0xD800 && character <= 0xDBFF)
+	{
+		m_pendingHighSurrogate = character;
+		return this;
+	}
+
+	char32_t codepoint = character;
+	if (character >= 0xDC00 && character <= 0xDFFF)
+	{
+		// A low surrogate without a high surrogate in front of it is malformed input - drop it
+		if (m_pendingHighSurrogate == 0) [[unlikely]]
+			return this;
+		codepoint = 0x10000 + ((m_pendingHighSurrogate - 0xD800) << 10) + (character - 0xDC00);
+	}
+	m_pendingHighSurrogate = 0;
+
+	// Just queue up the input - it gets applied once per frame in Update()
+	for (unsigned int iii = 0; iii < std::max(repeatCount, 1u); ++iii)
+	{
+		switch (codepoint)
+		{
+		case '\b':
+			// A backspace first removes a codepoint that has not been committed yet
+			if (!m_pendingInput.empty())
+			{
+				while (is_utf8_continuation(m_pendingInput.back()))
+					m_pendingInput.pop_back();
+				m_pendingInput.pop_back();
+			}
+			else
+				++m_pendingBackspaces;
+			break;
+		case '\r':
+			m_pendingInput.push_back('\n');
+			break;
+		default:
+			// Ignore all other control characters (ctrl+key combinations, escape, DEL, etc)
+			if (codepoint == '\t' || (codepoint >= 0x20 && codepoint != 0x7F))
+				append_utf8(m_pendingInput, codepoint);
+			break;
+		}
+	}
+
+	m_renderer->MarkDirty();
+	return this;
+}
+IEventReceiver* TextBox::OnKeyDown(KeyCode keyCode, unsigned int repeatCount)
+{
+	// Navigation keys must see all of the text that was typed before them
+	switch (keyCode)
+	{
+	case KeyCode::LEFT:
+		CommitPendingInput();
+		SetCaretPosition(PreviousCodepoint(m_caret));
+		break;
+	case KeyCode::RIGHT:
+		CommitPendingInput();
+		SetCaretPosition(NextCodepoint(m_caret));
+		break;
+	case KeyCode::UP:
+	case KeyCode::DOWN:
+	{
+		CommitPendingInput();
+		const size_t line = m_document.LineFromPosition(m_caret);
+		if ((keyCode == KeyCode::UP && line == 0) || (keyCode == KeyCode::DOWN && line + 1 >= m_document.LineCount()))
+			break;
+
+		const size_t newLine = keyCode == KeyCode::UP ? line - 1 : line + 1;
+		SetCaretPosition(PositionFromColumn(newLine, ColumnFromPosition(m_caret)));
+		break;
+	}
+	case KeyCode::HOME:
+		CommitPendingInput();
+		SetCaretPosition(m_document.LineStart(m_document.LineFromPosition(m_caret)));
+		break;
+	case KeyCode::END:
+		CommitPendingInput();
+		SetCaretPosition(m_document.LineEnd(m_document.LineFromPosition(m_caret)));
+		break;
+	case KeyCode::DELETE:
+		CommitPendingInput();
+		if (m_caret < m_document.Length())
+		{
+			m_document.Erase(m_caret, NextCodepoint(m_caret) - m_caret);
+			InvalidateLines(m_document.LineFromPosition(m_caret));
+			OnTextChanged(this);
+		}
+		break;
+	default:
+		break;
+	}
+
+	return this;
+}
+
+}
+
+#ifdef TOPO_PLATFORM_WINDOWS
+#pragma pop_macro("DELETE")
+#endif
\ No newline at end of file
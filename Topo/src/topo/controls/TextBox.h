@@ -0,0 +1,146 @@
+#pragma once
+#include "topo/Core.h"
+#include "Control.h"
+#include "geometry/RenderRectangle2D.h"
+#include "geometry/RenderText2D.h"
+#include "topo/utils/PieceTable.h"
+#include "topo/utils/String.h"
+
+
+namespace topo
+{
+// TextBox is a multi-line text editing control. The document is stored in a PieceTable, so edits do not copy
+// the document and the cost of typing does not grow with the size of the document.
+//
+// Character input (WM_CHAR) is not applied immediately. Instead, all characters/backspaces received during a
+// frame are coalesced and applied as (at most) a single erase + a single insert during Update(). Only the
+// lines that are visible are ever extracted from the document, and after an edit only the visible lines at
+// or below the edited line are refreshed.
+//
+// Every visible line is drawn by a RenderText2D of its own. When scrolling, the lines that stay in view keep their
+// RenderText2D (and with it their glyph objects) and only get moved, so only the lines that scroll into view get
+// extracted and shaped. The caret and mouse hit-testing use the advances of the shaped lines.
+//
+// The document is UTF-8. Positions (i.e. the caret) are byte offsets into the document, but the caret only ever
+// moves (and backspace/delete only ever erase) whole codepoints.
+class TextBox : public Control
+{
+public:
+	TextBox(const std::shared_ptr<UIRenderer>& renderer, float left, float top, float right, float bottom);
+	TextBox(const TextBox&) = delete;
+	TextBox(TextBox&&) = delete;
+	TextBox& operator=(const TextBox&) = delete;
+	TextBox& operator=(TextBox&&) = delete;
+
+	virtual void Update(const Timer& timer) override;
+
+	ND virtual float GetAutoHeight() const noexcept override { return m_lineHeight + m_padding.Top + m_padding.Bottom; }
+	ND virtual float GetAutoWidth() const noexcept override { return 100.0f; }
+
+	// Text
+	void SetText(std::string text);
+	ND std::string GetText() { CommitPendingInput(); return m_document.GetText(); }
+	ND constexpr const PieceTable& GetDocument() const noexcept { return m_document; }
+
+	// Caret
+	void SetCaretPosition(size_t position);
+	ND constexpr size_t GetCaretPosition() const noexcept { return m_caret; }
+
+	// Visible lines (text for lines [GetFirstVisibleLine(), GetFirstVisibleLine() + GetVisibleLines().size()))
+	ND constexpr size_t GetFirstVisibleLine() const noexcept { return m_firstVisibleLine; }
+	ND constexpr std::span<const std::string> GetVisibleLines() const noexcept { return m_visibleLines; }
+	void ScrollToLine(size_t line);
+
+	// Appearance
+	// NOTE: Setting the font also sets the line height to the font's line height
+	void SetFont(std::string_view fontFamily, float size);
+	inline void SetLineHeight(float height) noexcept { m_lineHeight = std::max(height, 1.0f); InvalidateVisual(); }
+	inline void SetPadding(const Padding& padding) noexcept { m_padding = padding; InvalidateVisual(); }
+	inline void SetPadding(float all) noexcept { m_padding = { all, all, all, all }; InvalidateVisual(); }
+	inline void SetTextColor(const Color& color) noexcept { m_textColor = color; InvalidateVisual(); }
+	inline void SetBackgroundColor(const Color& color) noexcept { m_backgroundColor = color; InvalidateVisual(); }
+	inline void SetCaretColor(const Color& color) noexcept { m_caretColor = color; InvalidateVisual(); }
+
+	// Control pooling
+	virtual void OnReleasedToPool() override;
+	virtual void SetClip(unsigned int clip) override;
+
+	// Event Callbacks
+	std::function<void(TextBox*, const Timer&)> OnUpdate = [](TextBox*, const Timer&) {};
+	std::function<void(TextBox*)> OnTextChanged = [](TextBox*) {};
+
+	// Event Handlers
+	virtual IEventReceiver* OnLButtonDown(float mouseX, float mouseY, MouseButtonEventKeyStates keyStates) override;
+	virtual IEventReceiver* OnMouseWheel(float wheelDelta, float mouseX, float mouseY, MouseButtonEventKeyStates keyStates) override;
+	virtual IEventReceiver* OnChar(unsigned int character, unsigned int repeatCount) override;
+	virtual IEventReceiver* OnKeyDown(KeyCode keyCode, unsigned int repeatCount) override;
+
+protected:
+	virtual void OnCommitVisual() override;
+
+private:
+	void CommitPendingInput();
+	void EnsureCaretVisible();
+	void RefreshVisibleLines();
+
+	// Codepoint navigation. Columns count codepoints (not bytes) from the start of the line
+	ND size_t PreviousCodepoint(size_t position) const noexcept;
+	ND size_t NextCodepoint(size_t position) const noexcept;
+	ND size_t ColumnFromPosition(size_t position) const;
+	ND size_t PositionFromColumn(size_t line, size_t column) const;
+
+	// Offset (in pixels from the start of the line) of the caret in front of the column'th codepoint, and the column
+	// whose caret is closest to the offset. Both go by the advances of the shaped line
+	ND float OffsetFromColumn(std::string_view line, size_t column) const;
+	ND size_t ColumnFromOffset(std::string_view line, float offset) const;
+
+	inline void InvalidateLines(size_t firstLine) noexcept
+	{
+		m_firstDirtyLine = std::min(m_firstDirtyLine, firstLine);
+		InvalidateVisual();
+	}
+
+	ND inline size_t VisibleLineCapacity() const noexcept
+	{
+		const float height = m_positionRect.Height() - m_padding.Top - m_padding.Bottom;
+		return static_cast<size_t>(std::ceil(std::max(height, 0.0f) / m_lineHeight));
+	}
+
+	PieceTable m_document;
+	size_t m_caret = 0;
+
+	// Coalesced WM_CHAR input: m_pendingBackspaces codepoints before the caret get erased, and then
+	// m_pendingInput (UTF-8) gets inserted at the caret
+	std::string m_pendingInput;
+	size_t m_pendingBackspaces = 0;
+
+	// WM_CHAR delivers UTF-16 code units, so characters outside of the BMP arrive as two messages. This holds the
+	// high surrogate until the low surrogate arrives (0 if there is none)
+	unsigned int m_pendingHighSurrogate = 0;
+
+	// Cached text of the visible lines, the line each of them was extracted from (NoLine if none) and the
+	// RenderText2D that draws it. Lines at or after m_firstDirtyLine need to be re-extracted
+	static constexpr size_t NoLine = std::numeric_limits<size_t>::max();
+	size_t m_firstVisibleLine = 0;
+	std::vector<std::string> m_visibleLines;
+	std::vector<size_t> m_extractedLines;
+	std::vector<RenderText2D> m_lineTexts;
+	size_t m_firstDirtyLine = 0;
+
+	std::string m_fontFamily = std::string(RenderText2D::DefaultFontFamily);
+	float m_fontSize = RenderText2D::DefaultFontSize;
+	unsigned int m_font = 0;
+	float m_lineHeight = 16.0f;
+	Padding m_padding = { 4.0f, 4.0f, 4.0f, 4.0f };
+	Color m_backgroundColor = { 1.0f, 1.0f, 1.0f, 1.0f };
+	Color m_caretColor = { 0.0f, 0.0f, 0.0f, 1.0f };
+	Color m_textColor = { 0.0f, 0.0f, 0.0f, 1.0f };
+
+	// Layer and clip the line texts get registered in (they get created while committing)
+	RenderLayer2D m_layer = RenderLayer2D::Main;
+	unsigned int m_clip = UIRenderer::WindowClip;
+
+	RenderRectangle2D m_backgroundRect;
+	RenderRectangle2D m_caretRect;
+};
+}
@@ -0,0 +1,139 @@
+#include "pch.h"
+#include "RenderImage2D.h"
+
+
+namespace topo
+{
+RenderImage2D::RenderImage2D(const std::shared_ptr<UIRenderer>& renderer, std::string_view filename, float left, float top, float right, float bottom, const Color& tint) :
+	m_renderer(renderer),
+	m_filename(filename),
+	m_left(left),
+	m_top(top),
+	m_right(right),
+	m_bottom(bottom),
+	m_tint(tint)
+{
+	Register();
+}
+RenderImage2D::RenderImage2D(const RenderImage2D& rhs) :
+	m_renderer(rhs.m_renderer),
+	m_filename(rhs.m_filename),
+	m_left(rhs.m_left),
+	m_top(rhs.m_top),
+	m_right(rhs.m_right),
+	m_bottom(rhs.m_bottom),
+	m_tint(rhs.m_tint),
+	m_cornerRadius(rhs.m_cornerRadius)
+{
+	Register();
+}
+RenderImage2D::RenderImage2D(RenderImage2D&& rhs) noexcept :
+	m_renderer(rhs.m_renderer),
+	m_filename(std::move(rhs.m_filename)),
+	m_image(rhs.m_image),
+	m_uuid(rhs.m_uuid),
+	m_left(rhs.m_left),
+	m_top(rhs.m_top),
+	m_right(rhs.m_right),
+	m_bottom(rhs.m_bottom),
+	m_tint(rhs.m_tint),
+	m_cornerRadius(rhs.m_cornerRadius),
+	m_movedFrom(rhs.m_movedFrom)
+{
+	rhs.m_movedFrom = true;
+}
+RenderImage2D& RenderImage2D::operator=(const RenderImage2D& rhs)
+{
+	if (this == &rhs)
+		return *this;
+
+	// Give back the object and image we currently own before registering new ones
+	if (!m_movedFrom)
+	{
+		m_renderer->UnregisterObject(m_uuid);
+		m_renderer->ReleaseImage(m_image);
+	}
+
+	m_renderer = rhs.m_renderer;
+	m_filename = rhs.m_filename;
+	m_left = rhs.m_left;
+	m_top = rhs.m_top;
+	m_right = rhs.m_right;
+	m_bottom = rhs.m_bottom;
+	m_tint = rhs.m_tint;
+	m_cornerRadius = rhs.m_cornerRadius;
+	m_movedFrom = false;
+	Register();
+
+	return *this;
+}
+RenderImage2D& RenderImage2D::operator=(RenderImage2D&& rhs) noexcept
+{
+	if (this == &rhs)
+		return *this;
+
+	// Give back the object and image we currently own before taking ownership of rhs's
+	if (!m_movedFrom)
+	{
+		m_renderer->UnregisterObject(m_uuid);
+		m_renderer->ReleaseImage(m_image);
+	}
+
+	m_renderer = rhs.m_renderer;
+	m_filename = std::move(rhs.m_filename);
+	m_image = rhs.m_image;
+	m_uuid = rhs.m_uuid;
+	m_left = rhs.m_left;
+	m_top = rhs.m_top;
+	m_right = rhs.m_right;
+	m_bottom = rhs.m_bottom;
+	m_tint = rhs.m_tint;
+	m_cornerRadius = rhs.m_cornerRadius;
+	m_movedFrom = rhs.m_movedFrom;
+
+	rhs.m_movedFrom = true;
+
+	return *this;
+}
+RenderImage2D::~RenderImage2D()
+{
+	if (!m_movedFrom)
+	{
+		m_renderer->UnregisterObject(m_uuid);
+		m_renderer->ReleaseImage(m_image);
+	}
+}
+
+void RenderImage2D::SetImage(std::string_view filename)
+{
+	if (filename == m_filename)
+		return;
+
+	// Acquire the new image first, so that a file that cannot be used leaves the current image in place
+	const unsigned int image = m_renderer->AcquireImage(filename);
+	m_renderer->ReleaseImage(m_image);
+	m_image = image;
+	m_filename = filename;
+	SendUpdate();
+}
+void RenderImage2D::SetCornerRadius(float cornerRadius)
+{
+	m_cornerRadius = cornerRadius;
+	m_renderer->UpdateShapeStyle(m_uuid, m_cornerRadius, 0.0f, {});
+}
+
+void RenderImage2D::Register()
+{
+	// Images have transparent texels (and antialiased edges), so they are always drawn back-to-front
+	m_image = m_renderer->AcquireImage(m_filename);
+	m_uuid = m_renderer->RegisterObject(RenderEffect2D::Transparent, BasicGeometry2D::Image);
+	if (m_cornerRadius > 0.0f)
+		m_renderer->UpdateShapeStyle(m_uuid, m_cornerRadius, 0.0f, {});
+	SendUpdate();
+}
+void RenderImage2D::SendUpdate()
+{
+	m_renderer->UpdateImage(m_uuid, m_left, m_top, m_right, m_bottom, m_image, m_tint);
+}
+
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "topo/Core.h"
+#include "topo/rendering/UIRenderer.h"
+#include "topo/utils/Color.h"
+
+
+
+namespace topo
+{
+// RenderImage2D draws an image (i.e. an icon) stretched over a rectangle. The image is loaded through the
+// AssetManager and copied into the renderer's image atlas (see UIRenderer::AcquireImage), so images are drawn by the
+// same instanced draw as rectangles and text - hundreds of icons do not add a single draw call or descriptor
+// binding. Every RenderImage2D that shows the same file shares the same spot in the atlas.
+//
+// The image is multiplied by the tint, so a white tint draws the image as it is
+class RenderImage2D
+{
+public:
+	RenderImage2D(const std::shared_ptr<UIRenderer>& renderer, std::string_view filename, float left, float top, float right, float bottom, const Color& tint = { 1.0f, 1.0f, 1.0f, 1.0f });
+	RenderImage2D(const RenderImage2D&);
+	RenderImage2D(RenderImage2D&&) noexcept;
+	RenderImage2D& operator=(const RenderImage2D&);
+	RenderImage2D& operator=(RenderImage2D&&) noexcept;
+	~RenderImage2D();
+
+	inline void SetRect(float left, float top, float right, float bottom)
+	{
+		m_left = left;
+		m_top = top;
+		m_right = right;
+		m_bottom = bottom;
+		SendUpdate();
+	}
+	inline void SetTint(const Color& tint)
+	{
+		m_tint = tint;
+		SendUpdate();
+	}
+	void SetImage(std::string_view filename);
+	void SetCornerRadius(float cornerRadius);
+
+	// Moves the image into another clip (see UIRenderer::SetObjectClip)
+	inline void SetClip(unsigned int clip) { m_renderer->SetObjectClip(m_uuid, clip); }
+
+	// Size of the image itself (in texels), i.e. to draw it 1:1
+	ND inline unsigned int GetImageWidth() const noexcept { return m_renderer->GetImageSize(m_image).first; }
+	ND inline unsigned int GetImageHeight() const noexcept { return m_renderer->GetImageSize(m_image).second; }
+	ND constexpr const std::string& GetFilename() const noexcept { return m_filename; }
+
+	// The renderer object backing this image (i.e. for use with UIRenderer::AnimateObject)
+	ND constexpr unsigned int GetUUID() const noexcept { return m_uuid; }
+
+private:
+	void Register();
+	void SendUpdate();
+
+	std::shared_ptr<UIRenderer> m_renderer;
+	std::string m_filename;
+	unsigned int m_image = 0;
+	unsigned int m_uuid = 0;
+	float m_left = 0.0f;
+	float m_top = 0.0f;
+	float m_right = 0.0f;
+	float m_bottom = 0.0f;
+	Color m_tint = {};
+	float m_cornerRadius = 0.0f;
+	bool m_movedFrom = false;
+};
+}
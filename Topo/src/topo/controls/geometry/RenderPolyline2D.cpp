@@ -0,0 +1,61 @@
+#include "pch.h"
+#include "RenderPolyline2D.h"
+#include "topo/rendering/UIInstanceBuilder.h"
+
+
+namespace topo
+{
+RenderPolyline2D::RenderPolyline2D(const std::shared_ptr<UIRenderer>& renderer, const Color& color, float thickness) :
+	m_renderer(renderer),
+	m_color(color),
+	m_thickness(thickness)
+{
+	m_id = m_renderer->RegisterPolyline();
+}
+RenderPolyline2D::~RenderPolyline2D()
+{
+	m_renderer->UnregisterPolyline(m_id);
+}
+
+void RenderPolyline2D::SetPoints(std::span<const DirectX::XMFLOAT2> points)
+{
+	m_points.assign(points.begin(), points.end());
+	RebuildSegments(0);
+}
+void RenderPolyline2D::AppendPoints(std::span<const DirectX::XMFLOAT2> points)
+{
+	if (points.empty())
+		return;
+
+	// The previous last segment must be rebuilt because its end is now a joint
+	const size_t previousCount = m_points.size();
+	m_points.insert(m_points.end(), points.begin(), points.end());
+	RebuildSegments(previousCount >= 2 ? previousCount - 2 : 0);
+}
+void RenderPolyline2D::Clear()
+{
+	m_points.clear();
+	RebuildSegments(0);
+}
+
+void RenderPolyline2D::RebuildSegments(size_t firstSegment)
+{
+	const size_t segmentCount = m_points.size() >= 2 ? m_points.size() - 1 : 0;
+	firstSegment = std::min(firstSegment, segmentCount);
+
+	// Only the segments from firstSegment onwards are built. The scratch space keeps its capacity, so appending a
+	// few points at a time does not allocate
+	m_segments.resize(segmentCount - firstSegment);
+	for (size_t iii = 0; iii < m_segments.size(); ++iii)
+	{
+		const size_t segment = firstSegment + iii;
+		const DirectX::XMFLOAT2* previous = segment > 0 ? &m_points[segment - 1] : nullptr;
+		const DirectX::XMFLOAT2* next = segment + 2 < m_points.size() ? &m_points[segment + 2] : nullptr;
+
+		m_segments[iii] = {};
+		WriteSegmentInstance(previous, m_points[segment], m_points[segment + 1], next, m_thickness, m_color, m_segments[iii]);
+	}
+
+	m_renderer->UpdatePolylineSegments(m_id, firstSegment, m_segments);
+}
+}
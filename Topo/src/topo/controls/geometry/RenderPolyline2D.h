@@ -0,0 +1,57 @@
+#pragma once
+#include "topo/Core.h"
+#include "topo/rendering/UIRenderer.h"
+#include "topo/utils/Color.h"
+
+
+
+namespace topo
+{
+// RenderPolyline2D draws a connected series of points (i.e. a chart series). Each segment becomes one instance, and
+// the renderer draws the segments of every polyline in the layer with a single draw call. Segments are cut along the
+// miter line of their joints instead of overlapping (see WriteSegmentInstance), so translucent polylines keep the
+// same color at their joints.
+//
+// AppendPoints() only builds the new segments (plus the previous last segment, whose end becomes a joint) and only
+// those get uploaded, so live-streaming data costs O(new points) per frame no matter how long the series is.
+//
+// Main layer polylines are drawn on top of every other main layer object until SetZOrder() puts them below some
+// (see UIRenderer::SetPolylineZOrder).
+//
+// NOTE: Points are in window coordinates (same as RenderRectangle2D)
+class RenderPolyline2D
+{
+public:
+	RenderPolyline2D(const std::shared_ptr<UIRenderer>& renderer, const Color& color, float thickness = 1.0f);
+	RenderPolyline2D(const RenderPolyline2D&) = delete;
+	RenderPolyline2D(RenderPolyline2D&&) = delete;
+	RenderPolyline2D& operator=(const RenderPolyline2D&) = delete;
+	RenderPolyline2D& operator=(RenderPolyline2D&&) = delete;
+	~RenderPolyline2D();
+
+	void SetPoints(std::span<const DirectX::XMFLOAT2> points);
+	void AppendPoints(std::span<const DirectX::XMFLOAT2> points);
+	void Clear();
+
+	inline void SetColor(const Color& color) { m_color = color; RebuildSegments(0); }
+	inline void SetThickness(float thickness) { m_thickness = thickness; RebuildSegments(0); }
+	inline void SetZOrder(std::uint16_t zOrder) { m_renderer->SetPolylineZOrder(m_id, zOrder); }
+
+	ND constexpr std::span<const DirectX::XMFLOAT2> GetPoints() const noexcept { return m_points; }
+	ND constexpr const Color& GetColor() const noexcept { return m_color; }
+	ND constexpr float GetThickness() const noexcept { return m_thickness; }
+
+private:
+	// Rebuilds segments [firstSegment, end) and sends them to the renderer
+	void RebuildSegments(size_t firstSegment);
+
+	std::shared_ptr<UIRenderer> m_renderer;
+	unsigned int m_id = 0;
+	std::vector<DirectX::XMFLOAT2> m_points;
+	Color m_color = {};
+	float m_thickness = 1.0f;
+
+	// Scratch space for building segments
+	std::vector<UIObjectData> m_segments;
+};
+}
@@ -47,6 +47,13 @@ RenderRectangle2D::RenderRectangle2D(RenderRectangle2D&& rhs) noexcept :
 }
 RenderRectangle2D& RenderRectangle2D::operator=(const RenderRectangle2D& rhs)
 {
+	if (this == &rhs)
+		return *this;
+
+	// Give back the object we currently own before registering a new one
+	if (!m_movedFrom && m_usingColor)
+		m_renderer->UnregisterObject(m_uuid);
+
 	m_renderer = rhs.m_renderer;
 	m_left = rhs.m_left;
 	m_top = rhs.m_top;
@@ -60,12 +67,20 @@ RenderRectangle2D& RenderRectangle2D::operator=(const RenderRectangle2D& rhs)
 		RenderEffect2D effect = (m_color.A < 1.0f) ? RenderEffect2D::Transparent : RenderEffect2D::Opaque;
 		m_uuid = m_renderer->RegisterObject(effect, BasicGeometry2D::Rectangle);
 	}
+	m_movedFrom = false;
 	SendUpdate();
 
 	return *this;
 }
 RenderRectangle2D& RenderRectangle2D::operator=(RenderRectangle2D&& rhs) noexcept
 {
+	if (this == &rhs)
+		return *this;
+
+	// Give back the object we currently own before taking ownership of rhs's object
+	if (!m_movedFrom && m_usingColor)
+		m_renderer->UnregisterObject(m_uuid);
+
 	m_renderer = rhs.m_renderer;
 	m_left = rhs.m_left;
 	m_top = rhs.m_top;
@@ -74,6 +89,7 @@ RenderRectangle2D& RenderRectangle2D::operator=(RenderRectangle2D&& rhs) noexcep
 	m_color = rhs.m_color;
 	m_usingColor = rhs.m_usingColor;
 	m_uuid = rhs.m_uuid;
+	m_movedFrom = rhs.m_movedFrom;
 
 	rhs.m_movedFrom = true;
 
@@ -81,7 +97,7 @@ RenderRectangle2D& RenderRectangle2D::operator=(RenderRectangle2D&& rhs) noexcep
 }
 RenderRectangle2D::~RenderRectangle2D()
 {
-	if (!m_movedFrom)
+	if (!m_movedFrom && m_usingColor)
 	{
 		m_renderer->UnregisterObject(m_uuid);
 	}
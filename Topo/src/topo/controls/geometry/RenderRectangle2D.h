@@ -30,6 +30,25 @@ public:
 		m_color = color;
 		SendUpdate();
 	}
+	inline void SetRectAndColor(float left, float top, float right, float bottom, const Color& color)
+	{
+		m_left = left;
+		m_top = top;
+		m_right = right;
+		m_bottom = bottom;
+		m_color = color;
+		SendUpdate();
+	}
+
+	// Moves the rectangle into another clip (see UIRenderer::SetObjectClip)
+	inline void SetClip(unsigned int clip)
+	{
+		if (m_usingColor)
+			m_renderer->SetObjectClip(m_uuid, clip);
+	}
+
+	// The renderer object backing this rectangle (i.e. for use with UIRenderer::AnimateObject)
+	ND constexpr unsigned int GetUUID() const noexcept { return m_uuid; }
 
 private:
 	void SendUpdate();
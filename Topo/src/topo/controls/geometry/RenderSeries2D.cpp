@@ -0,0 +1,80 @@
+#include "pch.h"
+#include "RenderSeries2D.h"
+
+
+namespace topo
+{
+RenderSeries2D::RenderSeries2D(const std::shared_ptr<UIRenderer>& renderer, const Color& color, float thickness) :
+	m_polyline(renderer, color, thickness)
+{}
+
+void RenderSeries2D::AppendSamples(std::span<const float> samples)
+{
+	const size_t previousCount = m_pyramid.Size();
+	m_pyramid.Append(samples);
+
+	if (static_cast<double>(previousCount) <= m_lastSample)
+		RebuildVisiblePoints();
+}
+void RenderSeries2D::Clear()
+{
+	m_pyramid.Clear();
+	m_points.clear();
+	m_polyline.Clear();
+}
+
+void RenderSeries2D::SetView(const Rect& plotRect, double firstSample, double lastSample, float minValue, float maxValue)
+{
+	m_plotRect = plotRect;
+	m_firstSample = firstSample;
+	m_lastSample = std::max(lastSample, firstSample + 1e-6);
+	m_minValue = minValue;
+	m_maxValue = (maxValue > minValue) ? maxValue : minValue + 1.0f;
+	RebuildVisiblePoints();
+}
+
+void RenderSeries2D::RebuildVisiblePoints()
+{
+	m_points.clear();
+
+	// Include one sample on either side of the view so the line runs all the way to the edges of the plot
+	const double first = std::max(std::floor(m_firstSample) - 1.0, 0.0);
+	const double last = std::min(std::ceil(m_lastSample) + 2.0, static_cast<double>(m_pyramid.Size()));
+	if (first >= last || m_plotRect.Width() <= 0.0f)
+	{
+		m_polyline.SetPoints(m_points);
+		return;
+	}
+
+	const double xScale = m_plotRect.Width() / (m_lastSample - m_firstSample);
+	const float yScale = m_plotRect.Height() / (m_maxValue - m_minValue);
+	auto toX = [&](double sample) { return static_cast<float>(m_plotRect.Left + (sample - m_firstSample) * xScale); };
+	auto toY = [&](float value) { return m_plotRect.Top + (m_maxValue - value) * yScale; };
+
+	// At most one block per pixel column, and each block adds at most 2 points
+	const size_t maxBlocks = static_cast<size_t>(std::ceil(m_plotRect.Width()));
+
+	m_pyramid.ForEachBlock(static_cast<size_t>(first), static_cast<size_t>(last), maxBlocks,
+		[&](size_t blockFirst, size_t sampleCount, float min, float max)
+		{
+			if (sampleCount == 1)
+			{
+				m_points.push_back({ toX(static_cast<double>(blockFirst)), toY(min) });
+				return;
+			}
+
+			// Draw the column as a vertical stroke. Start at whichever end is closer to the previous point so the
+			// connecting segments stay short
+			const float x = toX(static_cast<double>(blockFirst) + 0.5 * static_cast<double>(sampleCount - 1));
+			const float yMin = toY(min);
+			const float yMax = toY(max);
+			const bool minFirst = m_points.empty() || std::abs(m_points.back().y - yMin) <= std::abs(m_points.back().y - yMax);
+			m_points.push_back({ x, minFirst ? yMin : yMax });
+			if (min != max)
+				m_points.push_back({ x, minFirst ? yMax : yMin });
+		});
+
+	m_polyline.SetPoints(m_points);
+}
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "topo/Core.h"
+#include "RenderPolyline2D.h"
+#include "topo/utils/MinMaxPyramid.h"
+#include "topo/utils/Rect.h"
+
+
+
+namespace topo
+{
+// RenderSeries2D plots a (potentially huge) series of evenly spaced samples. The samples are kept in a
+// MinMaxPyramid and only ~2 points per pixel column of the plot are ever handed to the polyline: for each
+// column, the min and max of the samples that fall into it. So panning/zooming costs O(plot width) regardless of
+// the number of samples, and peaks are never lost to decimation.
+//
+// Sample iii is plotted at x = iii. SetView() maps the samples [firstSample, lastSample] and values
+// [minValue, maxValue] onto the plot rectangle (in window coordinates)
+class RenderSeries2D
+{
+public:
+	RenderSeries2D(const std::shared_ptr<UIRenderer>& renderer, const Color& color, float thickness = 1.0f);
+	RenderSeries2D(const RenderSeries2D&) = delete;
+	RenderSeries2D(RenderSeries2D&&) = delete;
+	RenderSeries2D& operator=(const RenderSeries2D&) = delete;
+	RenderSeries2D& operator=(RenderSeries2D&&) = delete;
+
+	// If the new samples fall within the current view, the visible points are rebuilt
+	void AppendSamples(std::span<const float> samples);
+	void Clear();
+
+	void SetView(const Rect& plotRect, double firstSample, double lastSample, float minValue, float maxValue);
+
+	ND constexpr const MinMaxPyramid& GetPyramid() const noexcept { return m_pyramid; }
+	ND constexpr size_t SampleCount() const noexcept { return m_pyramid.Size(); }
+	ND constexpr std::span<const DirectX::XMFLOAT2> GetVisiblePoints() const noexcept { return m_polyline.GetPoints(); }
+
+	inline void SetColor(const Color& color) { m_polyline.SetColor(color); }
+	inline void SetThickness(float thickness) { m_polyline.SetThickness(thickness); }
+
+private:
+	void RebuildVisiblePoints();
+
+	MinMaxPyramid m_pyramid;
+	RenderPolyline2D m_polyline;
+	std::vector<DirectX::XMFLOAT2> m_points;
+
+	Rect m_plotRect = {};
+	double m_firstSample = 0.0;
+	double m_lastSample = 1.0;
+	float m_minValue = 0.0f;
+	float m_maxValue = 1.0f;
+};
+}
@@ -0,0 +1,240 @@
+#include "pch.h"
+#include "RenderText2D.h"
+
+
+namespace topo
+{
+RenderText2D::RenderText2D(const std::shared_ptr<UIRenderer>& renderer, std::string_view text, float left, float top, const Color& color, std::string_view fontFamily, float size) :
+	m_renderer(renderer),
+	m_text(text),
+	m_fontFamily(fontFamily),
+	m_size(size),
+	m_left(left),
+	m_top(top),
+	m_color(color),
+	m_layer(renderer->GetCurrentLayer()),
+	m_clip(renderer->GetCurrentClip())
+{
+	GlyphCache& cache = m_renderer->GetGlyphCache();
+	m_font = cache.LoadFont(m_fontFamily);
+	m_metrics = cache.GetFontMetrics(m_font, m_size);
+	Rebuild();
+}
+RenderText2D::RenderText2D(const RenderText2D& rhs) :
+	m_renderer(rhs.m_renderer),
+	m_text(rhs.m_text),
+	m_fontFamily(rhs.m_fontFamily),
+	m_size(rhs.m_size),
+	m_font(rhs.m_font),
+	m_metrics(rhs.m_metrics),
+	m_left(rhs.m_left),
+	m_top(rhs.m_top),
+	m_color(rhs.m_color),
+	m_visible(rhs.m_visible),
+	m_zOrder(rhs.m_zOrder),
+	m_layer(rhs.m_layer),
+	m_clip(rhs.m_clip)
+{
+	Rebuild();
+}
+RenderText2D::RenderText2D(RenderText2D&& rhs) noexcept :
+	m_renderer(rhs.m_renderer),
+	m_text(std::move(rhs.m_text)),
+	m_fontFamily(std::move(rhs.m_fontFamily)),
+	m_size(rhs.m_size),
+	m_font(rhs.m_font),
+	m_metrics(rhs.m_metrics),
+	m_left(rhs.m_left),
+	m_top(rhs.m_top),
+	m_width(rhs.m_width),
+	m_color(rhs.m_color),
+	m_visible(rhs.m_visible),
+	m_zOrder(rhs.m_zOrder),
+	m_layer(rhs.m_layer),
+	m_clip(rhs.m_clip),
+	m_glyphs(std::move(rhs.m_glyphs)),
+	m_movedFrom(rhs.m_movedFrom)
+{
+	rhs.m_movedFrom = true;
+}
+RenderText2D& RenderText2D::operator=(const RenderText2D& rhs)
+{
+	if (this == &rhs)
+		return *this;
+
+	// Give back the glyph objects we currently own before registering new ones
+	if (!m_movedFrom)
+	{
+		UnregisterGlyphs();
+		ReleaseGlyphs();
+	}
+	m_glyphs.clear();
+
+	m_renderer = rhs.m_renderer;
+	m_text = rhs.m_text;
+	m_fontFamily = rhs.m_fontFamily;
+	m_size = rhs.m_size;
+	m_font = rhs.m_font;
+	m_metrics = rhs.m_metrics;
+	m_left = rhs.m_left;
+	m_top = rhs.m_top;
+	m_color = rhs.m_color;
+	m_visible = rhs.m_visible;
+	m_zOrder = rhs.m_zOrder;
+	m_layer = rhs.m_layer;
+	m_clip = rhs.m_clip;
+	m_movedFrom = false;
+
+	Rebuild();
+	return *this;
+}
+RenderText2D& RenderText2D::operator=(RenderText2D&& rhs) noexcept
+{
+	if (this == &rhs)
+		return *this;
+
+	// Give back the glyph objects we currently own before taking ownership of rhs's glyph objects
+	if (!m_movedFrom)
+	{
+		UnregisterGlyphs();
+		ReleaseGlyphs();
+	}
+
+	m_renderer = rhs.m_renderer;
+	m_text = std::move(rhs.m_text);
+	m_fontFamily = std::move(rhs.m_fontFamily);
+	m_size = rhs.m_size;
+	m_font = rhs.m_font;
+	m_metrics = rhs.m_metrics;
+	m_left = rhs.m_left;
+	m_top = rhs.m_top;
+	m_width = rhs.m_width;
+	m_color = rhs.m_color;
+	m_visible = rhs.m_visible;
+	m_zOrder = rhs.m_zOrder;
+	m_layer = rhs.m_layer;
+	m_clip = rhs.m_clip;
+	m_glyphs = std::move(rhs.m_glyphs);
+	m_movedFrom = rhs.m_movedFrom;
+
+	rhs.m_movedFrom = true;
+
+	return *this;
+}
+RenderText2D::~RenderText2D()
+{
+	if (!m_movedFrom)
+	{
+		UnregisterGlyphs();
+		ReleaseGlyphs();
+	}
+}
+
+void RenderText2D::SetText(std::string_view text)
+{
+	if (text == m_text)
+		return;
+
+	m_text = text;
+	Rebuild();
+}
+void RenderText2D::SetFont(std::string_view fontFamily, float size)
+{
+	GlyphCache& cache = m_renderer->GetGlyphCache();
+	m_fontFamily = fontFamily;
+	m_size = size;
+	m_font = cache.LoadFont(m_fontFamily);
+	m_metrics = cache.GetFontMetrics(m_font, m_size);
+	Rebuild();
+}
+void RenderText2D::SetZOrder(std::uint16_t zOrder)
+{
+	m_zOrder = zOrder;
+	for (const PlacedGlyph& glyph : m_glyphs)
+		m_renderer->SetObjectZOrder(glyph.UUID, m_zOrder);
+}
+void RenderText2D::SetClip(unsigned int clip)
+{
+	m_clip = clip;
+	for (const PlacedGlyph& glyph : m_glyphs)
+		m_renderer->SetObjectClip(glyph.UUID, m_clip);
+}
+
+void RenderText2D::Rebuild()
+{
+	GlyphCache& cache = m_renderer->GetGlyphCache();
+	const ShapedRun& run = cache.ShapeText(m_text, m_font, m_size);
+	m_width = run.Width;
+
+	// Acquire the new glyphs before releasing the old ones, so that glyphs that are in both never get evicted.
+	// Spaces (and glyphs that did not fit in the atlas) have nothing to draw, so they do not get an object
+	m_scratch.clear();
+	for (const ShapedGlyph& shaped : run.Glyphs)
+	{
+		const GlyphCache::Glyph* glyph = cache.AcquireGlyph(shaped.Key);
+		if (glyph == nullptr)
+			continue;
+
+		if (glyph->Region.Width == 0 || glyph->Region.Height == 0)
+		{
+			cache.ReleaseGlyph(shaped.Key);
+			continue;
+		}
+		m_scratch.push_back({ shaped.Key, 0, shaped.X, *glyph });
+	}
+
+	// Reuse the glyph objects we already have and only register/unregister the difference
+	const size_t reused = std::min(m_glyphs.size(), m_scratch.size());
+	for (size_t iii = 0; iii < reused; ++iii)
+		m_scratch[iii].UUID = m_glyphs[iii].UUID;
+
+	for (size_t iii = reused; iii < m_glyphs.size(); ++iii)
+		m_renderer->UnregisterObject(m_glyphs[iii].UUID);
+
+	if (m_scratch.size() > reused)
+	{
+		UIRenderer::LayerScope layerScope(*m_renderer, m_layer);
+		UIRenderer::ClipScope clipScope(*m_renderer, m_clip);
+		for (size_t iii = reused; iii < m_scratch.size(); ++iii)
+		{
+			m_scratch[iii].UUID = m_renderer->RegisterObject(RenderEffect2D::Transparent, BasicGeometry2D::Glyph);
+			if (m_zOrder != 0)
+				m_renderer->SetObjectZOrder(m_scratch[iii].UUID, m_zOrder);
+		}
+	}
+
+	ReleaseGlyphs();
+	std::swap(m_glyphs, m_scratch);
+	SendUpdate();
+}
+void RenderText2D::ReleaseGlyphs() noexcept
+{
+	GlyphCache& cache = m_renderer->GetGlyphCache();
+	for (const PlacedGlyph& glyph : m_glyphs)
+		cache.ReleaseGlyph(glyph.Key);
+}
+void RenderText2D::UnregisterGlyphs() noexcept
+{
+	for (const PlacedGlyph& glyph : m_glyphs)
+		m_renderer->UnregisterObject(glyph.UUID);
+}
+
+void RenderText2D::SendUpdate()
+{
+	// Glyphs are drawn 1:1 from the atlas, so they have to land on whole pixels
+	const float baseline = std::round(m_top + m_metrics.Ascent);
+	for (const PlacedGlyph& glyph : m_glyphs)
+	{
+		if (!m_visible)
+		{
+			// Collapse the glyph so it keeps its renderer slot, but does not draw anything
+			m_renderer->UpdateGlyph(glyph.UUID, 0.0f, 0.0f, GlyphAtlas::Region{}, m_color);
+			continue;
+		}
+
+		const float left = std::round(m_left + glyph.X) + static_cast<float>(glyph.Glyph.Left);
+		const float top = baseline + static_cast<float>(glyph.Glyph.Top);
+		m_renderer->UpdateGlyph(glyph.UUID, left, top, glyph.Glyph.Region, m_color);
+	}
+}
+}
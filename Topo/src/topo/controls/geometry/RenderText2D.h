@@ -0,0 +1,91 @@
+#pragma once
+#include "topo/Core.h"
+#include "topo/rendering/UIRenderer.h"
+#include "topo/utils/Color.h"
+
+
+
+namespace topo
+{
+// RenderText2D draws a single line of text. Every visible glyph is a glyph object of its own (see
+// UIRenderer::UpdateGlyph), so text goes through the same instanced draw as every other shape and gets sorted,
+// culled and clipped just like them.
+//
+// Shaping goes through the glyph cache's run cache, so setting a text that was shown before (by this or any other
+// RenderText2D) neither shapes nor rasterizes anything. Moving or recoloring the text only updates the glyph objects.
+//
+// Like other render objects, the glyph objects are placed in the layer and clip that were current when the
+// RenderText2D was constructed (or the clip given to SetClip), even if they get registered later on (i.e. when the
+// text gets longer).
+// NOTE: (left, top) is the top-left corner of the line, so the baseline is 'ascent' pixels below top
+class RenderText2D
+{
+public:
+	RenderText2D(const std::shared_ptr<UIRenderer>& renderer, std::string_view text, float left, float top, const Color& color, std::string_view fontFamily = DefaultFontFamily, float size = DefaultFontSize);
+	RenderText2D(const RenderText2D&);
+	RenderText2D(RenderText2D&&) noexcept;
+	RenderText2D& operator=(const RenderText2D&);
+	RenderText2D& operator=(RenderText2D&&) noexcept;
+	~RenderText2D();
+
+	void SetText(std::string_view text);
+	void SetFont(std::string_view fontFamily, float size);
+	inline void SetPosition(float left, float top) { m_left = left; m_top = top; SendUpdate(); }
+	inline void SetColor(const Color& color) { m_color = color; SendUpdate(); }
+	inline void SetVisible(bool visible) { m_visible = visible; SendUpdate(); }
+	// Sets everything that only moves/recolors the glyph objects at once, so every glyph object gets updated once
+	inline void Set(float left, float top, const Color& color, bool visible)
+	{
+		m_left = left;
+		m_top = top;
+		m_color = color;
+		m_visible = visible;
+		SendUpdate();
+	}
+	void SetZOrder(std::uint16_t zOrder);
+	void SetClip(unsigned int clip);
+
+	ND constexpr const std::string& GetText() const noexcept { return m_text; }
+	ND constexpr float GetWidth() const noexcept { return m_width; }
+	ND constexpr float GetHeight() const noexcept { return m_metrics.LineHeight(); }
+	ND constexpr const FontMetrics& GetFontMetrics() const noexcept { return m_metrics; }
+
+	static constexpr std::string_view DefaultFontFamily = "Segoe UI";
+	static constexpr float DefaultFontSize = 14.0f;
+
+private:
+	struct PlacedGlyph
+	{
+		std::uint64_t Key = 0;
+		unsigned int UUID = 0;
+		float X = 0.0f;			// Pen position relative to the start of the line
+		GlyphCache::Glyph Glyph = {};
+	};
+
+	// Shapes m_text and makes sure there is exactly one glyph object per visible glyph
+	void Rebuild();
+	void ReleaseGlyphs() noexcept;
+	void UnregisterGlyphs() noexcept;
+	void SendUpdate();
+
+	std::shared_ptr<UIRenderer> m_renderer;
+	std::string m_text;
+	std::string m_fontFamily;
+	float m_size = DefaultFontSize;
+	unsigned int m_font = 0;
+	FontMetrics m_metrics = {};
+	float m_left = 0.0f;
+	float m_top = 0.0f;
+	float m_width = 0.0f;
+	Color m_color = {};
+	bool m_visible = true;
+	std::uint16_t m_zOrder = 0;
+
+	RenderLayer2D m_layer = RenderLayer2D::Main;
+	unsigned int m_clip = UIRenderer::WindowClip;
+
+	std::vector<PlacedGlyph> m_glyphs;
+	std::vector<PlacedGlyph> m_scratch;
+	bool m_movedFrom = false;
+};
+}
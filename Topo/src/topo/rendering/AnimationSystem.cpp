@@ -0,0 +1,189 @@
+#include "pch.h"
+#include "AnimationSystem.h"
+#include "topo/Log.h"
+
+
+namespace topo
+{
+AnimationId AnimationSystem::Add(const AnimationTarget& target, float start, float end, float duration, Easing easing)
+{
+	if (target.Type == AnimationTargetType::Value && target.Value == nullptr) [[unlikely]]
+	{
+		LOG_ERROR("AnimationSystem: Cannot animate a nullptr value");
+		return 0;
+	}
+	if (target.Type == AnimationTargetType::Callback && target.Apply == nullptr) [[unlikely]]
+	{
+		LOG_ERROR("AnimationSystem: Cannot animate with a nullptr callback");
+		return 0;
+	}
+
+	const AnimationId id = m_nextId++;
+	if (m_updating)
+	{
+		m_pending.emplace_back(target, start, end, duration, easing, id);
+		m_indices.emplace(id, PendingIndex);
+		return id;
+	}
+
+	Append(target, start, end, duration, easing, id);
+	return id;
+}
+void AnimationSystem::Append(const AnimationTarget& target, float start, float end, float duration, Easing easing, AnimationId id)
+{
+	// Avoid dividing by 0 - a zero length tween just jumps to its end value on its second Update()
+	duration = std::max(duration, 0.0001f);
+
+	m_elapsed.push_back(0.0f);
+	m_inverseDuration.push_back(1.0f / duration);
+	m_start.push_back(start);
+	m_end.push_back(end);
+	m_values.push_back(start);
+	m_easing.push_back(easing);
+	m_targets.push_back(target);
+	m_ids.push_back(id);
+	m_cancelled.push_back(0);
+	m_indices.insert_or_assign(id, m_ids.size() - 1);
+	++m_easingCounts[static_cast<size_t>(easing)];
+	++m_newCount;
+}
+void AnimationSystem::AppendPending()
+{
+	for (const PendingTween& tween : m_pending)
+		Append(tween.Target, tween.Start, tween.End, tween.Duration, tween.EasingFunction, tween.Id);
+	m_pending.clear();
+}
+bool AnimationSystem::Cancel(AnimationId id) noexcept
+{
+	// Don't remove the tween right away because that would reorder the arrays (and the new tweens must remain at
+	// the end). It will get removed at the end of the next Update()
+	auto iter = m_indices.find(id);
+	if (iter == m_indices.end())
+		return false;
+
+	// A tween that is still pending (see Add) just never gets appended
+	if (iter->second == PendingIndex)
+	{
+		std::erase_if(m_pending, [id](const PendingTween& tween) { return tween.Id == id; });
+		m_indices.erase(iter);
+		return true;
+	}
+
+	m_cancelled[iter->second] = 1;
+	return true;
+}
+
+float AnimationSystem::Ease(Easing easing, float t) noexcept
+{
+	switch (easing)
+	{
+	case Easing::Linear:		 return t;
+	case Easing::EaseInQuad:	 return t * t;
+	case Easing::EaseOutQuad:	 return t * (2.0f - t);
+	case Easing::EaseInOutQuad:	 return t < 0.5f ? 2.0f * t * t : -1.0f + (4.0f - 2.0f * t) * t;
+	case Easing::EaseInCubic:	 return t * t * t;
+	case Easing::EaseOutCubic:	 { const float u = t - 1.0f; return u * u * u + 1.0f; }
+	case Easing::EaseInOutCubic:
+	{
+		if (t < 0.5f)
+			return 4.0f * t * t * t;
+		const float u = 2.0f * t - 2.0f;
+		return 0.5f * u * u * u + 1.0f;
+	}
+	}
+	return t;
+}
+
+template<Easing E>
+void AnimationSystem::EaseAll(float* values, size_t count) const noexcept
+{
+	// Every tween is eased with E and then the result is only kept for the tweens that actually use E. That is
+	// wasted work for the others, but it keeps the loop free of branches, so it vectorizes
+	const Easing* easing = m_easing.data();
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		const float t = values[iii];
+		const float eased = Ease(E, t);
+		values[iii] = easing[iii] == E ? eased : t;
+	}
+}
+
+void AnimationSystem::Advance(float deltaTime) noexcept
+{
+	const size_t count = m_ids.size();
+	const size_t firstNew = count - m_newCount;
+	m_newCount = 0;
+
+	float* elapsed = m_elapsed.data();
+	const float* inverseDuration = m_inverseDuration.data();
+	const float* start = m_start.data();
+	const float* end = m_end.data();
+	float* values = m_values.data();
+
+	// NOTE: The loops below are kept free of branches/aliasing so the compiler can vectorize them
+
+	// 1. Advance time (new tweens stay at 0 for their first frame)
+	for (size_t iii = 0; iii < firstNew; ++iii)
+		elapsed[iii] += deltaTime;
+
+	// 2. Normalized progress in [0, 1]
+	for (size_t iii = 0; iii < count; ++iii)
+		values[iii] = std::min(elapsed[iii] * inverseDuration[iii], 1.0f);
+
+	// 3. Easing - one pass per easing function that is in use (Linear is a no-op). Calling Ease() per tween would
+	// switch on the easing function for every element, which keeps the compiler from vectorizing the loop
+	if (m_easingCounts[static_cast<size_t>(Easing::EaseInQuad)] > 0)	 EaseAll<Easing::EaseInQuad>(values, count);
+	if (m_easingCounts[static_cast<size_t>(Easing::EaseOutQuad)] > 0)	 EaseAll<Easing::EaseOutQuad>(values, count);
+	if (m_easingCounts[static_cast<size_t>(Easing::EaseInOutQuad)] > 0)	 EaseAll<Easing::EaseInOutQuad>(values, count);
+	if (m_easingCounts[static_cast<size_t>(Easing::EaseInCubic)] > 0)	 EaseAll<Easing::EaseInCubic>(values, count);
+	if (m_easingCounts[static_cast<size_t>(Easing::EaseOutCubic)] > 0)	 EaseAll<Easing::EaseOutCubic>(values, count);
+	if (m_easingCounts[static_cast<size_t>(Easing::EaseInOutCubic)] > 0) EaseAll<Easing::EaseInOutCubic>(values, count);
+
+	// 4. Interpolate
+	for (size_t iii = 0; iii < count; ++iii)
+		values[iii] = start[iii] + (end[iii] - start[iii]) * values[iii];
+}
+void AnimationSystem::RemoveFinished() noexcept
+{
+	// Swap-and-pop every finished/cancelled tween. Order does not matter at this point because there are no
+	// new tweens in the arrays - tweens added during this Update() are still pending (see Add)
+	size_t iii = 0;
+	while (iii < m_ids.size())
+	{
+		if (m_cancelled[iii] || m_elapsed[iii] * m_inverseDuration[iii] >= 1.0f)
+		{
+			m_indices.erase(m_ids[iii]);
+			--m_easingCounts[static_cast<size_t>(m_easing[iii])];
+
+			const size_t last = m_ids.size() - 1;
+			if (iii != last)
+			{
+				m_indices[m_ids[last]] = iii;
+				m_elapsed[iii] = m_elapsed[last];
+				m_inverseDuration[iii] = m_inverseDuration[last];
+				m_start[iii] = m_start[last];
+				m_end[iii] = m_end[last];
+				m_values[iii] = m_values[last];
+				m_easing[iii] = m_easing[last];
+				m_targets[iii] = m_targets[last];
+				m_ids[iii] = m_ids[last];
+				m_cancelled[iii] = m_cancelled[last];
+			}
+			m_elapsed.pop_back();
+			m_inverseDuration.pop_back();
+			m_start.pop_back();
+			m_end.pop_back();
+			m_values.pop_back();
+			m_easing.pop_back();
+			m_targets.pop_back();
+			m_ids.pop_back();
+			m_cancelled.pop_back();
+		}
+		else
+		{
+			++iii;
+		}
+	}
+}
+
+}
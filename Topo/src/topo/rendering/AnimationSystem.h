@@ -0,0 +1,131 @@
+#pragma once
+#include "topo/Core.h"
+
+
+namespace topo
+{
+enum class Easing : unsigned char
+{
+	Linear, EaseInQuad, EaseOutQuad, EaseInOutQuad, EaseInCubic, EaseOutCubic, EaseInOutCubic
+};
+
+// Properties of a UIRenderer object that can be animated (see RenderObject2D). For lines, Left/Top/Right/Bottom
+// are x1/y1/x2/y2
+enum class AnimatedProperty : unsigned char
+{
+	Left, Top, Right, Bottom, Thickness, ColorR, ColorG, ColorB, ColorA
+};
+
+enum class AnimationTargetType : unsigned char
+{
+	RenderObject, // Writes to a property of a UIRenderer object
+	Value,		  // Writes to an arbitrary float - nothing is notified of the change, so the owner must poll it
+	Callback	  // Calls Apply(Context, Index, value) so that the owner can react to the change (see Layout::AnimateRow)
+};
+struct AnimationTarget
+{
+	AnimationTargetType Type = AnimationTargetType::Value;
+	AnimatedProperty	Property = AnimatedProperty::Left;
+	unsigned int		ObjectUUID = 0;
+	float*				Value = nullptr;
+	void (*Apply)(void* context, unsigned int index, float value) = nullptr;
+	void*				Context = nullptr;
+	unsigned int		Index = 0;
+};
+
+using AnimationId = unsigned int;
+
+// AnimationSystem holds every active tween in structure-of-arrays form, so advancing all of them is a handful of
+// tight loops over contiguous floats (time -> progress -> easing -> interpolated value) instead of one callback
+// per animated control. The resulting values are then handed to a single apply function, which lets the owner
+// (UIRenderer) write them straight into its object data in bulk.
+class AnimationSystem
+{
+public:
+	AnimationSystem() noexcept = default;
+	AnimationSystem(const AnimationSystem&) = delete;
+	AnimationSystem(AnimationSystem&&) = delete;
+	AnimationSystem& operator=(const AnimationSystem&) = delete;
+	AnimationSystem& operator=(AnimationSystem&&) = delete;
+
+	// Add() may be called from within Update() (i.e. by a Callback target that chains another tween). Such tweens
+	// are queued and only join the arrays once the update is done, so they first advance on the next Update()
+	AnimationId Add(const AnimationTarget& target, float start, float end, float duration, Easing easing = Easing::Linear);
+	bool Cancel(AnimationId id) noexcept;
+	ND inline bool IsActive(AnimationId id) const noexcept { return m_indices.contains(id); }
+
+	// Advances every tween by deltaTime (seconds), calls apply(const AnimationTarget&, float value) once for each
+	// tween that is still active, and then removes the tweens that finished
+	template<typename F>
+	void Update(float deltaTime, F&& apply)
+	{
+		m_updating = true;
+		Advance(deltaTime);
+
+		for (size_t iii = 0; iii < m_ids.size(); ++iii)
+		{
+			if (!m_cancelled[iii])
+				apply(m_targets[iii], m_values[iii]);
+		}
+
+		RemoveFinished();
+		m_updating = false;
+		AppendPending();
+	}
+
+	ND constexpr size_t Count() const noexcept { return m_ids.size(); }
+	ND constexpr bool Empty() const noexcept { return m_ids.empty(); }
+
+	ND static float Ease(Easing easing, float t) noexcept;
+
+private:
+	void Append(const AnimationTarget& target, float start, float end, float duration, Easing easing, AnimationId id);
+	void AppendPending();
+	void Advance(float deltaTime) noexcept;
+	void RemoveFinished() noexcept;
+
+	template<Easing E>
+	void EaseAll(float* values, size_t count) const noexcept;
+
+	// Hot data - one entry per tween, all indexed the same way
+	std::vector<float>		   m_elapsed;
+	std::vector<float>		   m_inverseDuration;
+	std::vector<float>		   m_start;
+	std::vector<float>		   m_end;
+	std::vector<float>		   m_values; // Scratch: progress, and then the interpolated value
+	std::vector<Easing>		   m_easing;
+
+	// Cold data
+	std::vector<AnimationTarget> m_targets;
+	std::vector<AnimationId>	 m_ids;
+	std::vector<unsigned char>	 m_cancelled;
+
+	// Where each active tween currently lives in the arrays above, so that Cancel() does not need to search for it
+	// (PendingIndex for tweens that are still in m_pending)
+	static constexpr size_t PendingIndex = std::numeric_limits<size_t>::max();
+	std::unordered_map<AnimationId, size_t> m_indices;
+
+	// Tweens added during Update(). Appending them right away would break the "the last m_newCount tweens are new"
+	// rule below (RemoveFinished() swaps tweens from the end into the holes), and would reallocate the arrays while
+	// apply is holding a reference into m_targets
+	struct PendingTween
+	{
+		AnimationTarget Target;
+		float			Start = 0.0f;
+		float			End = 0.0f;
+		float			Duration = 0.0f;
+		Easing			EasingFunction = Easing::Linear;
+		AnimationId		Id = 0;
+	};
+	std::vector<PendingTween> m_pending;
+	bool					  m_updating = false;
+
+	// Number of active tweens per easing function. Easing is done with one pass per easing function that is in use
+	std::array<unsigned int, 7> m_easingCounts = {};
+
+	// Tweens added since the last Update() sit at the end of the arrays. They do not advance during their first
+	// Update() so that they start exactly at their start value, no matter how long ago the last frame was
+	size_t		m_newCount = 0;
+	AnimationId m_nextId = 1;
+};
+}
@@ -138,6 +138,12 @@ public:
 	{
 		memcpy(&m_mappedData[frameIndex * m_elementByteSize], &singleElement, sizeof(T));
 	}
+	// Only overwrite the elements [firstElement, firstElement + elements.size()) of the frame's copy of the data
+	inline void CopyData(unsigned int frameIndex, unsigned int firstElement, std::span<const T> elements) noexcept
+	{
+		ASSERT(firstElement + elements.size() <= m_elementCount, "More data than expected");
+		memcpy(&m_mappedData[frameIndex * m_elementByteSize + firstElement * sizeof(T)], elements.data(), elements.size_bytes());
+	}
 
 private:
 	ConstantBufferMapped(const ConstantBufferMapped& rhs) = delete;
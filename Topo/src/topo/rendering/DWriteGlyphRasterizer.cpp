@@ -0,0 +1,131 @@
+#include "pch.h"
+#include "DWriteGlyphRasterizer.h"
+#include "topo/Log.h"
+#include "topo/TopoException.h"
+#include "topo/utils/String.h"
+#include "topo/utils/TranslateErrorCode.h"
+
+
+namespace topo
+{
+#ifdef TOPO_PLATFORM_WINDOWS
+
+namespace
+{
+void ThrowIfFailed(HRESULT hr, std::string_view call)
+{
+	if (FAILED(hr)) [[unlikely]]
+		throw EXCEPTION(std::format("DWriteGlyphRasterizer: {0} failed\n[Error Code] {1:#x} ({1})\n[Error Description]\n{2}\n", call, hr, TranslateErrorCode(hr)));
+}
+}
+
+DWriteGlyphRasterizer::DWriteGlyphRasterizer()
+{
+	ThrowIfFailed(
+		DWriteCreateFactory(DWRITE_FACTORY_TYPE_SHARED, __uuidof(IDWriteFactory2), reinterpret_cast<IUnknown**>(m_factory.GetAddressOf())),
+		"DWriteCreateFactory"
+	);
+	ThrowIfFailed(m_factory->GetSystemFontCollection(&m_systemFonts), "GetSystemFontCollection");
+}
+
+unsigned int DWriteGlyphRasterizer::LoadFont(std::string_view family)
+{
+	const std::wstring familyName = s2ws(family);
+
+	UINT32 index = 0;
+	BOOL exists = FALSE;
+	ThrowIfFailed(m_systemFonts->FindFamilyName(familyName.c_str(), &index, &exists), "FindFamilyName");
+	if (!exists) [[unlikely]]
+		throw EXCEPTION(std::format("DWriteGlyphRasterizer: Font family '{0}' is not installed", family));
+
+	Microsoft::WRL::ComPtr<IDWriteFontFamily> fontFamily = nullptr;
+	ThrowIfFailed(m_systemFonts->GetFontFamily(index, &fontFamily), "GetFontFamily");
+
+	Microsoft::WRL::ComPtr<IDWriteFont> dwriteFont = nullptr;
+	ThrowIfFailed(
+		fontFamily->GetFirstMatchingFont(DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STRETCH_NORMAL, DWRITE_FONT_STYLE_NORMAL, &dwriteFont),
+		"GetFirstMatchingFont"
+	);
+
+	Font& font = m_fonts.emplace_back();
+	ThrowIfFailed(dwriteFont->CreateFontFace(&font.Face), "CreateFontFace");
+	font.Face->GetMetrics(&font.Metrics);
+
+	return static_cast<unsigned int>(m_fonts.size() - 1);
+}
+
+FontMetrics DWriteGlyphRasterizer::GetFontMetrics(unsigned int font, float size)
+{
+	ASSERT(font < m_fonts.size(), "Invalid font");
+
+	const DWRITE_FONT_METRICS& metrics = m_fonts[font].Metrics;
+	const float scale = size / metrics.designUnitsPerEm;
+	return { metrics.ascent * scale, metrics.descent * scale, metrics.lineGap * scale };
+}
+
+void DWriteGlyphRasterizer::RasterizeGlyph(unsigned int font, float size, char32_t codepoint, GlyphBitmap& bitmap)
+{
+	ASSERT(font < m_fonts.size(), "Invalid font");
+
+	const Font& f = m_fonts[font];
+
+	const UINT32 codepoints[] = { static_cast<UINT32>(codepoint) };
+	UINT16 glyphIndex = 0;
+	ThrowIfFailed(f.Face->GetGlyphIndices(codepoints, 1, &glyphIndex), "GetGlyphIndices");
+
+	DWRITE_GLYPH_METRICS glyphMetrics = {};
+	ThrowIfFailed(f.Face->GetDesignGlyphMetrics(&glyphIndex, 1, &glyphMetrics), "GetDesignGlyphMetrics");
+
+	bitmap.Advance = glyphMetrics.advanceWidth * size / f.Metrics.designUnitsPerEm;
+	bitmap.Width = 0;
+	bitmap.Height = 0;
+	bitmap.Left = 0;
+	bitmap.Top = 0;
+	bitmap.Coverage.clear();
+
+	const FLOAT advance = 0.0f;
+	const DWRITE_GLYPH_OFFSET offset = {};
+	DWRITE_GLYPH_RUN run = {};
+	run.fontFace = f.Face.Get();
+	run.fontEmSize = size;
+	run.glyphCount = 1;
+	run.glyphIndices = &glyphIndex;
+	run.glyphAdvances = &advance;
+	run.glyphOffsets = &offset;
+
+	// Grayscale antialiasing - the ALIASED_1x1 texture then holds one 8-bit coverage value per pixel. The pen
+	// is at (0, 0), so the bounds are relative to the pen position on the baseline
+	Microsoft::WRL::ComPtr<IDWriteGlyphRunAnalysis> analysis = nullptr;
+	ThrowIfFailed(
+		m_factory->CreateGlyphRunAnalysis(
+			&run,
+			nullptr,
+			DWRITE_RENDERING_MODE_NATURAL_SYMMETRIC,
+			DWRITE_MEASURING_MODE_NATURAL,
+			DWRITE_GRID_FIT_MODE_DEFAULT,
+			DWRITE_TEXT_ANTIALIAS_MODE_GRAYSCALE,
+			0.0f,
+			0.0f,
+			&analysis
+		),
+		"CreateGlyphRunAnalysis"
+	);
+
+	RECT bounds = {};
+	ThrowIfFailed(analysis->GetAlphaTextureBounds(DWRITE_TEXTURE_ALIASED_1x1, &bounds), "GetAlphaTextureBounds");
+	if (bounds.right <= bounds.left || bounds.bottom <= bounds.top)
+		return;
+
+	bitmap.Width = static_cast<unsigned int>(bounds.right - bounds.left);
+	bitmap.Height = static_cast<unsigned int>(bounds.bottom - bounds.top);
+	bitmap.Left = bounds.left;
+	bitmap.Top = bounds.top;
+	bitmap.Coverage.resize(static_cast<size_t>(bitmap.Width) * bitmap.Height);
+	ThrowIfFailed(
+		analysis->CreateAlphaTexture(DWRITE_TEXTURE_ALIASED_1x1, &bounds, bitmap.Coverage.data(), static_cast<UINT32>(bitmap.Coverage.size())),
+		"CreateAlphaTexture"
+	);
+}
+
+#endif
+}
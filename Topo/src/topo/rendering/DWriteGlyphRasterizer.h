@@ -0,0 +1,38 @@
+#pragma once
+#include "topo/Core.h"
+#include "GlyphCache.h"
+
+
+namespace topo
+{
+#ifdef TOPO_PLATFORM_WINDOWS
+
+// GlyphRasterizer that renders grayscale antialiased glyphs of the installed system fonts with DirectWrite
+class DWriteGlyphRasterizer : public GlyphRasterizer
+{
+public:
+	DWriteGlyphRasterizer();
+	DWriteGlyphRasterizer(const DWriteGlyphRasterizer&) = delete;
+	DWriteGlyphRasterizer(DWriteGlyphRasterizer&&) = delete;
+	DWriteGlyphRasterizer& operator=(const DWriteGlyphRasterizer&) = delete;
+	DWriteGlyphRasterizer& operator=(DWriteGlyphRasterizer&&) = delete;
+	virtual ~DWriteGlyphRasterizer() noexcept override = default;
+
+	ND virtual unsigned int LoadFont(std::string_view family) override;
+	ND virtual FontMetrics GetFontMetrics(unsigned int font, float size) override;
+	virtual void RasterizeGlyph(unsigned int font, float size, char32_t codepoint, GlyphBitmap& bitmap) override;
+
+private:
+	struct Font
+	{
+		Microsoft::WRL::ComPtr<IDWriteFontFace> Face = nullptr;
+		DWRITE_FONT_METRICS Metrics = {};
+	};
+
+	Microsoft::WRL::ComPtr<IDWriteFactory2> m_factory = nullptr;
+	Microsoft::WRL::ComPtr<IDWriteFontCollection> m_systemFonts = nullptr;
+	std::vector<Font> m_fonts;
+};
+
+#endif
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include "topo/Core.h"
+#include "topo/utils/Color.h"
+#include "topo/utils/Rect.h"
+
+
+namespace topo
+{
+enum class DrawCommandType2D : unsigned int
+{
+	Rectangle, Line, Glyph, Image, ShapeStyle, ZOrder, ClipRect
+};
+
+// A single recorded change to an object description (or clip rect). The fields mirror RenderObject2D:
+//     Rectangle/Glyph/Image: Left/Top/Right/Bottom (FillColor is the tint of images)
+//     Line:                  Left/Top/Right/Bottom hold x1/y1/x2/y2
+//     ShapeStyle:            Left holds the corner radius, Thickness the border thickness and FillColor the border color
+//     ClipRect:              Target is the clip (not an object handle)
+// Extra holds the glyph's atlas texel (Glyph), the image (Image) or the z-order (ZOrder)
+struct DrawCommand2D
+{
+	DrawCommandType2D Type = DrawCommandType2D::Rectangle;
+	unsigned int Target = 0;
+	float Left = 0.0f;
+	float Top = 0.0f;
+	float Right = 0.0f;
+	float Bottom = 0.0f;
+	float Thickness = 0.0f;
+	Color FillColor = {};
+	unsigned int Extra = 0;
+};
+
+// DrawList2D is an append-only list of changes to render objects. While a list is bound to a thread (see
+// UIRenderer::DrawListScope), the renderer's update functions append to the list instead of touching the renderer,
+// so each thread can record its own list without any locking. The lists are then handed to
+// UIRenderer::SubmitDrawList() one after another, which applies them in that order - submitting lists in a fixed
+// order therefore gives exactly the same result as making the same calls on a single thread.
+//
+// Clear() keeps the memory around, so a list that is re-recorded every frame stops allocating after the first frame
+class DrawList2D
+{
+public:
+	DrawList2D() noexcept = default;
+	DrawList2D(const DrawList2D&) = default;
+	DrawList2D(DrawList2D&&) noexcept = default;
+	DrawList2D& operator=(const DrawList2D&) = default;
+	DrawList2D& operator=(DrawList2D&&) noexcept = default;
+
+	inline void RecordRectangle(unsigned int uuid, float left, float top, float right, float bottom, const Color& color)
+	{
+		m_commands.push_back({ DrawCommandType2D::Rectangle, uuid, left, top, right, bottom, 0.0f, color, 0 });
+	}
+	inline void RecordLine(unsigned int uuid, float x1, float y1, float x2, float y2, const Color& color, float thickness)
+	{
+		m_commands.push_back({ DrawCommandType2D::Line, uuid, x1, y1, x2, y2, thickness, color, 0 });
+	}
+	inline void RecordGlyph(unsigned int uuid, float left, float top, float right, float bottom, unsigned int glyphOrigin, const Color& color)
+	{
+		m_commands.push_back({ DrawCommandType2D::Glyph, uuid, left, top, right, bottom, 0.0f, color, glyphOrigin });
+	}
+	inline void RecordImage(unsigned int uuid, float left, float top, float right, float bottom, unsigned int image, const Color& tint)
+	{
+		m_commands.push_back({ DrawCommandType2D::Image, uuid, left, top, right, bottom, 0.0f, tint, image });
+	}
+	inline void RecordShapeStyle(unsigned int uuid, float cornerRadius, float borderThickness, const Color& borderColor)
+	{
+		m_commands.push_back({ DrawCommandType2D::ShapeStyle, uuid, cornerRadius, 0.0f, 0.0f, 0.0f, borderThickness, borderColor, 0 });
+	}
+	inline void RecordZOrder(unsigned int uuid, std::uint16_t zOrder)
+	{
+		m_commands.push_back({ DrawCommandType2D::ZOrder, uuid, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, {}, zOrder });
+	}
+	inline void RecordClipRect(unsigned int clip, const Rect& rect)
+	{
+		m_commands.push_back({ DrawCommandType2D::ClipRect, clip, rect.Left, rect.Top, rect.Right, rect.Bottom, 0.0f, {}, 0 });
+	}
+	constexpr void MarkDirty() noexcept { m_dirty = true; }
+
+	inline void Clear() noexcept
+	{
+		m_commands.clear();
+		m_dirty = false;
+	}
+
+	ND constexpr std::span<const DrawCommand2D> GetCommands() const noexcept { return m_commands; }
+	ND constexpr bool IsDirty() const noexcept { return m_dirty; }
+	ND constexpr bool Empty() const noexcept { return m_commands.empty() && !m_dirty; }
+
+private:
+	std::vector<DrawCommand2D> m_commands;
+	bool m_dirty = false;
+};
+}
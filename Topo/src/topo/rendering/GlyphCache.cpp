@@ -0,0 +1,228 @@
+#include "pch.h"
+#include "GlyphCache.h"
+#include "topo/Log.h"
+
+
+namespace topo
+{
+namespace
+{
+// Decodes the next codepoint of a UTF-8 string and advances position past it. Malformed sequences decode to
+// U+FFFD one byte at a time
+char32_t DecodeUtf8(std::string_view text, size_t& position) noexcept
+{
+	const unsigned char lead = static_cast<unsigned char>(text[position]);
+	size_t length = 0;
+	char32_t codepoint = 0;
+	if (lead < 0x80)		{ length = 1; codepoint = lead; }
+	else if (lead >> 5 == 0x6)	{ length = 2; codepoint = lead & 0x1F; }
+	else if (lead >> 4 == 0xE)	{ length = 3; codepoint = lead & 0x0F; }
+	else if (lead >> 3 == 0x1E)	{ length = 4; codepoint = lead & 0x07; }
+	else
+	{
+		++position;
+		return 0xFFFD;
+	}
+
+	if (position + length > text.size())
+	{
+		++position;
+		return 0xFFFD;
+	}
+
+	for (size_t iii = 1; iii < length; ++iii)
+	{
+		const unsigned char next = static_cast<unsigned char>(text[position + iii]);
+		if ((next & 0xC0) != 0x80)
+		{
+			++position;
+			return 0xFFFD;
+		}
+		codepoint = (codepoint << 6) | (next & 0x3F);
+	}
+
+	position += length;
+	return codepoint;
+}
+
+constexpr unsigned int KeyFont(std::uint64_t key) noexcept { return static_cast<unsigned int>(key >> 48); }
+constexpr float KeySize(std::uint64_t key) noexcept { return static_cast<float>((key >> 32) & 0xFFFF) * 0.25f; }
+constexpr char32_t KeyCodepoint(std::uint64_t key) noexcept { return static_cast<char32_t>(key & 0xFFFFFFFF); }
+}
+
+size_t GlyphCache::RunKeyHash::operator()(const RunKey& key) const noexcept
+{
+	size_t hash = std::hash<std::string>{}(key.Text);
+	hash ^= std::hash<std::uint64_t>{}((static_cast<std::uint64_t>(key.Font) << 32) | key.QuarterPixels) + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+	return hash;
+}
+
+GlyphCache::GlyphCache(std::unique_ptr<GlyphRasterizer> rasterizer) :
+	m_rasterizer(std::move(rasterizer))
+{
+	ASSERT(m_rasterizer != nullptr, "GlyphCache needs a rasterizer");
+}
+
+unsigned int GlyphCache::LoadFont(std::string_view family)
+{
+	auto iter = m_fonts.find(std::string(family));
+	if (iter != m_fonts.end())
+		return iter->second;
+
+	const unsigned int font = m_rasterizer->LoadFont(family);
+	m_fonts.emplace(std::string(family), font);
+	return font;
+}
+FontMetrics GlyphCache::GetFontMetrics(unsigned int font, float size)
+{
+	return m_rasterizer->GetFontMetrics(font, size);
+}
+
+void GlyphCache::Rasterize(std::uint64_t key)
+{
+	m_rasterizer->RasterizeGlyph(KeyFont(key), KeySize(key), KeyCodepoint(key), m_bitmap);
+	m_bitmapKey = key;
+	ASSERT(m_bitmap.Coverage.size() == static_cast<size_t>(m_bitmap.Width) * m_bitmap.Height, "Rasterizer returned a bitmap of the wrong size");
+}
+
+GlyphCache::GlyphEntry& GlyphCache::GetEntry(std::uint64_t key)
+{
+	auto iter = m_glyphs.find(key);
+	if (iter != m_glyphs.end())
+		return iter->second;
+
+	// First time this glyph is used. It is about to be drawn, so put it straight into the atlas
+	Rasterize(key);
+
+	GlyphEntry& entry = m_glyphs[key];
+	entry.Data.Region.Width = static_cast<std::uint16_t>(m_bitmap.Width);
+	entry.Data.Region.Height = static_cast<std::uint16_t>(m_bitmap.Height);
+	entry.Data.Left = m_bitmap.Left;
+	entry.Data.Top = m_bitmap.Top;
+	entry.Data.Advance = m_bitmap.Advance;
+
+	// Empty glyphs (spaces) never take up any room in the atlas
+	if (m_bitmap.Width == 0 || m_bitmap.Height == 0)
+	{
+		entry.Resident = true;
+		return entry;
+	}
+
+	MakeResident(key, entry);
+	return entry;
+}
+
+bool GlyphCache::MakeResident(std::uint64_t key, GlyphEntry& entry)
+{
+	const unsigned int width = entry.Data.Region.Width;
+	const unsigned int height = entry.Data.Region.Height;
+
+	// An evicted glyph has to be rasterized again (GetEntry() has just done so for new glyphs)
+	if (m_bitmapKey != key)
+		Rasterize(key);
+
+	// Make room by evicting the least recently released glyphs until the new one fits
+	std::optional<GlyphAtlas::Region> region = m_atlas.Allocate(width, height);
+	while (!region.has_value() && !m_evictable.empty())
+	{
+		Evict(m_glyphs[m_evictable.front()]);
+		region = m_atlas.Allocate(width, height);
+	}
+
+	if (!region.has_value()) [[unlikely]]
+	{
+		LOG_WARN("GlyphCache: The glyph atlas is full of glyphs that are in use - codepoint {0} will not be drawn", static_cast<std::uint32_t>(KeyCodepoint(key)));
+		return false;
+	}
+
+	m_atlas.Write(region.value(), m_bitmap.Coverage);
+	entry.Data.Region = region.value();
+	entry.Resident = true;
+	++m_residentGlyphs;
+
+	if (entry.References == 0)
+		entry.Lru = m_evictable.insert(m_evictable.end(), key);
+	return true;
+}
+
+void GlyphCache::Evict(GlyphEntry& entry) noexcept
+{
+	ASSERT(entry.Resident && entry.References == 0, "Only resident glyphs without references can be evicted");
+
+	m_atlas.Free(entry.Data.Region);
+	m_evictable.erase(entry.Lru);
+	entry.Resident = false;
+	--m_residentGlyphs;
+}
+
+const GlyphCache::Glyph* GlyphCache::AcquireGlyph(std::uint64_t key)
+{
+	GlyphEntry& entry = GetEntry(key);
+	const bool empty = entry.Data.Region.Width == 0 || entry.Data.Region.Height == 0;
+
+	if (!entry.Resident)
+	{
+		if (!MakeResident(key, entry))
+			return nullptr;
+	}
+
+	// A pinned glyph can not be evicted
+	if (entry.References == 0 && !empty)
+		m_evictable.erase(entry.Lru);
+
+	++entry.References;
+	return &entry.Data;
+}
+void GlyphCache::ReleaseGlyph(std::uint64_t key) noexcept
+{
+	auto iter = m_glyphs.find(key);
+	if (iter == m_glyphs.end() || iter->second.References == 0) [[unlikely]]
+	{
+		LOG_WARN("GlyphCache: Attempting to release a glyph that was not acquired ({0})", key);
+		return;
+	}
+
+	GlyphEntry& entry = iter->second;
+	const bool empty = entry.Data.Region.Width == 0 || entry.Data.Region.Height == 0;
+	if (--entry.References == 0 && !empty)
+		entry.Lru = m_evictable.insert(m_evictable.end(), key);
+}
+
+const ShapedRun& GlyphCache::ShapeText(std::string_view text, unsigned int font, float size)
+{
+	RunKey key{ std::string(text), font, static_cast<std::uint32_t>(size * 4.0f + 0.5f) & 0xFFFF };
+
+	auto iter = m_runs.find(key);
+	if (iter != m_runs.end())
+	{
+		// Most recently used runs go to the back
+		m_runLru.splice(m_runLru.end(), m_runLru, iter->second.Lru);
+		return iter->second.Run;
+	}
+
+	ShapedRun run;
+	run.Glyphs.reserve(text.size());
+
+	float pen = 0.0f;
+	size_t position = 0;
+	while (position < text.size())
+	{
+		const std::uint64_t glyphKey = MakeGlyphKey(font, size, DecodeUtf8(text, position));
+		run.Glyphs.push_back({ glyphKey, pen });
+		pen += GetEntry(glyphKey).Data.Advance;
+	}
+	run.Width = pen;
+
+	// Drop the least recently used run if the cache is full
+	if (m_runs.size() >= MaxShapedRuns)
+	{
+		auto oldest = m_runs.find(*m_runLru.front());
+		m_runLru.pop_front();
+		m_runs.erase(oldest);
+	}
+
+	auto [inserted, _] = m_runs.emplace(std::move(key), RunEntry{ std::move(run) });
+	inserted->second.Lru = m_runLru.insert(m_runLru.end(), &inserted->first);
+	return inserted->second.Run;
+}
+}
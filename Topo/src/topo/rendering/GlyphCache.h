@@ -0,0 +1,157 @@
+#pragma once
+#include "topo/Core.h"
+#include "topo/utils/GlyphAtlas.h"
+
+
+namespace topo
+{
+struct FontMetrics
+{
+	float Ascent = 0.0f;	// Distance from the baseline to the top of the line
+	float Descent = 0.0f;	// Distance from the baseline to the bottom of the line
+	float LineGap = 0.0f;
+	ND constexpr float LineHeight() const noexcept { return Ascent + Descent + LineGap; }
+};
+
+// Coverage of a single rasterized glyph. The top-left corner of the bitmap is (Left, Top) pixels away from the pen
+// position on the baseline (y down, so Top is usually negative). Glyphs without any pixels (i.e. spaces) have a
+// Width/Height of 0 and only an advance
+struct GlyphBitmap
+{
+	unsigned int Width = 0;
+	unsigned int Height = 0;
+	int Left = 0;
+	int Top = 0;
+	float Advance = 0.0f;
+	std::vector<std::uint8_t> Coverage; // Width * Height values, row major
+};
+
+// Turns codepoints into coverage bitmaps. GlyphCache only ever talks to this interface, so it can be driven by
+// a fake rasterizer without a window or a GPU (see DWriteGlyphRasterizer for the real one)
+class GlyphRasterizer
+{
+public:
+	GlyphRasterizer() noexcept = default;
+	GlyphRasterizer(const GlyphRasterizer&) = delete;
+	GlyphRasterizer(GlyphRasterizer&&) = delete;
+	GlyphRasterizer& operator=(const GlyphRasterizer&) = delete;
+	GlyphRasterizer& operator=(GlyphRasterizer&&) = delete;
+	virtual ~GlyphRasterizer() noexcept = default;
+
+	// Returns an id for the font family that the other functions take. Throws if the family does not exist
+	ND virtual unsigned int LoadFont(std::string_view family) = 0;
+	ND virtual FontMetrics GetFontMetrics(unsigned int font, float size) = 0;
+	virtual void RasterizeGlyph(unsigned int font, float size, char32_t codepoint, GlyphBitmap& bitmap) = 0;
+};
+
+// A glyph of a shaped run. X is the pen position (relative to the start of the run) the glyph is drawn at
+struct ShapedGlyph
+{
+	std::uint64_t Key = 0;
+	float X = 0.0f;
+};
+struct ShapedRun
+{
+	std::vector<ShapedGlyph> Glyphs;
+	float Width = 0.0f;
+};
+
+// GlyphCache rasterizes glyphs the first time they are needed and keeps them in a GlyphAtlas.
+//
+// Glyphs that are on screen are pinned: AcquireGlyph() adds a reference and ReleaseGlyph() removes it, and only
+// glyphs without references can be evicted. They are evicted in least recently released order whenever the atlas
+// runs out of room. An evicted glyph keeps its metrics, so shaping never has to rasterize the same glyph twice.
+//
+// Shaping (turning a string into positioned glyphs) is cached as well, keyed by (string, font, size), so static
+// labels only ever get shaped once. NOTE: Shaping is a simple advance-based layout of a single line (no kerning,
+// ligatures or bidi)
+class GlyphCache
+{
+public:
+	struct Glyph
+	{
+		GlyphAtlas::Region Region = {};
+		int Left = 0;
+		int Top = 0;
+		float Advance = 0.0f;
+	};
+
+	GlyphCache(std::unique_ptr<GlyphRasterizer> rasterizer);
+	GlyphCache(const GlyphCache&) = delete;
+	GlyphCache(GlyphCache&&) = delete;
+	GlyphCache& operator=(const GlyphCache&) = delete;
+	GlyphCache& operator=(GlyphCache&&) = delete;
+
+	// Fonts are loaded once per family. Loading a family that was already loaded returns the same id
+	ND unsigned int LoadFont(std::string_view family);
+	ND FontMetrics GetFontMetrics(unsigned int font, float size);
+
+	// Keys pack the font, the size (in quarter pixels) and the codepoint
+	ND static constexpr std::uint64_t MakeGlyphKey(unsigned int font, float size, char32_t codepoint) noexcept
+	{
+		const std::uint64_t quarterPixels = static_cast<std::uint64_t>(size * 4.0f + 0.5f) & 0xFFFF;
+		return (static_cast<std::uint64_t>(font & 0xFFFF) << 48) | (quarterPixels << 32) | static_cast<std::uint64_t>(codepoint);
+	}
+
+	// The run stays valid until the next call to ShapeText() (which may evict it from the run cache)
+	ND const ShapedRun& ShapeText(std::string_view text, unsigned int font, float size);
+
+	// Returns the glyph, making sure it is in the atlas, and pins it there until it gets released. Returns nullptr
+	// if the atlas is full of pinned glyphs
+	const Glyph* AcquireGlyph(std::uint64_t key);
+	void ReleaseGlyph(std::uint64_t key) noexcept;
+
+	ND constexpr GlyphAtlas& GetAtlas() noexcept { return m_atlas; }
+	ND constexpr const GlyphAtlas& GetAtlas() const noexcept { return m_atlas; }
+	ND inline size_t CachedRunCount() const noexcept { return m_runs.size(); }
+	ND constexpr size_t ResidentGlyphCount() const noexcept { return m_residentGlyphs; }
+
+	// Maximum number of shaped runs that are kept around
+	static constexpr size_t MaxShapedRuns = 1024;
+
+private:
+	struct GlyphEntry
+	{
+		Glyph Data = {};
+		unsigned int References = 0;
+		bool Resident = false;						// Whether the glyph is in the atlas
+		std::list<std::uint64_t>::iterator Lru = {};// Only valid for resident glyphs without references
+	};
+	struct RunKey
+	{
+		std::string Text;
+		unsigned int Font = 0;
+		std::uint32_t QuarterPixels = 0;
+		ND bool operator==(const RunKey&) const noexcept = default;
+	};
+	struct RunKeyHash
+	{
+		ND size_t operator()(const RunKey& key) const noexcept;
+	};
+	struct RunEntry
+	{
+		ShapedRun Run;
+		std::list<const RunKey*>::iterator Lru = {};
+	};
+
+	void Rasterize(std::uint64_t key);
+	GlyphEntry& GetEntry(std::uint64_t key);
+	bool MakeResident(std::uint64_t key, GlyphEntry& entry);
+	void Evict(GlyphEntry& entry) noexcept;
+
+	std::unique_ptr<GlyphRasterizer> m_rasterizer;
+	std::unordered_map<std::string, unsigned int> m_fonts;
+
+	GlyphAtlas m_atlas;
+	std::unordered_map<std::uint64_t, GlyphEntry> m_glyphs;
+	std::list<std::uint64_t> m_evictable;	// Least recently released glyph first
+	size_t m_residentGlyphs = 0;
+
+	std::unordered_map<RunKey, RunEntry, RunKeyHash> m_runs;
+	std::list<const RunKey*> m_runLru;		// Least recently used run first
+
+	// Scratch space for rasterizing. m_bitmapKey is the glyph it currently holds
+	GlyphBitmap m_bitmap;
+	std::uint64_t m_bitmapKey = UINT64_MAX;
+};
+}
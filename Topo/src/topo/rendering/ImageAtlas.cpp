@@ -0,0 +1,81 @@
+#include "pch.h"
+#include "ImageAtlas.h"
+#include "topo/Log.h"
+
+
+namespace topo
+{
+std::optional<unsigned int> ImageAtlas::Acquire(std::string_view name)
+{
+	auto iter = m_names.find(std::string(name));
+	if (iter == m_names.end())
+		return std::nullopt;
+
+	++m_entries[iter->second].References;
+	return iter->second;
+}
+
+std::optional<unsigned int> ImageAtlas::Add(std::string_view name, unsigned int width, unsigned int height, unsigned int flags)
+{
+	ASSERT(!m_names.contains(std::string(name)), "Image is already in the atlas - use Acquire()");
+	if (width == 0 || height == 0 || width > PageSize || height > PageSize) [[unlikely]]
+		return std::nullopt;
+
+	// First fit over the pages that already exist, and only then open a new page
+	std::optional<ShelfPacker::Region> region = std::nullopt;
+	unsigned int page = 0;
+	while (page < PageCount() && !(region = m_pages[page].Allocate(width, height)).has_value())
+		++page;
+
+	if (!region.has_value())
+	{
+		if (m_pages.size() >= MaxPages)
+			return std::nullopt;
+
+		region = m_pages.emplace_back(PageSize, PageSize).Allocate(width, height);
+		ASSERT(region.has_value(), "An image that fits on a page must fit on an empty page");
+	}
+
+	unsigned int image = 0;
+	if (!m_freeSlots.empty())
+	{
+		image = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		image = static_cast<unsigned int>(m_entries.size());
+		m_entries.emplace_back();
+		m_table.emplace_back();
+	}
+
+	m_entries[image] = { std::string(name), 1, region.value() };
+	m_table[image] = {
+		page,
+		static_cast<unsigned int>(region->X) | (static_cast<unsigned int>(region->Y) << 16),
+		width | (height << 16),
+		flags
+	};
+	m_names.emplace(std::string(name), image);
+	return image;
+}
+
+bool ImageAtlas::Release(unsigned int image) noexcept
+{
+	if (image >= m_entries.size() || m_entries[image].References == 0) [[unlikely]]
+	{
+		LOG_WARN("ImageAtlas: Attempting to release an image that is not in the atlas ({0})", image);
+		return false;
+	}
+
+	Entry& entry = m_entries[image];
+	if (--entry.References > 0)
+		return false;
+
+	m_pages[m_table[image].Page].Free(entry.Region);
+	m_names.erase(entry.Name);
+	entry.Name.clear();
+	m_freeSlots.push_back(image);
+	return true;
+}
+}
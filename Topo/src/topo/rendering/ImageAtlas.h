@@ -0,0 +1,79 @@
+#pragma once
+#include "topo/Core.h"
+#include "topo/utils/ShelfPacker.h"
+
+
+namespace topo
+{
+// Entry of the image table (gImages in Control-ps.hlsl). Image instances only carry the index of their entry (see
+// UIRenderer::UpdateImage), which keeps UIObjectData at 36 bytes
+struct UIImageData
+{
+	unsigned int Page;		// Page of the image atlas that holds the image
+	unsigned int Origin;	// Texel (x | y << 16) of the image's top-left corner on its page
+	unsigned int Size;		// Width | height << 16 (in texels)
+	unsigned int Flags;		// See ImageAtlas::SwapRedBlue/IgnoreAlpha
+};
+static_assert(sizeof(UIImageData) == 16, "UIImageData must match gImages in Control-ps.hlsl");
+
+// ImageAtlas keeps track of where UI images live in the image atlas. Like GlyphAtlas, it has no GPU dependencies:
+// it only hands out spots on its pages (see ShelfPacker) and keeps the image table, and the renderer copies the
+// images themselves (see UIRenderer::AcquireImage).
+//
+// Images are keyed by name (i.e. their filename) and reference counted, so every user of the same image shares the
+// same spot. An image leaves the atlas as soon as its last reference is released. Pages are added as they are
+// needed (up to MaxPages) and never go away, and every page is an RGBA8 square of PageSize texels
+class ImageAtlas
+{
+public:
+	// NOTE: The page size must match IMAGE_ATLAS_PAGE_SIZE in Control-ps.hlsl
+	static constexpr unsigned int PageSize = 1024;
+	static constexpr unsigned int MaxPages = 16;
+	static constexpr size_t PageBytes = static_cast<size_t>(PageSize) * PageSize * 4;
+
+	// Flags (see UIImageData). The atlas holds the images' texels exactly as their textures do, so BGRA images
+	// get swizzled when they are read and images without alpha (BGRX) get treated as opaque
+	static constexpr unsigned int SwapRedBlue = 1;
+	static constexpr unsigned int IgnoreAlpha = 2;
+
+	ImageAtlas() noexcept = default;
+	ImageAtlas(const ImageAtlas&) = default;
+	ImageAtlas(ImageAtlas&&) noexcept = default;
+	ImageAtlas& operator=(const ImageAtlas&) = default;
+	ImageAtlas& operator=(ImageAtlas&&) noexcept = default;
+
+	// Returns the image with the given name and adds a reference to it, or std::nullopt if it is not in the atlas
+	ND std::optional<unsigned int> Acquire(std::string_view name);
+
+	// Adds a (width x height) image with a single reference. Returns std::nullopt if there is no room for it
+	ND std::optional<unsigned int> Add(std::string_view name, unsigned int width, unsigned int height, unsigned int flags);
+
+	// Returns true if that was the last reference, in which case the image is gone
+	bool Release(unsigned int image) noexcept;
+
+	ND inline const UIImageData& GetImage(unsigned int image) const noexcept
+	{
+		ASSERT(image < m_table.size() && m_entries[image].References > 0, "Invalid image");
+		return m_table[image];
+	}
+	ND constexpr std::span<const UIImageData> GetTable() const noexcept { return m_table; }
+	ND inline unsigned int PageCount() const noexcept { return static_cast<unsigned int>(m_pages.size()); }
+	ND inline size_t ImageCount() const noexcept { return m_names.size(); }
+
+private:
+	struct Entry
+	{
+		std::string Name;
+		unsigned int References = 0;
+		ShelfPacker::Region Region = {};
+	};
+
+	std::vector<ShelfPacker> m_pages;
+
+	// m_table[iii] is the GPU side of m_entries[iii]. Slots of released images get reused
+	std::vector<UIImageData> m_table;
+	std::vector<Entry> m_entries;
+	std::vector<unsigned int> m_freeSlots;
+	std::unordered_map<std::string, unsigned int> m_names;
+};
+}
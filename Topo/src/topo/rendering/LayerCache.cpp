@@ -0,0 +1,417 @@
+#include "pch.h"
+#include "LayerCache.h"
+#include "topo/Log.h"
+
+
+namespace topo
+{
+void LayerCache::SetDeviceResources(std::shared_ptr<DeviceResources> deviceResources)
+{
+	m_deviceResources = deviceResources;
+	m_renderer.SetDeviceResources(deviceResources);
+	m_buffer = std::make_unique<StructuredBufferDefault>(m_deviceResources, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+}
+void LayerCache::OnWindowResize(float width, float height) noexcept
+{
+	m_windowWidth = width;
+	m_windowHeight = height;
+	m_renderer.SetViewport({ 0.0f, 0.0f, width, height, 0.0f, 1.0f });
+	m_renderer.SetScissorRect({ 0, 0, static_cast<LONG>(width), static_cast<LONG>(height) });
+}
+
+unsigned int LayerCache::AddLayer(unsigned int clip)
+{
+	// Reuse a free slot if there is one (its render item/buffer are still around)
+	unsigned int index = 0;
+	if (!m_freeLayerSlots.empty())
+	{
+		index = m_freeLayerSlots.back();
+		m_freeLayerSlots.pop_back();
+	}
+	else
+	{
+		index = static_cast<unsigned int>(m_layers.size());
+		Layer& layer = *m_layers.emplace_back(std::make_unique<Layer>());
+
+		// The whole layer gets rendered from scratch, so all of its content is uploaded
+		layer.Buffer = std::make_unique<StructuredBufferMapped<UIObjectData>>(m_deviceResources);
+		layer.Buffer->Update = [this, l = &layer](const Timer& timer, int frameIndex)
+			{
+				l->Buffer->Reserve(frameIndex, l->Instances.size());
+				l->Buffer->CopyData(frameIndex, 0, l->Instances);
+				m_bytesUploaded += l->Instances.size() * sizeof(UIObjectData);
+			};
+
+		RenderPassLayer& passLayer = m_renderer.GetRenderPass(0).GetRenderPassLayer(0);
+		layer.RenderItemIndex = static_cast<unsigned int>(passLayer.GetRenderItems().size());
+		RenderItem& item = passLayer.EmplaceBackRenderItem(0, 0);
+		SET_DEBUG_NAME(item, std::format("Cached Layer RenderItem #{0}", index));
+		item.BindStructuredBuffer(0, layer.Buffer.get());
+		item.SetActive(false);
+	}
+
+	Layer& layer = *m_layers[index];
+	layer.Clip = clip;
+	layer.Alive = true;
+	layer.Invalid = false;
+	layer.Cached = false;
+	layer.Rebuild = false;
+	layer.Evicted = false;
+	layer.StableUpdates = 0;
+	layer.LastUsedUpdate = m_updateCount;
+	return index;
+}
+void LayerCache::RemoveLayer(unsigned int index)
+{
+	Layer& layer = *m_layers[index];
+	if (layer.Cached)
+		Uncache(index);
+
+	layer.Alive = false;
+	m_freeLayerSlots.push_back(index);
+}
+void LayerCache::Uncache(unsigned int index)
+{
+	Layer& layer = *m_layers[index];
+	ASSERT(layer.Cached, "Layer is not cached");
+
+	if (layer.Rebuild)
+	{
+		layer.Rebuild = false;
+		layer.Instances.clear();
+		m_renderer.GetRenderPass(0).GetRenderPassLayer(0).GetRenderItem(layer.RenderItemIndex).SetActive(false);
+	}
+
+	m_allocator.Free(layer.CacheOffset, layer.CacheSize);
+	layer.Cached = false;
+	OnUncached(layer);
+}
+std::optional<size_t> LayerCache::Allocate(size_t size)
+{
+	while (true)
+	{
+		if (const std::optional<size_t> offset = m_allocator.Allocate(size))
+			return offset;
+
+		// Evict the cached layer that has not been in use for the longest. Layers that were picked during this
+		// update are not cached yet (see Cache), so they are never evicted to make room for each other
+		unsigned int victim = NoLayer;
+		for (unsigned int iii = 0; iii < static_cast<unsigned int>(m_layers.size()); ++iii)
+		{
+			const Layer& layer = *m_layers[iii];
+			if (layer.Alive && layer.Cached && (victim == NoLayer || layer.LastUsedUpdate < m_layers[victim]->LastUsedUpdate))
+				victim = iii;
+		}
+		if (victim == NoLayer)
+			return std::nullopt;
+
+		Uncache(victim);
+		m_layers[victim]->Evicted = true;
+	}
+}
+Rect LayerCache::SnapToWindowPixels(const Rect& rect) const noexcept
+{
+	return {
+		std::max(std::floor(rect.Left), 0.0f),
+		std::max(std::floor(rect.Top), 0.0f),
+		std::min(std::ceil(rect.Right), m_windowWidth),
+		std::min(std::ceil(rect.Bottom), m_windowHeight)
+	};
+}
+
+bool LayerCache::Update(std::span<const Rect> clipVisibleRects)
+{
+	++m_updateCount;
+	m_layersWaiting = 0;
+
+	// 1. Layers that changed go back to being drawn live and the rest count how long they have not been changing
+	for (unsigned int iii = 0; iii < static_cast<unsigned int>(m_layers.size()); ++iii)
+	{
+		Layer& layer = *m_layers[iii];
+		if (!layer.Alive)
+			continue;
+
+		if (layer.Invalid)
+		{
+			layer.Invalid = false;
+			layer.Evicted = false;
+			layer.StableUpdates = 0;
+			if (layer.Cached)
+				Uncache(iii);
+		}
+		else if (!layer.Cached)
+			layer.StableUpdates = std::min(layer.StableUpdates + 1, FramesBeforeCaching);
+	}
+
+	// 2. Pick the live layers that have stopped changing and make room for them in the layer cache. Every layer is
+	// rendered at its position in the window into the same render target, so a layer that overlaps a layer that is
+	// already going to be rendered has to wait for the next update
+	bool picked = false;
+	const auto overlapsRebuild = [this](const Rect& bounds) noexcept
+		{
+			for (const std::unique_ptr<Layer>& other : m_layers)
+			{
+				if (other->Rebuild && bounds.Left < other->Bounds.Right && other->Bounds.Left < bounds.Right && bounds.Top < other->Bounds.Bottom && other->Bounds.Top < bounds.Bottom)
+					return true;
+			}
+			return false;
+		};
+	for (std::unique_ptr<Layer>& ptr : m_layers)
+	{
+		Layer& layer = *ptr;
+		if (!layer.Alive || layer.Cached || layer.Evicted)
+			continue;
+
+		if (layer.StableUpdates < FramesBeforeCaching)
+		{
+			++m_layersWaiting;
+			continue;
+		}
+
+		// A layer that is entirely outside of the window (or its clip) has nothing to cache. It changes once it
+		// comes back into view, which starts the count over
+		const Rect bounds = SnapToWindowPixels(clipVisibleRects[layer.Clip]);
+		if (bounds.Width() <= 0.0f || bounds.Height() <= 0.0f)
+			continue;
+
+		if (overlapsRebuild(bounds))
+		{
+			++m_layersWaiting;
+			continue;
+		}
+
+		// The layer cache only gets created (or resized after SetBudget) once something gets cached
+		if (m_buffer->GetCapacityBytes(0) != m_allocator.GetCapacity() && m_allocator.GetCapacity() > 0)
+		{
+			ASSERT(m_allocator.GetUsed() == 0, "The layer cache cannot be resized while layers are cached");
+			m_buffer->Resize(m_allocator.GetCapacity());
+		}
+
+		const size_t size = RowPitch(static_cast<size_t>(bounds.Width())) * static_cast<size_t>(bounds.Height());
+		const std::optional<size_t> offset = Allocate(size);
+		if (!offset.has_value())
+		{
+			layer.Evicted = true;
+			continue;
+		}
+
+		// The layer only counts as cached once it has a composite (see Cache)
+		layer.Rebuild = true;
+		layer.Bounds = bounds;
+		layer.CacheOffset = offset.value();
+		layer.CacheSize = size;
+		layer.LastUsedUpdate = m_updateCount;
+		picked = true;
+	}
+	return picked;
+}
+void LayerCache::Cache(unsigned int index, unsigned int composite)
+{
+	Layer& layer = *m_layers[index];
+	ASSERT(layer.Rebuild && !layer.Cached, "Only layers that were picked by Update() can be cached");
+	ASSERT(!layer.Instances.empty(), "Layers without any content cannot be cached - use Discard()");
+
+	layer.Composite = composite;
+	layer.Cached = true;
+
+	RenderPassLayer& passLayer = m_renderer.GetRenderPass(0).GetRenderPassLayer(0);
+	RenderItem& item = passLayer.GetRenderItem(layer.RenderItemIndex);
+	item.SetInstanceCount(static_cast<unsigned int>(layer.Instances.size()));
+	item.SetActive(true);
+	passLayer.SetActive(true);
+
+	// Layers get rendered at their position in the window, so the render target has to match the window
+	if (m_targetWidth != static_cast<unsigned int>(m_windowWidth) || m_targetHeight != static_cast<unsigned int>(m_windowHeight))
+		CreateTarget();
+	m_rebuildPending = true;
+}
+void LayerCache::Discard(unsigned int index) noexcept
+{
+	Layer& layer = *m_layers[index];
+	ASSERT(layer.Rebuild && !layer.Cached, "Only layers that were picked by Update() can be discarded");
+
+	m_allocator.Free(layer.CacheOffset, layer.CacheSize);
+	layer.Instances.clear();
+	layer.Rebuild = false;
+	layer.Evicted = true;
+}
+void LayerCache::MarkRedrawn(std::span<const D3D12_RECT> redrawRects, std::span<const Rect> clipVisibleRects) noexcept
+{
+	// Layers that were evicted, or did not fit, get another chance once they are redrawn
+	for (const std::unique_ptr<Layer>& layer : m_layers)
+	{
+		if (!layer->Alive)
+			continue;
+
+		const Rect& bounds = layer->Cached ? layer->Bounds : clipVisibleRects[layer->Clip];
+		const bool redrawn = std::ranges::any_of(redrawRects, [&bounds](const D3D12_RECT& r) noexcept
+			{
+				return bounds.Left < static_cast<float>(r.right) && static_cast<float>(r.left) < bounds.Right &&
+					bounds.Top < static_cast<float>(r.bottom) && static_cast<float>(r.top) < bounds.Bottom;
+			});
+		if (!redrawn)
+			continue;
+
+		layer->LastUsedUpdate = m_updateCount;
+		if (layer->Evicted)
+		{
+			layer->Evicted = false;
+			++m_layersWaiting;
+		}
+	}
+}
+void LayerCache::SetBudget(size_t bytes)
+{
+	for (unsigned int iii = 0; iii < static_cast<unsigned int>(m_layers.size()); ++iii)
+	{
+		Layer& layer = *m_layers[iii];
+		if (layer.Cached)
+			Uncache(iii);
+		layer.Evicted = false;
+	}
+	m_allocator.Reset(bytes);
+}
+
+size_t LayerCache::Upload(const Timer& timer, int frameIndex)
+{
+	// Only the layer gets updated - the pass binds the same buffers as the UI pass, which the owner updates
+	if (!m_rebuildPending)
+		return 0;
+
+	m_bytesUploaded = 0;
+	m_renderer.GetRenderPass(0).GetRenderPassLayer(0).Update(timer, frameIndex);
+	return m_bytesUploaded;
+}
+void LayerCache::Render(int frameIndex)
+{
+	if (!m_rebuildPending)
+		return;
+
+	m_renderer.Render(frameIndex);
+
+	RenderPassLayer& passLayer = m_renderer.GetRenderPass(0).GetRenderPassLayer(0);
+	for (const std::unique_ptr<Layer>& layer : m_layers)
+	{
+		if (!layer->Rebuild)
+			continue;
+		layer->Rebuild = false;
+		layer->Instances.clear();
+		passLayer.GetRenderItem(layer->RenderItemIndex).SetActive(false);
+	}
+	passLayer.SetActive(false);
+	m_rebuildPending = false;
+}
+void LayerCache::CreateTarget()
+{
+	ID3D12Device* device = m_deviceResources->GetDevice();
+	m_targetWidth = static_cast<unsigned int>(m_windowWidth);
+	m_targetHeight = static_cast<unsigned int>(m_windowHeight);
+
+	// The previous render target might still be in use by the GPU, so do a delayed delete
+	if (m_target != nullptr)
+		m_deviceResources->DelayedDelete(m_target);
+
+	auto props = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+	auto desc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, m_targetWidth, m_targetHeight, 1, 1, 1, 0, D3D12_RESOURCE_FLAG_ALLOW_RENDER_TARGET);
+
+	D3D12_CLEAR_VALUE optClear = {};
+	optClear.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+
+	GFX_THROW_INFO(
+		device->CreateCommittedResource(
+			&props,
+			D3D12_HEAP_FLAG_NONE,
+			&desc,
+			D3D12_RESOURCE_STATE_RENDER_TARGET,
+			&optClear,
+			IID_PPV_ARGS(m_target.ReleaseAndGetAddressOf())
+		)
+	);
+
+	if (m_rtvHeap == nullptr)
+	{
+		D3D12_DESCRIPTOR_HEAP_DESC rtvHeapDesc = {};
+		rtvHeapDesc.NumDescriptors = 1;
+		rtvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+		rtvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+		rtvHeapDesc.NodeMask = 0;
+		GFX_THROW_INFO(
+			device->CreateDescriptorHeap(&rtvHeapDesc, IID_PPV_ARGS(m_rtvHeap.GetAddressOf()))
+		);
+	}
+
+	// RTVs are read when they get bound, so the descriptor can be overwritten even if an earlier frame used it
+	GFX_THROW_INFO_ONLY(
+		device->CreateRenderTargetView(m_target.Get(), nullptr, m_rtvHeap->GetCPUDescriptorHandleForHeapStart())
+	);
+}
+bool LayerCache::BeginRebuild(ID3D12GraphicsCommandList* commandList)
+{
+	m_rebuildRects.clear();
+	for (const std::unique_ptr<Layer>& layer : m_layers)
+	{
+		if (layer->Rebuild)
+		{
+			m_rebuildRects.push_back({
+				static_cast<LONG>(layer->Bounds.Left),
+				static_cast<LONG>(layer->Bounds.Top),
+				static_cast<LONG>(layer->Bounds.Right),
+				static_cast<LONG>(layer->Bounds.Bottom)
+			});
+		}
+	}
+	if (m_rebuildRects.empty())
+		return false;
+
+	// Layers are blended into transparent black, which leaves their colors premultiplied (see Control-ps.hlsl)
+	const D3D12_CPU_DESCRIPTOR_HANDLE rtv = m_rtvHeap->GetCPUDescriptorHandleForHeapStart();
+	const FLOAT clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	GFX_THROW_INFO_ONLY(commandList->OMSetRenderTargets(1, &rtv, true, nullptr));
+	GFX_THROW_INFO_ONLY(commandList->ClearRenderTargetView(rtv, clearColor, static_cast<UINT>(m_rebuildRects.size()), m_rebuildRects.data()));
+	return true;
+}
+void LayerCache::EndRebuild(ID3D12GraphicsCommandList* commandList)
+{
+	auto toCopySource = CD3DX12_RESOURCE_BARRIER::Transition(m_target.Get(), D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_COPY_SOURCE);
+	GFX_THROW_INFO_ONLY(commandList->ResourceBarrier(1, &toCopySource));
+
+	// Copy the pixels of each layer into its range of the layer cache, which gets implicitly promoted to COPY_DEST
+	// (see StructuredBufferDefault)
+	const CD3DX12_TEXTURE_COPY_LOCATION src(m_target.Get(), 0);
+	for (const std::unique_ptr<Layer>& layer : m_layers)
+	{
+		if (!layer->Rebuild)
+			continue;
+
+		const UINT width = static_cast<UINT>(layer->Bounds.Width());
+		const UINT height = static_cast<UINT>(layer->Bounds.Height());
+
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+		footprint.Offset = layer->CacheOffset;
+		footprint.Footprint = { DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, static_cast<UINT>(RowPitch(width)) };
+		const CD3DX12_TEXTURE_COPY_LOCATION dst(m_buffer->GetResource(), footprint);
+
+		const D3D12_BOX box = {
+			static_cast<UINT>(layer->Bounds.Left),
+			static_cast<UINT>(layer->Bounds.Top),
+			0,
+			static_cast<UINT>(layer->Bounds.Right),
+			static_cast<UINT>(layer->Bounds.Bottom),
+			1
+		};
+		GFX_THROW_INFO_ONLY(commandList->CopyTextureRegion(&dst, 0, 0, 0, &src, &box));
+	}
+
+	// The UI pass reads the layer cache right after this, in the same command list, so it needs an explicit transition
+	const std::array<D3D12_RESOURCE_BARRIER, 2> barriers = {
+		CD3DX12_RESOURCE_BARRIER::Transition(m_target.Get(), D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_RENDER_TARGET),
+		CD3DX12_RESOURCE_BARRIER::Transition(m_buffer->GetResource(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE)
+	};
+	GFX_THROW_INFO_ONLY(commandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data()));
+
+	// Back to the back buffer for the UI pass
+	const D3D12_CPU_DESCRIPTOR_HANDLE backBuffer = m_deviceResources->CurrentBackBufferView();
+	const D3D12_CPU_DESCRIPTOR_HANDLE depthStencil = m_deviceResources->DepthStencilView();
+	GFX_THROW_INFO_ONLY(commandList->OMSetRenderTargets(1, &backBuffer, true, &depthStencil));
+}
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include "topo/Core.h"
+#include "Renderer.h"
+#include "UIObjectData.h"
+#include "topo/utils/BufferAllocator.h"
+#include "topo/utils/Rect.h"
+#include "topo/utils/Timer.h"
+
+
+namespace topo
+{
+// LayerCache keeps the pixels of cached layers (see UIRenderer::SetClipCached) around on the GPU and decides which
+// layers get cached, when, and which ones get evicted. It knows nothing about render objects: UIRenderer hands it the
+// content of the layers it picks (see Update) and registers a composite for each of them (see Cache), and the
+// composite draws the layer's pixels from GetBuffer() until the layer changes.
+//
+// A layer is either live (its content is drawn like everything else) or cached. A layer that was cached during the
+// last update still has to be rendered into the layer cache (Rebuild), which happens at the start of the next
+// Render(). A layer is in use whenever part of it gets redrawn, and the layer that has not been in use for the
+// longest is the first to be evicted. Evicted layers (and layers that did not fit) are not cached again until they
+// change or get redrawn. Unused slots keep their render item/buffer so they can be reused.
+//
+// The layer cache itself is a buffer in the default heap that holds the pixels of every cached layer (RGBA8, rows
+// aligned to D3D12_TEXTURE_DATA_PITCH_ALIGNMENT, so they can be copied straight out of a texture). Layers get
+// rendered into a window sized render target and then copied into their range.
+//
+// NOTE: Once cached, a layer is a single quad at the lowest z-order of its content. Objects outside of the layer
+// that overlap it with a z-order in between the lowest and highest z-order of the layer's content are therefore
+// drawn on top of all of it, rather than in between. Layouts that interleave like that should not be cached
+class LayerCache
+{
+public:
+	static constexpr unsigned int NoLayer = UINT_MAX;
+	static constexpr unsigned int FramesBeforeCaching = 2;
+	static constexpr size_t DefaultBudget = 32 * 1024 * 1024;
+
+	struct Layer
+	{
+		unsigned int Clip = 0;
+		bool Alive = false;
+		bool Invalid = false;	// Something in the layer changed since the last update
+		bool Cached = false;
+		bool Rebuild = false;
+		bool Evicted = false;
+		unsigned int StableUpdates = 0;
+		std::uint64_t LastUsedUpdate = 0;
+
+		// While cached: the pixels the layer covers (window space, whole pixels), where they live in the layer cache,
+		// and the handle of the composite
+		Rect Bounds = {};
+		size_t CacheOffset = 0;
+		size_t CacheSize = 0;
+		unsigned int Composite = 0;
+
+		// While rebuilding: the layer's content, back-to-front, and the render item of the layer cache pass that draws it
+		std::vector<UIObjectData> Instances;
+		std::unique_ptr<StructuredBufferMapped<UIObjectData>> Buffer = nullptr;
+		unsigned int RenderItemIndex = 0;
+	};
+
+	LayerCache() = default;
+	LayerCache(const LayerCache&) = delete;
+	LayerCache(LayerCache&&) = delete;
+	LayerCache& operator=(const LayerCache&) = delete;
+	LayerCache& operator=(LayerCache&&) = delete;
+	~LayerCache() noexcept = default;
+
+	// Creates the layer cache (tiny at first - it only grows to the budget once something gets cached). The render
+	// pass that rebuilds layers is set up by the owner (see GetRenderer), with a single layer that blends
+	// back-to-front into R8G8B8A8_UNORM and its PreWork/PostWork calling BeginRebuild/EndRebuild
+	void SetDeviceResources(std::shared_ptr<DeviceResources> deviceResources);
+	void OnWindowResize(float width, float height) noexcept;
+
+	// Called whenever a composite stops drawing a layer (the layer changed, got evicted or was removed). The owner
+	// has to unregister the composite, which damages its rect, so the layer's content gets drawn live again there
+	std::function<void(const Layer&)> OnUncached = [](const Layer&) {};
+
+	ND unsigned int AddLayer(unsigned int clip);
+	void RemoveLayer(unsigned int layer);
+	inline void Invalidate(unsigned int layer) noexcept { m_layers[layer]->Invalid = true; }
+	ND inline Layer& GetLayer(unsigned int layer) noexcept { return *m_layers[layer]; }
+	ND inline const Layer& GetLayer(unsigned int layer) const noexcept { return *m_layers[layer]; }
+	ND inline unsigned int LayerCount() const noexcept { return static_cast<unsigned int>(m_layers.size()); }
+	ND inline bool IsCached(unsigned int layer) const noexcept { return m_layers[layer]->Cached; }
+
+	// Drops the layers that changed and picks the ones that stopped changing, given the visible rect of every clip.
+	// Returns true if any layer was picked - their content then has to be added to their Instances (back-to-front),
+	// after which each of them either gets cached (Cache) or not (Discard)
+	ND bool Update(std::span<const Rect> clipVisibleRects);
+	void Cache(unsigned int layer, unsigned int composite);
+	void Discard(unsigned int layer) noexcept;
+
+	// Marks every layer that is part of the redraw as in use
+	void MarkRedrawn(std::span<const D3D12_RECT> redrawRects, std::span<const Rect> clipVisibleRects) noexcept;
+
+	// Uploads the content of the layers that are about to be rendered. Returns the number of bytes uploaded
+	ND size_t Upload(const Timer& timer, int frameIndex);
+	void Render(int frameIndex);
+	ND bool BeginRebuild(ID3D12GraphicsCommandList* commandList);
+	void EndRebuild(ID3D12GraphicsCommandList* commandList);
+
+	// Every cached layer goes back to being drawn live, and they get cached again (in a layer cache of the new
+	// size) on the next update
+	void SetBudget(size_t bytes);
+	ND constexpr size_t GetBudget() const noexcept { return m_allocator.GetCapacity(); }
+	ND constexpr size_t GetBytesUsed() const noexcept { return m_allocator.GetUsed(); }
+	ND constexpr bool HasLayersWaiting() const noexcept { return m_layersWaiting > 0; }
+
+	ND constexpr Renderer& GetRenderer() noexcept { return m_renderer; }
+	ND inline StructuredBufferDefault* GetBuffer() const noexcept { return m_buffer.get(); }
+
+	ND static constexpr size_t RowPitch(size_t width) noexcept
+	{
+		return (width * 4 + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) / D3D12_TEXTURE_DATA_PITCH_ALIGNMENT * D3D12_TEXTURE_DATA_PITCH_ALIGNMENT;
+	}
+
+private:
+	ND std::optional<size_t> Allocate(size_t size);
+	void Uncache(unsigned int layer);
+	void CreateTarget();
+	ND Rect SnapToWindowPixels(const Rect& rect) const noexcept;
+
+	std::shared_ptr<DeviceResources> m_deviceResources = nullptr;
+	float m_windowWidth = 0.0f;
+	float m_windowHeight = 0.0f;
+
+	std::vector<std::unique_ptr<Layer>> m_layers;
+	std::vector<unsigned int> m_freeLayerSlots;
+	std::uint64_t m_updateCount = 0;
+	unsigned int m_layersWaiting = 0;
+	bool m_rebuildPending = false;
+	std::vector<D3D12_RECT> m_rebuildRects;
+	size_t m_bytesUploaded = 0;
+
+	BufferAllocator m_allocator{ DefaultBudget, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT };
+	std::unique_ptr<StructuredBufferDefault> m_buffer = nullptr;
+	Renderer m_renderer;
+	Microsoft::WRL::ComPtr<ID3D12Resource> m_target = nullptr;
+	Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_rtvHeap = nullptr;
+	unsigned int m_targetWidth = 0;
+	unsigned int m_targetHeight = 0;
+};
+}
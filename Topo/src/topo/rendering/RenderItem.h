@@ -1,5 +1,6 @@
 #pragma once
 #include "RootConstantBufferView.h"
+#include "RootShaderResourceView.h"
 #include "RootDescriptorTable.h"
 #include "Texture.h"
 
@@ -19,11 +20,15 @@ public:
 		for (auto& rcbv : m_constantBufferViews)
 			rcbv.GetConstantBuffer()->Update(timer, frameIndex);
 
+		for (auto& rsrv : m_shaderResourceViews)
+			rsrv.GetBuffer()->Update(timer, frameIndex);
+
 		for (auto& dt : m_descriptorTables)
 			dt.Update(&dt, timer, frameIndex);
 	}
 
 	constexpr void BindConstantBuffer(UINT rootParameterIndex, ConstantBufferBase* cb) noexcept { m_constantBufferViews.emplace_back(rootParameterIndex, cb); }
+	constexpr void BindStructuredBuffer(UINT rootParameterIndex, StructuredBufferBase* buffer) noexcept { m_shaderResourceViews.emplace_back(rootParameterIndex, buffer); }
 	constexpr void BindTexture(UINT rootParameterIndex, const Texture& texture) noexcept
 	{
 		// When binding a new Texture, we must make sure no two descriptor tables reference the same root parameter index
@@ -97,6 +102,8 @@ public:
 	template <class Self>
 	ND constexpr auto&& GetRootConstantBufferViews(this Self&& self) noexcept { return std::forward<Self>(self).m_constantBufferViews; }
 	template <class Self>
+	ND constexpr auto&& GetRootShaderResourceViews(this Self&& self) noexcept { return std::forward<Self>(self).m_shaderResourceViews; }
+	template <class Self>
 	ND constexpr auto&& GetRootDescriptorTables(this Self&& self) noexcept { return std::forward<Self>(self).m_descriptorTables; }
 
 	ND constexpr bool IsActive() const noexcept { return m_active; }
@@ -106,6 +113,9 @@ protected:
 	// 0+ constant buffer views for per-item constants
 	std::vector<RootConstantBufferView> m_constantBufferViews;
 
+	// 0+ root shader resource views for per-item structured buffers
+	std::vector<RootShaderResourceView> m_shaderResourceViews;
+
 	// 0+ descriptor tables for per-item resources
 	std::vector<RootDescriptorTable> m_descriptorTables;
 
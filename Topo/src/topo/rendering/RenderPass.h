@@ -1,6 +1,7 @@
 #pragma once
 #include "RootSignature.h"
 #include "RootConstantBufferView.h"
+#include "RootShaderResourceView.h"
 #include "RenderPassLayer.h"
 #include "ComputeLayer.h"
 #include "Texture.h"
@@ -165,12 +166,25 @@ public:
 				)
 			);
 		}
+
+		for (const RootShaderResourceView& srv : m_shaderResourceViews)
+		{
+			GFX_THROW_INFO_ONLY(
+				commandList->SetGraphicsRootShaderResourceView(
+					srv.GetRootParameterIndex(),
+					srv.GetBuffer()->GetGPUVirtualAddress(frameIndex)
+				)
+			);
+		}
 	}
 	inline void Update(const Timer& timer, int frameIndex)
 	{
-		// Loop over the constant buffer views to update per-pass constants
+		// Loop over the constant buffer views and structured buffers to update per-pass data
 		for (auto& rcbv : m_constantBufferViews)
 			rcbv.GetConstantBuffer()->Update(timer, frameIndex);
+
+		for (auto& rsrv : m_shaderResourceViews)
+			rsrv.GetBuffer()->Update(timer, frameIndex);
 	}
 
 
@@ -201,6 +215,7 @@ public:
 	constexpr void PushBackComputeLayer(ComputeLayer&& cl) noexcept { m_computeLayers.push_back(std::move(cl)); }
 
 	constexpr void BindConstantBuffer(UINT rootParameterIndex, ConstantBufferBase* cb) noexcept { m_constantBufferViews.emplace_back(rootParameterIndex, cb); }
+	constexpr void BindStructuredBuffer(UINT rootParameterIndex, StructuredBufferBase* buffer) noexcept { m_shaderResourceViews.emplace_back(rootParameterIndex, buffer); }
 
 	// Function pointers for Pre/Post-Work 
 	// PreWork needs to return a bool: false -> signals early exit (i.e. do not make a Draw call for this layer)
@@ -221,6 +236,9 @@ private:
 	// 0+ constant buffer views for per-pass constants
 	std::vector<RootConstantBufferView> m_constantBufferViews;
 
+	// 0+ root shader resource views for per-pass structured buffers
+	std::vector<RootShaderResourceView> m_shaderResourceViews;
+
 	// 0+ render layers
 	std::vector<RenderPassLayer> m_renderPassLayers;
 
@@ -242,6 +260,9 @@ public:
 		for (unsigned int iii = 0; iii < m_constantBufferViews.size(); ++iii)
 			SET_DEBUG_NAME(m_constantBufferViews[iii], std::format("{0} - Constant Buffer View #{1}", name, iii));
 
+		for (unsigned int iii = 0; iii < m_shaderResourceViews.size(); ++iii)
+			SET_DEBUG_NAME(m_shaderResourceViews[iii], std::format("{0} - Shader Resource View #{1}", name, iii));
+
 		for (unsigned int iii = 0; iii < m_renderPassLayers.size(); ++iii)
 			SET_DEBUG_NAME(m_renderPassLayers[iii], std::format("{0} - Render Pass Layer #{1}", name, iii));
 
@@ -26,13 +26,24 @@ void Renderer::Update(const Timer& timer, int frameIndex)
 }
 
 void Renderer::Render(int frameIndex)
+{
+	Render(frameIndex, { &m_scissorRect, 1 });
+}
+void Renderer::Render(int frameIndex, std::span<const D3D12_RECT> scissorRects)
 {
 	ASSERT(m_renderPasses.size() > 0, "No render passes");
+	ASSERT(scissorRects.size() > 0, "Must have at least 1 scissor rect");
 
 	auto commandList = m_deviceResources->GetCommandList();
 
 	GFX_THROW_INFO_ONLY(commandList->RSSetViewports(1, &m_viewport));
-	GFX_THROW_INFO_ONLY(commandList->RSSetScissorRects(1, &m_scissorRect));
+
+	// With a single scissor rect, it only needs to be set once. Otherwise, it gets set before every draw
+	const bool singleScissorRect = scissorRects.size() == 1;
+	if (singleScissorRect)
+	{
+		GFX_THROW_INFO_ONLY(commandList->RSSetScissorRects(1, scissorRects.data()));
+	}
 
 	for (RenderPass& pass : m_renderPasses)
 	{
@@ -103,10 +114,25 @@ void Renderer::Render(int frameIndex)
 					);
 				}
 
+				for (const RootShaderResourceView& srv : item.GetRootShaderResourceViews())
+				{
+					GFX_THROW_INFO_ONLY(
+						commandList->SetGraphicsRootShaderResourceView(srv.GetRootParameterIndex(), srv.GetBuffer()->GetGPUVirtualAddress(frameIndex))
+					);
+				}
+
 				const MeshDescriptor& mesh = meshGroup->GetSubmesh(item.GetSubmeshIndex());
-				GFX_THROW_INFO_ONLY(
-					commandList->DrawIndexedInstanced(mesh.IndexCount, item.GetInstanceCount(), mesh.StartIndexLocation, mesh.BaseVertexLocation, 0)
-				);
+				for (const D3D12_RECT& scissorRect : scissorRects)
+				{
+					if (!singleScissorRect)
+					{
+						GFX_THROW_INFO_ONLY(commandList->RSSetScissorRects(1, &scissorRect));
+					}
+
+					GFX_THROW_INFO_ONLY(
+						commandList->DrawIndexedInstanced(mesh.IndexCount, item.GetInstanceCount(), mesh.StartIndexLocation, mesh.BaseVertexLocation, 0)
+					);
+				}
 			}
 		}
 
@@ -148,6 +174,12 @@ void Renderer::RunComputeLayer(const ComputeLayer& layer, const Timer* timer, in
 				commandList->SetComputeRootConstantBufferView(cbv.GetRootParameterIndex(), cbv.GetConstantBuffer()->GetGPUVirtualAddress(frameIndex))
 			);
 		}
+		for (const RootShaderResourceView& srv : item.GetRootShaderResourceViews())
+		{
+			GFX_THROW_INFO_ONLY(
+				commandList->SetComputeRootShaderResourceView(srv.GetRootParameterIndex(), srv.GetBuffer()->GetGPUVirtualAddress(frameIndex))
+			);
+		}
 
 		GFX_THROW_INFO_ONLY(commandList->Dispatch(item.GetThreadGroupCountX(), item.GetThreadGroupCountY(), item.GetThreadGroupCountZ()));
 	}
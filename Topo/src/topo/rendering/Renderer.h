@@ -37,6 +37,12 @@ public:
 	void Update(const Timer& timer, int frameIndex);
 	void Render(int frameIndex);
 
+	// Draws every render item once for each of the scissor rects (in place of the renderer's own scissor rect), so
+	// only those parts of the render target get drawn to. The rects must not overlap, otherwise anything that is
+	// blended gets blended twice where they do. Nothing gets culled per rect, so every rect costs a full pass over
+	// every instance - keep the number of rects small (see UIRenderer::PrepareRedraw)
+	void Render(int frameIndex, std::span<const D3D12_RECT> scissorRects);
+
 	ND constexpr RenderPass& GetRenderPass(unsigned int index) noexcept
 	{
 		ASSERT(index < m_renderPasses.size(), "index too large");
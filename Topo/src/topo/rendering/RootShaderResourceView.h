@@ -0,0 +1,43 @@
+#pragma once
+#include "StructuredBuffer.h"
+#include "topo/utils/Timer.h"
+
+namespace topo
+{
+#ifdef DIRECTX12
+
+class RootShaderResourceView
+{
+public:
+	inline RootShaderResourceView(UINT rootParameterIndex, StructuredBufferBase* buffer) noexcept :
+		m_rootParameterIndex(rootParameterIndex),
+		m_buffer(buffer)
+	{
+		ASSERT(m_buffer != nullptr, "StructuredBuffer should not be nullptr");
+	}
+	RootShaderResourceView(const RootShaderResourceView&) noexcept = default;
+	RootShaderResourceView(RootShaderResourceView&&) noexcept = default;
+	RootShaderResourceView& operator=(const RootShaderResourceView&) noexcept = default;
+	RootShaderResourceView& operator=(RootShaderResourceView&&) noexcept = default;
+
+	ND constexpr UINT GetRootParameterIndex() const noexcept { return m_rootParameterIndex; }
+	ND constexpr StructuredBufferBase* GetBuffer() const noexcept { return m_buffer; }
+
+private:
+	UINT				  m_rootParameterIndex;
+	StructuredBufferBase* m_buffer;
+
+
+// In DIST builds, we don't name the object
+#ifndef TOPO_DIST
+public:
+	void SetDebugName(std::string_view name) noexcept { m_name = name; }
+	ND const std::string& GetDebugName() const noexcept { return m_name; }
+private:
+	std::string m_name;
+#endif
+};
+
+
+#endif
+}
@@ -0,0 +1,527 @@
+#include "pch.h"
+#include "SoftwareRenderer2D.h"
+#include "topo/Log.h"
+#include "topo/TopoException.h"
+
+namespace topo
+{
+namespace
+{
+inline float Saturate(float value) noexcept { return std::clamp(value, 0.0f, 1.0f); }
+
+// Colors are unpacked to floats in [0, 1] (R is the lowest byte, see UIObjectData::Color) and packed back with
+// rounding, just like the GPU does for an RGBA8 render target
+inline Color UnpackColor(std::uint32_t color) noexcept
+{
+	constexpr float scale = 1.0f / 255.0f;
+	return {
+		static_cast<float>(color & 0xFF) * scale,
+		static_cast<float>((color >> 8) & 0xFF) * scale,
+		static_cast<float>((color >> 16) & 0xFF) * scale,
+		static_cast<float>(color >> 24) * scale
+	};
+}
+inline std::uint32_t PackChannel(float value) noexcept { return static_cast<std::uint32_t>(Saturate(value) * 255.0f + 0.5f); }
+inline std::uint32_t PackColor(const Color& color) noexcept
+{
+	return PackChannel(color.R) | (PackChannel(color.G) << 8) | (PackChannel(color.B) << 16) | (PackChannel(color.A) << 24);
+}
+inline Color Lerp(const Color& from, const Color& to, float t) noexcept
+{
+	return {
+		from.R + (to.R - from.R) * t,
+		from.G + (to.G - from.G) * t,
+		from.B + (to.B - from.B) * t,
+		from.A + (to.A - from.A) * t
+	};
+}
+inline Color WithAlpha(Color color, float alpha) noexcept
+{
+	color.A = alpha;
+	return color;
+}
+
+// Same blend state as the GPU (see UIRenderer::InitializeRenderer): rgb = src * a + dst * (1 - a) and
+// a = a + dstA * (1 - a). The source is premultiplied up front, so both become a single multiply-add per channel
+struct BlendSource
+{
+	inline explicit BlendSource(const Color& color) noexcept :
+		Premultiplied{ color.R * color.A, color.G * color.A, color.B * color.A, color.A },
+		InverseAlpha(1.0f - color.A)
+	{}
+	ND inline std::uint32_t Over(std::uint32_t destination) const noexcept
+	{
+		const Color dst = UnpackColor(destination);
+		return PackColor({
+			dst.R * InverseAlpha + Premultiplied.R,
+			dst.G * InverseAlpha + Premultiplied.G,
+			dst.B * InverseAlpha + Premultiplied.B,
+			dst.A * InverseAlpha + Premultiplied.A
+		});
+	}
+
+	Color Premultiplied;
+	float InverseAlpha;
+};
+
+// These match BoxDistance/EllipseDistance in Control-ps.hlsl
+inline float BoxDistance(float x, float y, float halfWidth, float halfHeight, float radius) noexcept
+{
+	radius = std::min(radius, std::min(halfWidth, halfHeight));
+	const float qx = std::abs(x) - halfWidth + radius;
+	const float qy = std::abs(y) - halfHeight + radius;
+	const float outside = std::sqrt(std::max(qx, 0.0f) * std::max(qx, 0.0f) + std::max(qy, 0.0f) * std::max(qy, 0.0f));
+	return outside + std::min(std::max(qx, qy), 0.0f) - radius;
+}
+inline float EllipseDistance(float x, float y, float halfWidth, float halfHeight) noexcept
+{
+	halfWidth = std::max(halfWidth, 0.0001f);
+	halfHeight = std::max(halfHeight, 0.0001f);
+	const float k0 = std::sqrt((x / halfWidth) * (x / halfWidth) + (y / halfHeight) * (y / halfHeight));
+	const float k1x = x / (halfWidth * halfWidth);
+	const float k1y = y / (halfHeight * halfHeight);
+	const float k1 = std::sqrt(k1x * k1x + k1y * k1y);
+	return k0 < 0.0001f ? -std::min(halfWidth, halfHeight) : k0 * (k0 - 1.0f) / k1;
+}
+inline float TriangleDistance(float x, float y, float halfWidth, float halfHeight) noexcept
+{
+	// Same as TriangleDistance in Control-ps.hlsl
+	const float qx = halfWidth;
+	const float qy = 2.0f * halfHeight;
+	const float px = std::abs(x);
+	const float py = halfHeight - y;
+
+	const float ta = Saturate((px * qx + py * qy) / std::max(qx * qx + qy * qy, 0.0001f));
+	const float ax = px - qx * ta;
+	const float ay = py - qy * ta;
+	const float bx = px - qx * Saturate(px / std::max(qx, 0.0001f));
+	const float by = py - qy;
+
+	const float distanceSquared = std::min(ax * ax + ay * ay, bx * bx + by * by);
+	const float side = std::min(-(px * qy - py * qx), -(py - qy));
+	return side > 0.0f ? -std::sqrt(distanceSquared) : (side < 0.0f ? std::sqrt(distanceSquared) : 0.0f);
+}
+
+// Converts a pixel coordinate to an int, clamping first so that huge (or NaN) values cannot overflow
+inline int ToPixel(float value, int low, int high) noexcept
+{
+	return static_cast<int>(std::clamp(value, static_cast<float>(low), static_cast<float>(high)));
+}
+
+constexpr std::array<std::uint32_t, 256> MakeCrcTable() noexcept
+{
+	std::array<std::uint32_t, 256> table = {};
+	for (std::uint32_t iii = 0; iii < 256; ++iii)
+	{
+		std::uint32_t crc = iii;
+		for (unsigned int jjj = 0; jjj < 8; ++jjj)
+			crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+		table[iii] = crc;
+	}
+	return table;
+}
+constexpr std::array<std::uint32_t, 256> CrcTable = MakeCrcTable();
+
+void AppendBigEndian(std::vector<std::uint8_t>& bytes, std::uint32_t value)
+{
+	bytes.push_back(static_cast<std::uint8_t>(value >> 24));
+	bytes.push_back(static_cast<std::uint8_t>(value >> 16));
+	bytes.push_back(static_cast<std::uint8_t>(value >> 8));
+	bytes.push_back(static_cast<std::uint8_t>(value));
+}
+// Length, type, data and the CRC of the type and data
+void AppendChunk(std::vector<std::uint8_t>& bytes, std::string_view type, std::span<const std::uint8_t> data)
+{
+	ASSERT(type.size() == 4, "PNG chunk types are 4 characters");
+
+	AppendBigEndian(bytes, static_cast<std::uint32_t>(data.size()));
+	const size_t crcStart = bytes.size();
+	bytes.insert(bytes.end(), type.begin(), type.end());
+	bytes.insert(bytes.end(), data.begin(), data.end());
+
+	std::uint32_t crc = 0xFFFFFFFFu;
+	for (size_t iii = crcStart; iii < bytes.size(); ++iii)
+		crc = CrcTable[(crc ^ bytes[iii]) & 0xFF] ^ (crc >> 8);
+	AppendBigEndian(bytes, ~crc);
+}
+
+void WriteFile(const std::filesystem::path& path, std::span<const std::uint8_t> bytes)
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file) [[unlikely]]
+		throw EXCEPTION(std::format("SoftwareRenderer2D: Could not open '{0}' for writing", path.string()));
+
+	file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+	if (!file) [[unlikely]]
+		throw EXCEPTION(std::format("SoftwareRenderer2D: Could not write to '{0}'", path.string()));
+}
+}
+
+SoftwareRenderer2D::SoftwareRenderer2D(unsigned int width, unsigned int height)
+{
+	Resize(width, height);
+}
+
+void SoftwareRenderer2D::Resize(unsigned int width, unsigned int height)
+{
+	m_width = width;
+	m_height = height;
+	m_pixels.assign(static_cast<size_t>(width) * height, 0);
+	m_depth.assign(static_cast<size_t>(width) * height, -1);
+
+	m_tiles.clear();
+	for (unsigned int top = 0; top < height; top += TileSize)
+	{
+		for (unsigned int left = 0; left < width; left += TileSize)
+		{
+			m_tiles.push_back({
+				static_cast<int>(left),
+				static_cast<int>(top),
+				static_cast<int>(std::min(left + TileSize, width)),
+				static_cast<int>(std::min(top + TileSize, height))
+			});
+		}
+	}
+}
+
+void SoftwareRenderer2D::Clear(const Color& color) noexcept
+{
+	std::fill(m_pixels.begin(), m_pixels.end(), PackColor(color));
+
+	// -1 is behind every z-order
+	std::fill(m_depth.begin(), m_depth.end(), -1);
+}
+
+void SoftwareRenderer2D::Draw(std::span<const UIObjectData> instances, SoftwarePipeline2D pipeline)
+{
+	if (instances.empty() || m_tiles.empty())
+		return;
+
+	m_setups.resize(instances.size());
+	for (size_t iii = 0; iii < instances.size(); ++iii)
+		m_setups[iii] = Prepare(instances[iii]);
+
+	// Tiles do not share any pixels, so they can be drawn in any order (and at the same time)
+	const auto drawTile = [this, instances, pipeline](const PixelRect& tile) { DrawTile(tile, instances, pipeline); };
+	if (m_parallel)
+		std::for_each(std::execution::par, m_tiles.begin(), m_tiles.end(), drawTile);
+	else
+		std::for_each(m_tiles.begin(), m_tiles.end(), drawTile);
+}
+
+SoftwareRenderer2D::Setup SoftwareRenderer2D::Prepare(const UIObjectData& instance) const noexcept
+{
+	Setup setup;
+	setup.HalfWidth = 0.5f * instance.Size.x;
+	setup.HalfHeight = 0.5f * instance.Size.y;
+	setup.Shape = static_cast<SdfShape2D>(instance.Shape & 0x7);
+	setup.BorderThickness = static_cast<float>((instance.Shape >> 3) & 0x1F) * 0.25f;
+	setup.CornerRadius = static_cast<float>((instance.Shape >> 8) & 0xFF) * 0.5f;
+	setup.Depth = static_cast<int>(instance.Shape >> 16);
+	setup.Cos = std::cos(instance.Rotation);
+	setup.Sin = std::sin(instance.Rotation);
+	setup.Clip = (instance.Clip < m_clipRects.size()) ? m_clipRects[instance.Clip] : Rect{ 0.0f, 0.0f, static_cast<float>(m_width), static_cast<float>(m_height) };
+
+	if (setup.Shape == SdfShape2D::Segment)
+	{
+		const auto joint = [&setup](unsigned int code, float side) -> Setup::Joint
+			{
+				if (code == SegmentNoJoint)
+					return {};
+
+				const float angle = SegmentJointAngle(code);
+				return { true, side * (setup.HalfWidth - SegmentJointExtension(angle, setup.HalfHeight)), std::cos(angle), -std::sin(angle) };
+			};
+		setup.StartJoint = joint(instance.BorderColor & 0xFFFF, -1.0f);
+		setup.EndJoint = joint(instance.BorderColor >> 16, 1.0f);
+	}
+
+	// Bounds of the quad the vertex shader draws (grown by a pixel on every side) in pixels, so y is flipped
+	float minX = std::numeric_limits<float>::max();
+	float minY = std::numeric_limits<float>::max();
+	float maxX = std::numeric_limits<float>::lowest();
+	float maxY = std::numeric_limits<float>::lowest();
+	for (const float x : { -1.0f, instance.Size.x + 1.0f })
+	{
+		for (const float y : { 1.0f, -(instance.Size.y + 1.0f) })
+		{
+			const float screenX = instance.Position.x + x * setup.Cos - y * setup.Sin;
+			const float screenY = -(instance.Position.y + x * setup.Sin + y * setup.Cos);
+			minX = std::min(minX, screenX);
+			maxX = std::max(maxX, screenX);
+			minY = std::min(minY, screenY);
+			maxY = std::max(maxY, screenY);
+		}
+	}
+
+	// A pixel is drawn if its center is inside both the quad and the clip rect
+	const int width = static_cast<int>(m_width);
+	const int height = static_cast<int>(m_height);
+	setup.Bounds.Left = std::max(ToPixel(std::floor(minX), 0, width), ToPixel(std::ceil(setup.Clip.Left - 0.5f), 0, width));
+	setup.Bounds.Top = std::max(ToPixel(std::floor(minY), 0, height), ToPixel(std::ceil(setup.Clip.Top - 0.5f), 0, height));
+	setup.Bounds.Right = std::min(ToPixel(std::ceil(maxX), 0, width), ToPixel(std::floor(setup.Clip.Right - 0.5f) + 1.0f, 0, width));
+	setup.Bounds.Bottom = std::min(ToPixel(std::ceil(maxY), 0, height), ToPixel(std::floor(setup.Clip.Bottom - 0.5f) + 1.0f, 0, height));
+
+	// Composites of cached layers only exist on the GPU. The content of the layer gets drawn instead (see
+	// UIRenderer::RenderSoftware), so the composite itself does not draw anything
+	if (setup.Shape == SdfShape2D::Layer)
+		setup.Bounds = {};
+
+	// Plain rectangles are fully covered (coverage 1, so it does not matter how they are blended) wherever the pixel
+	// center is at least half a pixel inside of the rectangle
+	if (instance.Rotation == 0.0f && setup.Shape == SdfShape2D::Box && setup.CornerRadius == 0.0f && setup.BorderThickness == 0.0f && !setup.Bounds.Empty())
+	{
+		const float top = -instance.Position.y;
+		setup.Interior.Left = std::max(setup.Bounds.Left, ToPixel(std::ceil(instance.Position.x), 0, width));
+		setup.Interior.Top = std::max(setup.Bounds.Top, ToPixel(std::ceil(top), 0, height));
+		setup.Interior.Right = std::min(setup.Bounds.Right, ToPixel(std::floor(instance.Position.x + instance.Size.x - 1.0f) + 1.0f, 0, width));
+		setup.Interior.Bottom = std::min(setup.Bounds.Bottom, ToPixel(std::floor(top + instance.Size.y - 1.0f) + 1.0f, 0, height));
+	}
+	return setup;
+}
+
+void SoftwareRenderer2D::DrawTile(const PixelRect& tile, std::span<const UIObjectData> instances, SoftwarePipeline2D pipeline) noexcept
+{
+	for (size_t iii = 0; iii < instances.size(); ++iii)
+	{
+		const Setup& setup = m_setups[iii];
+		const PixelRect rect = {
+			std::max(tile.Left, setup.Bounds.Left),
+			std::max(tile.Top, setup.Bounds.Top),
+			std::min(tile.Right, setup.Bounds.Right),
+			std::min(tile.Bottom, setup.Bounds.Bottom)
+		};
+		if (rect.Empty())
+			continue;
+
+		for (int y = rect.Top; y < rect.Bottom; ++y)
+		{
+			if (setup.Interior.Empty() || y < setup.Interior.Top || y >= setup.Interior.Bottom)
+			{
+				DrawPixels(y, rect.Left, rect.Right, instances[iii], setup, pipeline);
+				continue;
+			}
+
+			// Edge pixels on either side of the interior still need to be antialiased
+			const int spanLeft = std::clamp(setup.Interior.Left, rect.Left, rect.Right);
+			const int spanRight = std::clamp(setup.Interior.Right, spanLeft, rect.Right);
+			DrawPixels(y, rect.Left, spanLeft, instances[iii], setup, pipeline);
+			FillSpan(y, spanLeft, spanRight, instances[iii].Color, setup.Depth, pipeline);
+			DrawPixels(y, spanRight, rect.Right, instances[iii], setup, pipeline);
+		}
+	}
+}
+
+void SoftwareRenderer2D::DrawPixels(int y, int left, int right, const UIObjectData& instance, const Setup& setup, SoftwarePipeline2D pipeline) noexcept
+{
+	if (left >= right)
+		return;
+
+	const Color fillColor = UnpackColor(instance.Color);
+	const Color borderColor = UnpackColor(instance.BorderColor);
+	const size_t row = static_cast<size_t>(y) * m_width;
+	const float pixelY = static_cast<float>(y) + 0.5f;
+
+	for (int x = left; x < right; ++x)
+	{
+		// Pixel center relative to the quad's origin, rotated into the quad's space (y up) - see Control-vs.hlsl
+		const float relativeX = static_cast<float>(x) + 0.5f - instance.Position.x;
+		const float relativeY = -pixelY - instance.Position.y;
+		const float localX = relativeX * setup.Cos + relativeY * setup.Sin;
+		const float localY = relativeY * setup.Cos - relativeX * setup.Sin;
+		if (localX < -1.0f || localX > instance.Size.x + 1.0f || localY > 1.0f || localY < -(instance.Size.y + 1.0f))
+			continue;
+
+		// Relative to the center of the shape
+		const float centerX = localX - setup.HalfWidth;
+		const float centerY = localY + setup.HalfHeight;
+
+		if (setup.StartJoint.Active && (centerX - setup.StartJoint.Position) * setup.StartJoint.NormalX + centerY * setup.StartJoint.NormalY <= 0.0f)
+			continue;
+		if (setup.EndJoint.Active && (centerX - setup.EndJoint.Position) * setup.EndJoint.NormalX + centerY * setup.EndJoint.NormalY > 0.0f)
+			continue;
+
+		float d = 0.0f;
+		switch (setup.Shape)
+		{
+		case SdfShape2D::Glyph:		d = 0.5f - GlyphCoverage(centerX, centerY, setup, instance.BorderColor); break;
+		case SdfShape2D::Ellipse:	d = EllipseDistance(centerX, centerY, setup.HalfWidth, setup.HalfHeight); break;
+		case SdfShape2D::Triangle:	d = TriangleDistance(centerX, centerY, setup.HalfWidth, setup.HalfHeight); break;
+		default:					d = BoxDistance(centerX, centerY, setup.HalfWidth, setup.HalfHeight, setup.CornerRadius); break;
+		}
+
+		Color color = fillColor;
+		if (setup.BorderThickness > 0.0f)
+			color = Lerp(color, borderColor, Saturate(d + setup.BorderThickness + 0.5f));
+
+		const size_t index = row + static_cast<size_t>(x);
+		if (pipeline == SoftwarePipeline2D::Opaque)
+		{
+			// See ControlOpaque-ps: only pixels that the shape fully covers, the rest is left to OpaqueFringe
+			if (d > -0.5f || setup.Depth <= m_depth[index])
+				continue;
+
+			m_pixels[index] = PackColor(WithAlpha(color, 1.0f));
+			m_depth[index] = setup.Depth;
+			continue;
+		}
+
+		if (pipeline == SoftwarePipeline2D::OpaqueFringe && d <= -0.5f)
+			continue;
+
+		const float alpha = color.A * Saturate(0.5f - d);
+		if (alpha < 1.0f / 255.0f)
+			continue;
+		if (pipeline != SoftwarePipeline2D::Overlay && setup.Depth < m_depth[index])
+			continue;
+
+		m_pixels[index] = BlendSource(WithAlpha(color, alpha)).Over(m_pixels[index]);
+	}
+}
+
+void SoftwareRenderer2D::FillSpan(int y, int left, int right, std::uint32_t color, int depth, SoftwarePipeline2D pipeline) noexcept
+{
+	if (left >= right)
+		return;
+
+	std::uint32_t* pixels = m_pixels.data() + static_cast<size_t>(y) * m_width;
+	int* depths = m_depth.data() + static_cast<size_t>(y) * m_width;
+	const std::uint32_t alpha = color >> 24;
+
+	switch (pipeline)
+	{
+	case SoftwarePipeline2D::Opaque:
+	{
+		const std::uint32_t opaque = color | 0xFF000000u;
+		for (int x = left; x < right; ++x)
+		{
+			if (depth > depths[x])
+			{
+				pixels[x] = opaque;
+				depths[x] = depth;
+			}
+		}
+		return;
+	}
+	case SoftwarePipeline2D::OpaqueFringe:
+		// Interiors are fully covered, so Opaque already drew them
+		return;
+	case SoftwarePipeline2D::Transparent:
+	{
+		if (alpha == 0)
+			return;
+
+		const BlendSource source(UnpackColor(color));
+		for (int x = left; x < right; ++x)
+		{
+			if (depth >= depths[x])
+				pixels[x] = (alpha == 0xFF) ? color : source.Over(pixels[x]);
+		}
+		return;
+	}
+	case SoftwarePipeline2D::Overlay:
+	{
+		if (alpha == 0)
+			return;
+
+		// Fully opaque colors simply replace what is there
+		if (alpha == 0xFF)
+		{
+			std::fill(pixels + left, pixels + right, color);
+			return;
+		}
+
+		const BlendSource source(UnpackColor(color));
+		for (int x = left; x < right; ++x)
+			pixels[x] = source.Over(pixels[x]);
+		return;
+	}
+	}
+}
+
+float SoftwareRenderer2D::GlyphCoverage(float x, float y, const Setup& setup, std::uint32_t origin) const noexcept
+{
+	if (m_glyphAtlas == nullptr)
+		return 0.0f;
+
+	// Same as GlyphCoverage in Control-ps.hlsl
+	const int texelX = static_cast<int>(std::floor(x + setup.HalfWidth));
+	const int texelY = static_cast<int>(std::floor(setup.HalfHeight - y));
+	const int width = static_cast<int>(2.0f * setup.HalfWidth + 0.5f);
+	const int height = static_cast<int>(2.0f * setup.HalfHeight + 0.5f);
+	if (texelX < 0 || texelY < 0 || texelX >= width || texelY >= height)
+		return 0.0f;
+
+	const size_t atlasX = static_cast<size_t>(origin & 0xFFFF) + static_cast<size_t>(texelX);
+	const size_t atlasY = static_cast<size_t>(origin >> 16) + static_cast<size_t>(texelY);
+	if (atlasX >= GlyphAtlas::Width || atlasY >= GlyphAtlas::Height) [[unlikely]]
+		return 0.0f;
+
+	return static_cast<float>(m_glyphAtlas->GetPixels()[atlasY * GlyphAtlas::Width + atlasX]) / 255.0f;
+}
+
+void SoftwareRenderer2D::WritePPM(const std::filesystem::path& path) const
+{
+	const std::string header = std::format("P6\n{0} {1}\n255\n", m_width, m_height);
+
+	std::vector<std::uint8_t> bytes(header.begin(), header.end());
+	bytes.reserve(header.size() + m_pixels.size() * 3);
+	for (const std::uint32_t pixel : m_pixels)
+	{
+		bytes.push_back(static_cast<std::uint8_t>(pixel));
+		bytes.push_back(static_cast<std::uint8_t>(pixel >> 8));
+		bytes.push_back(static_cast<std::uint8_t>(pixel >> 16));
+	}
+	WriteFile(path, bytes);
+}
+
+void SoftwareRenderer2D::WritePNG(const std::filesystem::path& path) const
+{
+	// Every row starts with its filter type (0 = none), followed by the RGBA bytes of the row
+	std::vector<std::uint8_t> scanlines;
+	scanlines.reserve(static_cast<size_t>(m_height) * (1 + static_cast<size_t>(m_width) * 4));
+	for (unsigned int y = 0; y < m_height; ++y)
+	{
+		scanlines.push_back(0);
+		const std::uint8_t* row = reinterpret_cast<const std::uint8_t*>(m_pixels.data() + static_cast<size_t>(y) * m_width);
+		scanlines.insert(scanlines.end(), row, row + static_cast<size_t>(m_width) * 4);
+	}
+
+	// zlib stream made of uncompressed (stored) deflate blocks, which hold at most 65535 bytes each
+	std::vector<std::uint8_t> zlib = { 0x78, 0x01 };
+	size_t offset = 0;
+	do
+	{
+		const size_t length = std::min<size_t>(scanlines.size() - offset, 0xFFFF);
+		const bool last = offset + length == scanlines.size();
+		zlib.push_back(last ? 1 : 0);
+		zlib.push_back(static_cast<std::uint8_t>(length));
+		zlib.push_back(static_cast<std::uint8_t>(length >> 8));
+		zlib.push_back(static_cast<std::uint8_t>(~length));
+		zlib.push_back(static_cast<std::uint8_t>(~length >> 8));
+		zlib.insert(zlib.end(), scanlines.begin() + offset, scanlines.begin() + offset + length);
+		offset += length;
+	} while (offset < scanlines.size());
+
+	std::uint32_t a = 1;
+	std::uint32_t b = 0;
+	for (const std::uint8_t byte : scanlines)
+	{
+		a = (a + byte) % 65521;
+		b = (b + a) % 65521;
+	}
+	AppendBigEndian(zlib, (b << 16) | a);
+
+	// 8 bits per channel, color type 6 (RGBA), default compression/filter, no interlacing
+	std::vector<std::uint8_t> header;
+	AppendBigEndian(header, m_width);
+	AppendBigEndian(header, m_height);
+	header.insert(header.end(), { 8, 6, 0, 0, 0 });
+
+	std::vector<std::uint8_t> bytes = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	AppendChunk(bytes, "IHDR", header);
+	AppendChunk(bytes, "IDAT", zlib);
+	AppendChunk(bytes, "IEND", {});
+	WriteFile(path, bytes);
+}
+}
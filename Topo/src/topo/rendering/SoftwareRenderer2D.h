@@ -0,0 +1,140 @@
+#pragma once
+#include "topo/Core.h"
+#include "topo/Log.h"
+#include "UIObjectData.h"
+#include "topo/utils/Color.h"
+#include "topo/utils/GlyphAtlas.h"
+#include "topo/utils/Rect.h"
+
+
+namespace topo
+{
+// The pipeline states of the UI render pass (see UIRenderer::InitializeRenderer)
+enum class SoftwarePipeline2D
+{
+	Opaque,		// Depth tested (LESS) and written, not blended. Only the pixels that the shape fully covers are drawn
+	OpaqueFringe,// Like Transparent, but only draws the pixels that Opaque left out (the antialiased edges)
+	Transparent,// Depth tested (LESS_EQUAL), but not written. Blended
+	Overlay		// No depth. Blended (the polyline and overlay layers)
+};
+
+// SoftwareRenderer2D draws UI instance data (see UIObjectData) into an in-memory RGBA8 framebuffer without a GPU. It
+// evaluates the same signed distance shapes, borders, glyph coverage, clip rects and depth/blend states as
+// Control-vs.hlsl/Control-ps.hlsl, so given the same instances (see UIRenderer::RenderSoftware) it produces the same
+// frame - which makes it usable for golden image comparisons and for rendering UI snapshots on machines without a
+// GPU or a window.
+//
+// The framebuffer is split into TileSize x TileSize tiles that are drawn on all cores. Every tile walks the
+// instances in order, so the result does not depend on the number of threads. Plain rectangles (the vast majority
+// of UI instances) fill the rows of their interior as spans, and everything else is shaded pixel by pixel. Colors
+// are blended with plain scalar math, so this builds without DirectXMath (see the TopoHeadless project).
+//
+// NOTE: Edge pixels may differ from the GPU by a unit or two, since the GPU interpolates the shape's local position
+// and this evaluates it exactly at each pixel center
+class SoftwareRenderer2D
+{
+public:
+	SoftwareRenderer2D(unsigned int width, unsigned int height);
+	SoftwareRenderer2D(const SoftwareRenderer2D&) = default;
+	SoftwareRenderer2D(SoftwareRenderer2D&&) noexcept = default;
+	SoftwareRenderer2D& operator=(const SoftwareRenderer2D&) = default;
+	SoftwareRenderer2D& operator=(SoftwareRenderer2D&&) noexcept = default;
+
+	// Resizing discards the contents of the framebuffer
+	void Resize(unsigned int width, unsigned int height);
+
+	// Clears the framebuffer to the color and resets the depth buffer
+	void Clear(const Color& color) noexcept;
+
+	// Table of clip rects (in pixels) that UIObjectData::Clip indexes. Instances with a clip that is not in the table
+	// are only clipped by the framebuffer
+	inline void SetClipRects(std::span<const Rect> clipRects) { m_clipRects.assign(clipRects.begin(), clipRects.end()); }
+
+	// Glyph instances take their coverage from this atlas. Without an atlas, glyphs are not drawn
+	constexpr void SetGlyphAtlas(const GlyphAtlas* atlas) noexcept { m_glyphAtlas = atlas; }
+
+	// NOTE: The pixels of UI images only exist on the GPU (see ImageAtlas), so image instances are drawn as boxes in
+	// their tint color. That keeps their footprint in snapshots, but not their content
+
+	// Draws the instances in order
+	void Draw(std::span<const UIObjectData> instances, SoftwarePipeline2D pipeline);
+
+	// When disabled, all tiles are drawn on the calling thread
+	constexpr void SetParallel(bool parallel) noexcept { m_parallel = parallel; }
+
+	ND constexpr unsigned int GetWidth() const noexcept { return m_width; }
+	ND constexpr unsigned int GetHeight() const noexcept { return m_height; }
+
+	// Row-major (top row first) RGBA8 pixels - R is the lowest byte, just like UIObjectData::Color
+	ND constexpr std::span<const std::uint32_t> GetPixels() const noexcept { return m_pixels; }
+	ND inline std::uint32_t GetPixel(unsigned int x, unsigned int y) const noexcept
+	{
+		ASSERT(x < m_width && y < m_height, "Pixel is outside of the framebuffer");
+		return m_pixels[static_cast<size_t>(y) * m_width + x];
+	}
+
+	// Binary PPM (P6 - the alpha channel is dropped) and PNG (RGBA, uncompressed). Both throw if the file cannot be written
+	void WritePPM(const std::filesystem::path& path) const;
+	void WritePNG(const std::filesystem::path& path) const;
+
+	static constexpr unsigned int TileSize = 64;
+
+private:
+	// Pixels [Left, Right) x [Top, Bottom)
+	struct PixelRect
+	{
+		int Left = 0;
+		int Top = 0;
+		int Right = 0;
+		int Bottom = 0;
+		ND constexpr bool Empty() const noexcept { return Right <= Left || Bottom <= Top; }
+	};
+
+	// Everything about an instance that does not change from one pixel to the next
+	struct Setup
+	{
+		PixelRect Bounds = {};	// Pixels that might be covered, already clipped (empty if the instance is not drawn)
+		Rect Clip = {};
+		float Cos = 1.0f;
+		float Sin = 0.0f;
+		float HalfWidth = 0.0f;
+		float HalfHeight = 0.0f;
+		float CornerRadius = 0.0f;
+		float BorderThickness = 0.0f;
+		SdfShape2D Shape = SdfShape2D::Box;
+		int Depth = 0;			// The z-order - higher is closer
+		PixelRect Interior = {};// Pixels that are fully covered by a plain rectangle (empty for anything else)
+
+		// Polyline segments only keep the pixels between their joints, which cut along the line through (Position, 0)
+		// with the normal (NormalX, NormalY) - see SegmentKeepsPixel in Control-ps.hlsl
+		struct Joint
+		{
+			bool Active = false;
+			float Position = 0.0f;
+			float NormalX = 1.0f;
+			float NormalY = 0.0f;
+		};
+		Joint StartJoint = {};
+		Joint EndJoint = {};
+	};
+
+	ND Setup Prepare(const UIObjectData& instance) const noexcept;
+	void DrawTile(const PixelRect& tile, std::span<const UIObjectData> instances, SoftwarePipeline2D pipeline) noexcept;
+	void DrawPixels(int y, int left, int right, const UIObjectData& instance, const Setup& setup, SoftwarePipeline2D pipeline) noexcept;
+	void FillSpan(int y, int left, int right, std::uint32_t color, int depth, SoftwarePipeline2D pipeline) noexcept;
+	ND float GlyphCoverage(float x, float y, const Setup& setup, std::uint32_t origin) const noexcept;
+
+	unsigned int m_width = 0;
+	unsigned int m_height = 0;
+	std::vector<std::uint32_t> m_pixels;
+	std::vector<int> m_depth;
+	std::vector<PixelRect> m_tiles;
+
+	std::vector<Rect> m_clipRects;
+	const GlyphAtlas* m_glyphAtlas = nullptr;
+	bool m_parallel = true;
+
+	// Scratch space for Draw()
+	std::vector<Setup> m_setups;
+};
+}
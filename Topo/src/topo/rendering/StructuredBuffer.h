@@ -0,0 +1,210 @@
+#pragma once
+#include "topo/DeviceResources.h"
+#include "topo/Log.h"
+#include "topo/utils/Timer.h"
+
+
+namespace topo
+{
+#ifdef DIRECTX12
+
+// StructuredBufferBase is a persistently mapped upload buffer that is bound as a root shader resource view
+// (StructuredBuffer<T> in HLSL). Unlike a constant buffer, it is not limited to 64KB and it can grow.
+//
+// Each frame resource gets its own, separately allocated buffer. This way, growing the buffer for one frame
+// resource never touches a buffer the GPU may still be reading for a different frame. The buffer that gets
+// replaced is handed to DeviceResources::DelayedDelete(), so growing never has to wait on the GPU
+class StructuredBufferBase
+{
+public:
+	inline StructuredBufferBase(std::shared_ptr<DeviceResources> deviceResources) :
+		m_deviceResources(deviceResources)
+	{
+		ASSERT(m_deviceResources != nullptr, "No device resources");
+	}
+	inline virtual ~StructuredBufferBase() noexcept
+	{
+		for (unsigned int iii = 0; iii < g_numFrameResources; ++iii)
+			Release(iii);
+	}
+
+	ND inline D3D12_GPU_VIRTUAL_ADDRESS GetGPUVirtualAddress(unsigned int frameIndex) const noexcept
+	{
+		return m_buffers[frameIndex]->GetGPUVirtualAddress();
+	}
+	ND constexpr size_t GetCapacityBytes(unsigned int frameIndex) const noexcept { return m_capacityBytes[frameIndex]; }
+
+	std::function<void(const Timer&, int)> Update = [](const Timer&, int) {};
+
+protected:
+	StructuredBufferBase(const StructuredBufferBase&) = delete;
+	StructuredBufferBase(StructuredBufferBase&&) = delete;
+	StructuredBufferBase& operator=(const StructuredBufferBase&) = delete;
+	StructuredBufferBase& operator=(StructuredBufferBase&&) = delete;
+
+	// Makes sure the frame resource's buffer can hold at least 'bytes' bytes. Returns true if a new buffer had
+	// to be allocated, in which case the frame resource's previous contents are gone and must be rewritten
+	inline bool ReserveBytes(unsigned int frameIndex, size_t bytes)
+	{
+		if (bytes <= m_capacityBytes[frameIndex] && m_buffers[frameIndex] != nullptr)
+			return false;
+
+		// Grow geometrically so that a steadily growing UI only reallocates a handful of times
+		size_t capacity = std::max(m_capacityBytes[frameIndex] * 2, static_cast<size_t>(MinimumCapacityBytes));
+		capacity = std::max(capacity, bytes);
+
+		Release(frameIndex);
+
+		auto props = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+		auto desc = CD3DX12_RESOURCE_DESC::Buffer(static_cast<UINT64>(capacity));
+
+		GFX_THROW_INFO(
+			m_deviceResources->GetDevice()->CreateCommittedResource(
+				&props,
+				D3D12_HEAP_FLAG_NONE,
+				&desc,
+				D3D12_RESOURCE_STATE_GENERIC_READ,
+				nullptr,
+				IID_PPV_ARGS(&m_buffers[frameIndex])
+			)
+		);
+
+		// Just like ConstantBufferMapped, the buffer stays mapped until it is released
+		GFX_THROW_INFO(
+			m_buffers[frameIndex]->Map(0, nullptr, reinterpret_cast<void**>(&m_mappedData[frameIndex]))
+		);
+
+		m_capacityBytes[frameIndex] = capacity;
+
+#ifndef TOPO_DIST
+		if (!m_name.empty())
+			SetDebugName(m_name);
+#endif
+		return true;
+	}
+
+	std::shared_ptr<DeviceResources> m_deviceResources;
+	std::array<Microsoft::WRL::ComPtr<ID3D12Resource>, g_numFrameResources> m_buffers = {};
+	std::array<BYTE*, g_numFrameResources> m_mappedData = {};
+	std::array<size_t, g_numFrameResources> m_capacityBytes = {};
+
+	static constexpr size_t MinimumCapacityBytes = 64 * 1024;
+
+private:
+	inline void Release(unsigned int frameIndex) noexcept
+	{
+		if (m_buffers[frameIndex] == nullptr)
+			return;
+
+		// Buffers in the default heap (see StructuredBufferDefault) are never mapped
+		if (m_mappedData[frameIndex] != nullptr)
+			m_buffers[frameIndex]->Unmap(0, nullptr);
+		m_mappedData[frameIndex] = nullptr;
+
+		// The buffer might still be in use by the GPU, so do a delayed delete
+		m_deviceResources->DelayedDelete(m_buffers[frameIndex]);
+		m_buffers[frameIndex] = nullptr;
+	}
+
+// In DIST builds, we don't name the object
+#ifndef TOPO_DIST
+public:
+	void SetDebugName(std::string_view name) noexcept
+	{
+		m_name = name;
+		for (unsigned int iii = 0; iii < g_numFrameResources; ++iii)
+		{
+			if (m_buffers[iii] != nullptr)
+			{
+				std::string frameName = std::format("{0} (frame {1})", name, iii);
+				m_buffers[iii]->SetPrivateData(WKPDID_D3DDebugObjectName, static_cast<UINT>(frameName.size()), frameName.data());
+			}
+		}
+	}
+	ND const std::string& GetDebugName() const noexcept { return m_name; }
+protected:
+	std::string m_name = "";
+#endif
+};
+
+template<typename T>
+class StructuredBufferMapped : public StructuredBufferBase
+{
+public:
+	inline StructuredBufferMapped(std::shared_ptr<DeviceResources> deviceResources, size_t initialElementCount = 1024) :
+		StructuredBufferBase(deviceResources)
+	{
+		// Allocate every frame resource up front so that GetGPUVirtualAddress() is always valid
+		for (unsigned int iii = 0; iii < g_numFrameResources; ++iii)
+			ReserveBytes(iii, initialElementCount * sizeof(T));
+	}
+
+	// See StructuredBufferBase::ReserveBytes()
+	inline bool Reserve(unsigned int frameIndex, size_t elementCount) { return ReserveBytes(frameIndex, elementCount * sizeof(T)); }
+	ND constexpr size_t GetCapacity(unsigned int frameIndex) const noexcept { return m_capacityBytes[frameIndex] / sizeof(T); }
+
+	// Overwrites the elements [firstElement, firstElement + elements.size()) of the frame resource's buffer. Call
+	// Reserve() first if the buffer may not be large enough
+	inline void CopyData(unsigned int frameIndex, size_t firstElement, std::span<const T> elements) noexcept
+	{
+		ASSERT((firstElement + elements.size()) * sizeof(T) <= m_capacityBytes[frameIndex], "More data than the buffer can hold - call Reserve() first");
+		memcpy(m_mappedData[frameIndex] + firstElement * sizeof(T), elements.data(), elements.size_bytes());
+	}
+};
+
+// StructuredBufferDefault is a single buffer in the default heap that is shared by every frame resource. The CPU
+// never touches it - only the GPU writes to it (i.e. with CopyTextureRegion), so it is meant for data that is
+// produced on the GPU and then read for many frames (see UIRenderer's layer cache). Writes are recorded on the same
+// queue as the draws that read the buffer, so they are ordered after the reads of every earlier frame.
+//
+// The buffer is created in the COMMON state. Buffers are implicitly promoted from COMMON to whatever state they
+// are first used in and decay back to COMMON at the end of every ExecuteCommandLists(), so only a buffer that is
+// written and then read within the same command list needs an explicit transition
+class StructuredBufferDefault : public StructuredBufferBase
+{
+public:
+	inline StructuredBufferDefault(std::shared_ptr<DeviceResources> deviceResources, size_t capacityBytes) :
+		StructuredBufferBase(deviceResources)
+	{
+		Resize(capacityBytes);
+	}
+
+	// Replaces the buffer with a new one, so the previous contents are gone
+	inline void Resize(size_t capacityBytes)
+	{
+		auto props = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT);
+		auto desc = CD3DX12_RESOURCE_DESC::Buffer(static_cast<UINT64>(capacityBytes));
+
+		Microsoft::WRL::ComPtr<ID3D12Resource> buffer = nullptr;
+		GFX_THROW_INFO(
+			m_deviceResources->GetDevice()->CreateCommittedResource(
+				&props,
+				D3D12_HEAP_FLAG_NONE,
+				&desc,
+				D3D12_RESOURCE_STATE_COMMON,
+				nullptr,
+				IID_PPV_ARGS(&buffer)
+			)
+		);
+
+		// The previous buffer might still be in use by the GPU, so do a delayed delete
+		if (m_buffers[0] != nullptr)
+			m_deviceResources->DelayedDelete(m_buffers[0]);
+
+		for (unsigned int iii = 0; iii < g_numFrameResources; ++iii)
+		{
+			m_buffers[iii] = buffer;
+			m_capacityBytes[iii] = capacityBytes;
+		}
+
+#ifndef TOPO_DIST
+		if (!m_name.empty())
+			SetDebugName(m_name);
+#endif
+	}
+
+	ND inline ID3D12Resource* GetResource() const noexcept { return m_buffers[0].Get(); }
+};
+
+#endif
+}
@@ -0,0 +1,316 @@
+#include "pch.h"
+#include "UIInstanceBuilder.h"
+#include "topo/Log.h"
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace topo
+{
+// Color is laid out exactly like an XMFLOAT4, so it can be saturated/scaled/rounded/packed in one go
+static_assert(sizeof(Color) == sizeof(XMFLOAT4));
+
+unsigned int PackColorRGBA8(const Color& color) noexcept
+{
+	XMUBYTEN4 packed;
+	XMStoreUByteN4(&packed, XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&color)));
+	return packed.v;
+}
+unsigned int PackShapeParameters(SdfShape2D shape, float cornerRadius, float borderThickness) noexcept
+{
+	if (borderThickness > MaxBorderThickness) [[unlikely]]
+		LOG_WARN("PackShapeParameters: Border thickness {0} is larger than the maximum of {1} and gets clamped", borderThickness, MaxBorderThickness);
+
+	const unsigned int border = static_cast<unsigned int>(std::clamp(borderThickness, 0.0f, MaxBorderThickness) * 4.0f + 0.5f);
+	const unsigned int radius = static_cast<unsigned int>(std::clamp(cornerRadius, 0.0f, MaxCornerRadius) * 2.0f + 0.5f);
+	return static_cast<unsigned int>(shape) | (border << 3) | (radius << 8);
+}
+
+namespace
+{
+// The builders write the first 32 bytes of each instance as two 16 byte stores, and Clip on its own
+static_assert(offsetof(UIObjectData, Position) == 0 && offsetof(UIObjectData, Size) == 8 && offsetof(UIObjectData, Rotation) == 16 &&
+	offsetof(UIObjectData, Color) == 20 && offsetof(UIObjectData, BorderColor) == 24 && offsetof(UIObjectData, Shape) == 28 && offsetof(UIObjectData, Clip) == 32);
+
+inline XMVECTOR Load4(std::span<const float> values, size_t index) noexcept
+{
+	return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&values[index]));
+}
+
+// Packs four colors into the four lanes of one vector (each lane RGBA8, exactly like PackColorRGBA8). The colors
+// are saturated, scaled and rounded like XMStoreUByteN4 does, and then narrowed to bytes with two saturating packs
+// instead of extracting every channel on its own
+inline XMVECTOR PackColors4(const Color* colors) noexcept
+{
+#if defined(_XM_SSE_INTRINSICS_)
+	const XMVECTOR scale = XMVectorReplicate(255.0f);
+	const __m128i c0 = _mm_cvtps_epi32(XMVectorMultiply(XMVectorSaturate(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&colors[0]))), scale));
+	const __m128i c1 = _mm_cvtps_epi32(XMVectorMultiply(XMVectorSaturate(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&colors[1]))), scale));
+	const __m128i c2 = _mm_cvtps_epi32(XMVectorMultiply(XMVectorSaturate(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&colors[2]))), scale));
+	const __m128i c3 = _mm_cvtps_epi32(XMVectorMultiply(XMVectorSaturate(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&colors[3]))), scale));
+	return _mm_castsi128_ps(_mm_packus_epi16(_mm_packs_epi32(c0, c1), _mm_packs_epi32(c2, c3)));
+#else
+	return XMVectorSetInt(PackColorRGBA8(colors[0]), PackColorRGBA8(colors[1]), PackColorRGBA8(colors[2]), PackColorRGBA8(colors[3]));
+#endif
+}
+
+// Turns four objects' worth of lanes into four instances: front = (Position.x, Position.y, Size.x, Size.y) and
+// back = (Rotation, Color, BorderColor, Shape), one lane per object. Both get transposed so that each row is the
+// first/second half of one instance and stored straight into it. Clip is the only member written on its own
+inline void StoreInstances4(FXMVECTOR x, FXMVECTOR y, FXMVECTOR width, GXMVECTOR height, HXMVECTOR rotation, HXMVECTOR colors, UIObjectData* instances) noexcept
+{
+	const XMVECTOR zero = XMVectorZero();
+	const XMMATRIX front = XMMatrixTranspose(XMMATRIX(x, y, width, height));
+	const XMMATRIX back = XMMatrixTranspose(XMMATRIX(rotation, colors, zero, zero));
+	for (size_t iii = 0; iii < 4; ++iii)
+	{
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&instances[iii].Position), front.r[iii]);
+		XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&instances[iii].Rotation), back.r[iii]);
+		instances[iii].Clip = 0;
+	}
+}
+}
+
+// Both builders work four objects at a time, from the loads of the batch's spans to the stores into the instances.
+// What stays scalar is the remainder (the last count % 4 objects), Clip (see StoreInstances4) and the single object
+// Write*Instance functions, which have nothing to batch
+void BuildRectangleInstances(const RectangleBatch2D& batch, std::span<UIObjectData> instances) noexcept
+{
+	const size_t count = instances.size();
+	ASSERT(batch.Left.size() == count && batch.Top.size() == count && batch.Right.size() == count &&
+		batch.Bottom.size() == count && batch.Colors.size() == count, "All spans must have the same length");
+
+	const XMVECTOR zero = XMVectorZero();
+
+	size_t iii = 0;
+	for (; iii + 4 <= count; iii += 4)
+	{
+		const XMVECTOR left = Load4(batch.Left, iii);
+		const XMVECTOR top = Load4(batch.Top, iii);
+		StoreInstances4(
+			left,
+			XMVectorNegate(top),
+			XMVectorSubtract(Load4(batch.Right, iii), left),
+			XMVectorSubtract(Load4(batch.Bottom, iii), top),
+			zero,
+			PackColors4(&batch.Colors[iii]),
+			&instances[iii]
+		);
+	}
+
+	// Remainder
+	for (; iii < count; ++iii)
+	{
+		UIObjectData& data = instances[iii];
+		data.Position = { batch.Left[iii], -batch.Top[iii] };
+		data.Size = { batch.Right[iii] - batch.Left[iii], batch.Bottom[iii] - batch.Top[iii] };
+		data.Rotation = 0.0f;
+		data.Color = PackColorRGBA8(batch.Colors[iii]);
+		data.BorderColor = 0;
+		data.Shape = 0;
+		data.Clip = 0;
+	}
+}
+
+void BuildLineInstances(const LineBatch2D& batch, std::span<UIObjectData> instances) noexcept
+{
+	const size_t count = instances.size();
+	ASSERT(batch.X1.size() == count && batch.Y1.size() == count && batch.X2.size() == count &&
+		batch.Y2.size() == count && batch.Thickness.size() == count && batch.Colors.size() == count, "All spans must have the same length");
+
+	// A line is a (length x thickness) rectangle rotated by -atan2(dy, dx) around its start point. The start
+	// point gets shifted by half the rotated thickness so the line is centered on it. Because
+	// sin(rotation) = -dy / length and cos(rotation) = dx / length, that shift does not need any trig
+	const XMVECTOR half = XMVectorReplicate(0.5f);
+	const XMVECTOR zero = XMVectorZero();
+
+	size_t iii = 0;
+	for (; iii + 4 <= count; iii += 4)
+	{
+		const XMVECTOR x1 = Load4(batch.X1, iii);
+		const XMVECTOR y1 = Load4(batch.Y1, iii);
+		const XMVECTOR thickness = Load4(batch.Thickness, iii);
+		const XMVECTOR dx = XMVectorSubtract(Load4(batch.X2, iii), x1);
+		const XMVECTOR dy = XMVectorSubtract(Load4(batch.Y2, iii), y1);
+
+		const XMVECTOR len = XMVectorSqrt(XMVectorMultiplyAdd(dx, dx, XMVectorMultiply(dy, dy)));
+		const XMVECTOR invLen = XMVectorSelect(zero, XMVectorReciprocal(len), XMVectorGreater(len, zero));
+		const XMVECTOR halfThicknessOverLen = XMVectorMultiply(XMVectorMultiply(thickness, half), invLen);
+
+		StoreInstances4(
+			XMVectorMultiplyAdd(dy, halfThicknessOverLen, x1),
+			XMVectorMultiplyAdd(dx, halfThicknessOverLen, XMVectorNegate(y1)),
+			len,
+			thickness,
+			XMVectorNegate(XMVectorATan2(dy, dx)),
+			PackColors4(&batch.Colors[iii]),
+			&instances[iii]
+		);
+	}
+
+	// Remainder
+	for (; iii < count; ++iii)
+	{
+		const float dx = batch.X2[iii] - batch.X1[iii];
+		const float dy = batch.Y2[iii] - batch.Y1[iii];
+		const float len = std::sqrt(dx * dx + dy * dy);
+		const float halfThicknessOverLen = len > 0.0f ? 0.5f * batch.Thickness[iii] / len : 0.0f;
+
+		UIObjectData& data = instances[iii];
+		data.Position = { batch.X1[iii] + dy * halfThicknessOverLen, -batch.Y1[iii] + dx * halfThicknessOverLen };
+		data.Size = { len, batch.Thickness[iii] };
+		data.Rotation = -std::atan2(dy, dx);
+		data.Color = PackColorRGBA8(batch.Colors[iii]);
+		data.BorderColor = 0;
+		data.Shape = 0;
+		data.Clip = 0;
+	}
+}
+
+void WriteRectangleInstance(float left, float top, float right, float bottom, const Color& color, UIObjectData& data) noexcept
+{
+	data.Position = { left, -top };
+	data.Size = { right - left, bottom - top };
+	data.Rotation = 0.0f;
+	data.Color = PackColorRGBA8(color);
+}
+void WriteLineInstance(float x1, float y1, float x2, float y2, float thickness, const Color& color, UIObjectData& data) noexcept
+{
+	// See BuildLineInstances
+	const float dx = x2 - x1;
+	const float dy = y2 - y1;
+	const float len = std::sqrt(dx * dx + dy * dy);
+	const float halfThicknessOverLen = len > 0.0f ? 0.5f * thickness / len : 0.0f;
+
+	data.Position = { x1 + dy * halfThicknessOverLen, -y1 + dx * halfThicknessOverLen };
+	data.Size = { len, thickness };
+	data.Rotation = -std::atan2(dy, dx);
+	data.Color = PackColorRGBA8(color);
+}
+void WriteSegmentInstance(const XMFLOAT2* previous, XMFLOAT2 start, XMFLOAT2 end, const XMFLOAT2* next, float thickness, const Color& color, UIObjectData& data) noexcept
+{
+	const float dx = end.x - start.x;
+	const float dy = end.y - start.y;
+	const float len = std::sqrt(dx * dx + dy * dy);
+	const float halfThickness = 0.5f * thickness;
+
+	// The angle between the miter line and the segment's normal is half the turn, atan2(cross, 1 + dot). The
+	// neighbor computes the same joint with the directions swapped, which exactly negates the angle, so both end
+	// up cutting along the same line. Joints next to zero length segments and full reversals (which have no
+	// miter) are left as plain line ends
+	const auto joint = [&](const XMFLOAT2& from, const XMFLOAT2& to, unsigned int& code, float& extension)
+		{
+			const float ox = to.x - from.x;
+			const float oy = to.y - from.y;
+			const float otherLen = std::sqrt(ox * ox + oy * oy);
+			if (len <= 0.0f || otherLen <= 0.0f)
+				return;
+
+			const float cross = (dx * oy - dy * ox) / (len * otherLen);
+			const float dot = (dx * ox + dy * oy) / (len * otherLen);
+			if (1.0f + dot < 1e-4f)
+				return;
+
+			const float angle = std::atan2(cross, 1.0f + dot);
+			code = static_cast<unsigned int>(std::lround(angle * (32767.0f / 1.5707963f)) + 32767);
+			extension = SegmentJointExtension(SegmentJointAngle(code), halfThickness);
+		};
+
+	unsigned int startJoint = SegmentNoJoint;
+	unsigned int endJoint = SegmentNoJoint;
+	float startExtension = 0.0f;
+	float endExtension = 0.0f;
+	if (previous != nullptr)
+		joint(*previous, start, startJoint, startExtension);
+	if (next != nullptr)
+		joint(end, *next, endJoint, endExtension);
+
+	// The quad reaches past the joints by the extension (the shader gets the joint points back from the angles)
+	const float ux = len > 0.0f ? dx / len : 0.0f;
+	const float uy = len > 0.0f ? dy / len : 0.0f;
+	WriteLineInstance(start.x - ux * startExtension, start.y - uy * startExtension, end.x + ux * endExtension, end.y + uy * endExtension, thickness, color, data);
+	data.BorderColor = startJoint | (endJoint << 16);
+	data.Shape = (data.Shape & 0xFFFF0000u) | PackShapeParameters(SdfShape2D::Segment, 0.0f, 0.0f);
+}
+
+Rect InstanceBounds(const UIObjectData& instance) noexcept
+{
+	// Unrotated instances span [x, x + width] and [-y, -y + height]. For rotated ones, every point is within
+	// length(Size) of the origin
+	const float left = instance.Position.x;
+	const float top = -instance.Position.y;
+	if (instance.Rotation == 0.0f)
+		return { left - 1.0f, top - 1.0f, left + instance.Size.x + 1.0f, top + instance.Size.y + 1.0f };
+
+	const float radius = std::sqrt(instance.Size.x * instance.Size.x + instance.Size.y * instance.Size.y) + 1.0f;
+	return { left - radius, top - radius, left + radius, top + radius };
+}
+void CullInstances(std::span<const UIObjectData> instances, std::span<const unsigned int> clipIndices, std::span<const Rect> clipRects, std::vector<unsigned int>& visible)
+{
+	const size_t count = instances.size();
+	ASSERT(clipIndices.size() == count, "Every instance needs a clip index");
+
+	// Same as InstanceBounds, but four instances at a time. Position/Size of the four instances get loaded as they
+	// are and transposed into one vector per member, and so do the four clip rects. Rotation is the first lane of
+	// each instance's second half, so two merges and a permute gather it
+	static_assert(sizeof(Rect) == sizeof(XMFLOAT4) && offsetof(Rect, Left) == 0 && offsetof(Rect, Bottom) == 12);
+	const XMVECTOR one = XMVectorReplicate(1.0f);
+	const XMVECTOR zero = XMVectorZero();
+	alignas(16) std::uint32_t mask[4];
+
+	size_t iii = 0;
+	for (; iii + 4 <= count; iii += 4)
+	{
+		const UIObjectData* group = &instances[iii];
+		const XMMATRIX front = XMMatrixTranspose(XMMATRIX(
+			XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&group[0].Position)),
+			XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&group[1].Position)),
+			XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&group[2].Position)),
+			XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&group[3].Position))
+		));
+		const XMVECTOR rotation = XMVectorPermute<0, 1, 4, 5>(
+			XMVectorMergeXY(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&group[0].Rotation)), XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&group[1].Rotation))),
+			XMVectorMergeXY(XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&group[2].Rotation)), XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&group[3].Rotation)))
+		);
+		const XMMATRIX clip = XMMatrixTranspose(XMMATRIX(
+			XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&clipRects[clipIndices[iii]])),
+			XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&clipRects[clipIndices[iii + 1]])),
+			XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&clipRects[clipIndices[iii + 2]])),
+			XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&clipRects[clipIndices[iii + 3]]))
+		));
+
+		// front.r = (Position.x, Position.y, Size.x, Size.y) and clip.r = (Left, Top, Right, Bottom)
+		const XMVECTOR left = front.r[0];
+		const XMVECTOR top = XMVectorNegate(front.r[1]);
+		const XMVECTOR width = front.r[2];
+		const XMVECTOR height = front.r[3];
+		const XMVECTOR radius = XMVectorAdd(XMVectorSqrt(XMVectorMultiplyAdd(width, width, XMVectorMultiply(height, height))), one);
+		const XMVECTOR unrotated = XMVectorEqual(rotation, zero);
+
+		const XMVECTOR boundsLeft = XMVectorSubtract(left, XMVectorSelect(radius, one, unrotated));
+		const XMVECTOR boundsTop = XMVectorSubtract(top, XMVectorSelect(radius, one, unrotated));
+		const XMVECTOR boundsRight = XMVectorAdd(left, XMVectorSelect(radius, XMVectorAdd(width, one), unrotated));
+		const XMVECTOR boundsBottom = XMVectorAdd(top, XMVectorSelect(radius, XMVectorAdd(height, one), unrotated));
+
+		const XMVECTOR overlapX = XMVectorAndInt(XMVectorGreater(boundsRight, clip.r[0]), XMVectorLess(boundsLeft, clip.r[2]));
+		const XMVECTOR overlapY = XMVectorAndInt(XMVectorGreater(boundsBottom, clip.r[1]), XMVectorLess(boundsTop, clip.r[3]));
+		XMStoreInt4A(mask, XMVectorAndInt(overlapX, overlapY));
+
+		for (size_t jjj = 0; jjj < 4; ++jjj)
+		{
+			if (mask[jjj] != 0)
+				visible.push_back(static_cast<unsigned int>(iii + jjj));
+		}
+	}
+
+	// Remainder
+	for (; iii < count; ++iii)
+	{
+		const Rect b = InstanceBounds(instances[iii]);
+		const Rect& c = clipRects[clipIndices[iii]];
+		if (b.Right > c.Left && b.Left < c.Right && b.Bottom > c.Top && b.Top < c.Bottom)
+			visible.push_back(static_cast<unsigned int>(iii));
+	}
+}
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "topo/Core.h"
+#include "UIObjectData.h"
+#include "topo/utils/Color.h"
+#include "topo/utils/Rect.h"
+
+
+namespace topo
+{
+// Structure-of-arrays descriptions of many rectangles/lines. All spans must have the same length
+struct RectangleBatch2D
+{
+	std::span<const float> Left;
+	std::span<const float> Top;
+	std::span<const float> Right;
+	std::span<const float> Bottom;
+	std::span<const Color> Colors;
+};
+struct LineBatch2D
+{
+	std::span<const float> X1;
+	std::span<const float> Y1;
+	std::span<const float> X2;
+	std::span<const float> Y2;
+	std::span<const float> Thickness;
+	std::span<const Color> Colors;
+};
+
+// RGBA8 (R in the lowest byte), as expected by UIObjectData
+ND unsigned int PackColorRGBA8(const Color& color) noexcept;
+
+// Packs the SDF parameters of UIObjectData::Shape: bits 0-2 hold the shape, bits 3-7 the border thickness (in
+// quarter pixels, so at most MaxBorderThickness) and bits 8-15 the corner radius (in half pixels, so at most
+// MaxCornerRadius). Bits 16-31 are left for the z-order (see PackZOrder). Both get clamped to their maximum, and
+// a thicker border logs a warning, because it is drawn visibly thinner than asked for
+constexpr float MaxBorderThickness = 7.75f;
+constexpr float MaxCornerRadius = 127.5f;
+ND unsigned int PackShapeParameters(SdfShape2D shape, float cornerRadius, float borderThickness) noexcept;
+ND constexpr unsigned int PackZOrder(std::uint16_t zOrder) noexcept { return static_cast<unsigned int>(zOrder) << 16; }
+
+// Fill instances[iii] with the instance data for the iii'th rectangle/line of the batch. The math, the color packing
+// and the stores into the instances are done four objects at a time with DirectXMath, so it uses SSE/AVX (depending
+// on the compiler settings) or DirectXMath's scalar implementation when _XM_NO_INTRINSICS_ is defined. Lines never
+// promote to double and only need a vectorized sqrt and atan2 (no sin/cos). Instances are plain boxes without a
+// border (see PackShapeParameters) that are only clipped by the window
+void BuildRectangleInstances(const RectangleBatch2D& batch, std::span<UIObjectData> instances) noexcept;
+void BuildLineInstances(const LineBatch2D& batch, std::span<UIObjectData> instances) noexcept;
+
+// Single object versions of the builders, for overwriting an existing instance in place. Only the geometry and the
+// fill color are written, so the shape parameters, border color and clip of the instance are kept
+void WriteRectangleInstance(float left, float top, float right, float bottom, const Color& color, UIObjectData& data) noexcept;
+void WriteLineInstance(float x1, float y1, float x2, float y2, float thickness, const Color& color, UIObjectData& data) noexcept;
+
+// Polyline segments (SdfShape2D::Segment). previous/next are the points before start and after end (nullptr where the
+// polyline ends). Instead of overlapping their neighbors, segments reach past their joints and get cut along the
+// miter line of the joint, so that each pixel of a joint is drawn by exactly one of the two segments. The miter
+// angles (the angle between the miter line and the segment's normal, which is half the turn) are packed as snorm16
+// over [-pi/2, pi/2] into BorderColor - the start joint in the low 16 bits and the end joint in the high ones.
+// Like WriteLineInstance, the clip and the z-order of the instance are left alone. The joint constants live next to
+// UIObjectData (see SegmentNoJoint)
+void WriteSegmentInstance(const DirectX::XMFLOAT2* previous, DirectX::XMFLOAT2 start, DirectX::XMFLOAT2 end, const DirectX::XMFLOAT2* next,
+	float thickness, const Color& color, UIObjectData& data) noexcept;
+
+// Bounds of an instance in pixels (y down), grown by the pixel the vertex shader adds for antialiasing. Rotated
+// instances (lines) get a conservative square around their origin
+ND Rect InstanceBounds(const UIObjectData& instance) noexcept;
+
+// Appends the index of every instance that overlaps its clip rect (clipRects[clipIndices[iii]], in pixels) to
+// visible, in order. Like the builders, it works four instances at a time: the bounds (see InstanceBounds) are
+// computed from the instances' members transposed into vectors, and tested against the transposed clip rects
+void CullInstances(std::span<const UIObjectData> instances, std::span<const unsigned int> clipIndices, std::span<const Rect> clipRects, std::vector<unsigned int>& visible);
+}
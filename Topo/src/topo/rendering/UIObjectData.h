@@ -0,0 +1,64 @@
+#pragma once
+#include "topo/Core.h"
+
+
+namespace topo
+{
+// The instance data every 2D shape is drawn from. It lives on its own (without any D3D12 dependencies), so that the
+// code that builds/culls instances and the software renderer (see SoftwareRenderer2D) can be used headless
+
+// Shapes that Control-ps.hlsl (and SoftwareRenderer2D) know how to evaluate as signed distance fields
+enum class SdfShape2D : unsigned int
+{
+	Box = 0,	// Rectangles (optionally with rounded corners) and lines
+	Ellipse = 1,// Circles/ellipses - the ellipse fills the object's rectangle
+	Glyph = 2,	// Text - the coverage comes from the glyph atlas (see GlyphCache)
+	Layer = 3,	// Composite of a cached layer - the color comes from the layer cache (see UIRenderer::SetClipCached)
+	Image = 4,	// Rectangles (optionally with rounded corners) that take their color from the image atlas (see ImageAtlas)
+	Segment = 5,// Polyline segments - lines that get cut along the miter line of their joints (see WriteSegmentInstance)
+	Triangle = 6// Isosceles triangles that fill the object's rectangle - the apex is at the top center
+};
+
+// Same layout as DirectX::XMFLOAT2 (and float2 in HLSL), without pulling DirectXMath into headless code
+struct Float2
+{
+	float x;
+	float y;
+};
+
+// Compact instance data (36 bytes) shared by every 2D shape. The vertex shader (Control-vs.hlsl) expands it:
+//     position = Position + RotateZ(Rotation) * (unitSquareVertex * Size)
+// and the pixel shader evaluates the shape's signed distance to antialias its edges and draw its border. The
+// object's z-order (see UIRenderer::SetObjectZOrder) rides along in the high bits of Shape and becomes its depth.
+// Clip indexes the clip rect table (see UIRenderer::RegisterClip) that the shape gets clipped against.
+// Rectangles have no rotation, so Position is the top-left corner (in world space, so y is -top) and Size is
+// (width, height). Lines use Size = (length, thickness) and a rotation (see BuildLineInstances). Glyphs are
+// rectangles without a border, so their BorderColor holds the texel (x | y << 16) of the glyph in the glyph atlas.
+// Layer composites are rectangles on whole pixels whose BorderColor holds the offset (in uints) of the layer's pixels.
+// Images are rectangles without a border, so their BorderColor holds the index of the image in the image table.
+// Polyline segments are lines without a border, so their BorderColor holds the miter angles of their two joints
+struct UIObjectData
+{
+	Float2 Position;
+	Float2 Size;
+	float Rotation;
+	unsigned int Color;			// RGBA8 - R is the lowest byte
+	unsigned int BorderColor;	// RGBA8
+	unsigned int Shape;			// See PackShapeParameters (UIInstanceBuilder.h)
+	unsigned int Clip;
+};
+static_assert(sizeof(UIObjectData) == 36, "UIObjectData must match PerObjectData in Control-vs.hlsl");
+
+// Must match SEGMENT_NO_JOINT/SEGMENT_MITER_LIMIT/SEGMENT_JOINT_MARGIN in Control-ps.hlsl. Ends without a joint are
+// plain antialiased line ends, miters longer than SegmentMiterLimit half thicknesses get cut off, and the quad
+// reaches SegmentJointMargin pixels past the miter so that its antialiased end never shows at the joint (see
+// WriteSegmentInstance)
+constexpr unsigned int SegmentNoJoint = 0xFFFF;
+constexpr float SegmentMiterLimit = 4.0f;
+constexpr float SegmentJointMargin = 1.0f;
+ND inline float SegmentJointAngle(unsigned int joint) noexcept { return (static_cast<float>(joint) - 32767.0f) * (1.5707963f / 32767.0f); }
+ND inline float SegmentJointExtension(float angle, float halfThickness) noexcept
+{
+	return std::min(std::abs(std::tan(angle)), SegmentMiterLimit) * halfThickness + SegmentJointMargin;
+}
+}
@@ -1,5 +1,7 @@
 #include "pch.h"
 #include "UIRenderer.h"
+#include "UIInstanceBuilder.h"
+#include "DWriteGlyphRasterizer.h"
 
 using namespace DirectX;
 
@@ -9,14 +11,1400 @@ void UIRenderer::SetDeviceResources(std::shared_ptr<DeviceResources> deviceResou
 {
 	m_deviceResources = deviceResources;
 	m_renderer.SetDeviceResources(deviceResources);
+	m_layerCache.SetDeviceResources(deviceResources);
+
+	// A composite that stops drawing its layer damages its rect when it goes away, which is where the layer's content
+	// gets drawn live again (it is no longer culled either)
+	m_layerCache.OnUncached = [this](const LayerCache::Layer& layer)
+		{
+			UnregisterObject(layer.Composite);
+			m_cullClipRectsDirty = true;
+		};
 
 	InitializeRenderer();
 }
 
+unsigned int UIRenderer::RegisterObject(RenderEffect2D effect, BasicGeometry2D geometry)
+{
+	ASSERT(!IsRecording(), "RegisterObject() cannot be called while recording a draw list");
+
+	// Reuse a free slot if there is one
+	unsigned int index = 0;
+	if (!m_freeObjectSlots.empty())
+	{
+		index = m_freeObjectSlots.back();
+		m_freeObjectSlots.pop_back();
+	}
+	else
+	{
+		index = static_cast<unsigned int>(m_renderObjects.size());
+		if (index > HandleIndexMask) [[unlikely]]
+			throw EXCEPTION(std::format("UIRenderer: Too many render objects - the maximum is {0}", HandleIndexMask + 1));
+		m_renderObjects.emplace_back();
+	}
+
+	RenderObject2D& ro = m_renderObjects[index];
+	const unsigned int generation = ro.Generation;
+	const bool queued = ro.Dirty;
+	ro = RenderObject2D{};
+	ro.Generation = generation;
+	ro.Dirty = queued;	// The slot may still be sitting in m_dirtyObjects from its previous owner
+	ro.Alive = true;
+	ro.RenderPassIndex = 0;
+	ro.Geometry = geometry;
+	ro.Effect = effect;
+	ro.Sequence = m_nextSequence++ & 0xFFFFFF;
+	ro.Clip = ClipIndex(m_currentClip);
+
+	// The current LayerScope determines the layer. Within the main layer, transparent objects get a layer of their
+	// own that is drawn (back-to-front) after all opaque objects. The overlay is always drawn back-to-front, so
+	// the effect does not matter there
+	InstanceList2D* list = &m_rectangleInstances;
+	ro.RenderLayerIndex = MainPassLayer;
+	if (m_currentLayer == RenderLayer2D::Overlay)
+	{
+		list = &m_overlayRectangleInstances;
+		ro.RenderLayerIndex = OverlayPassLayer;
+	}
+	else if (effect == RenderEffect2D::Transparent)
+	{
+		list = &m_transparentRectangleInstances;
+		ro.RenderLayerIndex = TransparentPassLayer;
+	}
+	InstanceList2D& instances = *list;
+
+	switch (geometry)
+	{
+	case BasicGeometry2D::Line:
+	case BasicGeometry2D::Rectangle: 
+	case BasicGeometry2D::Circle:
+	case BasicGeometry2D::Triangle:
+	case BasicGeometry2D::Glyph:
+	case BasicGeometry2D::Image:
+	case BasicGeometry2D::CachedLayer:
+		ro.RenderItemIndex = 0; 
+		ro.Instances = &instances;
+		ro.ObjectDataIndex = static_cast<unsigned int>(instances.Data.size());
+		instances.Data.emplace_back();
+		instances.Owners.push_back(index);
+		instances.MarkDirty(ro.ObjectDataIndex);
+		instances.OrderDirty = true;
+		break;
+	}
+
+	MarkDirty();
+
+	return MakeHandle(index, ro.Generation);
+}
+void UIRenderer::UnregisterObject(unsigned int uuid) noexcept
+{
+	ASSERT(!IsRecording(), "UnregisterObject() cannot be called while recording a draw list");
+
+	if (!IsValidObject(uuid)) [[unlikely]]
+	{
+		LOG_WARN("UIRenderer: Attempting to unregister an invalid or stale object handle ({0})", uuid);
+		return;
+	}
+
+	const unsigned int index = HandleIndex(uuid);
+	RenderObject2D& ro = m_renderObjects[index];
+
+	// Swap-remove the instance data so that the live instances stay contiguous. The object that owned the
+	// last instance needs to be told where its instance moved to
+	if (ro.Instances != nullptr)
+	{
+		InstanceList2D& instances = *ro.Instances;
+		AddInstanceDamage(instances.Data[ro.ObjectDataIndex]);
+		if (ro.RenderLayerIndex != OverlayPassLayer)
+			InvalidateCachedLayer(ro.Clip);
+
+		const unsigned int last = static_cast<unsigned int>(instances.Data.size()) - 1;
+		if (ro.ObjectDataIndex != last)
+		{
+			instances.Data[ro.ObjectDataIndex] = instances.Data[last];
+			instances.Owners[ro.ObjectDataIndex] = instances.Owners[last];
+			m_renderObjects[instances.Owners[last]].ObjectDataIndex = ro.ObjectDataIndex;
+			instances.MarkDirty(ro.ObjectDataIndex);
+			instances.OrderDirty = true;
+		}
+		instances.Data.pop_back();
+		instances.Owners.pop_back();
+		instances.CullDirty = true;
+	}
+
+	// Free the slot. Bumping the generation invalidates every outstanding handle to this object. A slot whose
+	// generation has run out of bits is retired instead of wrapping back to 0, because that would make handles
+	// from thousands of reuses ago valid again. That costs one slot per 4096 reuses
+	ro.Alive = false;
+	ro.Instances = nullptr;
+	if (ro.Generation < HandleGenerationMask) [[likely]]
+	{
+		++ro.Generation;
+		m_freeObjectSlots.push_back(index);
+	}
+
+	MarkDirty();
+}
+void UIRenderer::RefreshLayerActive(RenderPassLayer& layer) noexcept
+{
+	// The layer only needs to be active if at least one of its render items has instances
+	bool layerActive = false;
+	for (const RenderItem& item : layer.GetRenderItems())
+		layerActive = layerActive || item.IsActive();
+	layer.SetActive(layerActive);
+}
+
+unsigned int UIRenderer::RegisterClip(const Rect& rect)
+{
+	ASSERT(!IsRecording(), "RegisterClip() cannot be called while recording a draw list");
+
+	unsigned int index = 0;
+	if (!m_freeClipSlots.empty())
+	{
+		index = m_freeClipSlots.back();
+		m_freeClipSlots.pop_back();
+	}
+	else
+	{
+		index = static_cast<unsigned int>(m_clips.size());
+		if (index > HandleIndexMask) [[unlikely]]
+			throw EXCEPTION(std::format("UIRenderer: Too many clips - the maximum is {0}", HandleIndexMask + 1));
+		m_clips.emplace_back();
+		m_clipRects.emplace_back();
+		m_clipVisibleRects.emplace_back();
+		m_clipLayers.push_back(NoCachedLayer);
+	}
+
+	ClipNode2D& node = m_clips[index];
+	node.Parent = ClipIndex(m_currentClip);
+	node.Alive = true;
+	node.Resolved = false;
+	node.CachedLayer = NoCachedLayer;
+	m_clipRects[index] = rect;
+	m_clipsDirty = true;
+	return MakeHandle(index, node.Generation);
+}
+void UIRenderer::UnregisterClip(unsigned int clip) noexcept
+{
+	ASSERT(!IsRecording(), "UnregisterClip() cannot be called while recording a draw list");
+
+	if (clip == WindowClip || !IsValidClip(clip)) [[unlikely]]
+	{
+		LOG_WARN("UIRenderer: Attempting to unregister an invalid or stale clip handle ({0})", clip);
+		return;
+	}
+
+	const unsigned int index = HandleIndex(clip);
+	ClipNode2D& node = m_clips[index];
+	if (node.CachedLayer != NoCachedLayer)
+		m_layerCache.RemoveLayer(node.CachedLayer);
+
+	// Anything still referencing the slot falls back to being clipped by the window until it gets moved into
+	// another clip. Just like object slots, bumping the generation invalidates every outstanding handle, and a
+	// slot whose generation has run out of bits is retired
+	node.Parent = WindowClip;
+	node.Alive = false;
+	node.Resolved = false;
+	node.CachedLayer = NoCachedLayer;
+	m_clipRects[index] = m_clipRects[WindowClip];
+	if (node.Generation < HandleGenerationMask) [[likely]]
+	{
+		++node.Generation;
+		m_freeClipSlots.push_back(index);
+	}
+	m_clipsDirty = true;
+}
+void UIRenderer::SetClipRect(unsigned int clip, const Rect& rect) noexcept
+{
+	ASSERT(IsValidClip(clip), "Invalid or stale clip handle");
+
+	if (DrawList2D* list = RecordingDrawList()) [[unlikely]]
+	{
+		list->RecordClipRect(clip, rect);
+		return;
+	}
+
+	const unsigned int index = HandleIndex(clip);
+	if (m_clipRects[index] == rect)
+		return;
+
+	m_clipRects[index] = rect;
+	m_clipsDirty = true;
+	MarkDirty();
+}
+void UIRenderer::SetClipParent(unsigned int clip, unsigned int parent)
+{
+	ASSERT(!IsRecording(), "SetClipParent() cannot be called while recording a draw list");
+	ASSERT(clip != WindowClip && IsValidClip(clip), "Invalid or stale clip handle (the window has no parent)");
+
+	const unsigned int index = HandleIndex(clip);
+	const unsigned int parentIndex = ClipIndex(parent);
+	if (m_clips[index].Parent == parentIndex)
+		return;
+
+	// A clip cannot be nested in itself
+	for (unsigned int ancestor = parentIndex; ancestor != WindowClip; ancestor = m_clips[ancestor].Parent)
+	{
+		if (ancestor == index) [[unlikely]]
+		{
+			LOG_WARN("UIRenderer: Cannot nest clip {0} in its own descendant {1}", clip, parent);
+			return;
+		}
+	}
+
+	// Resolving the clips takes care of the damage and of moving the clip between cached layers
+	m_clips[index].Parent = parentIndex;
+	m_clipsDirty = true;
+	MarkDirty();
+}
+void UIRenderer::SetObjectClip(unsigned int uuid, unsigned int clip)
+{
+	ASSERT(!IsRecording(), "SetObjectClip() cannot be called while recording a draw list");
+	ASSERT(IsValidObject(uuid), "Invalid or stale object handle");
+
+	const unsigned int index = HandleIndex(uuid);
+	RenderObject2D& ro = m_renderObjects[index];
+	const unsigned int clipIndex = ClipIndex(clip);
+	if (ro.Clip == clipIndex)
+		return;
+
+	// The commit writes the new clip into the instance, which damages both clips and invalidates the new clip's
+	// cached layer. The object also leaves the old clip's layer
+	if (ro.Instances != nullptr)
+	{
+		if (ro.RenderLayerIndex != OverlayPassLayer)
+			InvalidateCachedLayer(ro.Clip);
+		ro.Instances->CullDirty = true;
+	}
+	ro.Clip = clipIndex;
+	QueueCommit(index);
+}
+void UIRenderer::ResolveClipRects() noexcept
+{
+	if (!m_clipsDirty)
+		return;
+	m_clipsDirty = false;
+
+	for (ClipNode2D& node : m_clips)
+		node.Resolved = false;
+
+	// Clips can be registered in any order (slots get reused), so resolve each clip's parent chain first
+	auto resolve = [this](auto& self, unsigned int clip) -> void
+		{
+			ClipNode2D& node = m_clips[clip];
+			if (node.Resolved)
+				return;
+			node.Resolved = true;
+
+			Rect visible = m_clipRects[clip];
+			unsigned int layer = node.CachedLayer;
+			if (clip != WindowClip)
+			{
+				self(self, node.Parent);
+				const Rect& parent = m_clipVisibleRects[node.Parent];
+				visible.Left = std::max(visible.Left, parent.Left);
+				visible.Top = std::max(visible.Top, parent.Top);
+				visible.Right = std::min(visible.Right, parent.Right);
+				visible.Bottom = std::min(visible.Bottom, parent.Bottom);
+
+				// Nested cached clips are part of the outermost cached layer
+				if (m_clipLayers[node.Parent] != NoCachedLayer)
+					layer = m_clipLayers[node.Parent];
+			}
+
+			// A clip that joins or leaves a layer changes the content of both layers
+			if (m_clipLayers[clip] != layer)
+			{
+				InvalidateCachedLayer(clip);
+				m_clipLayers[clip] = layer;
+				InvalidateCachedLayer(clip);
+			}
+
+			// Everything in the clip may have been drawn anywhere in its old visible rect and may now be drawn
+			// anywhere in its new one. NOTE: Objects that are left in a freed clip get damaged once they are
+			// committed again (freed clips have the window's rect, so damaging it would redraw the whole window)
+			Rect& previous = m_clipVisibleRects[clip];
+			if (previous != visible)
+			{
+				AddDamage(previous);
+				if (node.Alive)
+					AddDamage(visible);
+				previous = visible;
+				InvalidateCachedLayer(clip);
+			}
+		};
+	for (unsigned int clip = 0; clip < static_cast<unsigned int>(m_clips.size()); ++clip)
+		resolve(resolve, clip);
+
+	// Every object may now be in or out of its clip, and the GPU's clip table is out of date
+	m_clipBufferDirty.fill(true);
+	m_cullClipRectsDirty = true;
+	m_rectangleInstances.CullDirty = true;
+	m_transparentRectangleInstances.CullDirty = true;
+	m_overlayRectangleInstances.CullDirty = true;
+}
+void UIRenderer::CullInstances(InstanceList2D& instances, unsigned int layerIndex, std::span<const Rect> clipRects)
+{
+	if (!instances.CullDirty)
+		return;
+	instances.CullDirty = false;
+
+	const size_t count = instances.Data.size();
+	m_cullClipIndices.resize(count);
+	for (size_t iii = 0; iii < count; ++iii)
+		m_cullClipIndices[iii] = m_renderObjects[instances.Owners[iii]].Clip;
+
+	m_cullVisible.clear();
+	topo::CullInstances(instances.Data, m_cullClipIndices, clipRects, m_cullVisible);
+
+	// Everything in the GPU buffer from the first difference onwards has to be rewritten
+	const auto [newIter, oldIter] = std::ranges::mismatch(m_cullVisible, instances.Visible);
+	if (newIter != m_cullVisible.end() || oldIter != instances.Visible.end())
+	{
+		const unsigned int firstChange = static_cast<unsigned int>(newIter - m_cullVisible.begin());
+		for (unsigned int& changedFrom : instances.VisibleChangedFrom)
+			changedFrom = std::min(changedFrom, firstChange);
+	}
+	std::swap(instances.Visible, m_cullVisible);
+
+	instances.VisibleBefore.resize(count + 1);
+	unsigned int visibleCount = 0;
+	size_t next = 0;
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		instances.VisibleBefore[iii] = visibleCount;
+		if (next < instances.Visible.size() && instances.Visible[next] == iii)
+		{
+			++visibleCount;
+			++next;
+		}
+	}
+	instances.VisibleBefore[count] = visibleCount;
+
+	const auto setVisibleCount = [this, visibleCount](unsigned int index)
+		{
+			RenderPassLayer& layer = m_renderer.GetRenderPass(0).GetRenderPassLayer(index);
+			RenderItem& item = layer.GetRenderItem(0);
+			item.SetInstanceCount(visibleCount);
+			item.SetActive(visibleCount > 0);
+			RefreshLayerActive(layer);
+		};
+	setVisibleCount(layerIndex);
+
+	// The fringe layer draws the edges of the very same instances (see InitializeRenderer)
+	if (layerIndex == MainPassLayer)
+		setVisibleCount(OpaqueFringePassLayer);
+}
+
+namespace
+{
+// Polyline instances that are not segments. The quad is above and to the left of the window, so clamping it to any
+// clip rect leaves nothing to rasterize
+constexpr UIObjectData HiddenPolylineInstance = { { -16.0f, 16.0f }, { 0.0f, 0.0f }, 0.0f, 0, 0, 0, 0 };
+}
+
+unsigned int UIRenderer::RegisterPolyline()
+{
+	ASSERT(!IsRecording(), "RegisterPolyline() cannot be called while recording a draw list");
+
+	unsigned int id = 0;
+	if (!m_freePolylineSlots.empty())
+	{
+		id = m_freePolylineSlots.back();
+		m_freePolylineSlots.pop_back();
+	}
+	else
+	{
+		id = static_cast<unsigned int>(m_polylines.size());
+		m_polylines.emplace_back();
+	}
+
+	// The polyline gets a range of instances once it has segments (see UpdatePolylineSegments)
+	m_polylines[id] = {
+		.Batch = (m_currentLayer == RenderLayer2D::Overlay) ? OverlayPolylineBatch : MainPolylineBatch,
+		.Clip = ClipIndex(m_currentClip),
+		.Alive = true
+	};
+	return id;
+}
+void UIRenderer::UnregisterPolyline(unsigned int id) noexcept
+{
+	ASSERT(!IsRecording(), "UnregisterPolyline() cannot be called while recording a draw list");
+
+	if (id >= m_polylines.size() || !m_polylines[id].Alive) [[unlikely]]
+	{
+		LOG_WARN("UIRenderer: Attempting to unregister an invalid polyline ({0})", id);
+		return;
+	}
+
+	Polyline2D& polyline = m_polylines[id];
+	PolylineBatch2D& batch = m_polylineBatches[polyline.Batch];
+	for (unsigned int iii = polyline.First; iii < polyline.First + polyline.Count; ++iii)
+		AddInstanceDamage(batch.Instances.Data[iii]);
+
+	HidePolylineInstances(batch, polyline.First, polyline.First + polyline.Count);
+	if (polyline.Capacity > 0)
+		batch.Ranges.Free(polyline.First, polyline.Capacity);
+
+	const unsigned int batchIndex = polyline.Batch;
+	polyline = {};
+	m_freePolylineSlots.push_back(id);
+
+	// Once most of the batch is hidden, move the remaining polylines together so the draw stops paying for it
+	if (batch.Ranges.GetCapacity() > MinCompactedPolylineBatch && batch.Ranges.GetUsed() < batch.Ranges.GetCapacity() / 4)
+		CompactPolylineBatch(batchIndex);
+
+	RefreshPolylineBatch(batch);
+	MarkDirty();
+}
+void UIRenderer::UpdatePolylineSegments(unsigned int id, size_t firstSegment, std::span<const UIObjectData> segments)
+{
+	ASSERT(id < m_polylines.size() && m_polylines[id].Alive, "Invalid polyline");
+	ASSERT(!IsRecording(), "UpdatePolylineSegments() cannot be called while recording a draw list");
+
+	Polyline2D& polyline = m_polylines[id];
+	PolylineBatch2D& batch = m_polylineBatches[polyline.Batch];
+	ASSERT(firstSegment <= polyline.Count, "Polylines must be updated without leaving gaps");
+
+	const unsigned int first = static_cast<unsigned int>(firstSegment);
+	const unsigned int count = first + static_cast<unsigned int>(segments.size());
+
+	// Every segment from firstSegment onwards gets redrawn where it was and where it now is
+	for (unsigned int iii = polyline.First + first; iii < polyline.First + polyline.Count; ++iii)
+		AddInstanceDamage(batch.Instances.Data[iii]);
+
+	// Growing moves the polyline to a range with room to spare, so appending one point at a time only moves it
+	// every so often. Dropped segments are hidden
+	if (count > polyline.Capacity)
+		MovePolyline(polyline, first, std::max(count, 2 * polyline.Capacity));
+	else if (count < polyline.Count)
+		HidePolylineInstances(batch, polyline.First + count, polyline.First + polyline.Count);
+	polyline.Count = count;
+
+	std::vector<UIObjectData>& data = batch.Instances.Data;
+	std::ranges::copy(segments, data.begin() + polyline.First + first);
+	for (unsigned int iii = polyline.First + first; iii < polyline.First + count; ++iii)
+	{
+		data[iii].Clip = polyline.Clip;
+		data[iii].Shape = (data[iii].Shape & 0xFFFFu) | PackZOrder(polyline.ZOrder);
+		AddInstanceDamage(data[iii]);
+	}
+	if (!segments.empty())
+		batch.Instances.MarkDirty(polyline.First + first, polyline.First + count);
+
+	RefreshPolylineBatch(batch);
+	MarkDirty();
+}
+void UIRenderer::SetPolylineZOrder(unsigned int id, std::uint16_t zOrder)
+{
+	ASSERT(id < m_polylines.size() && m_polylines[id].Alive, "Invalid polyline");
+	ASSERT(!IsRecording(), "SetPolylineZOrder() cannot be called while recording a draw list");
+
+	Polyline2D& polyline = m_polylines[id];
+	if (polyline.ZOrder == zOrder)
+		return;
+	polyline.ZOrder = zOrder;
+
+	// Only the depth of the segments changes, so the segments are rewritten in place
+	PolylineBatch2D& batch = m_polylineBatches[polyline.Batch];
+	std::vector<UIObjectData>& data = batch.Instances.Data;
+	for (unsigned int iii = polyline.First; iii < polyline.First + polyline.Count; ++iii)
+	{
+		data[iii].Shape = (data[iii].Shape & 0xFFFFu) | PackZOrder(zOrder);
+		AddInstanceDamage(data[iii]);
+	}
+	if (polyline.Count > 0)
+	{
+		batch.Instances.MarkDirty(polyline.First, polyline.First + polyline.Count);
+		MarkDirty();
+	}
+}
+void UIRenderer::MovePolyline(Polyline2D& polyline, unsigned int keep, unsigned int capacity)
+{
+	PolylineBatch2D& batch = m_polylineBatches[polyline.Batch];
+	std::vector<UIObjectData>& data = batch.Instances.Data;
+
+	std::optional<size_t> first = batch.Ranges.Allocate(capacity);
+	if (!first.has_value())
+	{
+		// Grow the batch so there is a free range of at least capacity at its end. The new instances start out hidden
+		const size_t size = data.size();
+		batch.Ranges.Grow(std::max(2 * size, size + capacity));
+		data.resize(batch.Ranges.GetCapacity(), HiddenPolylineInstance);
+		batch.Instances.MarkDirty(static_cast<unsigned int>(size), static_cast<unsigned int>(data.size()));
+
+		first = batch.Ranges.Allocate(capacity);
+		ASSERT(first.has_value(), "Growing the polyline batch must leave room for the polyline");
+	}
+
+	// Free ranges are always hidden, so only the segments that are kept need to be written
+	const unsigned int newFirst = static_cast<unsigned int>(*first);
+	std::copy(data.begin() + polyline.First, data.begin() + polyline.First + keep, data.begin() + newFirst);
+	if (keep > 0)
+		batch.Instances.MarkDirty(newFirst, newFirst + keep);
+
+	HidePolylineInstances(batch, polyline.First, polyline.First + polyline.Count);
+	if (polyline.Capacity > 0)
+		batch.Ranges.Free(polyline.First, polyline.Capacity);
+
+	polyline.First = newFirst;
+	polyline.Count = keep;
+	polyline.Capacity = capacity;
+}
+void UIRenderer::CompactPolylineBatch(unsigned int batchIndex)
+{
+	PolylineBatch2D& batch = m_polylineBatches[batchIndex];
+
+	// Polylines keep their capacity and are packed in slot order. The rest of the ranges is already hidden
+	std::vector<UIObjectData> data;
+	data.reserve(batch.Ranges.GetUsed());
+	batch.Ranges.Reset(batch.Ranges.GetUsed());
+	for (Polyline2D& polyline : m_polylines)
+	{
+		if (!polyline.Alive || polyline.Batch != batchIndex || polyline.Capacity == 0)
+			continue;
+
+		const auto range = batch.Instances.Data.begin() + polyline.First;
+		data.insert(data.end(), range, range + polyline.Capacity);
+
+		polyline.First = static_cast<unsigned int>(*batch.Ranges.Allocate(polyline.Capacity));
+		ASSERT(polyline.First + polyline.Capacity == data.size(), "Compacted polylines must be packed in order");
+	}
+
+	batch.Instances.Data = std::move(data);
+	batch.Instances.MarkDirty(0, static_cast<unsigned int>(batch.Instances.Data.size()));
+}
+void UIRenderer::HidePolylineInstances(PolylineBatch2D& batch, unsigned int first, unsigned int last) noexcept
+{
+	if (first >= last)
+		return;
+
+	std::fill(batch.Instances.Data.begin() + first, batch.Instances.Data.begin() + last, HiddenPolylineInstance);
+	batch.Instances.MarkDirty(first, last);
+}
+void UIRenderer::RefreshPolylineBatch(PolylineBatch2D& batch)
+{
+	batch.Instances.SetAllVisible();
+
+	// Hidden instances are drawn too (they just do not cover any pixels), so the batch only goes idle once no
+	// polyline has a range in it
+	RenderPassLayer& layer = m_renderer.GetRenderPass(0).GetRenderPassLayer(batch.RenderLayerIndex);
+	RenderItem& item = layer.GetRenderItem(batch.RenderItemIndex);
+	item.SetInstanceCount(static_cast<unsigned int>(batch.Instances.Data.size()));
+	item.SetActive(batch.Ranges.GetUsed() > 0);
+	RefreshLayerActive(layer);
+}
+
+unsigned int UIRenderer::AcquireImage(std::string_view filename)
+{
+	ASSERT(!IsRecording(), "AcquireImage() cannot be called while recording a draw list");
+
+	if (const std::optional<unsigned int> image = m_imageAtlas.Acquire(filename))
+		return image.value();
+
+	// The atlas holds the texels exactly as they are in the texture, so only formats with 4 bytes per texel that
+	// the pixel shader knows how to read can go in there. The shader reads the raw bytes, so _SRGB textures would
+	// never get the decode their format asks for and are rejected rather than drawn with the wrong colors
+	Texture texture = AssetManager::CheckoutTexture(m_deviceResources, filename);
+	const D3D12_RESOURCE_DESC desc = texture.GetResource()->GetDesc();
+	if (desc.Dimension != D3D12_RESOURCE_DIMENSION_TEXTURE2D) [[unlikely]]
+		throw EXCEPTION(std::format("UIRenderer: Image '{0}' is not a 2D texture", filename));
+
+	unsigned int flags = 0;
+	switch (desc.Format)
+	{
+	case DXGI_FORMAT_R8G8B8A8_UNORM:
+		break;
+	case DXGI_FORMAT_B8G8R8A8_UNORM:
+		flags = ImageAtlas::SwapRedBlue;
+		break;
+	case DXGI_FORMAT_B8G8R8X8_UNORM:
+		flags = ImageAtlas::SwapRedBlue | ImageAtlas::IgnoreAlpha;
+		break;
+	case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+		throw EXCEPTION(std::format("UIRenderer: Image '{0}' has an sRGB format ({1}) - images must be RGBA8 or BGRA8 UNORM (not UNORM_SRGB)", filename, static_cast<int>(desc.Format)));
+	default:
+		throw EXCEPTION(std::format("UIRenderer: Image '{0}' has an unsupported format ({1}) - images must be RGBA8 or BGRA8", filename, static_cast<int>(desc.Format)));
+	}
+
+	const unsigned int width = static_cast<unsigned int>(desc.Width);
+	const unsigned int height = static_cast<unsigned int>(desc.Height);
+	const std::optional<unsigned int> image = m_imageAtlas.Add(filename, width, height, flags);
+	if (!image.has_value()) [[unlikely]]
+		throw EXCEPTION(std::format("UIRenderer: There is no room for image '{0}' ({1}x{2}) in the image atlas (pages are {3}x{3} and there are at most {4})", filename, width, height, ImageAtlas::PageSize, ImageAtlas::MaxPages));
+
+	m_pendingImageCopies.push_back({ image.value(), std::move(texture) });
+	m_imageTableDirty.fill(true);
+	MarkDirty();
+	return image.value();
+}
+void UIRenderer::ReleaseImage(unsigned int image) noexcept
+{
+	ASSERT(!IsRecording(), "ReleaseImage() cannot be called while recording a draw list");
+
+	// The table entry of the image stays as it is until its slot gets reused, so there is nothing to upload. An
+	// image that was released before it got copied does not need to be copied at all
+	if (m_imageAtlas.Release(image))
+		std::erase_if(m_pendingImageCopies, [image](const PendingImageCopy2D& copy) noexcept { return copy.Image == image; });
+}
+
+void UIRenderer::SetClipCached(unsigned int clip, bool cached)
+{
+	ASSERT(!IsRecording(), "SetClipCached() cannot be called while recording a draw list");
+	ASSERT(clip != WindowClip && IsValidClip(clip), "Invalid or stale clip handle (the window itself cannot be cached)");
+
+	ClipNode2D& node = m_clips[HandleIndex(clip)];
+	if (cached == (node.CachedLayer != NoCachedLayer))
+		return;
+
+	if (!cached)
+	{
+		m_layerCache.RemoveLayer(node.CachedLayer);
+		node.CachedLayer = NoCachedLayer;
+	}
+	else
+		node.CachedLayer = m_layerCache.AddLayer(HandleIndex(clip));
+
+	// Which clips are part of which layer gets worked out when the clips are resolved
+	m_clipsDirty = true;
+	MarkDirty();
+}
+void UIRenderer::SetLayerCacheBudget(size_t bytes)
+{
+	ASSERT(!IsRecording(), "SetLayerCacheBudget() cannot be called while recording a draw list");
+
+	m_layerCache.SetBudget(bytes);
+	MarkDirty();
+}
+void UIRenderer::UpdateCachedLayers()
+{
+	// Drop the layers that changed and pick the ones that stopped changing (see LayerCache::Update)
+	if (m_layerCache.Update(m_clipVisibleRects))
+		GatherCachedLayerContent();
+
+	// The content of cached layers gets culled, so it is neither uploaded nor drawn by the UI pass
+	if (m_cullClipRectsDirty)
+	{
+		m_cullClipRectsDirty = false;
+
+		constexpr Rect culled = {
+			std::numeric_limits<float>::max(),
+			std::numeric_limits<float>::max(),
+			std::numeric_limits<float>::lowest(),
+			std::numeric_limits<float>::lowest()
+		};
+		m_cullClipRects.assign(m_clipVisibleRects.begin(), m_clipVisibleRects.end());
+		for (size_t clip = 0; clip < m_cullClipRects.size(); ++clip)
+		{
+			const unsigned int layer = m_clipLayers[clip];
+			if (layer != NoCachedLayer && m_layerCache.IsCached(layer))
+				m_cullClipRects[clip] = culled;
+		}
+		m_rectangleInstances.CullDirty = true;
+		m_transparentRectangleInstances.CullDirty = true;
+	}
+}
+void UIRenderer::GatherCachedLayerContent()
+{
+	// Gather every main layer instance that is part of a layer that is about to be cached (reusing the scratch
+	// space of SortInstances). Layers are rendered with a single pipeline that blends everything back-to-front, so
+	// opaque objects are drawn before transparent ones with the same z-order, and their sequence is reversed so
+	// that the opaque object registered first still ends up on top (like it does with the depth test)
+	m_sortKeys.clear();
+	m_sortOrder.clear();
+	m_sortedData.clear();
+	m_sortedOwners.clear();
+	for (const InstanceList2D* list : { &m_rectangleInstances, &m_transparentRectangleInstances })
+	{
+		for (size_t iii = 0; iii < list->Data.size(); ++iii)
+		{
+			const RenderObject2D& ro = m_renderObjects[list->Owners[iii]];
+			const unsigned int layer = (ro.Clip < m_clipLayers.size()) ? m_clipLayers[ro.Clip] : NoCachedLayer;
+			if (layer == NoCachedLayer || !m_layerCache.GetLayer(layer).Rebuild || m_layerCache.IsCached(layer))
+				continue;
+
+			const unsigned int sequence = (ro.Effect == RenderEffect2D::Opaque) ? 0xFFFFFFu - ro.Sequence : ro.Sequence;
+			m_sortKeys.push_back(MakeSortKey(0, ro.ZOrder, static_cast<unsigned int>(ro.Effect), SortKeyTexture(ro), sequence));
+			m_sortOrder.push_back(static_cast<unsigned int>(m_sortedData.size()));
+			m_sortedData.push_back(list->Data[iii]);
+			m_sortedOwners.push_back(layer);
+		}
+	}
+	m_radixSort.Sort(m_sortKeys, m_sortOrder);
+
+	for (const unsigned int index : m_sortOrder)
+		m_layerCache.GetLayer(m_sortedOwners[index]).Instances.push_back(m_sortedData[index]);
+
+	// Give every layer that has any content a composite. The composite is clipped by the layer's parent clip (the
+	// layer's own clip is culled now) and drawn at the lowest z-order of the layer's content (see SetClipCached)
+	for (unsigned int iii = 0; iii < m_layerCache.LayerCount(); ++iii)
+	{
+		const LayerCache::Layer& layer = m_layerCache.GetLayer(iii);
+		if (!layer.Rebuild || layer.Cached)
+			continue;
+
+		if (layer.Instances.empty())
+		{
+			m_layerCache.Discard(iii);
+			continue;
+		}
+
+		std::uint16_t zOrder = std::numeric_limits<std::uint16_t>::max();
+		for (const UIObjectData& instance : layer.Instances)
+			zOrder = std::min(zOrder, static_cast<std::uint16_t>(instance.Shape >> 16));
+
+		unsigned int composite = 0;
+		{
+			LayerScope layerScope(*this, RenderLayer2D::Main);
+			ClipScope clipScope(*this, ClipHandle(m_clips[layer.Clip].Parent));
+			composite = RegisterObject(RenderEffect2D::Transparent, BasicGeometry2D::CachedLayer);
+		}
+		const unsigned int index = HandleIndex(composite);
+		RenderObject2D& ro = m_renderObjects[index];
+		ro.Left = layer.Bounds.Left;
+		ro.Top = layer.Bounds.Top;
+		ro.Right = layer.Bounds.Right;
+		ro.Bottom = layer.Bounds.Bottom;
+		ro.ZOrder = zOrder;
+		ro.LayerCacheOffset = static_cast<unsigned int>(layer.CacheOffset / sizeof(unsigned int));
+		QueueCommit(index);
+
+		m_layerCache.Cache(iii, composite);
+		m_cullClipRectsDirty = true;
+	}
+}
+
+void UIRenderer::CopyPendingImages(ID3D12GraphicsCommandList* commandList)
+{
+	// Grow the image atlas so it holds every page. The new buffer starts out empty, so the pages that were already
+	// filled get copied over (the delayed delete in Resize keeps the old buffer around until the copy is done)
+	const size_t bytes = static_cast<size_t>(m_imageAtlas.PageCount()) * ImageAtlas::PageBytes;
+	if (m_imageAtlasBuffer->GetCapacityBytes(0) < bytes)
+	{
+		const Microsoft::WRL::ComPtr<ID3D12Resource> previous = m_imageAtlasBuffer->GetResource();
+		const size_t previousBytes = m_imageAtlasBuffer->GetCapacityBytes(0) / ImageAtlas::PageBytes * ImageAtlas::PageBytes;
+		m_imageAtlasBuffer->Resize(bytes);
+		if (previousBytes > 0)
+			GFX_THROW_INFO_ONLY(commandList->CopyBufferRegion(m_imageAtlasBuffer->GetResource(), 0, previous.Get(), 0, previousBytes));
+	}
+
+	// Textures are left in PIXEL_SHADER_RESOURCE once they are loaded (see DDSTextureLoader)
+	std::vector<D3D12_RESOURCE_BARRIER> barriers;
+	barriers.reserve(m_pendingImageCopies.size());
+	for (const PendingImageCopy2D& copy : m_pendingImageCopies)
+		barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(copy.Source.GetResource(), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_SOURCE));
+	GFX_THROW_INFO_ONLY(commandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data()));
+
+	// Each page is laid out like a texture in a placed footprint, so the top mip of each image can be copied straight
+	// to its spot on its page. The image atlas gets implicitly promoted to COPY_DEST (see StructuredBufferDefault)
+	for (const PendingImageCopy2D& copy : m_pendingImageCopies)
+	{
+		const UIImageData& image = m_imageAtlas.GetImage(copy.Image);
+
+		D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+		footprint.Offset = static_cast<UINT64>(image.Page) * ImageAtlas::PageBytes;
+		footprint.Footprint = { copy.Source.GetFormat(), ImageAtlas::PageSize, ImageAtlas::PageSize, 1, ImageAtlas::PageSize * 4 };
+		const CD3DX12_TEXTURE_COPY_LOCATION dst(m_imageAtlasBuffer->GetResource(), footprint);
+		const CD3DX12_TEXTURE_COPY_LOCATION src(copy.Source.GetResource(), 0);
+		GFX_THROW_INFO_ONLY(commandList->CopyTextureRegion(&dst, image.Origin & 0xFFFF, image.Origin >> 16, 0, &src, nullptr));
+	}
+
+	// The UI pass reads the image atlas later in the same command list, so it needs an explicit transition
+	for (D3D12_RESOURCE_BARRIER& barrier : barriers)
+		std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+	barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(m_imageAtlasBuffer->GetResource(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE));
+	GFX_THROW_INFO_ONLY(commandList->ResourceBarrier(static_cast<UINT>(barriers.size()), barriers.data()));
+
+	// The copies are recorded, so the textures can go (textures are deleted with a delayed delete)
+	m_pendingImageCopies.clear();
+}
+
+Rect UIRenderer::SnapToWindowPixels(const Rect& rect) const noexcept
+{
+	// Snap outwards to whole pixels (anything that touches a pixel can change it) and ignore whatever is outside
+	// of the window
+	return {
+		std::max(std::floor(rect.Left), 0.0f),
+		std::max(std::floor(rect.Top), 0.0f),
+		std::min(std::ceil(rect.Right), m_windowWidth),
+		std::min(std::ceil(rect.Bottom), m_windowHeight)
+	};
+}
+void UIRenderer::AddDamage(const Rect& rect)
+{
+	m_damage.Add(SnapToWindowPixels(rect));
+}
+void UIRenderer::AddInstanceDamage(const UIObjectData& instance)
+{
+	// Instances that were registered but never committed are all zeros and have never been drawn
+	if (instance.Size.x == 0.0f && instance.Size.y == 0.0f)
+		return;
+
+	// Nothing gets drawn outside of the instance's clip rect
+	Rect bounds = InstanceBounds(instance);
+	if (instance.Clip < m_clipVisibleRects.size())
+	{
+		const Rect& clip = m_clipVisibleRects[instance.Clip];
+		bounds.Left = std::max(bounds.Left, clip.Left);
+		bounds.Top = std::max(bounds.Top, clip.Top);
+		bounds.Right = std::min(bounds.Right, clip.Right);
+		bounds.Bottom = std::min(bounds.Bottom, clip.Bottom);
+	}
+	AddDamage(bounds);
+}
+std::span<const D3D12_RECT> UIRenderer::PrepareRedraw(int backBufferIndex)
+{
+	ASSERT(backBufferIndex >= 0 && backBufferIndex < static_cast<int>(m_backBufferDamage.size()), "Invalid back buffer index");
+
+	// The window may have shrunk since the damage was added, so clamp it again
+	const LONG width = static_cast<LONG>(m_windowWidth);
+	const LONG height = static_cast<LONG>(m_windowHeight);
+	const auto toRect = [width, height](const Rect& rect) noexcept -> D3D12_RECT
+		{
+			return {
+				std::clamp(static_cast<LONG>(rect.Left), 0L, width),
+				std::clamp(static_cast<LONG>(rect.Top), 0L, height),
+				std::clamp(static_cast<LONG>(rect.Right), 0L, width),
+				std::clamp(static_cast<LONG>(rect.Bottom), 0L, height)
+			};
+		};
+
+	DamageRegion& damage = m_backBufferDamage[backBufferIndex];
+	m_redrawRects.clear();
+	for (const Rect& rect : damage.GetRects())
+	{
+		const D3D12_RECT r = toRect(rect);
+		if (r.right > r.left && r.bottom > r.top)
+			m_redrawRects.push_back(r);
+	}
+	damage.Clear();
+
+	// The renderer draws every instance once per rect, so too many rects (or rects that would cover most of their
+	// union anyways) get redrawn as a single rect. The union gets cleared and fully redrawn, so that is always safe
+	if (m_redrawRects.size() > 1)
+	{
+		D3D12_RECT bounds = m_redrawRects[0];
+		std::int64_t area = 0;
+		for (const D3D12_RECT& r : m_redrawRects)
+		{
+			bounds.left = std::min(bounds.left, r.left);
+			bounds.top = std::min(bounds.top, r.top);
+			bounds.right = std::max(bounds.right, r.right);
+			bounds.bottom = std::max(bounds.bottom, r.bottom);
+			area += static_cast<std::int64_t>(r.right - r.left) * (r.bottom - r.top);
+		}
+
+		const std::int64_t boundsArea = static_cast<std::int64_t>(bounds.right - bounds.left) * (bounds.bottom - bounds.top);
+		if (m_redrawRects.size() > MaxScissoredRedraws || static_cast<float>(area) >= ScissoredRedrawAreaRatio * static_cast<float>(boundsArea))
+			m_redrawRects.assign(1, bounds);
+	}
+
+	// Any cached layer that gets redrawn is in use (see LayerCache)
+	m_layerCache.MarkRedrawn(m_redrawRects, m_clipVisibleRects);
+
+	m_presentRects.clear();
+	for (const Rect& rect : m_presentDamage.GetRects())
+	{
+		const RECT r = toRect(rect);
+		if (r.right > r.left && r.bottom > r.top)
+			m_presentRects.push_back(r);
+	}
+	m_presentDamage.Clear();
+
+	return m_redrawRects;
+}
+void UIRenderer::Render(int frameIndex)
+{
+	// Images that were acquired since the last frame have to be in the image atlas before anything draws them
+	if (!m_pendingImageCopies.empty())
+		CopyPendingImages(m_deviceResources->GetCommandList());
+
+	// Layers that were cached by the last Update() have to be in the layer cache before their composites get drawn
+	m_layerCache.Render(frameIndex);
+
+	// Only the damaged parts of the back buffer are drawn. Everything else still holds what was last drawn there
+	if (!m_redrawRects.empty())
+		m_renderer.Render(frameIndex, m_redrawRects);
+	m_framePending = false;
+}
+
+void UIRenderer::RenderSoftware(SoftwareRenderer2D& target) const
+{
+	target.SetClipRects(m_clipVisibleRects);
+	target.SetGlyphAtlas(m_glyphCache != nullptr ? &m_glyphCache->GetAtlas() : nullptr);
+
+	// The content of cached layers gets culled on the GPU (their composites draw it instead), so every instance is
+	// drawn here, in draw order. Instances that were culled are outside of their clip rect and do not draw anything
+	// anyways, and composites are skipped by the software renderer
+	const auto drawAll = [&target](const InstanceList2D& instances, SoftwarePipeline2D pipeline)
+		{
+			target.Draw(instances.Data, pipeline);
+		};
+
+	// Same order as the layers of the UI render pass. Polylines are never culled, and their hidden instances do not
+	// draw anything either
+	drawAll(m_rectangleInstances, SoftwarePipeline2D::Opaque);
+	drawAll(m_rectangleInstances, SoftwarePipeline2D::OpaqueFringe);
+	drawAll(m_transparentRectangleInstances, SoftwarePipeline2D::Transparent);
+	drawAll(m_polylineBatches[MainPolylineBatch].Instances, SoftwarePipeline2D::Transparent);
+	drawAll(m_overlayRectangleInstances, SoftwarePipeline2D::Overlay);
+	drawAll(m_polylineBatches[OverlayPolylineBatch].Instances, SoftwarePipeline2D::Overlay);
+}
+
+void UIRenderer::SubmitDrawList(const DrawList2D& list)
+{
+	ASSERT(!IsRecording(), "Draw lists must be submitted on the thread that owns the renderer");
+
+	// Each command goes through the same function that recorded it, so a submitted list has exactly the same effect
+	// as making its calls directly (in the order they were recorded)
+	for (const DrawCommand2D& command : list.GetCommands())
+	{
+		switch (command.Type)
+		{
+		case DrawCommandType2D::Rectangle:
+			UpdateRectangle(command.Target, command.Left, command.Top, command.Right, command.Bottom, command.FillColor);
+			break;
+		case DrawCommandType2D::Line:
+			UpdateLine(command.Target, command.Left, command.Top, command.Right, command.Bottom, command.FillColor, command.Thickness);
+			break;
+		case DrawCommandType2D::Glyph:
+			ASSERT(IsValidObject(command.Target), "Invalid or stale object handle");
+			SetGlyph(HandleIndex(command.Target), command.Left, command.Top, command.Right, command.Bottom, command.Extra, command.FillColor);
+			break;
+		case DrawCommandType2D::Image:
+			ASSERT(IsValidObject(command.Target), "Invalid or stale object handle");
+			SetImage(HandleIndex(command.Target), command.Left, command.Top, command.Right, command.Bottom, command.Extra, command.FillColor);
+			break;
+		case DrawCommandType2D::ShapeStyle:
+			UpdateShapeStyle(command.Target, command.Left, command.Thickness, command.FillColor);
+			break;
+		case DrawCommandType2D::ZOrder:
+			SetObjectZOrder(command.Target, static_cast<std::uint16_t>(command.Extra));
+			break;
+		case DrawCommandType2D::ClipRect:
+			SetClipRect(command.Target, { command.Left, command.Top, command.Right, command.Bottom });
+			break;
+		}
+	}
+
+	if (list.IsDirty())
+		MarkDirty();
+}
+
+template<typename F>
+void UIRenderer::CommitInPlace(unsigned int index, F&& write)
+{
+	// Objects that are already queued (i.e. their style changed this frame) still need the full commit
+	RenderObject2D& ro = m_renderObjects[index];
+	if (ro.Dirty || ro.Instances == nullptr)
+	{
+		QueueCommit(index);
+		return;
+	}
+
+	UIObjectData& data = ro.Instances->Data[ro.ObjectDataIndex];
+	const UIObjectData previous = data;
+	write(data);
+
+	// Same as CommitDirtyObjects()
+	if (std::memcmp(&previous, &data, sizeof(UIObjectData)) != 0)
+	{
+		ro.Instances->MarkDirty(ro.ObjectDataIndex);
+		AddInstanceDamage(previous);
+		AddInstanceDamage(data);
+		if (ro.RenderLayerIndex != OverlayPassLayer)
+			InvalidateCachedLayer(ro.Clip);
+	}
+}
+void UIRenderer::UpdateRectangles(std::span<const unsigned int> uuids, const RectangleBatch2D& rectangles)
+{
+	ASSERT(rectangles.Left.size() == uuids.size() && rectangles.Top.size() == uuids.size() && rectangles.Right.size() == uuids.size() &&
+		rectangles.Bottom.size() == uuids.size() && rectangles.Colors.size() == uuids.size(), "All spans must have the same length");
+
+	if (RecordingDrawList() != nullptr) [[unlikely]]
+	{
+		for (size_t iii = 0; iii < uuids.size(); ++iii)
+			UpdateRectangle(uuids[iii], rectangles.Left[iii], rectangles.Top[iii], rectangles.Right[iii], rectangles.Bottom[iii], rectangles.Colors[iii]);
+		return;
+	}
+
+	// Instead of storing the descriptions and gathering/building/scattering them in CommitDirtyObjects(), write each
+	// object's instance data right where it lives, in a single pass. The description is still kept up to date
+	// because other changes (style, z-order, animations) rebuild the instance from it
+	for (size_t iii = 0; iii < uuids.size(); ++iii)
+	{
+		ASSERT(IsValidObject(uuids[iii]), "Invalid or stale object handle");
+
+		const unsigned int index = HandleIndex(uuids[iii]);
+		RenderObject2D& ro = m_renderObjects[index];
+		ro.Left = rectangles.Left[iii];
+		ro.Top = rectangles.Top[iii];
+		ro.Right = rectangles.Right[iii];
+		ro.Bottom = rectangles.Bottom[iii];
+		ro.FillColor = rectangles.Colors[iii];
+
+		CommitInPlace(index, [&ro](UIObjectData& data) { WriteRectangleInstance(ro.Left, ro.Top, ro.Right, ro.Bottom, ro.FillColor, data); });
+	}
+
+	MarkDirty();
+}
+void UIRenderer::UpdateLines(std::span<const unsigned int> uuids, const LineBatch2D& lines)
+{
+	ASSERT(lines.X1.size() == uuids.size() && lines.Y1.size() == uuids.size() && lines.X2.size() == uuids.size() &&
+		lines.Y2.size() == uuids.size() && lines.Thickness.size() == uuids.size() && lines.Colors.size() == uuids.size(), "All spans must have the same length");
+
+	if (RecordingDrawList() != nullptr) [[unlikely]]
+	{
+		for (size_t iii = 0; iii < uuids.size(); ++iii)
+			UpdateLine(uuids[iii], lines.X1[iii], lines.Y1[iii], lines.X2[iii], lines.Y2[iii], lines.Colors[iii], lines.Thickness[iii]);
+		return;
+	}
+
+	// See UpdateRectangles
+	for (size_t iii = 0; iii < uuids.size(); ++iii)
+	{
+		ASSERT(IsValidObject(uuids[iii]), "Invalid or stale object handle");
+
+		const unsigned int index = HandleIndex(uuids[iii]);
+		RenderObject2D& ro = m_renderObjects[index];
+		ro.Left = lines.X1[iii];
+		ro.Top = lines.Y1[iii];
+		ro.Right = lines.X2[iii];
+		ro.Bottom = lines.Y2[iii];
+		ro.Thickness = lines.Thickness[iii];
+		ro.FillColor = lines.Colors[iii];
+
+		CommitInPlace(index, [&ro](UIObjectData& data) { WriteLineInstance(ro.Left, ro.Top, ro.Right, ro.Bottom, ro.Thickness, ro.FillColor, data); });
+	}
+
+	MarkDirty();
+}
+
+void UIRenderer::CommitBatch2D::Clear() noexcept
+{
+	Left.clear();
+	Top.clear();
+	Right.clear();
+	Bottom.clear();
+	Thickness.clear();
+	Colors.clear();
+	Objects.clear();
+}
+void UIRenderer::CommitBatch2D::PushBack(const RenderObject2D& ro, unsigned int index)
+{
+	Left.push_back(ro.Left);
+	Top.push_back(ro.Top);
+	Right.push_back(ro.Right);
+	Bottom.push_back(ro.Bottom);
+	Thickness.push_back(ro.Thickness);
+	Colors.push_back(ro.FillColor);
+	Objects.push_back(index);
+}
+
+void UIRenderer::CommitDirtyObjects()
+{
+	if (m_dirtyObjects.empty())
+		return;
+
+	// 1. Gather the descriptions of every dirty object
+	m_rectangleCommits.Clear();
+	m_lineCommits.Clear();
+	for (unsigned int index : m_dirtyObjects)
+	{
+		RenderObject2D& ro = m_renderObjects[index];
+		ro.Dirty = false;
+
+		// Skip objects that were unregistered after being queued
+		if (!ro.Alive || ro.Instances == nullptr)
+			continue;
+
+		if (ro.Geometry == BasicGeometry2D::Line)
+			m_lineCommits.PushBack(ro, index);
+		else
+			m_rectangleCommits.PushBack(ro, index);
+	}
+	m_dirtyObjects.clear();
+
+	// 2. Build the instance data in bulk
+	m_rectangleCommits.Instances.resize(m_rectangleCommits.Objects.size());
+	BuildRectangleInstances(
+		{ m_rectangleCommits.Left, m_rectangleCommits.Top, m_rectangleCommits.Right, m_rectangleCommits.Bottom, m_rectangleCommits.Colors },
+		m_rectangleCommits.Instances
+	);
+
+	m_lineCommits.Instances.resize(m_lineCommits.Objects.size());
+	BuildLineInstances(
+		{ m_lineCommits.Left, m_lineCommits.Top, m_lineCommits.Right, m_lineCommits.Bottom, m_lineCommits.Thickness, m_lineCommits.Colors },
+		m_lineCommits.Instances
+	);
+
+	// 3. Scatter the instance data to wherever each object's instance currently lives
+	for (const CommitBatch2D* batch : { &m_rectangleCommits, &m_lineCommits })
+	{
+		for (size_t iii = 0; iii < batch->Objects.size(); ++iii)
+		{
+			const RenderObject2D& ro = m_renderObjects[batch->Objects[iii]];
+			UIObjectData& data = ro.Instances->Data[ro.ObjectDataIndex];
+			const UIObjectData previous = data;
+			data = batch->Instances[iii];
+
+			// The builders produce plain boxes, so only glyphs and styled objects need their shape parameters filled in
+			if (ro.Geometry == BasicGeometry2D::Glyph)
+			{
+				data.Shape = static_cast<unsigned int>(SdfShape2D::Glyph);
+				data.BorderColor = ro.GlyphOrigin;
+			}
+			else if (ro.Geometry == BasicGeometry2D::Image)
+			{
+				data.Shape = PackShapeParameters(SdfShape2D::Image, ro.CornerRadius, 0.0f);
+				data.BorderColor = ro.Image;
+			}
+			else if (ro.Geometry == BasicGeometry2D::CachedLayer)
+			{
+				data.Shape = static_cast<unsigned int>(SdfShape2D::Layer);
+				data.BorderColor = ro.LayerCacheOffset;
+			}
+			else if (ro.Geometry == BasicGeometry2D::Circle || ro.Geometry == BasicGeometry2D::Triangle || ro.CornerRadius > 0.0f || ro.BorderThickness > 0.0f)
+			{
+				const SdfShape2D shape =
+					(ro.Geometry == BasicGeometry2D::Circle) ? SdfShape2D::Ellipse :
+					(ro.Geometry == BasicGeometry2D::Triangle) ? SdfShape2D::Triangle : SdfShape2D::Box;
+				const float cornerRadius = (ro.Geometry == BasicGeometry2D::Rectangle) ? ro.CornerRadius : 0.0f;
+				data.Shape = PackShapeParameters(shape, cornerRadius, ro.BorderThickness);
+				data.BorderColor = PackColorRGBA8(ro.BorderColor);
+			}
+			data.Shape |= PackZOrder(ro.ZOrder);
+			data.Clip = ro.Clip;
+			ro.Instances->MarkDirty(ro.ObjectDataIndex);
+
+			// Objects quite often get committed without anything about them actually changing, and those don't
+			// need to be redrawn. Otherwise, the object has to be redrawn where it was and where it now is
+			if (std::memcmp(&previous, &data, sizeof(UIObjectData)) != 0)
+			{
+				AddInstanceDamage(previous);
+				AddInstanceDamage(data);
+				if (ro.RenderLayerIndex != OverlayPassLayer)
+					InvalidateCachedLayer(ro.Clip);
+			}
+		}
+	}
+}
+
+void UIRenderer::SortInstances(InstanceList2D& instances)
+{
+	if (!instances.OrderDirty)
+		return;
+	instances.OrderDirty = false;
+
+	const size_t count = instances.Data.size();
+	m_sortKeys.resize(count);
+	m_sortOrder.resize(count);
+	for (size_t iii = 0; iii < count; ++iii)
+	{
+		m_sortKeys[iii] = MakeSortKey(m_renderObjects[instances.Owners[iii]]);
+		m_sortOrder[iii] = static_cast<unsigned int>(iii);
+	}
+
+	// Registering an object appends it with the highest sequence number, so quite often the instances are still
+	// in order and nothing needs to move
+	if (std::is_sorted(m_sortKeys.begin(), m_sortKeys.end()))
+		return;
+
+	m_radixSort.Sort(m_sortKeys, m_sortOrder);
+
+	// Apply the permutation. Only the instances that actually moved need to be uploaded again
+	m_sortedData.resize(count);
+	m_sortedOwners.resize(count);
+	unsigned int firstMoved = static_cast<unsigned int>(count);
+	unsigned int lastMoved = 0;
+	for (unsigned int iii = 0; iii < static_cast<unsigned int>(count); ++iii)
+	{
+		const unsigned int source = m_sortOrder[iii];
+		m_sortedData[iii] = instances.Data[source];
+		m_sortedOwners[iii] = instances.Owners[source];
+		if (source != iii)
+		{
+			m_renderObjects[m_sortedOwners[iii]].ObjectDataIndex = iii;
+			firstMoved = std::min(firstMoved, iii);
+			lastMoved = iii + 1;
+		}
+	}
+	std::swap(instances.Data, m_sortedData);
+	std::swap(instances.Owners, m_sortedOwners);
+
+	if (firstMoved < lastMoved)
+		instances.MarkDirty(firstMoved, lastMoved);
+}
+
+void InstanceList2D::MarkDirty(unsigned int first, unsigned int last) noexcept
+{
+	CullDirty = true;
+
+	for (auto& ranges : DirtyRanges)
+	{
+		// Objects tend to get committed in the order they were created, so most of the time the new range will
+		// either extend the last range or already be part of it
+		if (!ranges.empty())
+		{
+			auto& back = ranges.back();
+			if (first <= back.second && last >= back.first)
+			{
+				back.first = std::min(back.first, first);
+				back.second = std::max(back.second, last);
+				continue;
+			}
+		}
+
+		if (ranges.size() < MaxDirtyRanges)
+		{
+			ranges.emplace_back(first, last);
+			continue;
+		}
+
+		// Too many ranges - collapse them all into one
+		unsigned int collapsedFirst = first;
+		unsigned int collapsedLast = last;
+		for (const auto& [f, l] : ranges)
+		{
+			collapsedFirst = std::min(collapsedFirst, f);
+			collapsedLast = std::max(collapsedLast, l);
+		}
+		ranges.clear();
+		ranges.emplace_back(collapsedFirst, collapsedLast);
+	}
+}
+void InstanceList2D::SetAllVisible()
+{
+	const unsigned int count = static_cast<unsigned int>(Data.size());
+	const unsigned int previous = static_cast<unsigned int>(Visible.size());
+
+	// The instances that were already visible keep their positions, and new ones are covered by their dirty ranges
+	Visible.resize(count);
+	VisibleBefore.resize(count + 1);
+	for (unsigned int iii = previous; iii < count; ++iii)
+	{
+		Visible[iii] = iii;
+		VisibleBefore[iii + 1] = iii + 1;
+	}
+}
+size_t InstanceList2D::Upload(StructuredBufferMapped<UIObjectData>& buffer, unsigned int frameIndex)
+{
+	auto& ranges = DirtyRanges[frameIndex];
+	unsigned int& changedFrom = VisibleChangedFrom[frameIndex];
+	const unsigned int visibleCount = static_cast<unsigned int>(Visible.size());
+	const unsigned int count = static_cast<unsigned int>(Data.size());
+
+	// If the frame resource's buffer had to grow, it is a brand new buffer and every instance must be written
+	if (buffer.Reserve(frameIndex, visibleCount))
+		changedFrom = 0;
+
+	// Translate the dirty ranges of Data into ranges of the GPU buffer. Culled instances map to empty ranges
+	for (auto& [first, last] : ranges)
+	{
+		// Instances may have been removed after the range was marked
+		first = VisibleBefore[std::min(first, count)];
+		last = VisibleBefore[std::min(last, count)];
+	}
+	if (changedFrom < visibleCount)
+		ranges.emplace_back(changedFrom, visibleCount);
+	changedFrom = UINT_MAX;
+
+	if (ranges.empty())
+		return 0;
+
+	// Merge overlapping/adjacent ranges so each instance gets copied at most once
+	std::sort(ranges.begin(), ranges.end());
+
+	size_t bytes = 0;
+	unsigned int first = ranges[0].first;
+	unsigned int last = ranges[0].second;
+	auto copy = [&]()
+		{
+			if (first >= last)
+				return;
+
+			// If nothing between first and last was culled, the instances are contiguous in Data as well.
+			// Otherwise, they have to be gathered first
+			const unsigned int dataFirst = Visible[first];
+			if (Visible[last - 1] - dataFirst == last - 1 - first)
+			{
+				buffer.CopyData(frameIndex, first, std::span<const UIObjectData>(Data.data() + dataFirst, last - first));
+			}
+			else
+			{
+				Staging.resize(last - first);
+				for (unsigned int iii = first; iii < last; ++iii)
+					Staging[iii - first] = Data[Visible[iii]];
+				buffer.CopyData(frameIndex, first, Staging);
+			}
+			bytes += static_cast<size_t>(last - first) * sizeof(UIObjectData);
+		};
+
+	for (size_t iii = 1; iii < ranges.size(); ++iii)
+	{
+		if (ranges[iii].first <= last)
+		{
+			last = std::max(last, ranges[iii].second);
+		}
+		else
+		{
+			copy();
+			first = ranges[iii].first;
+			last = ranges[iii].second;
+		}
+	}
+	copy();
+
+	ranges.clear();
+	return bytes;
+}
+
+void UIRenderer::UpdateAnimations(float deltaTime) noexcept
+{
+	m_animations.Update(deltaTime, [this](const AnimationTarget& target, float value)
+		{
+			if (target.Type == AnimationTargetType::Value)
+			{
+				*target.Value = value;
+				return;
+			}
+			if (target.Type == AnimationTargetType::Callback)
+			{
+				target.Apply(target.Context, target.Index, value);
+				return;
+			}
+
+			// The object may have been unregistered while the tween was running
+			if (!IsValidObject(target.ObjectUUID))
+				return;
+
+			const unsigned int index = HandleIndex(target.ObjectUUID);
+			RenderObject2D& ro = m_renderObjects[index];
+			switch (target.Property)
+			{
+			case AnimatedProperty::Left:	  ro.Left = value; break;
+			case AnimatedProperty::Top:		  ro.Top = value; break;
+			case AnimatedProperty::Right:	  ro.Right = value; break;
+			case AnimatedProperty::Bottom:	  ro.Bottom = value; break;
+			case AnimatedProperty::Thickness: ro.Thickness = value; break;
+			case AnimatedProperty::ColorR:	  ro.FillColor.R = value; break;
+			case AnimatedProperty::ColorG:	  ro.FillColor.G = value; break;
+			case AnimatedProperty::ColorB:	  ro.FillColor.B = value; break;
+			case AnimatedProperty::ColorA:	  ro.FillColor.A = value; break;
+			}
+			QueueCommit(index);
+		});
+
+	// Make sure the final values of any tweens that just finished get rendered
+	MarkDirty();
+}
+
 void UIRenderer::InitializeRenderer()
 {
-	m_uiObjectConstantBuffer = std::make_unique<ConstantBufferMapped<UIObjectData>>(m_deviceResources);
-	m_uiObjectConstantBuffer->Update = [this](const Timer& timer, int frameIndex)
+	m_uiObjectBuffer = std::make_unique<StructuredBufferMapped<UIObjectData>>(m_deviceResources);
+	m_uiObjectBuffer->Update = [this](const Timer& timer, int frameIndex)
 		{
 //				using namespace DirectX;
 //
@@ -30,7 +1418,14 @@ void UIRenderer::InitializeRenderer()
 //
 //				m_uiObjectConstantBuffer->CopyData(frameIndex, data); 
 
-			m_uiObjectConstantBuffer->CopyData(frameIndex, m_rectangleRenderItemTransforms);
+			// Only the instances that changed since this frame resource was last written need to be copied
+			m_bytesUploaded += m_rectangleInstances.Upload(*m_uiObjectBuffer, frameIndex);
+		};
+
+	m_uiTransparentObjectBuffer = std::make_unique<StructuredBufferMapped<UIObjectData>>(m_deviceResources);
+	m_uiTransparentObjectBuffer->Update = [this](const Timer& timer, int frameIndex)
+		{
+			m_bytesUploaded += m_transparentRectangleInstances.Upload(*m_uiTransparentObjectBuffer, frameIndex);
 		};
 
 //	std::vector<Vertex> squareVertices{
@@ -74,14 +1469,88 @@ void UIRenderer::InitializeRenderer()
 			m_uiPassConstantsBuffer->CopyData(frameIndex, pc);
 		};
 
+	m_clipBuffer = std::make_unique<StructuredBufferMapped<XMFLOAT4>>(m_deviceResources, 256);
+	m_clipBuffer->Update = [this](const Timer& timer, int frameIndex)
+		{
+			if (!m_clipBufferDirty[frameIndex])
+				return;
+			m_clipBufferDirty[frameIndex] = false;
+
+			// Rect has the same layout as an XMFLOAT4 (left, top, right, bottom)
+			static_assert(sizeof(Rect) == sizeof(XMFLOAT4));
+			m_clipBuffer->Reserve(frameIndex, m_clipVisibleRects.size());
+			m_clipBuffer->CopyData(frameIndex, 0, std::span<const XMFLOAT4>(reinterpret_cast<const XMFLOAT4*>(m_clipVisibleRects.data()), m_clipVisibleRects.size()));
+			m_bytesUploaded += m_clipVisibleRects.size() * sizeof(XMFLOAT4);
+		};
+
+	// Glyph atlas. The atlas is only ever sampled at whole texels (glyphs are drawn 1:1), so instead of a texture
+	// it lives in a structured buffer like the rest of the UI data and only the rows that changed get copied
+	static_assert(GlyphAtlas::Width % 4 == 0, "The atlas gets packed 4 texels to a uint");
+	m_glyphCache = std::make_unique<GlyphCache>(std::make_unique<DWriteGlyphRasterizer>());
+	m_glyphAtlasBuffer = std::make_unique<StructuredBufferMapped<unsigned int>>(m_deviceResources, static_cast<size_t>(GlyphAtlas::Width) * GlyphAtlas::Height / 4);
+	m_glyphAtlasBuffer->Update = [this](const Timer& timer, int frameIndex)
+		{
+			// Rows that the glyph cache wrote since the last frame need to go to every frame resource's copy
+			const auto [first, last] = m_glyphCache->GetAtlas().TakeDirtyRows();
+			if (first < last)
+			{
+				for (auto& rows : m_glyphAtlasDirtyRows)
+				{
+					const bool empty = rows.first >= rows.second;
+					rows.first = empty ? first : std::min(rows.first, first);
+					rows.second = empty ? last : std::max(rows.second, last);
+				}
+			}
+
+			auto& rows = m_glyphAtlasDirtyRows[frameIndex];
+			if (rows.first >= rows.second)
+				return;
+
+			constexpr size_t wordsPerRow = GlyphAtlas::Width / 4;
+			const std::span<const std::uint8_t> pixels = m_glyphCache->GetAtlas().GetPixels().subspan(
+				static_cast<size_t>(rows.first) * GlyphAtlas::Width,
+				static_cast<size_t>(rows.second - rows.first) * GlyphAtlas::Width
+			);
+			m_glyphAtlasBuffer->CopyData(frameIndex, rows.first * wordsPerRow, std::span<const unsigned int>(reinterpret_cast<const unsigned int*>(pixels.data()), pixels.size() / 4));
+			m_bytesUploaded += pixels.size();
+			rows = { 0, 0 };
+		};
+
+	// Images (see AcquireImage). The image atlas starts out tiny as well and grows a page at a time
+	m_imageAtlasBuffer = std::make_unique<StructuredBufferDefault>(m_deviceResources, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+	m_imageTableBuffer = std::make_unique<StructuredBufferMapped<UIImageData>>(m_deviceResources, 256);
+	m_imageTableBuffer->Update = [this](const Timer& timer, int frameIndex)
+		{
+			if (!m_imageTableDirty[frameIndex])
+				return;
+			m_imageTableDirty[frameIndex] = false;
+
+			const std::span<const UIImageData> table = m_imageAtlas.GetTable();
+			m_imageTableBuffer->Reserve(frameIndex, table.size());
+			m_imageTableBuffer->CopyData(frameIndex, 0, table);
+			m_bytesUploaded += table.size_bytes();
+		};
+
+	// t0: per-item instance data, t1: clip rect table, t2: glyph atlas, b1: pass constants, t3: layer cache,
+	// t4: image atlas, t5: image table
 	RenderPassSignature sig{
-		ConstantBufferParameter{ 0 },
-		ConstantBufferParameter{ 1 }
+		ShaderResourceViewParameter{ 0 },
+		ShaderResourceViewParameter{ 1 },
+		ShaderResourceViewParameter{ 2 },
+		ConstantBufferParameter{ 1 },
+		ShaderResourceViewParameter{ 3 },
+		ShaderResourceViewParameter{ 4 },
+		ShaderResourceViewParameter{ 5 }
 	};
 
 	RenderPass& uiPass = m_renderer.EmplaceBackRenderPass(sig);
 	SET_DEBUG_NAME(uiPass, "UI Render Pass");
-	uiPass.BindConstantBuffer(1, m_uiPassConstantsBuffer.get());
+	uiPass.BindStructuredBuffer(1, m_clipBuffer.get());
+	uiPass.BindStructuredBuffer(2, m_glyphAtlasBuffer.get());
+	uiPass.BindConstantBuffer(3, m_uiPassConstantsBuffer.get());
+	uiPass.BindStructuredBuffer(4, m_layerCache.GetBuffer());
+	uiPass.BindStructuredBuffer(5, m_imageAtlasBuffer.get());
+	uiPass.BindStructuredBuffer(6, m_imageTableBuffer.get());
 
 
 	auto il = std::vector<D3D12_INPUT_ELEMENT_DESC>{
@@ -90,15 +1559,30 @@ void UIRenderer::InitializeRenderer()
 	};
 	const Shader& vs = AssetManager::CheckoutShader("Control-vs.cso", std::move(il));
 	const Shader& ps = AssetManager::CheckoutShader("Control-ps.cso");
+	const Shader& opaquePS = AssetManager::CheckoutShader("ControlOpaque-ps.cso");
+	const Shader& fringePS = AssetManager::CheckoutShader("ControlFringe-ps.cso");
 
-	PipelineStateDesc psDesc{};
-	psDesc.RootSignature = uiPass.GetRootSignature();
-	psDesc.VertexShader = vs;
-	psDesc.PixelShader = ps;
-	psDesc.SampleMask = UINT_MAX; /// ??? Why?
-	psDesc.NumRenderTargets = 1;
-	psDesc.RTVFormats[0] = m_deviceResources->GetBackBufferFormat();
-	psDesc.DSVFormat = m_deviceResources->GetDepthStencilFormat();
+	// Shapes are antialiased in the pixel shader (their edges have partial alpha), so every UI layer except for the
+	// opaque layer blends
+	BlendDesc uiBlend{};
+	uiBlend.RenderTarget[0].BlendEnable = true;
+	uiBlend.RenderTarget[0].SrcBlend = BLEND::SRC_ALPHA;
+	uiBlend.RenderTarget[0].DestBlend = BLEND::INV_SRC_ALPHA;
+	uiBlend.RenderTarget[0].SrcBlendAlpha = BLEND::ONE;
+	uiBlend.RenderTarget[0].DestBlendAlpha = BLEND::INV_SRC_ALPHA;
+
+	// Opaque objects are sorted front-to-back and write depth, so anything they hide fails the depth test. They do
+	// not blend (whatever is behind them has not been drawn yet), so ControlOpaque-ps only draws the pixels they
+	// fully cover. Their antialiased edges are drawn by the fringe layer below
+	PipelineStateDesc psDesc{
+		.RootSignature = uiPass.GetRootSignature(),
+		.VertexShader = vs,
+		.PixelShader = opaquePS,
+		.SampleMask = UINT_MAX, /// ??? Why?
+		.NumRenderTargets = 1,
+		.RTVFormats = { m_deviceResources->GetBackBufferFormat() },
+		.DSVFormat = m_deviceResources->GetDepthStencilFormat()
+	};
 
 	RenderPassLayer& layer1 = uiPass.EmplaceBackRenderPassLayer(m_meshGroup.get(), psDesc);
 	SET_DEBUG_NAME(layer1, "Opaque Layer");
@@ -106,7 +1590,138 @@ void UIRenderer::InitializeRenderer()
 	RenderItem& squareRI = layer1.EmplaceBackRenderItem(0, 0);
 	SET_DEBUG_NAME(squareRI, "Rectangle RenderItem");
 
-	squareRI.BindConstantBuffer(0, m_uiObjectConstantBuffer.get());
+	squareRI.BindStructuredBuffer(0, m_uiObjectBuffer.get());
+
+	// Transparent layer. Transparent objects are sorted back-to-front, tested against the depth written by the
+	// opaque layer (LESS_EQUAL, so they are drawn on top of opaque objects with the same z-order), and do not
+	// write depth themselves so that they never hide each other
+	DepthStencilDesc transparentDepthStencil{};
+	transparentDepthStencil.DepthWriteMask = DEPTH_WRITE_MASK::ZERO;
+	transparentDepthStencil.DepthFunc = COMPARISON_FUNC::LESS_EQUAL;
+
+	PipelineStateDesc transparentDesc{
+		.RootSignature = uiPass.GetRootSignature(),
+		.VertexShader = vs,
+		.PixelShader = ps,
+		.BlendDesc = uiBlend,
+		.SampleMask = UINT_MAX,
+		.DepthStencilDesc = transparentDepthStencil,
+		.NumRenderTargets = 1,
+		.RTVFormats = { m_deviceResources->GetBackBufferFormat() },
+		.DSVFormat = m_deviceResources->GetDepthStencilFormat()
+	};
+
+	// Opaque fringe layer. Draws the instances of the opaque layer again, but ControlFringe-ps only keeps the pixels
+	// that the opaque layer left out (the ones their shape only partially covers) and blends them just like a
+	// transparent object. Everything opaque has been drawn by then, so the edges blend with whatever is really
+	// behind them. The fringes themselves do not write depth, so the fringes of overlapping opaque objects are
+	// blended in the opaque layer's order (front-to-back), which is only wrong where two edges overlap. The render
+	// item shares m_uiObjectBuffer with the opaque layer - updating it twice uploads nothing the second time
+	PipelineStateDesc fringeDesc = transparentDesc;
+	fringeDesc.PixelShader = fringePS;
+
+	RenderPassLayer& fringeLayer = uiPass.EmplaceBackRenderPassLayer(m_meshGroup.get(), fringeDesc);
+	SET_DEBUG_NAME(fringeLayer, "Opaque Fringe Layer");
+
+	RenderItem& fringeRI = fringeLayer.EmplaceBackRenderItem(0, 0);
+	SET_DEBUG_NAME(fringeRI, "Rectangle Fringe RenderItem");
+	fringeRI.BindStructuredBuffer(0, m_uiObjectBuffer.get());
+
+	RenderPassLayer& transparentLayer = uiPass.EmplaceBackRenderPassLayer(m_meshGroup.get(), transparentDesc);
+	SET_DEBUG_NAME(transparentLayer, "Transparent Layer");
+	transparentLayer.SetActive(false);
+
+	RenderItem& transparentRI = transparentLayer.EmplaceBackRenderItem(0, 0);
+	SET_DEBUG_NAME(transparentRI, "Transparent Rectangle RenderItem");
+	transparentRI.BindStructuredBuffer(0, m_uiTransparentObjectBuffer.get());
+
+	// Overlay layer (popups, tooltips, etc). It is drawn after the main layer and ignores depth so that it always
+	// gets composited on top of the main layer
+	m_uiOverlayObjectBuffer = std::make_unique<StructuredBufferMapped<UIObjectData>>(m_deviceResources);
+	m_uiOverlayObjectBuffer->Update = [this](const Timer& timer, int frameIndex)
+		{
+			m_bytesUploaded += m_overlayRectangleInstances.Upload(*m_uiOverlayObjectBuffer, frameIndex);
+		};
+
+	DepthStencilDesc overlayDepthStencil{};
+	overlayDepthStencil.DepthEnable = false;
+	overlayDepthStencil.DepthWriteMask = DEPTH_WRITE_MASK::ZERO;
+
+	PipelineStateDesc overlayDesc{
+		.RootSignature = uiPass.GetRootSignature(),
+		.VertexShader = vs,
+		.PixelShader = ps,
+		.BlendDesc = uiBlend,
+		.SampleMask = UINT_MAX,
+		.DepthStencilDesc = overlayDepthStencil,
+		.NumRenderTargets = 1,
+		.RTVFormats = { m_deviceResources->GetBackBufferFormat() },
+		.DSVFormat = m_deviceResources->GetDepthStencilFormat()
+	};
+
+	// Polylines of the main layer get their own layer. They are depth tested against the opaque layer just like
+	// transparent objects (see SetPolylineZOrder), but drawn after them, and below the overlay. Overlay polylines
+	// go straight into the overlay layer, which ignores depth. Each of them is a single render item that draws
+	// every polyline of its layer (see PolylineBatch2D)
+	RenderPassLayer& polylineLayer = uiPass.EmplaceBackRenderPassLayer(m_meshGroup.get(), transparentDesc);
+	SET_DEBUG_NAME(polylineLayer, "Polyline Layer");
+	polylineLayer.SetActive(false);
+
+	RenderPassLayer& overlayLayer = uiPass.EmplaceBackRenderPassLayer(m_meshGroup.get(), overlayDesc);
+	SET_DEBUG_NAME(overlayLayer, "Overlay Layer");
+
+	RenderItem& overlayRI = overlayLayer.EmplaceBackRenderItem(0, 0);
+	SET_DEBUG_NAME(overlayRI, "Overlay Rectangle RenderItem");
+
+	overlayRI.BindStructuredBuffer(0, m_uiOverlayObjectBuffer.get());
+
+	const auto createPolylineBatch = [this](PolylineBatch2D& batch, RenderPassLayer& layer, unsigned int layerIndex, std::string_view name)
+		{
+			batch.Buffer = std::make_unique<StructuredBufferMapped<UIObjectData>>(m_deviceResources);
+			batch.Buffer->Update = [this, b = &batch](const Timer& timer, int frameIndex)
+				{
+					m_bytesUploaded += b->Instances.Upload(*b->Buffer, frameIndex);
+				};
+
+			batch.RenderLayerIndex = layerIndex;
+			batch.RenderItemIndex = static_cast<unsigned int>(layer.GetRenderItems().size());
+			RenderItem& item = layer.EmplaceBackRenderItem(0, 0);
+			SET_DEBUG_NAME(item, name);
+			item.BindStructuredBuffer(0, batch.Buffer.get());
+			item.SetActive(false);
+		};
+	createPolylineBatch(m_polylineBatches[MainPolylineBatch], polylineLayer, MainPolylinePassLayer, "Polyline RenderItem");
+	createPolylineBatch(m_polylineBatches[OverlayPolylineBatch], overlayLayer, OverlayPassLayer, "Overlay Polyline RenderItem");
+
+	// Layer cache pass. Cached layers are drawn with the same shaders, clip rect table and pass constants as the UI
+	// pass, into a render target the size of the window (see LayerCache::BeginRebuild/EndRebuild). Each
+	// layer has a render item of its own. Everything is blended back-to-front (see GatherCachedLayerContent), so
+	// there is no depth buffer
+	RenderPass& layerCachePass = m_layerCache.GetRenderer().EmplaceBackRenderPass(sig);
+	SET_DEBUG_NAME(layerCachePass, "Layer Cache Render Pass");
+	layerCachePass.BindStructuredBuffer(1, m_clipBuffer.get());
+	layerCachePass.BindStructuredBuffer(2, m_glyphAtlasBuffer.get());
+	layerCachePass.BindConstantBuffer(3, m_uiPassConstantsBuffer.get());
+	layerCachePass.BindStructuredBuffer(4, m_layerCache.GetBuffer());
+	layerCachePass.BindStructuredBuffer(5, m_imageAtlasBuffer.get());
+	layerCachePass.BindStructuredBuffer(6, m_imageTableBuffer.get());
+	layerCachePass.PreWork = [this](RenderPass&, ID3D12GraphicsCommandList* commandList) { return m_layerCache.BeginRebuild(commandList); };
+	layerCachePass.PostWork = [this](RenderPass&, ID3D12GraphicsCommandList* commandList) { m_layerCache.EndRebuild(commandList); };
+
+	PipelineStateDesc layerCacheDesc{
+		.RootSignature = layerCachePass.GetRootSignature(),
+		.VertexShader = vs,
+		.PixelShader = ps,
+		.BlendDesc = uiBlend,
+		.SampleMask = UINT_MAX,
+		.DepthStencilDesc = overlayDepthStencil,
+		.NumRenderTargets = 1,
+		.RTVFormats = { FORMAT::R8G8B8A8_UNORM }
+	};
+
+	RenderPassLayer& layerCacheLayer = layerCachePass.EmplaceBackRenderPassLayer(m_meshGroup.get(), layerCacheDesc);
+	SET_DEBUG_NAME(layerCacheLayer, "Layer Cache Layer");
+	layerCacheLayer.SetActive(false);
 }
 
 
@@ -3,7 +3,18 @@
 #include "Renderer.h"
 #include "OrthographicCamera.h"
 #include "AssetManager.h"
+#include "AnimationSystem.h"
+#include "DrawList2D.h"
+#include "UIObjectData.h"
+#include "GlyphCache.h"
+#include "ImageAtlas.h"
+#include "LayerCache.h"
+#include "SoftwareRenderer2D.h"
+#include "topo/utils/BufferAllocator.h"
 #include "topo/utils/Color.h"
+#include "topo/utils/DamageRegion.h"
+#include "topo/utils/RadixSort.h"
+#include "topo/utils/Rect.h"
 
 
 
@@ -106,11 +117,6 @@ namespace topo
 		DirectX::XMFLOAT4X4 MatTransform = MathHelper::Identity4x4();
 	};
 
-	struct UIObjectData
-	{
-		DirectX::XMFLOAT4X4 World;
-		DirectX::XMFLOAT4 Color;
-	};
 	struct ObjectData
 	{
 		DirectX::XMFLOAT4X4 World = MathHelper::Identity4x4();
@@ -118,13 +124,109 @@ namespace topo
 	};
 
 
+struct RectangleBatch2D;
+struct LineBatch2D;
+
+// Opaque objects are drawn front-to-back with depth writes so that anything they hide is rejected by the depth
+// test before it gets shaded. Transparent objects are drawn afterwards, back-to-front and blended
 enum class RenderEffect2D
 {
 	Opaque, Transparent
 };
+// Circles and triangles fill the rectangle they are given (see UpdateRectangle), and triangles point up (see
+// SdfShape2D::Triangle). CachedLayer is only used by the renderer itself for the quad that a cached layer is
+// composited with (see UIRenderer::SetClipCached)
 enum class BasicGeometry2D
 {
-	Rectangle, Circle, Triangle, Line
+	Rectangle, Circle, Triangle, Line, Glyph, Image, CachedLayer
+};
+
+// Layers are drawn in order, so everything in the Overlay layer is composited on top of the Main layer. Each layer
+// has its own instance data, so changes to overlay objects (i.e. opening/closing a popup) never touch the
+// instance data of the main layer
+enum class RenderLayer2D : unsigned int
+{
+	Main = 0, Overlay = 1
+};
+
+// Instance data for a single render item. Live instances are always kept contiguous (unregistering swaps the last
+// instance into the freed spot). Only the instances that survive culling (see UIRenderer::CullInstances) get
+// uploaded: the GPU buffer holds Data[Visible[0]], Data[Visible[1]], ... and the render item draws exactly those
+struct InstanceList2D
+{
+	std::vector<UIObjectData> Data;
+	std::vector<unsigned int> Owners; // Slot index (in UIRenderer::m_renderObjects) of the object that owns each instance
+
+	// Indices into Data of the instances that survived culling (in draw order), and VisibleBefore[iii] = number of
+	// visible instances before Data[iii] (it has Data.size() + 1 entries). The GPU buffer position of a visible
+	// instance is therefore VisibleBefore[index], and a range of instances [first, last) maps to the range
+	// [VisibleBefore[first], VisibleBefore[last]) of the GPU buffer
+	std::vector<unsigned int> Visible;
+	std::vector<unsigned int> VisibleBefore = { 0 };
+
+	// Set whenever instance data, the instance order or the clip rects changed, so visibility must be recomputed
+	bool CullDirty = false;
+
+	// Each frame resource has its own copy of the instance data on the GPU, so each one keeps its own list of
+	// instance ranges [first, last) that changed since that copy was last written. A change gets added to every
+	// list and each list is cleared when its frame resource gets uploaded. The ranges index Data (not the GPU buffer)
+	std::array<std::vector<std::pair<unsigned int, unsigned int>>, g_numFrameResources> DirtyRanges;
+
+	// When the set of visible instances changes, everything in the GPU buffer from the first position that changed
+	// onwards has shifted. This is the first such position per frame resource (or UINT_MAX if nothing shifted)
+	std::array<unsigned int, g_numFrameResources> VisibleChangedFrom = MakeVisibleChangedFrom();
+	ND static constexpr std::array<unsigned int, g_numFrameResources> MakeVisibleChangedFrom() noexcept
+	{
+		std::array<unsigned int, g_numFrameResources> result = {};
+		result.fill(UINT_MAX);
+		return result;
+	}
+
+	// Scratch space for gathering visible instances that are not contiguous in Data
+	std::vector<UIObjectData> Staging;
+
+	// Once a list holds this many ranges, it gets collapsed into a single range covering all of them. At that
+	// point, most of the instances are changing anyways and a few large memcpy's beat many small ones
+	static constexpr size_t MaxDirtyRanges = 32;
+
+	// Set whenever the instances may no longer be in draw order (see UIRenderer::SortInstances)
+	bool OrderDirty = false;
+
+	inline void MarkDirty(unsigned int index) noexcept { MarkDirty(index, index + 1); }
+	void MarkDirty(unsigned int first, unsigned int last) noexcept;
+
+	// For lists that are never culled (polylines): makes every instance visible. Only the instances that were added
+	// since the last call are touched, so appending stays cheap
+	void SetAllVisible();
+
+	// Copies the frame's dirty (visible) instances into the buffer and returns the number of bytes that were copied
+	size_t Upload(StructuredBufferMapped<UIObjectData>& buffer, unsigned int frameIndex);
+};
+
+// Every polyline of a render layer is drawn by one instanced draw (see PolylineBatch2D). A polyline owns the range
+// [First, First + Capacity) of its batch's instances, and each segment is a single instance, so
+// Instances.Data[First + iii] is the segment between points iii and iii + 1
+struct Polyline2D
+{
+	unsigned int Batch = 0;
+	unsigned int First = 0;
+	unsigned int Count = 0;
+	unsigned int Capacity = 0;
+	unsigned int Clip = 0;
+	std::uint16_t ZOrder = 0xFFFF;
+	bool Alive = false;
+};
+
+// The instances of all polylines of a render layer. Ranges are handed out by Ranges (in instances), and instances
+// that are not segments (the unused end of each range and the ranges of unregistered polylines) are hidden, so the
+// batch can always draw all of its instances
+struct PolylineBatch2D
+{
+	InstanceList2D Instances;
+	BufferAllocator Ranges{ 0, 1 };
+	std::unique_ptr<StructuredBufferMapped<UIObjectData>> Buffer = nullptr;
+	unsigned int RenderLayerIndex = 0;
+	unsigned int RenderItemIndex = 0;
 };
 
 struct RenderObject2D
@@ -134,15 +236,57 @@ struct RenderObject2D
 	unsigned int RenderLayerIndex = 0;
 	unsigned int RenderItemIndex = 0;
 
-	// Hold data for which vector will hold transformation data
-	std::vector<UIObjectData>* ObjectDataVector = nullptr;
-	unsigned int			   ObjectDataIndex = 0;
+	// Hold data for which instance list holds the object's instance data (nullptr for geometry that does not
+	// have instance data yet) and where in that list it currently lives. The index changes when other
+	// objects in the same list are unregistered (see UIRenderer::UnregisterObject)
+	InstanceList2D* Instances = nullptr;
+	unsigned int	ObjectDataIndex = 0;
+
+	// Slot allocation
+	unsigned int Generation = 0;
+	bool Alive = false;
+
+	// Clip rect the object is culled against (see UIRenderer::ClipScope)
+	unsigned int Clip = 0;
+
+	// Draw order (see UIRenderer::MakeSortKey). Sequence is the order in which objects were registered and breaks
+	// ties between objects with the same z-order
+	RenderEffect2D Effect = RenderEffect2D::Opaque;
+	std::uint16_t ZOrder = 0;
+	unsigned int Sequence = 0;
+
+	// Description of the object. Calls to UpdateRectangle/UpdateLine only store these values and the
+	// instance data (position/size/rotation + packed color) is computed once per frame in UIRenderer::CommitDirtyObjects().
+	// NOTE: For lines, Left/Top/Right/Bottom hold x1/y1/x2/y2
+	BasicGeometry2D Geometry = BasicGeometry2D::Rectangle;
+	float Left = 0.0f;
+	float Top = 0.0f;
+	float Right = 0.0f;
+	float Bottom = 0.0f;
+	float Thickness = 0.0f;
+	Color FillColor = {};
+
+	// Style (see UIRenderer::UpdateShapeStyle). Lines ignore the corner radius
+	float CornerRadius = 0.0f;
+	float BorderThickness = 0.0f;
+	Color BorderColor = {};
+
+	// Glyphs only: texel (x | y << 16) of the glyph in the glyph atlas (see UIRenderer::UpdateGlyph)
+	unsigned int GlyphOrigin = 0;
+
+	// Images only: the image in the image atlas (see UIRenderer::AcquireImage)
+	unsigned int Image = 0;
+
+	// Cached layer composites only: offset (in uints) of the layer's pixels in the layer cache
+	unsigned int LayerCacheOffset = 0;
+
+	bool Dirty = false;
 };
 
 class UIRenderer
 {
 public:
-	inline UIRenderer(float windowWidth, float windowHeight) noexcept :
+	inline UIRenderer(float windowWidth, float windowHeight) :
 		m_renderer(),
 		m_orthographicCamera(windowWidth, windowHeight),
 		m_windowWidth(windowWidth),
@@ -152,6 +296,16 @@ public:
 
 		m_renderer.SetViewport({ 0.0f, 0.0f, windowWidth, windowHeight, 0.0f, 1.0f });
 		m_renderer.SetScissorRect({ 0, 0, static_cast<LONG>(windowWidth), static_cast<LONG>(windowHeight) });
+		m_layerCache.OnWindowResize(windowWidth, windowHeight);
+
+		// The window is the root of the clip tree
+		m_clips.push_back({ WindowClip, true, false });
+		m_clipRects.push_back({ 0.0f, 0.0f, windowWidth, windowHeight });
+		m_clipVisibleRects.push_back(m_clipRects.back());
+		m_clipLayers.push_back(NoCachedLayer);
+
+		// Nothing has been drawn yet
+		AddDamage(m_clipRects.back());
 	}
 	UIRenderer(UIRenderer&&) = delete;
 	UIRenderer(const UIRenderer&) = delete;
@@ -165,120 +319,689 @@ public:
 
 		m_renderer.SetViewport({ 0.0f, 0.0f, width, height, 0.0f, 1.0f });
 		m_renderer.SetScissorRect({ 0, 0, static_cast<LONG>(width), static_cast<LONG>(height) });
+		m_layerCache.OnWindowResize(width, height);
 
 		m_orthographicCamera.SetProjection(width, height);
 		m_orthographicCamera.SetPosition(width / 2, -1 * height / 2, 0.0f);
+
+		SetClipRect(WindowClip, { 0.0f, 0.0f, width, height });
+
+		// Resizing the swap chain discards the contents of every back buffer
+		AddDamage({ 0.0f, 0.0f, width, height });
+		MarkDirty();
 	}
 
 	void SetDeviceResources(std::shared_ptr<DeviceResources> deviceResources);
 
-	inline void Update(const Timer& timer, int frameIndex) { m_renderer.Update(timer, frameIndex); }
-	inline void Render(int frameIndex) { m_renderer.Render(frameIndex); }
+	inline void Update(const Timer& timer, int frameIndex) 
+	{ 
+		// Advance all animations. This only writes to the object descriptions, so animated objects get committed
+		// below along with everything else
+		if (!m_animations.Empty())
+			UpdateAnimations(timer.DeltaTime());
+
+		// Write the instance data for every object that changed since the last frame (exactly once per object)
+		CommitDirtyObjects();
+		ResolveClipRects();
+
+		// Drop the cached layers that changed and cache the ones that stopped changing. This (un)registers the
+		// composites of cached layers, so they need to be committed as well
+		UpdateCachedLayers();
+		CommitDirtyObjects();
+
+		// Put the instances back in draw order. This only does any work if something changed the order
+		SortInstances(m_rectangleInstances);
+		SortInstances(m_transparentRectangleInstances);
+		SortInstances(m_overlayRectangleInstances);
+
+		// Drop every instance that is outside the window or its clip rect, so it is neither uploaded nor drawn. The
+		// content of cached layers is drawn by their composites instead, so it gets culled as well
+		CullInstances(m_rectangleInstances, MainPassLayer, m_cullClipRects);
+		CullInstances(m_transparentRectangleInstances, TransparentPassLayer, m_cullClipRects);
+		CullInstances(m_overlayRectangleInstances, OverlayPassLayer, m_clipVisibleRects);
+
+		// The instance buffers' Update functions (called by m_renderer.Update) accumulate into this value
+		m_bytesUploaded = 0;
+		m_renderer.Update(timer, frameIndex); 
+
+		// Layers that are about to be rendered into the layer cache upload their content
+		m_bytesUploaded += m_layerCache.Upload(timer, frameIndex);
+
+		// Any change made before this point has now been copied to the GPU for this frame, so whatever it damaged
+		// must be rendered. Changes made after this point (while processing input, updating the page, etc) will be
+		// picked up next frame. Each back buffer still holds whatever it was last drawn with, so it needs to redraw
+		// everything that was damaged since then (see PrepareRedraw)
+		if (!m_damage.Empty())
+		{
+			for (DamageRegion& damage : m_backBufferDamage)
+				damage.Add(m_damage);
+			m_presentDamage.Add(m_damage);
+			m_damage.Clear();
+			m_framePending = true;
+		}
+		m_dirty = false;
+	}
+
+	// Partial redraw: PrepareRedraw() returns the rects of the back buffer that need to be redrawn (they need to be
+	// cleared before calling Render(), which only draws inside of them) and GetPresentRects() the rects that
+	// changed since the last frame that was presented. Every redraw rect is a full pass over all visible instances,
+	// so more than MaxScissoredRedraws rects, or rects that cover most of their union anyways (see
+	// ScissoredRedrawAreaRatio), get redrawn as their union instead
+	ND std::span<const D3D12_RECT> PrepareRedraw(int backBufferIndex);
+	ND constexpr std::span<const RECT> GetPresentRects() const noexcept { return m_presentRects; }
+	void Render(int frameIndex);
+
+	// On-demand rendering: Anything that changes what will be drawn must call MarkDirty(). Anything that
+	// changes every frame (i.e. animations) should call BeginAnimation() when it starts and EndAnimation()
+	// when it finishes so that frames keep getting updated while it is active. NeedsRender() is only true when
+	// the last Update() damaged part of the window, and NeedsUpdate() when there are changes that have not been
+	// committed yet (or cached layers that are waiting to be cached) - a frame that doesn't need to be rendered
+	// should therefore only block if nothing needs an update
+	ND constexpr bool NeedsRender() const noexcept { return m_framePending; }
+	ND constexpr bool NeedsUpdate() const noexcept { return m_dirty || m_activeAnimations > 0 || !m_animations.Empty() || m_layerCache.HasLayersWaiting(); }
+	inline void MarkDirty() noexcept 
+	{ 
+		if (DrawList2D* list = RecordingDrawList()) [[unlikely]]
+		{
+			list->MarkDirty();
+			return;
+		}
+		m_dirty = true; 
+	}
+	constexpr void BeginAnimation() noexcept { ++m_activeAnimations; }
+	inline void EndAnimation() noexcept 
+	{ 
+		ASSERT(m_activeAnimations > 0, "Called EndAnimation() more times than BeginAnimation()");
+		--m_activeAnimations; 
+		MarkDirty(); // Make sure the final state of the animation gets rendered
+	}
+
+	// Tweens - All active tweens are advanced together once per frame (see AnimationSystem). Animating a render
+	// object property takes precedence over the owning control, but if the control commits a new visual while the
+	// tween is active, the tween will overwrite that property again on the next frame
+	inline AnimationId AnimateObject(unsigned int uuid, AnimatedProperty property, float start, float end, float duration, Easing easing = Easing::Linear)
+	{
+		ASSERT(IsValidObject(uuid), "Invalid or stale object handle");
+		return m_animations.Add({ AnimationTargetType::RenderObject, property, uuid, nullptr }, start, end, duration, easing);
+	}
+	// NOTE: Nothing gets notified when the value changes. Don't use this for values that something else depends on,
+	// like a Row/Column Value (use Layout::AnimateRow/AnimateColumn, which readjust the layout every frame)
+	inline AnimationId AnimateValue(float* value, float start, float end, float duration, Easing easing = Easing::Linear)
+	{
+		return m_animations.Add({ AnimationTargetType::Value, AnimatedProperty::Left, 0, value }, start, end, duration, easing);
+	}
+	// Calls apply(context, index, value) every frame with the current value of the tween
+	inline AnimationId AnimateCallback(void (*apply)(void*, unsigned int, float), void* context, unsigned int index, float start, float end, float duration, Easing easing = Easing::Linear)
+	{
+		return m_animations.Add({ AnimationTargetType::Callback, AnimatedProperty::Left, 0, nullptr, apply, context, index }, start, end, duration, easing);
+	}
+	inline bool CancelAnimation(AnimationId id) noexcept { return m_animations.Cancel(id); }
+	ND inline bool IsAnimating(AnimationId id) const noexcept { return m_animations.IsActive(id); }
 
 	void InitializeRenderer();
 	ND constexpr float GetWindowWidth() const noexcept { return m_windowWidth; }
 	ND constexpr float GetWindowHeight() const noexcept { return m_windowHeight; }
 
-	unsigned int RegisterObject(RenderEffect2D effect, BasicGeometry2D geometry)
+	// All objects registered while a LayerScope is alive get placed in that scope's layer
+	ND constexpr RenderLayer2D GetCurrentLayer() const noexcept { return m_currentLayer; }
+	class LayerScope
 	{
-		RenderObject2D& ro = m_renderObjects.emplace_back();
-		ro.RenderPassIndex = 0;
-
-		switch (effect)
+	public:
+		inline LayerScope(UIRenderer& renderer, RenderLayer2D layer) noexcept :
+			m_renderer(renderer),
+			m_previousLayer(renderer.m_currentLayer)
 		{
-		case RenderEffect2D::Opaque:	  ro.RenderLayerIndex = 0; break;
-		case RenderEffect2D::Transparent: ro.RenderLayerIndex = 1; break;
+			m_renderer.m_currentLayer = layer;
 		}
+		inline ~LayerScope() noexcept { m_renderer.m_currentLayer = m_previousLayer; }
+		LayerScope(const LayerScope&) = delete;
+		LayerScope(LayerScope&&) = delete;
+		LayerScope& operator=(const LayerScope&) = delete;
+		LayerScope& operator=(LayerScope&&) = delete;
+
+	private:
+		UIRenderer&	  m_renderer;
+		RenderLayer2D m_previousLayer;
+	};
 
-		switch (geometry)
+	// Clip rects form a tree: each Layout registers one for its rect (as a child of the clip of the layout it is in),
+	// and an object is only drawn if it overlaps the intersection of its clip rect with all of its ancestors'. Clip 0
+	// is the window. The intersected rects are also uploaded as a table that every instance indexes, so objects
+	// that are partially outside their clip get clipped on the GPU without splitting the instanced draw. Objects
+	// and clips registered while a ClipScope is alive get that scope's clip (or parent).
+	// Clip handles carry a generation just like object handles, so a stale handle is caught instead of silently
+	// affecting whatever clip reuses the slot (objects and clips given a stale clip fall back to the window).
+	// SetObjectClip()/SetClipParent() move existing objects/clips into another clip (i.e. when a pooled control is
+	// handed out to a different layout, see ControlPool)
+	static constexpr unsigned int WindowClip = 0;
+	unsigned int RegisterClip(const Rect& rect);
+	ND constexpr unsigned int GetCurrentClip() const noexcept { return m_currentClip; }
+	void UnregisterClip(unsigned int clip) noexcept;
+	void SetClipRect(unsigned int clip, const Rect& rect) noexcept;
+	void SetClipParent(unsigned int clip, unsigned int parent);
+	void SetObjectClip(unsigned int uuid, unsigned int clip);
+	ND inline bool IsValidClip(unsigned int clip) const noexcept
+	{
+		const unsigned int index = HandleIndex(clip);
+		return index < m_clips.size() && m_clips[index].Alive && m_clips[index].Generation == HandleGeneration(clip);
+	}
+
+	class ClipScope
+	{
+	public:
+		inline ClipScope(UIRenderer& renderer, unsigned int clip) noexcept :
+			m_renderer(renderer),
+			m_previousClip(renderer.m_currentClip)
 		{
-		case BasicGeometry2D::Line:
-		case BasicGeometry2D::Rectangle: 
-			ro.RenderItemIndex = 0; 
-			ro.ObjectDataVector = &m_rectangleRenderItemTransforms;
-			ro.ObjectDataIndex = static_cast<unsigned int>(m_rectangleRenderItemTransforms.size());
-			m_rectangleRenderItemTransforms.emplace_back();
-			break;
-		case BasicGeometry2D::Circle:	 ro.RenderItemIndex = 1; break;
-		case BasicGeometry2D::Triangle:  ro.RenderItemIndex = 2; break;
+			m_renderer.m_currentClip = clip;
 		}
+		inline ~ClipScope() noexcept { m_renderer.m_currentClip = m_previousClip; }
+		ClipScope(const ClipScope&) = delete;
+		ClipScope(ClipScope&&) = delete;
+		ClipScope& operator=(const ClipScope&) = delete;
+		ClipScope& operator=(ClipScope&&) = delete;
+
+	private:
+		UIRenderer&	 m_renderer;
+		unsigned int m_previousClip;
+	};
 
-		// Increment the instance count for the render item
-		RenderPass& pass = m_renderer.GetRenderPass(ro.RenderPassIndex);
-		RenderPassLayer& layer = pass.GetRenderPassLayer(ro.RenderLayerIndex);
-		RenderItem& renderItem = layer.GetRenderItem(ro.RenderItemIndex);
-		renderItem.SetInstanceCount(renderItem.GetInstanceCount() + 1);
+	// Cached layers: marking a clip as cached (see Layout::SetCached) turns everything in it and in the clips nested
+	// in it into a layer. Once nothing in the layer has changed for LayerCache::FramesBeforeCaching updates, its
+	// content is rendered once into the layer cache, and from then on it is drawn as a single quad until anything in
+	// it changes again. Only main layer objects are cached - overlay objects and polylines in the clip are still
+	// drawn as usual. The layer cache holds GetLayerCacheBudget() bytes (4 per pixel). When a layer does not fit, the
+	// cached layers that have been off screen the longest get evicted, and a layer that still does not fit is simply
+	// not cached. Nested cached clips are part of the outermost layer.
+	// NOTE: The quad is drawn at the lowest z-order of the layer's content, so anything outside of the layer that
+	// overlaps it at a z-order in between the layer's lowest and highest one ends up on top of the whole layer once
+	// it is cached. Only cache clips whose content is not interleaved with anything else (see LayerCache)
+	// NOTE: Layers are rendered at their position in the window, so moving/resizing a layer renders it again
+	void SetClipCached(unsigned int clip, bool cached);
+	ND inline bool IsClipCached(unsigned int clip) const noexcept { return IsValidClip(clip) && m_clips[HandleIndex(clip)].CachedLayer != NoCachedLayer; }
+	void SetLayerCacheBudget(size_t bytes);
+	ND constexpr size_t GetLayerCacheBudget() const noexcept { return m_layerCache.GetBudget(); }
+	ND constexpr size_t GetLayerCacheBytesUsed() const noexcept { return m_layerCache.GetBytesUsed(); }
+
+	// Separate redraw rects only pay off when there are few of them and they are far apart: redrawing the pixels in
+	// between is cheap next to another pass over every instance
+	static constexpr size_t MaxScissoredRedraws = 3;
+	static constexpr float ScissoredRedrawAreaRatio = 0.5f;
 
-		ASSERT(m_renderObjects.size() > 0, "Should not be empty");
-		return static_cast<unsigned int>(m_renderObjects.size() - 1);
+private:
+	// Draw list that the calling thread is recording into (if any - see DrawListScope). It is per thread rather than
+	// per renderer, so it also records which renderer it belongs to
+	struct DrawListBinding2D
+	{
+		const UIRenderer* Renderer = nullptr;
+		DrawList2D* List = nullptr;
+	};
+	static inline thread_local DrawListBinding2D s_drawList = {};
+
+public:
+	// Draw lists (see DrawList2D) let several threads build render data at the same time. While a DrawListScope is
+	// alive, every UpdateRectangle/UpdateLine/UpdateGlyph/UpdateShapeStyle/SetObjectZOrder/SetClipRect/MarkDirty call
+	// that the calling thread makes on this renderer is appended to the scope's draw list instead of being applied.
+	// Nothing else may be called on the renderer while recording: registering/unregistering objects, clips or
+	// polylines and using the glyph cache must stay on the thread that owns the renderer (and assert otherwise).
+	// SubmitDrawList() must be called on the owning thread as well. Submitting lists in a fixed order makes the
+	// result independent of which thread recorded what and when (see Layout::SetParallelCommit)
+	class DrawListScope
+	{
+	public:
+		inline DrawListScope(UIRenderer& renderer, DrawList2D& list) noexcept :
+			m_previous(s_drawList)
+		{
+			s_drawList = { &renderer, &list };
+		}
+		inline ~DrawListScope() noexcept { s_drawList = m_previous; }
+		DrawListScope(const DrawListScope&) = delete;
+		DrawListScope(DrawListScope&&) = delete;
+		DrawListScope& operator=(const DrawListScope&) = delete;
+		DrawListScope& operator=(DrawListScope&&) = delete;
+
+	private:
+		DrawListBinding2D m_previous;
+	};
+	ND inline bool IsRecording() const noexcept { return RecordingDrawList() != nullptr; }
+	void SubmitDrawList(const DrawList2D& list);
+
+	// Objects are referenced by handles: the low bits hold the slot index into m_renderObjects and the high bits
+	// hold the slot's generation. Unregistering an object frees its slot and bumps the generation, so any stale
+	// handle to the old object can be detected instead of silently modifying whatever object reuses the slot
+	unsigned int RegisterObject(RenderEffect2D effect, BasicGeometry2D geometry);
+	void UnregisterObject(unsigned int uuid) noexcept;
+	ND inline bool IsValidObject(unsigned int uuid) const noexcept
+	{
+		const unsigned int index = HandleIndex(uuid);
+		return index < m_renderObjects.size() && m_renderObjects[index].Alive && m_renderObjects[index].Generation == HandleGeneration(uuid);
 	}
-	void UnregisterObject(unsigned int uuid)
+	ND constexpr size_t LiveObjectCount() const noexcept { return m_renderObjects.size() - m_freeObjectSlots.size(); }
+
+	// Text (see RenderText2D). The glyph cache is created along with the renderer (see SetDeviceResources)
+	ND inline GlyphCache& GetGlyphCache() noexcept
+	{
+		ASSERT(!IsRecording(), "The glyph cache cannot be used while recording a draw list");
+		ASSERT(m_glyphCache != nullptr, "The glyph cache does not exist until the device resources are set");
+		return *m_glyphCache;
+	}
+
+	// Images (see RenderImage2D). Images are loaded through the AssetManager (RGBA8 or BGRA8 DDS textures, only the
+	// top mip is used) and copied into the image atlas, so every image quad is drawn by the same instanced draw as
+	// rectangles and text without binding anything per image. Acquiring an image that is already in the atlas only
+	// adds a reference, and the image leaves the atlas once every reference is released. Throws if the texture has an
+	// unsupported format (including the _SRGB ones, which the atlas cannot decode), is larger than an atlas page
+	// (ImageAtlas::PageSize) or if the atlas is full
+	ND unsigned int AcquireImage(std::string_view filename);
+	void ReleaseImage(unsigned int image) noexcept;
+	ND inline std::pair<unsigned int, unsigned int> GetImageSize(unsigned int image) const noexcept
 	{
+		const unsigned int size = m_imageAtlas.GetImage(image).Size;
+		return { size & 0xFFFF, size >> 16 };
+	}
+	ND constexpr const ImageAtlas& GetImageAtlas() const noexcept { return m_imageAtlas; }
+
+	// Number of bytes of instance data that were copied to the GPU during the most recent call to Update(). For a
+	// UI that is not changing, this should be 0
+	ND constexpr size_t GetBytesUploadedLastUpdate() const noexcept { return m_bytesUploaded; }
 
-		// When we unregister an object -> need to check if render items are 0 for ALL
-		// render items in the layer, if so, it needs to be marked inactive
+	// Draws the same instances (as of the last call to Update()) with the same layers and pipeline states as the UI
+	// render pass, but on the CPU (see SoftwareRenderer2D). Used for golden images and UI snapshots. The target is
+	// not cleared first, so call SoftwareRenderer2D::Clear() before this
+	void RenderSoftware(SoftwareRenderer2D& target) const;
 
-		// Similarly, when registering an object, need to mark the layer as active if
-		// its the first object in the layer
+	inline void UpdateRectangle(unsigned int uuid, float left, float top, float right, float bottom, const Color& color)
+	{
+		ASSERT(IsValidObject(uuid), "Invalid or stale object handle");
 
+		if (DrawList2D* list = RecordingDrawList()) [[unlikely]]
+		{
+			list->RecordRectangle(uuid, left, top, right, bottom, color);
+			return;
+		}
+
+		const unsigned int index = HandleIndex(uuid);
+		RenderObject2D& ro = m_renderObjects[index];
+		ro.Left = left;
+		ro.Top = top;
+		ro.Right = right;
+		ro.Bottom = bottom;
+		ro.FillColor = color;
+		QueueCommit(index);
 	}
-	void UpdateRectangle(unsigned int uuid, float left, float top, float right, float bottom, const Color& color)
+	inline void UpdateLine(unsigned int uuid, float x1, float y1, float x2, float y2, const Color& color, float thickness)
 	{
-		using namespace DirectX;
+		ASSERT(IsValidObject(uuid), "Invalid or stale object handle");
 
-		ASSERT(uuid < m_renderObjects.size(), "UUID too large");
+		if (DrawList2D* list = RecordingDrawList()) [[unlikely]]
+		{
+			list->RecordLine(uuid, x1, y1, x2, y2, color, thickness);
+			return;
+		}
 
-		std::vector<UIObjectData>& vec = *m_renderObjects[uuid].ObjectDataVector;
-		UIObjectData& data = vec[m_renderObjects[uuid].ObjectDataIndex];
+		const unsigned int index = HandleIndex(uuid);
+		RenderObject2D& ro = m_renderObjects[index];
+		ro.Left = x1;
+		ro.Top = y1;
+		ro.Right = x2;
+		ro.Bottom = y2;
+		ro.FillColor = color;
+		ro.Thickness = thickness;
+		QueueCommit(index);
+	}
 
-		XMMATRIX world = XMMatrixScaling(right - left, bottom - top, 1.0f) * XMMatrixTranslation(left, -top, 0.0f);
-		XMStoreFloat4x4(&data.World, XMMatrixTranspose(world));
+	// Glyphs are drawn as (region.Width x region.Height) rectangles at (left, top) that take their coverage from
+	// the given region of the glyph atlas. left/top should be whole pixels (see RenderText2D)
+	inline void UpdateGlyph(unsigned int uuid, float left, float top, const GlyphAtlas::Region& region, const Color& color)
+	{
+		ASSERT(IsValidObject(uuid), "Invalid or stale object handle");
 
-		data.Color = { color.R, color.G, color.B, color.A };
+		const float right = left + region.Width;
+		const float bottom = top + region.Height;
+		const unsigned int glyphOrigin = static_cast<unsigned int>(region.X) | (static_cast<unsigned int>(region.Y) << 16);
+		if (DrawList2D* list = RecordingDrawList()) [[unlikely]]
+		{
+			list->RecordGlyph(uuid, left, top, right, bottom, glyphOrigin, color);
+			return;
+		}
+		SetGlyph(HandleIndex(uuid), left, top, right, bottom, glyphOrigin, color);
 	}
-	void UpdateLine(unsigned int uuid, float x1, float y1, float x2, float y2, const Color& color, float thickness)
+
+	// Images are stretched over the (left, top, right, bottom) rectangle and multiplied by the tint. The image must
+	// have been acquired (see AcquireImage). Like rectangles, images can have rounded corners (see UpdateShapeStyle),
+	// but they do not have a border
+	inline void UpdateImage(unsigned int uuid, float left, float top, float right, float bottom, unsigned int image, const Color& tint)
 	{
-		using namespace DirectX;
+		ASSERT(IsValidObject(uuid), "Invalid or stale object handle");
 
-		ASSERT(uuid < m_renderObjects.size(), "UUID too large");
+		if (DrawList2D* list = RecordingDrawList()) [[unlikely]]
+		{
+			list->RecordImage(uuid, left, top, right, bottom, image, tint);
+			return;
+		}
+		SetImage(HandleIndex(uuid), left, top, right, bottom, image, tint);
+	}
 
-		std::vector<UIObjectData>& vec = *m_renderObjects[uuid].ObjectDataVector;
-		UIObjectData& data = vec[m_renderObjects[uuid].ObjectDataIndex];
+	// Rounded corners and borders. Rectangles, circles and lines are all drawn by the same instanced draw as signed
+	// distance shapes, so styling an object does not cost anything extra
+	inline void UpdateShapeStyle(unsigned int uuid, float cornerRadius, float borderThickness, const Color& borderColor)
+	{
+		ASSERT(IsValidObject(uuid), "Invalid or stale object handle");
 
-		// 1. translate the original rectangle up 0.5 so it is centered on the y-axis
-		// 2. scale the x direction to the length of the line and the y-direction to the thickness of the line
-		// 3. rotate the line around the z-axis so it points in the direction it should
-		// 4. translate the line to its final position
-		XMMATRIX world =
-			XMMatrixTranslation(0.0f, 0.5f, 0.0f) *
-			XMMatrixScaling(static_cast<float>(std::sqrt(std::pow(x2 - x1, 2) + std::pow(y2 - y1, 2))), thickness, 1.0f) *
-			XMMatrixRotationZ(-std::atan2(y2 - y1, x2 - x1)) *
-			XMMatrixTranslation(x1, -y1, 0.0f);
-		XMStoreFloat4x4(&data.World, XMMatrixTranspose(world));
+		if (DrawList2D* list = RecordingDrawList()) [[unlikely]]
+		{
+			list->RecordShapeStyle(uuid, cornerRadius, borderThickness, borderColor);
+			return;
+		}
 
-		data.Color = { color.R, color.G, color.B, color.A };
+		const unsigned int index = HandleIndex(uuid);
+		RenderObject2D& ro = m_renderObjects[index];
+		ro.CornerRadius = cornerRadius;
+		ro.BorderThickness = borderThickness;
+		ro.BorderColor = borderColor;
+		QueueCommit(index);
 	}
 
+	// Objects with a higher z-order are drawn on top of objects with a lower z-order. Objects with the same z-order
+	// keep their previous behavior: for opaque objects, the one registered first wins, and transparent objects are
+	// drawn on top of opaque ones. Polylines have a z-order of their own (see SetPolylineZOrder)
+	inline void SetObjectZOrder(unsigned int uuid, std::uint16_t zOrder)
+	{
+		ASSERT(IsValidObject(uuid), "Invalid or stale object handle");
+
+		if (DrawList2D* list = RecordingDrawList()) [[unlikely]]
+		{
+			list->RecordZOrder(uuid, zOrder);
+			return;
+		}
+
+		const unsigned int index = HandleIndex(uuid);
+		RenderObject2D& ro = m_renderObjects[index];
+		if (ro.ZOrder == zOrder)
+			return;
+
+		ro.ZOrder = zOrder;
+		if (ro.Instances != nullptr)
+			ro.Instances->OrderDirty = true;
+		QueueCommit(index);
+	}
 
+	// Batch versions of UpdateRectangle/UpdateLine: uuids[iii] gets the iii'th description of the batch (see
+	// UIInstanceBuilder.h). Unlike the single object versions, the instance data is written right away instead of
+	// being built in CommitDirtyObjects(), which makes moving a large number of existing objects a single pass
+	void UpdateRectangles(std::span<const unsigned int> uuids, const RectangleBatch2D& rectangles);
+	void UpdateLines(std::span<const unsigned int> uuids, const LineBatch2D& lines);
+
+	// Polylines (see RenderPolyline2D). Like objects, a polyline is placed in the layer of the current LayerScope.
+	// UpdatePolylineSegments() overwrites the segments starting at firstSegment and drops every segment after the
+	// last one given, so appending to a polyline only needs to send the new segments. All polylines of a layer are
+	// drawn together, so overlapping polylines are not drawn in any particular order. Main layer polylines are
+	// depth tested like transparent objects: objects with a higher z-order hide them. Their z-order defaults to the
+	// highest one, which draws them on top of the rest of the main layer
+	unsigned int RegisterPolyline();
+	void UnregisterPolyline(unsigned int id) noexcept;
+	void UpdatePolylineSegments(unsigned int id, size_t firstSegment, std::span<const UIObjectData> segments);
+	void SetPolylineZOrder(unsigned int id, std::uint16_t zOrder);
 
 private:
+	static constexpr unsigned int HandleIndexBits = 20;
+	static constexpr unsigned int HandleIndexMask = (1u << HandleIndexBits) - 1;
+	static constexpr unsigned int HandleGenerationMask = (1u << (32 - HandleIndexBits)) - 1;
+	ND static constexpr unsigned int MakeHandle(unsigned int index, unsigned int generation) noexcept { return (generation << HandleIndexBits) | index; }
+	ND static constexpr unsigned int HandleIndex(unsigned int uuid) noexcept { return uuid & HandleIndexMask; }
+	ND static constexpr unsigned int HandleGeneration(unsigned int uuid) noexcept { return uuid >> HandleIndexBits; }
+
+	// Layers of the UI render pass, in the order they are drawn
+	static constexpr unsigned int MainPassLayer = 0;
+	static constexpr unsigned int OpaqueFringePassLayer = 1;
+	static constexpr unsigned int TransparentPassLayer = 2;
+	static constexpr unsigned int MainPolylinePassLayer = 3;
+	static constexpr unsigned int OverlayPassLayer = 4;
+
+	// 64-bit draw order key. Instances are drawn in ascending key order:
+	//     [63:60] layer | [59:44] depth | [43:40] pipeline | [39:24] texture | [23:0] sequence
+	// The layer and pipeline are constant within an instance list today and the only textures are the atlases, but
+	// having them in the key means lists can later be merged/batched by sorting without changing the key. Because the
+	// texture comes before the sequence, text and images are drawn on top of shapes with the same z-order
+	ND static constexpr std::uint64_t MakeSortKey(unsigned int layer, unsigned int depth, unsigned int pipeline, unsigned int texture, unsigned int sequence) noexcept
+	{
+		return (static_cast<std::uint64_t>(layer & 0xF) << 60) |
+			(static_cast<std::uint64_t>(depth & 0xFFFF) << 44) |
+			(static_cast<std::uint64_t>(pipeline & 0xF) << 40) |
+			(static_cast<std::uint64_t>(texture & 0xFFFF) << 24) |
+			static_cast<std::uint64_t>(sequence & 0xFFFFFF);
+	}
+	static constexpr unsigned int GlyphAtlasTexture = 1;
+	static constexpr unsigned int LayerCacheTexture = 2;
+	static constexpr unsigned int ImageAtlasTexture = 3;
+	ND static constexpr unsigned int SortKeyTexture(const RenderObject2D& ro) noexcept
+	{
+		switch (ro.Geometry)
+		{
+		case BasicGeometry2D::Glyph:		return GlyphAtlasTexture;
+		case BasicGeometry2D::CachedLayer:	return LayerCacheTexture;
+		case BasicGeometry2D::Image:		return ImageAtlasTexture;
+		default:							return 0;
+		}
+	}
+	ND static constexpr std::uint64_t MakeSortKey(const RenderObject2D& ro) noexcept
+	{
+		// Opaque objects in the main layer go front-to-back (so the depth test can reject what they hide) and
+		// everything else goes back-to-front (so blending composites correctly)
+		const unsigned int depth = (ro.RenderLayerIndex == MainPassLayer) ? 0xFFFFu - ro.ZOrder : ro.ZOrder;
+		return MakeSortKey(ro.RenderLayerIndex, depth, static_cast<unsigned int>(ro.Effect), SortKeyTexture(ro), ro.Sequence);
+	}
+
+	ND inline DrawList2D* RecordingDrawList() const noexcept { return s_drawList.Renderer == this ? s_drawList.List : nullptr; }
+
+	inline void SetGlyph(unsigned int index, float left, float top, float right, float bottom, unsigned int glyphOrigin, const Color& color)
+	{
+		RenderObject2D& ro = m_renderObjects[index];
+		ro.Left = left;
+		ro.Top = top;
+		ro.Right = right;
+		ro.Bottom = bottom;
+		ro.FillColor = color;
+		ro.GlyphOrigin = glyphOrigin;
+		QueueCommit(index);
+	}
+	inline void SetImage(unsigned int index, float left, float top, float right, float bottom, unsigned int image, const Color& tint)
+	{
+		RenderObject2D& ro = m_renderObjects[index];
+		ro.Left = left;
+		ro.Top = top;
+		ro.Right = right;
+		ro.Bottom = bottom;
+		ro.FillColor = tint;
+		ro.Image = image;
+		QueueCommit(index);
+	}
+	inline void QueueCommit(unsigned int index)
+	{
+		// Only queue the object the first time it is changed this frame. Any subsequent changes just overwrite
+		// the description and will get picked up by the same commit
+		RenderObject2D& ro = m_renderObjects[index];
+		if (!ro.Dirty)
+		{
+			ro.Dirty = true;
+			m_dirtyObjects.push_back(index);
+		}
+		MarkDirty();
+	}
+	void RefreshLayerActive(RenderPassLayer& layer) noexcept;
+
+	// Polyline ranges (see PolylineBatch2D). MovePolyline() gives the polyline a range of capacity instances and keeps
+	// its first keep segments. Batches larger than MinCompactedPolylineBatch get compacted once less than a quarter
+	// of them is in use
+	static constexpr size_t MinCompactedPolylineBatch = 4096;
+	void MovePolyline(Polyline2D& polyline, unsigned int keep, unsigned int capacity);
+	void CompactPolylineBatch(unsigned int batchIndex);
+	void HidePolylineInstances(PolylineBatch2D& batch, unsigned int first, unsigned int last) noexcept;
+	void RefreshPolylineBatch(PolylineBatch2D& batch);
+
+	void CommitDirtyObjects();
+	template<typename F>
+	void CommitInPlace(unsigned int index, F&& write);
+	void SortInstances(InstanceList2D& instances);
+	void ResolveClipRects() noexcept;
+	void CullInstances(InstanceList2D& instances, unsigned int layerIndex, std::span<const Rect> clipRects);
+	void UpdateAnimations(float deltaTime) noexcept;
+	ND Rect SnapToWindowPixels(const Rect& rect) const noexcept;
+	void AddDamage(const Rect& rect);
+	void AddInstanceDamage(const UIObjectData& instance);
+	void CopyPendingImages(ID3D12GraphicsCommandList* commandList);
+
+	// Cached layers (see SetClipCached). The layer cache decides which layers get cached, and the renderer gives
+	// each of them their content and a composite
+	inline void InvalidateCachedLayer(unsigned int clip) noexcept
+	{
+		const unsigned int layer = (clip < m_clipLayers.size()) ? m_clipLayers[clip] : NoCachedLayer;
+		if (layer != NoCachedLayer)
+			m_layerCache.Invalidate(layer);
+	}
+	void UpdateCachedLayers();
+	void GatherCachedLayerContent();
+
 	Renderer			m_renderer;
 	OrthographicCamera	m_orthographicCamera;
 	std::shared_ptr<DeviceResources> m_deviceResources = nullptr;
 	float m_windowWidth;
 	float m_windowHeight;
 
+	// On-demand rendering state
+	bool m_dirty = true;
+	bool m_framePending = false;
+	unsigned int m_activeAnimations = 0;
 
-	// All Object Data
-	std::vector<RenderObject2D> m_renderObjects;
+	// Partial redraw state. m_damage collects what changed (in whole pixels) until the next Update() hands it to
+	// every back buffer's region and to m_presentDamage. Rendering a back buffer redraws (and then clears) its region
+	DamageRegion m_damage;
+	DamageRegion m_presentDamage;
+	std::array<DamageRegion, DeviceResources::SwapChainBufferCount> m_backBufferDamage;
+	std::vector<D3D12_RECT> m_redrawRects;
+	std::vector<RECT> m_presentRects;
+
+	AnimationSystem m_animations;
 
-	// vector of world matrices
-	std::vector<UIObjectData> m_rectangleRenderItemTransforms;
+	// All Object Data. Slots of unregistered objects are kept in m_freeObjectSlots for reuse
+	std::vector<RenderObject2D> m_renderObjects;
+	std::vector<unsigned int> m_freeObjectSlots;
+
+	// Layer that newly registered objects are placed in (see LayerScope)
+	RenderLayer2D m_currentLayer = RenderLayer2D::Main;
+
+	// Instance data (see UIObjectData) for each render item
+	InstanceList2D m_rectangleInstances;
+	InstanceList2D m_transparentRectangleInstances;
+	InstanceList2D m_overlayRectangleInstances;
+
+	// Clip tree (see RegisterClip). m_clipRects holds the rect each clip was given and m_clipVisibleRects the
+	// intersection with all of its ancestors, which is what objects get culled against. m_clipLayers holds the
+	// cached layer (if any) that each clip is part of. Everything in here (and in UIObjectData::Clip) is indexed by
+	// the clip's slot - only the public functions deal with clip handles. m_currentClip is a handle
+	static constexpr unsigned int NoCachedLayer = LayerCache::NoLayer;
+	struct ClipNode2D
+	{
+		unsigned int Parent = WindowClip;
+		bool Alive = false;
+		bool Resolved = false;
+		unsigned int CachedLayer = NoCachedLayer; // The layer this clip is the root of (see SetClipCached)
+		unsigned int Generation = 0;
+	};
+	ND inline unsigned int ClipIndex(unsigned int clip) const noexcept { return IsValidClip(clip) ? HandleIndex(clip) : WindowClip; }
+	ND inline unsigned int ClipHandle(unsigned int index) const noexcept { return MakeHandle(index, m_clips[index].Generation); }
+	std::vector<ClipNode2D> m_clips;
+	std::vector<Rect> m_clipRects;
+	std::vector<Rect> m_clipVisibleRects;
+	std::vector<unsigned int> m_clipLayers;
+	std::vector<unsigned int> m_freeClipSlots;
+	unsigned int m_currentClip = WindowClip;
+	bool m_clipsDirty = true;
+
+	// GPU copy of m_clipVisibleRects (left, top, right, bottom). Each frame resource is rewritten once after the
+	// clips change
+	std::unique_ptr<StructuredBufferMapped<DirectX::XMFLOAT4>> m_clipBuffer = nullptr;
+	std::array<bool, g_numFrameResources> m_clipBufferDirty = {};
+
+	// Scratch space for CullInstances(). The main layer gets culled against m_cullClipRects, which is
+	// m_clipVisibleRects with the clips of cached layers replaced by a rect that nothing overlaps
+	std::vector<unsigned int> m_cullClipIndices;
+	std::vector<unsigned int> m_cullVisible;
+	std::vector<Rect> m_cullClipRects;
+	bool m_cullClipRectsDirty = true;
+
+	// Cached layers (see SetClipCached and LayerCache)
+	LayerCache m_layerCache;
+
+	// Registration counter (see RenderObject2D::Sequence). It wraps after 2^24 objects, after which objects with
+	// the same z-order may swap places once
+	unsigned int m_nextSequence = 0;
+
+	// Scratch space for SortInstances()
+	RadixSort m_radixSort;
+	std::vector<std::uint64_t> m_sortKeys;
+	std::vector<unsigned int> m_sortOrder;
+	std::vector<UIObjectData> m_sortedData;
+	std::vector<unsigned int> m_sortedOwners;
+
+	// Polylines. The batches are created with the render pass (see InitializeRenderer)
+	static constexpr unsigned int MainPolylineBatch = 0;
+	static constexpr unsigned int OverlayPolylineBatch = 1;
+	std::array<PolylineBatch2D, 2> m_polylineBatches;
+	std::vector<Polyline2D> m_polylines;
+	std::vector<unsigned int> m_freePolylineSlots;
+
+	// Slot indices of all objects that have changed since the last commit
+	std::vector<unsigned int> m_dirtyObjects;
+
+	// Scratch space for CommitDirtyObjects(). The descriptions of the dirty objects are gathered into SoA arrays,
+	// built into instance data in one batch, and then scattered into the instance lists
+	struct CommitBatch2D
+	{
+		std::vector<float> Left;
+		std::vector<float> Top;
+		std::vector<float> Right;
+		std::vector<float> Bottom;
+		std::vector<float> Thickness;
+		std::vector<Color> Colors;
+		std::vector<unsigned int> Objects;
+		std::vector<UIObjectData> Instances;
+
+		void Clear() noexcept;
+		void PushBack(const RenderObject2D& ro, unsigned int index);
+	};
+	CommitBatch2D m_rectangleCommits;
+	CommitBatch2D m_lineCommits;
+
+	size_t m_bytesUploaded = 0;
+
+	// Text. The glyph atlas lives in a structured buffer (4 texels per uint) that each frame resource has a copy of.
+	// Rows [first, last) of the atlas still need to be copied to a frame resource's copy
+	std::unique_ptr<GlyphCache> m_glyphCache = nullptr;
+	std::unique_ptr<StructuredBufferMapped<unsigned int>> m_glyphAtlasBuffer = nullptr;
+	std::array<std::pair<unsigned int, unsigned int>, g_numFrameResources> m_glyphAtlasDirtyRows = {};
+
+	// Images (see AcquireImage). The image atlas is a buffer in the default heap that holds every page of
+	// m_imageAtlas (RGBA8, rows of ImageAtlas::PageSize texels), so images can be copied straight out of their
+	// textures. The image table is small and changes rarely, so each frame resource has a mapped copy of it. Images
+	// get copied at the start of the next Render(), and each pending copy holds on to its texture until then
+	struct PendingImageCopy2D
+	{
+		unsigned int Image = 0;
+		Texture Source;
+	};
+	ImageAtlas m_imageAtlas;
+	std::vector<PendingImageCopy2D> m_pendingImageCopies;
+	std::unique_ptr<StructuredBufferDefault> m_imageAtlasBuffer = nullptr;
+	std::unique_ptr<StructuredBufferMapped<UIImageData>> m_imageTableBuffer = nullptr;
+	std::array<bool, g_numFrameResources> m_imageTableDirty = {};
 
 	// 2D Test
 	std::unique_ptr<ConstantBufferMapped<UIPassConstants>>	m_uiPassConstantsBuffer = nullptr;
 	std::unique_ptr<MeshGroup<Vertex>> m_meshGroup = nullptr;
-	std::unique_ptr<ConstantBufferMapped<UIObjectData>> m_uiObjectConstantBuffer = nullptr;
+	std::unique_ptr<StructuredBufferMapped<UIObjectData>> m_uiObjectBuffer = nullptr;
+	std::unique_ptr<StructuredBufferMapped<UIObjectData>> m_uiTransparentObjectBuffer = nullptr;
+	std::unique_ptr<StructuredBufferMapped<UIObjectData>> m_uiOverlayObjectBuffer = nullptr;
 	DirectX::XMFLOAT3 m_eyePosition = {};
 };
 
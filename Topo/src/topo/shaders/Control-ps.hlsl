@@ -1,11 +1,231 @@
+#define SHAPE_BOX 0
+#define SHAPE_ELLIPSE 1
+#define SHAPE_GLYPH 2
+#define SHAPE_LAYER 3
+#define SHAPE_IMAGE 4
+#define SHAPE_SEGMENT 5
+#define SHAPE_TRIANGLE 6
+
+// Must match GlyphAtlas::Width
+#define GLYPH_ATLAS_WIDTH 1024
+
+// Must match ImageAtlas::PageSize and ImageAtlas::SwapRedBlue/IgnoreAlpha
+#define IMAGE_ATLAS_PAGE_SIZE 1024
+#define IMAGE_SWAP_RED_BLUE 1
+#define IMAGE_IGNORE_ALPHA 2
+
+// Must match SegmentNoJoint/SegmentMiterLimit/SegmentJointMargin (UIObjectData.h)
+#define SEGMENT_NO_JOINT 0xFFFF
+#define SEGMENT_MITER_LIMIT 4.0f
+#define SEGMENT_JOINT_MARGIN 1.0f
+
+// The glyph atlas holds one 8-bit coverage value per texel, packed 4 to a uint
+StructuredBuffer<uint> gGlyphAtlas : register(t2);
+
+// The pixels of every cached layer (see UIRenderer::SetClipCached) as RGBA8 with premultiplied alpha. Each row of a
+// layer starts on a 256 byte boundary (D3D12_TEXTURE_DATA_PITCH_ALIGNMENT)
+StructuredBuffer<uint> gLayerCache : register(t3);
+
+// The pages of the image atlas (see ImageAtlas) as RGBA8, one page after the other. Each image instance indexes the
+// image table, which holds the page (x), the texel of the image's top-left corner (y: x | y << 16), the size of
+// the image (z: width | height << 16) and its flags (w)
+StructuredBuffer<uint> gImageAtlas : register(t4);
+StructuredBuffer<uint4> gImages : register(t5);
 
 struct VertexOut
 {
     float4 Position : SV_POSITION;
     float4 Color : COLOR;
+    float4 BorderColor : BORDER_COLOR;
+    float2 Local : LOCAL;
+    nointerpolation float2 HalfSize : HALF_SIZE;
+    nointerpolation float2 Parameters : PARAMETERS;
+    nointerpolation uint Shape : SHAPE;
+    nointerpolation float4 ClipRect : CLIP_RECT;
+    nointerpolation uint GlyphOrigin : GLYPH_ORIGIN;
 };
 
+// Signed distance (in pixels) from p to a box centered on the origin with rounded corners
+float BoxDistance(float2 p, float2 halfSize, float radius)
+{
+    radius = min(radius, min(halfSize.x, halfSize.y));
+    float2 q = abs(p) - halfSize + radius;
+    return length(max(q, 0.0f)) + min(max(q.x, q.y), 0.0f) - radius;
+}
+
+// Approximate signed distance to an ellipse centered on the origin. It is exact for circles and close enough
+// near the edge of an ellipse, which is all that antialiasing and borders need
+float EllipseDistance(float2 p, float2 halfSize)
+{
+    halfSize = max(halfSize, 0.0001f);
+    float k0 = length(p / halfSize);
+    float k1 = length(p / (halfSize * halfSize));
+    return k0 < 0.0001f ? -min(halfSize.x, halfSize.y) : k0 * (k0 - 1.0f) / k1;
+}
+
+// Signed distance to the isosceles triangle that fills the box centered on the origin, with its apex at the top
+// center. Flipping y puts the apex at the origin and the base at y = height, where the distance is the one from
+// https://iquilezles.org/articles/distfunctions2d (exact, so borders have the same thickness on every side)
+float TriangleDistance(float2 p, float2 halfSize)
+{
+    float2 q = float2(halfSize.x, 2.0f * halfSize.y);
+    p = float2(abs(p.x), halfSize.y - p.y);
+    float2 a = p - q * saturate(dot(p, q) / max(dot(q, q), 0.0001f));
+    float2 b = p - q * float2(saturate(p.x / max(q.x, 0.0001f)), 1.0f);
+    float2 d = min(float2(dot(a, a), -(p.x * q.y - p.y * q.x)), float2(dot(b, b), -(p.y - q.y)));
+    return -sqrt(d.x) * sign(d.y);
+}
+
+// Coverage of the glyph at p (relative to the center of the glyph, y up). Glyph quads are placed on whole pixels,
+// so every pixel center falls on exactly one texel and no filtering is needed
+float GlyphCoverage(float2 p, float2 halfSize, uint origin)
+{
+    int2 texel = int2(floor(float2(p.x + halfSize.x, halfSize.y - p.y)));
+    int2 size = int2(2.0f * halfSize + 0.5f);
+    if (any(texel < 0) || any(texel >= size))
+        return 0.0f;
+
+    uint index = ((origin >> 16) + texel.y) * GLYPH_ATLAS_WIDTH + (origin & 0xFFFF) + texel.x;
+    return ((gGlyphAtlas[index >> 2] >> ((index & 3) * 8)) & 0xFF) / 255.0f;
+}
+
+// Color of the cached layer at p (relative to the center of the composite, y up). Like glyphs, composites are
+// placed on whole pixels, so every pixel center falls on exactly one texel of the layer
+float4 LayerColor(float2 p, float2 halfSize, uint offset)
+{
+    int2 texel = int2(floor(float2(p.x + halfSize.x, halfSize.y - p.y)));
+    int2 size = int2(2.0f * halfSize + 0.5f);
+    if (any(texel < 0) || any(texel >= size))
+        return 0.0f;
+
+    uint rowPitch = ((uint(size.x) * 4 + 255) & ~255) / 4;
+    uint color = gLayerCache[offset + texel.y * rowPitch + texel.x];
+    return float4(color & 0xFF, (color >> 8) & 0xFF, (color >> 16) & 0xFF, color >> 24) / 255.0f;
+}
+
+// Texel of the image with premultiplied alpha (so that filtering does not bleed the color of transparent texels).
+// Texels outside of the image are clamped to its edge, so the neighbors of an image on its page never bleed in
+float4 ImageTexel(uint4 image, int2 texel)
+{
+    int2 size = int2(image.z & 0xFFFF, image.z >> 16);
+    texel = clamp(texel, int2(0, 0), size - 1);
+
+    uint index = (image.x * IMAGE_ATLAS_PAGE_SIZE + (image.y >> 16) + texel.y) * IMAGE_ATLAS_PAGE_SIZE + (image.y & 0xFFFF) + texel.x;
+    uint color = gImageAtlas[index];
+    float4 texelColor = float4(color & 0xFF, (color >> 8) & 0xFF, (color >> 16) & 0xFF, color >> 24) / 255.0f;
+    if (image.w & IMAGE_SWAP_RED_BLUE)
+        texelColor = texelColor.bgra;
+    if (image.w & IMAGE_IGNORE_ALPHA)
+        texelColor.a = 1.0f;
+    return float4(texelColor.rgb * texelColor.a, texelColor.a);
+}
+
+// Color of the image at p (relative to the center of the quad, y up). Unlike glyphs, images get stretched over
+// their quad (i.e. icons drawn at a different scale), so the four nearest texels are filtered bilinearly
+float4 ImageColor(float2 p, float2 halfSize, uint index)
+{
+    uint4 image = gImages[index];
+    float2 size = float2(image.z & 0xFFFF, image.z >> 16);
+    float2 uv = float2(p.x + halfSize.x, halfSize.y - p.y) / max(2.0f * halfSize, 0.0001f);
+
+    float2 texel = uv * size - 0.5f;
+    int2 t = int2(floor(texel));
+    float2 f = texel - t;
+    float4 color = lerp(
+        lerp(ImageTexel(image, t), ImageTexel(image, t + int2(1, 0)), f.x),
+        lerp(ImageTexel(image, t + int2(0, 1)), ImageTexel(image, t + int2(1, 1)), f.x),
+        f.y);
+    return color.a > 0.0f ? float4(color.rgb / color.a, color.a) : 0.0f;
+}
+
+// Polyline segments reach past their joints, and each joint cuts the segment along the joint's miter line, which
+// goes through the joint point at the packed angle to the segment's normal (see WriteSegmentInstance). The neighbor
+// keeps exactly the other side of the same line, so every pixel of a joint is drawn once and translucent polylines
+// do not get darker at their joints. The cut is not antialiased, since the neighbor continues the shape past it
+float SegmentJointAngle(uint joint)
+{
+    return (float(joint) - 32767.0f) * (1.5707963f / 32767.0f);
+}
+float SegmentJointExtension(float angle, float halfThickness)
+{
+    return min(abs(tan(angle)), SEGMENT_MITER_LIMIT) * halfThickness + SEGMENT_JOINT_MARGIN;
+}
+bool SegmentKeepsPixel(float2 p, float2 halfSize, uint joints)
+{
+    uint startJoint = joints & 0xFFFF;
+    if (startJoint != SEGMENT_NO_JOINT)
+    {
+        float angle = SegmentJointAngle(startJoint);
+        float2 jointPoint = float2(-halfSize.x + SegmentJointExtension(angle, halfSize.y), 0.0f);
+        if (dot(p - jointPoint, float2(cos(angle), -sin(angle))) <= 0.0f)
+            return false;
+    }
+
+    uint endJoint = joints >> 16;
+    if (endJoint != SEGMENT_NO_JOINT)
+    {
+        float angle = SegmentJointAngle(endJoint);
+        float2 jointPoint = float2(halfSize.x - SegmentJointExtension(angle, halfSize.y), 0.0f);
+        if (dot(p - jointPoint, float2(cos(angle), -sin(angle))) > 0.0f)
+            return false;
+    }
+    return true;
+}
+
 float4 main(VertexOut vin) : SV_TARGET
 {
-    return vin.Color;
-}
\ No newline at end of file
+    // SV_POSITION holds the pixel center (in pixels, y down), just like the clip rect
+    clip(float4(vin.Position.xy - vin.ClipRect.xy, vin.ClipRect.zw - vin.Position.xy));
+
+    if (vin.Shape == SHAPE_SEGMENT && !SegmentKeepsPixel(vin.Local, vin.HalfSize, vin.GlyphOrigin))
+        discard;
+
+    // The layer was blended into transparent black, so its color is premultiplied. Undo that so the composite
+    // blends just like any other transparent shape
+    if (vin.Shape == SHAPE_LAYER)
+    {
+        float4 layer = LayerColor(vin.Local, vin.HalfSize, vin.GlyphOrigin);
+        clip(layer.a - 1.0f / 255.0f);
+        return float4(layer.rgb / layer.a, layer.a);
+    }
+
+    float d;
+    if (vin.Shape == SHAPE_GLYPH)
+        d = 0.5f - GlyphCoverage(vin.Local, vin.HalfSize, vin.GlyphOrigin); // So that the coverage below comes out as the glyph's coverage
+    else if (vin.Shape == SHAPE_ELLIPSE)
+        d = EllipseDistance(vin.Local, vin.HalfSize);
+    else if (vin.Shape == SHAPE_TRIANGLE)
+        d = TriangleDistance(vin.Local, vin.HalfSize);
+    else
+        d = BoxDistance(vin.Local, vin.HalfSize, vin.Parameters.x);
+
+    // Distances are in pixels, so coverage is 1 a half pixel inside the edge and 0 a half pixel outside of it
+    float coverage = saturate(0.5f - d);
+
+    // Images are boxes (so they can have rounded corners) whose color is the image tinted by the fill color
+    float4 color = vin.Color;
+    if (vin.Shape == SHAPE_IMAGE)
+        color *= ImageColor(vin.Local, vin.HalfSize, vin.GlyphOrigin);
+
+    float border = vin.Parameters.y;
+    if (border > 0.0f)
+        color = lerp(color, vin.BorderColor, saturate(d + border + 0.5f));
+
+#if defined(CONTROL_OPAQUE)
+    // Opaque shapes are drawn front-to-back without blending, so only the pixels they fully cover are drawn here.
+    // Their antialiased edge is blended in afterwards by the fringe pass (see ControlFringe-ps.hlsl)
+    clip(-0.5f - d);
+    color.a = 1.0f;
+#else
+#if defined(CONTROL_FRINGE)
+    // The opaque pass already drew the fully covered pixels
+    if (d <= -0.5f)
+        discard;
+#endif
+    color.a *= coverage;
+
+    // Do not let fully transparent pixels write depth (they would hide whatever gets drawn there later)
+    clip(color.a - 1.0f / 255.0f);
+#endif
+    return color;
+}
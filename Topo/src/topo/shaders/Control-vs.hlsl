@@ -1,19 +1,21 @@
- 
-
-// Constant buffers can hold 4096 'vectors'. A vector is a float4
-// 4096 / 5 = 819.2
-#define MAX_INSTANCES 819
-
+// Compact instance data (must match UIObjectData in UIRenderer.h)
 struct PerObjectData
 {
-    float4x4 World;
-    float4 Color;
+    float2 Position;
+    float2 Size;
+    float Rotation;
+    uint Color;         // RGBA8 - R is the lowest byte
+    uint BorderColor;   // RGBA8 (glyphs: texel of the glyph in the glyph atlas - x | y << 16, layers: offset in the layer cache, images: index into gImages, polyline segments: miter angles of the joints)
+    uint Shape;         // bits 0-2: shape, bits 3-7: border thickness (quarter pixels), bits 8-15: corner radius (half pixels), bits 16-31: z-order
+    uint Clip;          // Index into gClipRects
 };
 
-cbuffer cbPerObject : register(b0)
-{
-    PerObjectData gPerObjectData[MAX_INSTANCES];
-};
+// Per-instance data lives in a structured buffer (bound as a root SRV) instead of a constant buffer, so the
+// number of instances is not limited by the 64KB constant buffer size
+StructuredBuffer<PerObjectData> gPerObjectData : register(t0);
+
+// Clip rects (left, top, right, bottom - in pixels) that every instance indexes. Entry 0 is the window
+StructuredBuffer<float4> gClipRects : register(t1);
  
 cbuffer cbPass : register(b1)
 {
@@ -43,16 +45,54 @@ struct VertexOut
 {
     float4 Position : SV_POSITION;
     float4 Color : COLOR;
+    float4 BorderColor : BORDER_COLOR;
+    float2 Local : LOCAL;                           // Position relative to the center of the shape (in pixels)
+    nointerpolation float2 HalfSize : HALF_SIZE;
+    nointerpolation float2 Parameters : PARAMETERS; // Corner radius, border thickness
+    nointerpolation uint Shape : SHAPE;
+    nointerpolation float4 ClipRect : CLIP_RECT;
+    nointerpolation uint GlyphOrigin : GLYPH_ORIGIN;
 };
 
+float4 UnpackColor(uint color)
+{
+    return float4(color & 0xFF, (color >> 8) & 0xFF, (color >> 16) & 0xFF, color >> 24) / 255.0f;
+}
+
 VertexOut main(VertexIn vin)
 {
     VertexOut vout = (VertexOut) 0.0f;
-    vout.Color = gPerObjectData[vin.instanceID].Color;
+    PerObjectData data = gPerObjectData[vin.instanceID];
+    vout.Color = UnpackColor(data.Color);
+    vout.BorderColor = UnpackColor(data.BorderColor);
+    vout.HalfSize = 0.5f * data.Size;
+    vout.Parameters = float2(((data.Shape >> 8) & 0xFF) * 0.5f, ((data.Shape >> 3) & 0x1F) * 0.25f);
+    vout.Shape = data.Shape & 0x7;
+    vout.GlyphOrigin = data.BorderColor;
 	
-    // Transform to world space.
-    vin.Position.z = 1.0f;
-    float4 posW = mul(vin.Position, gPerObjectData[vin.instanceID].World);
+    // Grow the quad by 1 pixel on every side so the pixel shader has room for the antialiased edge. The unit square
+    // spans x in [0, 1] and y in [-1, 0]
+    float2 local = vin.Position.xy * (data.Size + 2.0f) + float2(-1.0f, 1.0f);
+
+    // Axis aligned quads can simply be clamped to the clip rect, which means the clipped part is never rasterized.
+    // Rotated quads (lines) are clipped per pixel instead. Clip rects are in pixels, so y is flipped
+    vout.ClipRect = gClipRects[data.Clip];
+    if (data.Rotation == 0.0f)
+    {
+        float2 screen = float2(data.Position.x + local.x, -(data.Position.y + local.y));
+        screen = clamp(screen, vout.ClipRect.xy, vout.ClipRect.zw);
+        local = float2(screen.x - data.Position.x, -screen.y - data.Position.y);
+    }
+
+    vout.Local = float2(local.x - vout.HalfSize.x, local.y + vout.HalfSize.y);
+
+    // Rotate the quad around its origin, and then move it into place
+    float s, c;
+    sincos(data.Rotation, s, c);
+
+    // Higher z-orders are closer to the camera. The camera looks down +z and its near/far planes are 0.1/1000
+    float z = 999.0f - (data.Shape >> 16) * (998.0f / 65535.0f);
+    float4 posW = float4(data.Position + float2(local.x * c - local.y * s, local.x * s + local.y * c), z, 1.0f);
 
     // Transform to homogeneous clip space.
     vout.Position = mul(posW, gViewProj);
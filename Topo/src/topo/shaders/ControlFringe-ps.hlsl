@@ -0,0 +1,3 @@
+// Pixel shader for the antialiased edges of the opaque UI layer (see UIRenderer::InitializeRenderer)
+#define CONTROL_FRINGE
+#include "Control-ps.hlsl"
@@ -0,0 +1,3 @@
+// Pixel shader for the opaque UI layer (see UIRenderer::InitializeRenderer)
+#define CONTROL_OPAQUE
+#include "Control-ps.hlsl"
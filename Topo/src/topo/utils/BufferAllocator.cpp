@@ -0,0 +1,92 @@
+#include "pch.h"
+#include "BufferAllocator.h"
+#include "topo/Log.h"
+
+
+namespace topo
+{
+BufferAllocator::BufferAllocator(size_t capacity, size_t alignment) :
+	m_alignment(alignment)
+{
+	ASSERT(alignment > 0, "Alignment must not be 0");
+	Reset(capacity);
+}
+
+std::optional<size_t> BufferAllocator::Allocate(size_t size)
+{
+	size = AlignedSize(size);
+	if (size == 0)
+		return std::nullopt;
+
+	for (size_t iii = 0; iii < m_free.size(); ++iii)
+	{
+		Range& range = m_free[iii];
+		if (range.Size < size)
+			continue;
+
+		// Take the front of the free range (every free range starts and ends on the alignment)
+		const size_t offset = range.Offset;
+		range.Offset += size;
+		range.Size -= size;
+		if (range.Size == 0)
+			m_free.erase(m_free.begin() + iii);
+
+		m_used += size;
+		return offset;
+	}
+	return std::nullopt;
+}
+void BufferAllocator::Free(size_t offset, size_t size)
+{
+	size = AlignedSize(size);
+	ASSERT(offset % m_alignment == 0 && offset + size <= m_capacity, "Range was not allocated by this allocator");
+	ASSERT(m_used >= size, "Freeing more than was allocated");
+
+	// Insert the range in offset order and merge it with the free ranges on either side
+	auto next = std::ranges::lower_bound(m_free, offset, {}, &Range::Offset);
+	ASSERT(next == m_free.end() || offset + size <= next->Offset, "Range overlaps a free range");
+
+	if (next != m_free.end() && offset + size == next->Offset)
+	{
+		next->Offset = offset;
+		next->Size += size;
+	}
+	else
+		next = m_free.insert(next, { offset, size });
+
+	if (next != m_free.begin())
+	{
+		auto previous = std::prev(next);
+		ASSERT(previous->Offset + previous->Size <= offset, "Range overlaps a free range");
+		if (previous->Offset + previous->Size == next->Offset)
+		{
+			previous->Size += next->Size;
+			m_free.erase(next);
+		}
+	}
+
+	m_used -= size;
+}
+void BufferAllocator::Reset(size_t capacity)
+{
+	// Only whole aligned ranges can be handed out
+	m_capacity = capacity / m_alignment * m_alignment;
+	m_used = 0;
+	m_free.clear();
+	if (m_capacity > 0)
+		m_free.push_back({ 0, m_capacity });
+}
+void BufferAllocator::Grow(size_t capacity)
+{
+	capacity = capacity / m_alignment * m_alignment;
+	if (capacity <= m_capacity)
+		return;
+
+	// The new space goes at the end, so it can only merge with a free range that reaches the old end
+	if (!m_free.empty() && m_free.back().Offset + m_free.back().Size == m_capacity)
+		m_free.back().Size += capacity - m_capacity;
+	else
+		m_free.push_back({ m_capacity, capacity - m_capacity });
+	m_capacity = capacity;
+}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "topo/Core.h"
+
+
+namespace topo
+{
+// BufferAllocator hands out aligned ranges of a buffer with a fixed capacity. It only does the bookkeeping (the
+// buffer itself lives wherever the caller wants it to). Free ranges are kept sorted by offset, allocation is first
+// fit, and freeing a range merges it with its neighbors, so a buffer that is filled with a handful of long-lived
+// ranges (i.e. cached layers, see UIRenderer::SetClipCached) does not fragment much
+class BufferAllocator
+{
+public:
+	BufferAllocator(size_t capacity, size_t alignment);
+	BufferAllocator(const BufferAllocator&) = default;
+	BufferAllocator(BufferAllocator&&) noexcept = default;
+	BufferAllocator& operator=(const BufferAllocator&) = default;
+	BufferAllocator& operator=(BufferAllocator&&) noexcept = default;
+
+	// Returns the offset of the range, or nothing if there is no free range that is large enough
+	ND std::optional<size_t> Allocate(size_t size);
+
+	// size must be the size that was passed to Allocate()
+	void Free(size_t offset, size_t size);
+
+	// Frees everything and changes the capacity
+	void Reset(size_t capacity);
+
+	// Raises the capacity (smaller capacities are ignored). Unlike Reset(), every allocation stays where it is
+	void Grow(size_t capacity);
+
+	ND constexpr size_t GetCapacity() const noexcept { return m_capacity; }
+	ND constexpr size_t GetUsed() const noexcept { return m_used; }
+	ND constexpr size_t GetAlignment() const noexcept { return m_alignment; }
+	ND constexpr size_t AlignedSize(size_t size) const noexcept { return (size + m_alignment - 1) / m_alignment * m_alignment; }
+
+private:
+	struct Range
+	{
+		size_t Offset = 0;
+		size_t Size = 0;
+	};
+
+	size_t m_capacity = 0;
+	size_t m_alignment = 1;
+	size_t m_used = 0;
+	std::vector<Range> m_free;
+};
+}
@@ -0,0 +1,97 @@
+#include "pch.h"
+#include "DamageRegion.h"
+
+
+namespace topo
+{
+namespace
+{
+ND constexpr float RectArea(const Rect& rect) noexcept
+{
+	return rect.Width() * rect.Height();
+}
+ND constexpr Rect RectUnion(const Rect& a, const Rect& b) noexcept
+{
+	return { std::min(a.Left, b.Left), std::min(a.Top, b.Top), std::max(a.Right, b.Right), std::max(a.Bottom, b.Bottom) };
+}
+ND constexpr bool ShouldMerge(const Rect& a, const Rect& b) noexcept
+{
+	// Overlapping rects always have to be merged. Rects that don't overlap are only merged if their union does not
+	// cover anything extra, i.e. they share a full edge
+	const bool overlap = a.Left < b.Right && b.Left < a.Right && a.Top < b.Bottom && b.Top < a.Bottom;
+	return overlap || RectArea(RectUnion(a, b)) <= RectArea(a) + RectArea(b);
+}
+}
+
+void DamageRegion::Add(const Rect& rect)
+{
+	if (rect.Right <= rect.Left || rect.Bottom <= rect.Top)
+		return;
+
+	// Absorb every rect that has to be merged with the new one. The merged rect grows with each rect it absorbs, so
+	// it can start to overlap rects that were already checked - keep going until a full pass absorbs nothing
+	Rect merged = rect;
+	bool absorbed = true;
+	while (absorbed)
+	{
+		absorbed = false;
+		for (size_t iii = 0; iii < m_rects.size();)
+		{
+			if (ShouldMerge(m_rects[iii], merged))
+			{
+				merged = RectUnion(m_rects[iii], merged);
+				m_rects[iii] = m_rects.back();
+				m_rects.pop_back();
+				absorbed = true;
+			}
+			else
+				++iii;
+		}
+	}
+	m_rects.push_back(merged);
+
+	if (m_rects.size() > MaxRects)
+		MergeCheapestPair();
+}
+void DamageRegion::Add(const DamageRegion& region)
+{
+	for (const Rect& rect : region.m_rects)
+		Add(rect);
+}
+float DamageRegion::Area() const noexcept
+{
+	// The rects never overlap, so their areas can just be added up
+	float area = 0.0f;
+	for (const Rect& rect : m_rects)
+		area += RectArea(rect);
+	return area;
+}
+void DamageRegion::MergeCheapestPair()
+{
+	size_t first = 0;
+	size_t second = 1;
+	float cheapest = std::numeric_limits<float>::max();
+	for (size_t iii = 0; iii < m_rects.size(); ++iii)
+	{
+		for (size_t jjj = iii + 1; jjj < m_rects.size(); ++jjj)
+		{
+			const float cost = RectArea(RectUnion(m_rects[iii], m_rects[jjj])) - RectArea(m_rects[iii]) - RectArea(m_rects[jjj]);
+			if (cost < cheapest)
+			{
+				cheapest = cost;
+				first = iii;
+				second = jjj;
+			}
+		}
+	}
+
+	// Remove both rects (the later one first, so the earlier index stays valid) and add their union back. The union
+	// may overlap other rects, which Add() takes care of
+	const Rect merged = RectUnion(m_rects[first], m_rects[second]);
+	m_rects[second] = m_rects.back();
+	m_rects.pop_back();
+	m_rects[first] = m_rects.back();
+	m_rects.pop_back();
+	Add(merged);
+}
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "topo/Core.h"
+#include "Rect.h"
+
+
+namespace topo
+{
+// DamageRegion accumulates the parts of the window that need to be redrawn as a small set of rects. Rects that
+// overlap (or line up exactly along an edge) are merged as they are added, so the rects of a region never overlap
+// each other - which matters, because every rect gets drawn separately and transparent objects would otherwise be
+// blended twice where two rects overlap. Once there are more than MaxRects rects, the two rects whose union covers
+// the least additional area are merged, so a frame never ends up with more than a handful of scissored draws.
+//
+// Rects are expected to already be snapped to whole pixels (see UIRenderer::AddDamage)
+class DamageRegion
+{
+public:
+	DamageRegion() noexcept = default;
+	DamageRegion(const DamageRegion&) = default;
+	DamageRegion(DamageRegion&&) noexcept = default;
+	DamageRegion& operator=(const DamageRegion&) = default;
+	DamageRegion& operator=(DamageRegion&&) noexcept = default;
+
+	// Empty rects are ignored
+	void Add(const Rect& rect);
+	void Add(const DamageRegion& region);
+	inline void Clear() noexcept { m_rects.clear(); }
+
+	ND constexpr bool Empty() const noexcept { return m_rects.empty(); }
+	ND constexpr std::span<const Rect> GetRects() const noexcept { return m_rects; }
+	ND float Area() const noexcept;
+
+	static constexpr size_t MaxRects = 8;
+
+private:
+	void MergeCheapestPair();
+
+	std::vector<Rect> m_rects;
+};
+}
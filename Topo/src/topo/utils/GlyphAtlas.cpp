@@ -0,0 +1,40 @@
+#include "pch.h"
+#include "GlyphAtlas.h"
+#include "topo/Log.h"
+
+
+namespace topo
+{
+GlyphAtlas::GlyphAtlas() :
+	m_pixels(static_cast<size_t>(Width) * Height, 0)
+{}
+
+void GlyphAtlas::Write(const Region& region, std::span<const std::uint8_t> coverage) noexcept
+{
+	ASSERT(coverage.size() == static_cast<size_t>(region.Width) * region.Height, "Coverage must hold Width * Height values");
+	ASSERT(region.X + region.Width <= Width && region.Y + region.Height <= Height, "Region is outside of the atlas");
+
+	for (unsigned int row = 0; row < region.Height; ++row)
+	{
+		std::copy_n(
+			coverage.data() + static_cast<size_t>(row) * region.Width,
+			region.Width,
+			m_pixels.data() + static_cast<size_t>(region.Y + row) * Width + region.X
+		);
+	}
+
+	m_dirtyFirst = std::min(m_dirtyFirst, static_cast<unsigned int>(region.Y));
+	m_dirtyLast = std::max(m_dirtyLast, static_cast<unsigned int>(region.Y + region.Height));
+}
+
+std::pair<unsigned int, unsigned int> GlyphAtlas::TakeDirtyRows() noexcept
+{
+	if (m_dirtyFirst >= m_dirtyLast)
+		return { 0, 0 };
+
+	std::pair<unsigned int, unsigned int> rows{ m_dirtyFirst, m_dirtyLast };
+	m_dirtyFirst = UINT_MAX;
+	m_dirtyLast = 0;
+	return rows;
+}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "topo/Core.h"
+#include "ShelfPacker.h"
+
+
+namespace topo
+{
+// GlyphAtlas is a fixed size 8-bit coverage bitmap that glyphs get packed into. It has no GPU dependencies: the
+// renderer copies the rows that changed (see TakeDirtyRows) into its own GPU copy of the atlas.
+//
+// Glyphs are packed into shelves (see ShelfPacker). There is no compaction, so when Allocate() fails the caller is
+// expected to free glyphs it can live without (i.e. the least recently used ones - see GlyphCache) and try again.
+class GlyphAtlas
+{
+public:
+	// NOTE: The width must match GLYPH_ATLAS_WIDTH in Control-ps.hlsl
+	static constexpr unsigned int Width = 1024;
+	static constexpr unsigned int Height = 1024;
+
+	using Region = ShelfPacker::Region;
+
+	GlyphAtlas();
+	GlyphAtlas(const GlyphAtlas&) = default;
+	GlyphAtlas(GlyphAtlas&&) noexcept = default;
+	GlyphAtlas& operator=(const GlyphAtlas&) = default;
+	GlyphAtlas& operator=(GlyphAtlas&&) noexcept = default;
+
+	// Returns std::nullopt if there is no room for a (width x height) glyph
+	ND inline std::optional<Region> Allocate(unsigned int width, unsigned int height) { return m_packer.Allocate(width, height); }
+	inline void Free(const Region& region) noexcept { m_packer.Free(region); }
+	inline void Clear() noexcept { m_packer.Clear(); }
+
+	// Writes (region.Width x region.Height) row-major coverage values into the region
+	void Write(const Region& region, std::span<const std::uint8_t> coverage) noexcept;
+
+	ND constexpr std::span<const std::uint8_t> GetPixels() const noexcept { return m_pixels; }
+
+	// Rows [first, last) hold every pixel written since the last call (first == last if nothing changed)
+	ND std::pair<unsigned int, unsigned int> TakeDirtyRows() noexcept;
+
+	ND constexpr size_t ShelfCount() const noexcept { return m_packer.ShelfCount(); }
+	ND constexpr unsigned int UsedHeight() const noexcept { return m_packer.UsedHeight(); }
+
+private:
+	std::vector<std::uint8_t> m_pixels;
+	ShelfPacker m_packer{ Width, Height };
+
+	unsigned int m_dirtyFirst = UINT_MAX;
+	unsigned int m_dirtyLast = 0;
+};
+}
@@ -0,0 +1,68 @@
+#include "pch.h"
+#include "MinMaxPyramid.h"
+
+
+namespace topo
+{
+void MinMaxPyramid::Append(std::span<const float> samples)
+{
+	if (samples.empty())
+		return;
+
+	const size_t firstNew = m_samples.size();
+	m_samples.insert(m_samples.end(), samples.begin(), samples.end());
+
+	// Add levels until the top level is a single block
+	while ((static_cast<size_t>(1) << m_levels.size()) < m_samples.size())
+		m_levels.emplace_back();
+
+	// Only the blocks that contain new samples need to be (re)computed. For each level, that is the block that
+	// held the previous last sample (it may have been partially filled) through the new last block
+	for (size_t level = 1; level <= m_levels.size(); ++level)
+	{
+		std::vector<MinMax>& blocks = m_levels[level - 1];
+		const size_t blockCount = ((m_samples.size() - 1) >> level) + 1;
+		const size_t firstDirty = firstNew >> level;
+		blocks.resize(blockCount);
+
+		for (size_t block = firstDirty; block < blockCount; ++block)
+		{
+			MinMax result;
+			if (level == 1)
+			{
+				const size_t iii = block * 2;
+				const float a = m_samples[iii];
+				const float b = iii + 1 < m_samples.size() ? m_samples[iii + 1] : a;
+				result = { std::min(a, b), std::max(a, b) };
+			}
+			else
+			{
+				const std::vector<MinMax>& below = m_levels[level - 2];
+				const MinMax& a = below[block * 2];
+				const MinMax& b = block * 2 + 1 < below.size() ? below[block * 2 + 1] : a;
+				result = { std::min(a.Min, b.Min), std::max(a.Max, b.Max) };
+			}
+			blocks[block] = result;
+		}
+	}
+}
+void MinMaxPyramid::Clear() noexcept
+{
+	m_samples.clear();
+	m_levels.clear();
+}
+
+size_t MinMaxPyramid::SelectLevel(size_t first, size_t last, size_t maxBlocks) const noexcept
+{
+	if (first >= last)
+		return 0;
+
+	maxBlocks = std::max(maxBlocks, static_cast<size_t>(1));
+
+	size_t level = 0;
+	while (level < m_levels.size() && (((last - 1) >> level) - (first >> level) + 1) > maxBlocks)
+		++level;
+	return level;
+}
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "topo/Core.h"
+
+
+namespace topo
+{
+// MinMaxPyramid stores a series of samples along with a multi-resolution min/max summary of it. Level 0 is the
+// samples themselves and every level above it holds the min/max of each pair of blocks of the level below, so
+// a block of level k covers 2^k samples. The summary takes ~2x the memory of the samples.
+//
+// ForEachBlock() picks the finest level that covers a range of samples with at most a given number of blocks.
+// Because each block holds the exact min/max of its samples, drawing min -> max for every block preserves every
+// peak of the series, while the cost only depends on the number of blocks (i.e. pixels), not the number of
+// samples. Appending samples only recomputes the last block of each level that they touch.
+class MinMaxPyramid
+{
+public:
+	struct MinMax
+	{
+		float Min = 0.0f;
+		float Max = 0.0f;
+	};
+
+	MinMaxPyramid() noexcept = default;
+	MinMaxPyramid(const MinMaxPyramid&) = default;
+	MinMaxPyramid(MinMaxPyramid&&) noexcept = default;
+	MinMaxPyramid& operator=(const MinMaxPyramid&) = default;
+	MinMaxPyramid& operator=(MinMaxPyramid&&) noexcept = default;
+
+	void Append(std::span<const float> samples);
+	void Clear() noexcept;
+
+	ND constexpr size_t Size() const noexcept { return m_samples.size(); }
+	ND constexpr std::span<const float> GetSamples() const noexcept { return m_samples; }
+	ND constexpr size_t LevelCount() const noexcept { return m_levels.size() + 1; }
+
+	// Smallest level at which [first, last) is covered by at most maxBlocks blocks
+	ND size_t SelectLevel(size_t first, size_t last, size_t maxBlocks) const noexcept;
+
+	// Calls f(size_t firstSample, size_t sampleCount, float min, float max) for every block of the selected level
+	// that overlaps [first, last). The blocks at either end may extend past the range
+	template<typename F>
+	void ForEachBlock(size_t first, size_t last, size_t maxBlocks, F&& f) const
+	{
+		last = std::min(last, m_samples.size());
+		if (first >= last)
+			return;
+
+		const size_t level = SelectLevel(first, last, maxBlocks);
+		if (level == 0)
+		{
+			for (size_t iii = first; iii < last; ++iii)
+				f(iii, static_cast<size_t>(1), m_samples[iii], m_samples[iii]);
+			return;
+		}
+
+		const std::vector<MinMax>& blocks = m_levels[level - 1];
+		const size_t blockSize = static_cast<size_t>(1) << level;
+		for (size_t block = first >> level; block <= (last - 1) >> level; ++block)
+		{
+			const size_t blockFirst = block << level;
+			f(blockFirst, std::min(blockSize, m_samples.size() - blockFirst), blocks[block].Min, blocks[block].Max);
+		}
+	}
+
+private:
+	std::vector<float> m_samples;
+
+	// m_levels[k - 1] holds the blocks of level k
+	std::vector<std::vector<MinMax>> m_levels;
+};
+}
@@ -0,0 +1,219 @@
+#pragma once
+#include "topo/Core.h"
+#include "topo/Log.h"
+
+
+namespace topo
+{
+enum class CollectionChangeType
+{
+	Insert, Remove, Move, Update, Reset
+};
+
+// Describes a single change to an ObservableCollection
+//    Insert: Count items were inserted starting at Index
+//    Remove: Count items were removed starting at Index (Index refers to the collection BEFORE the removal)
+//    Move:   The item at Index was moved to NewIndex (NewIndex refers to the collection AFTER the move)
+//    Update: The Count items starting at Index were assigned new values
+//    Reset:  The entire collection changed (Index/Count are unused)
+struct CollectionChange
+{
+	CollectionChangeType Type = CollectionChangeType::Reset;
+	size_t Index = 0;
+	size_t Count = 0;
+	size_t NewIndex = 0;
+};
+
+// ObservableCollection is a thin wrapper around std::vector that notifies subscribers with a change set
+// every time it is modified. Subscribers only ever receive the delta, so they can do work proportional to
+// the size of the change rather than the size of the collection.
+//
+// Calling BeginBatch()/EndBatch() will accumulate all changes made in between into a single change set.
+// While batching, consecutive inserts/removes/updates of adjacent ranges are merged so that, for example,
+// streaming 1000 items onto the end of the collection results in a single Insert change.
+template<typename T>
+class ObservableCollection
+{
+public:
+	using ChangeHandler = std::function<void(std::span<const CollectionChange>)>;
+
+	ObservableCollection() noexcept = default;
+	ObservableCollection(const ObservableCollection&) = delete;
+	ObservableCollection(ObservableCollection&&) = delete;
+	ObservableCollection& operator=(const ObservableCollection&) = delete;
+	ObservableCollection& operator=(ObservableCollection&&) = delete;
+
+	// Subscriptions
+	ND inline unsigned int Subscribe(ChangeHandler handler)
+	{
+		unsigned int token = m_nextSubscriptionToken++;
+		m_subscribers.emplace_back(token, std::move(handler));
+		return token;
+	}
+	inline void Unsubscribe(unsigned int token) noexcept
+	{
+		std::erase_if(m_subscribers, [token](const auto& pair) { return pair.first == token; });
+	}
+
+	// Batching
+	inline void BeginBatch() noexcept { ++m_batchDepth; }
+	inline void EndBatch()
+	{
+		ASSERT(m_batchDepth > 0, "Called EndBatch() more times than BeginBatch()");
+		if (--m_batchDepth == 0)
+			Flush();
+	}
+
+	// Read access
+	ND constexpr size_t Size() const noexcept { return m_items.size(); }
+	ND constexpr bool Empty() const noexcept { return m_items.empty(); }
+	ND constexpr const T& operator[](size_t index) const noexcept { return m_items[index]; }
+	ND constexpr const T& Get(size_t index) const noexcept { return m_items[index]; }
+	ND constexpr std::span<const T> Items() const noexcept { return m_items; }
+	ND constexpr auto begin() const noexcept { return m_items.begin(); }
+	ND constexpr auto end() const noexcept { return m_items.end(); }
+
+	// Modifiers
+	inline void PushBack(const T& item) { Insert(m_items.size(), item); }
+	inline void PushBack(T&& item) { Insert(m_items.size(), std::move(item)); }
+	inline void Insert(size_t index, const T& item)
+	{
+		ASSERT(index <= m_items.size(), "Index out of range");
+		m_items.insert(m_items.begin() + index, item);
+		Record({ CollectionChangeType::Insert, index, 1 });
+	}
+	inline void Insert(size_t index, T&& item)
+	{
+		ASSERT(index <= m_items.size(), "Index out of range");
+		m_items.insert(m_items.begin() + index, std::move(item));
+		Record({ CollectionChangeType::Insert, index, 1 });
+	}
+	inline void InsertRange(size_t index, std::span<const T> items)
+	{
+		ASSERT(index <= m_items.size(), "Index out of range");
+		if (items.empty())
+			return;
+		m_items.insert(m_items.begin() + index, items.begin(), items.end());
+		Record({ CollectionChangeType::Insert, index, items.size() });
+	}
+	inline void RemoveAt(size_t index, size_t count = 1)
+	{
+		ASSERT(index + count <= m_items.size(), "Index out of range");
+		if (count == 0)
+			return;
+		m_items.erase(m_items.begin() + index, m_items.begin() + index + count);
+		Record({ CollectionChangeType::Remove, index, count });
+	}
+	inline void Move(size_t oldIndex, size_t newIndex)
+	{
+		ASSERT(oldIndex < m_items.size() && newIndex < m_items.size(), "Index out of range");
+		if (oldIndex == newIndex)
+			return;
+		if (oldIndex < newIndex)
+			std::rotate(m_items.begin() + oldIndex, m_items.begin() + oldIndex + 1, m_items.begin() + newIndex + 1);
+		else
+			std::rotate(m_items.begin() + newIndex, m_items.begin() + oldIndex, m_items.begin() + oldIndex + 1);
+		Record({ CollectionChangeType::Move, oldIndex, 1, newIndex });
+	}
+	inline void Set(size_t index, const T& item)
+	{
+		ASSERT(index < m_items.size(), "Index out of range");
+		m_items[index] = item;
+		Record({ CollectionChangeType::Update, index, 1 });
+	}
+	inline void Set(size_t index, T&& item)
+	{
+		ASSERT(index < m_items.size(), "Index out of range");
+		m_items[index] = std::move(item);
+		Record({ CollectionChangeType::Update, index, 1 });
+	}
+	inline void Clear()
+	{
+		m_items.clear();
+		m_pendingChanges.clear();
+		Record({ CollectionChangeType::Reset });
+	}
+	inline void Assign(std::span<const T> items)
+	{
+		m_items.assign_range(items);
+		m_pendingChanges.clear();
+		Record({ CollectionChangeType::Reset });
+	}
+
+private:
+	inline void Record(const CollectionChange& change)
+	{
+		// Try to merge the change into the previous one so that bulk operations produce a single change
+		if (!m_pendingChanges.empty())
+		{
+			CollectionChange& last = m_pendingChanges.back();
+			if (last.Type == change.Type)
+			{
+				switch (change.Type)
+				{
+				case CollectionChangeType::Insert:
+					// Inserting directly after (or before) the last inserted range
+					if (change.Index == last.Index + last.Count || change.Index == last.Index)
+					{
+						last.Count += change.Count;
+						return;
+					}
+					break;
+				case CollectionChangeType::Remove:
+					// Removing at the same index (i.e. continuing to erase forward) or directly before the last range
+					if (change.Index == last.Index)
+					{
+						last.Count += change.Count;
+						return;
+					}
+					if (change.Index + change.Count == last.Index)
+					{
+						last.Index = change.Index;
+						last.Count += change.Count;
+						return;
+					}
+					break;
+				case CollectionChangeType::Update:
+					if (change.Index >= last.Index && change.Index <= last.Index + last.Count)
+					{
+						last.Count = std::max(last.Count, change.Index + change.Count - last.Index);
+						return;
+					}
+					break;
+				default:
+					break;
+				}
+			}
+		}
+
+		m_pendingChanges.push_back(change);
+		Flush();
+	}
+	inline void Flush()
+	{
+		// Only notify subscribers once we are outside of all batches
+		if (m_batchDepth > 0 || m_pendingChanges.empty())
+			return;
+
+		// Swap out the pending changes before notifying so that a subscriber can safely modify the collection
+		std::vector<CollectionChange> changes;
+		std::swap(changes, m_pendingChanges);
+
+		for (auto& [token, handler] : m_subscribers)
+			handler(changes);
+
+		// Reuse the allocation for the next change set
+		if (m_pendingChanges.empty())
+		{
+			changes.clear();
+			std::swap(changes, m_pendingChanges);
+		}
+	}
+
+	std::vector<T> m_items;
+	std::vector<CollectionChange> m_pendingChanges;
+	std::vector<std::pair<unsigned int, ChangeHandler>> m_subscribers;
+	unsigned int m_nextSubscriptionToken = 0;
+	unsigned int m_batchDepth = 0;
+};
+}
@@ -0,0 +1,287 @@
+#include "pch.h"
+#include "PieceTable.h"
+#include "topo/Log.h"
+
+
+namespace topo
+{
+PieceTable::PieceTable(std::string text) :
+	m_original(std::move(text))
+{
+	// Record the line breaks of the original buffer once up front
+	for (size_t iii = 0; iii < m_original.size(); ++iii)
+	{
+		if (m_original[iii] == '\n')
+			m_originalLineBreaks.push_back(iii);
+	}
+
+	if (!m_original.empty())
+		m_pieces.push_back(MakePiece(BufferType::Original, 0, m_original.size()));
+
+	m_length = m_original.size();
+	m_lineBreakCount = m_originalLineBreaks.size();
+}
+
+size_t PieceTable::CountLineBreaks(BufferType type, size_t start, size_t length) const noexcept
+{
+	const std::vector<size_t>& breaks = GetLineBreaks(type);
+	auto first = std::lower_bound(breaks.begin(), breaks.end(), start);
+	auto last = std::lower_bound(first, breaks.end(), start + length);
+	return static_cast<size_t>(last - first);
+}
+PieceTable::Piece PieceTable::MakePiece(BufferType type, size_t start, size_t length) const noexcept
+{
+	return { type, start, length, CountLineBreaks(type, start, length) };
+}
+
+void PieceTable::UpdatePrefixSums() const noexcept
+{
+	if (m_validPrefixCount == m_pieces.size() && m_pieceOffsets.size() == m_pieces.size())
+		return;
+
+	m_pieceOffsets.resize(m_pieces.size());
+	m_pieceLineBreaks.resize(m_pieces.size());
+
+	// Only recompute from the first piece that changed
+	size_t offset = 0;
+	size_t lineBreaks = 0;
+	if (m_validPrefixCount > 0)
+	{
+		const size_t last = m_validPrefixCount - 1;
+		offset = m_pieceOffsets[last] + m_pieces[last].Length;
+		lineBreaks = m_pieceLineBreaks[last] + m_pieces[last].LineBreakCount;
+	}
+
+	for (size_t iii = m_validPrefixCount; iii < m_pieces.size(); ++iii)
+	{
+		m_pieceOffsets[iii] = offset;
+		m_pieceLineBreaks[iii] = lineBreaks;
+		offset += m_pieces[iii].Length;
+		lineBreaks += m_pieces[iii].LineBreakCount;
+	}
+	m_validPrefixCount = m_pieces.size();
+}
+std::pair<size_t, size_t> PieceTable::FindPiece(size_t position) const noexcept
+{
+	UpdatePrefixSums();
+
+	// Find the last piece whose offset is <= position
+	auto iter = std::upper_bound(m_pieceOffsets.begin(), m_pieceOffsets.end(), position);
+	if (iter == m_pieceOffsets.begin())
+		return { 0, 0 };
+
+	const size_t index = static_cast<size_t>(iter - m_pieceOffsets.begin()) - 1;
+	return { index, m_pieceOffsets[index] };
+}
+
+void PieceTable::Insert(size_t position, std::string_view text)
+{
+	if (text.empty())
+		return;
+
+	if (position > m_length) [[unlikely]]
+	{
+		LOG_WARN("PieceTable: Attempting to insert at position {0}, but length is {1}. Appending instead.", position, m_length);
+		position = m_length;
+	}
+
+	// Append the text to the add buffer and record its line breaks
+	const size_t addStart = m_add.size();
+	const size_t lineBreaksBefore = m_addLineBreaks.size();
+	m_add.append(text);
+	for (size_t iii = 0; iii < text.size(); ++iii)
+	{
+		if (text[iii] == '\n')
+			m_addLineBreaks.push_back(addStart + iii);
+	}
+
+	const size_t insertedLineBreaks = m_addLineBreaks.size() - lineBreaksBefore;
+	m_length += text.size();
+	m_lineBreakCount += insertedLineBreaks;
+
+	if (m_pieces.empty())
+	{
+		m_pieces.push_back(MakePiece(BufferType::Add, addStart, text.size()));
+		InvalidateFrom(0);
+		return;
+	}
+
+	auto [pieceIndex, pieceOffset] = FindPiece(position);
+
+	// When inserting at the very start of a piece, we are really inserting at the end of the previous piece
+	if (position == pieceOffset && pieceIndex > 0)
+	{
+		--pieceIndex;
+		pieceOffset -= m_pieces[pieceIndex].Length;
+	}
+
+	Piece& piece = m_pieces[pieceIndex];
+	const size_t offsetInPiece = position - pieceOffset;
+
+	// Common case when typing: inserting at the end of the piece that was the last thing added to the add
+	// buffer. In this case, we can just extend the piece instead of creating a new one
+	if (offsetInPiece == piece.Length && piece.Buffer == BufferType::Add && piece.Start + piece.Length == addStart)
+	{
+		piece.Length += text.size();
+		piece.LineBreakCount += insertedLineBreaks;
+		InvalidateFrom(pieceIndex + 1);
+		return;
+	}
+
+	Piece newPiece{ BufferType::Add, addStart, text.size(), insertedLineBreaks };
+
+	if (offsetInPiece == 0)
+	{
+		// Only possible for the first piece
+		m_pieces.insert(m_pieces.begin() + pieceIndex, newPiece);
+		InvalidateFrom(pieceIndex);
+	}
+	else if (offsetInPiece == piece.Length)
+	{
+		m_pieces.insert(m_pieces.begin() + pieceIndex + 1, newPiece);
+		InvalidateFrom(pieceIndex + 1);
+	}
+	else
+	{
+		// Split the piece in two and put the new piece in between
+		Piece right = MakePiece(piece.Buffer, piece.Start + offsetInPiece, piece.Length - offsetInPiece);
+		piece = MakePiece(piece.Buffer, piece.Start, offsetInPiece);
+
+		const Piece pieces[] = { newPiece, right };
+		m_pieces.insert(m_pieces.begin() + pieceIndex + 1, std::begin(pieces), std::end(pieces));
+		InvalidateFrom(pieceIndex);
+	}
+}
+void PieceTable::Erase(size_t position, size_t length)
+{
+	if (position >= m_length || length == 0)
+		return;
+
+	length = std::min(length, m_length - position);
+
+	auto [pieceIndex, pieceOffset] = FindPiece(position);
+	const size_t firstAffected = pieceIndex;
+	size_t remaining = length;
+
+	while (remaining > 0 && pieceIndex < m_pieces.size())
+	{
+		Piece& piece = m_pieces[pieceIndex];
+		const size_t offsetInPiece = position > pieceOffset ? position - pieceOffset : 0;
+		const size_t eraseCount = std::min(remaining, piece.Length - offsetInPiece);
+
+		if (offsetInPiece == 0 && eraseCount == piece.Length)
+		{
+			// Entire piece is erased
+			m_lineBreakCount -= piece.LineBreakCount;
+			m_pieces.erase(m_pieces.begin() + pieceIndex);
+		}
+		else if (offsetInPiece == 0)
+		{
+			// Erase from the front of the piece
+			const Piece trimmed = MakePiece(piece.Buffer, piece.Start + eraseCount, piece.Length - eraseCount);
+			m_lineBreakCount -= piece.LineBreakCount - trimmed.LineBreakCount;
+			piece = trimmed;
+			pieceOffset += piece.Length;
+			++pieceIndex;
+		}
+		else if (offsetInPiece + eraseCount == piece.Length)
+		{
+			// Erase from the back of the piece
+			const Piece trimmed = MakePiece(piece.Buffer, piece.Start, offsetInPiece);
+			m_lineBreakCount -= piece.LineBreakCount - trimmed.LineBreakCount;
+			piece = trimmed;
+			pieceOffset += piece.Length;
+			++pieceIndex;
+		}
+		else
+		{
+			// Erase from the middle of the piece - split it in two
+			const Piece left = MakePiece(piece.Buffer, piece.Start, offsetInPiece);
+			const Piece right = MakePiece(piece.Buffer, piece.Start + offsetInPiece + eraseCount, piece.Length - offsetInPiece - eraseCount);
+			m_lineBreakCount -= piece.LineBreakCount - left.LineBreakCount - right.LineBreakCount;
+			piece = left;
+			m_pieces.insert(m_pieces.begin() + pieceIndex + 1, right);
+		}
+
+		remaining -= eraseCount;
+	}
+
+	m_length -= length;
+	InvalidateFrom(firstAffected);
+}
+
+size_t PieceTable::LineStart(size_t line) const noexcept
+{
+	if (line == 0 || m_pieces.empty())
+		return 0;
+	if (line > m_lineBreakCount)
+		return m_length;
+
+	UpdatePrefixSums();
+
+	// Find the piece that contains the line'th line break (i.e. the break that ends line - 1)
+	auto iter = std::lower_bound(m_pieceLineBreaks.begin(), m_pieceLineBreaks.end(), line);
+	const size_t pieceIndex = static_cast<size_t>(iter - m_pieceLineBreaks.begin()) - 1;
+	const Piece& piece = m_pieces[pieceIndex];
+
+	// Look up the position of the break within the piece's buffer
+	const std::vector<size_t>& breaks = GetLineBreaks(piece.Buffer);
+	auto firstBreakInPiece = std::lower_bound(breaks.begin(), breaks.end(), piece.Start);
+	const size_t breakPosition = *(firstBreakInPiece + (line - m_pieceLineBreaks[pieceIndex] - 1));
+
+	return m_pieceOffsets[pieceIndex] + (breakPosition - piece.Start) + 1;
+}
+size_t PieceTable::LineEnd(size_t line) const noexcept
+{
+	if (line >= m_lineBreakCount)
+		return m_length;
+	return LineStart(line + 1) - 1;
+}
+size_t PieceTable::LineFromPosition(size_t position) const noexcept
+{
+	if (m_pieces.empty())
+		return 0;
+	if (position >= m_length)
+		return m_lineBreakCount;
+
+	auto [pieceIndex, pieceOffset] = FindPiece(position);
+	const Piece& piece = m_pieces[pieceIndex];
+	return m_pieceLineBreaks[pieceIndex] + CountLineBreaks(piece.Buffer, piece.Start, position - pieceOffset);
+}
+
+char PieceTable::CharAt(size_t position) const noexcept
+{
+	ASSERT(position < m_length, "Position out of range");
+	auto [pieceIndex, pieceOffset] = FindPiece(position);
+	const Piece& piece = m_pieces[pieceIndex];
+	return GetBuffer(piece.Buffer)[piece.Start + (position - pieceOffset)];
+}
+std::string PieceTable::GetText(size_t position, size_t length) const
+{
+	std::string result;
+	if (position >= m_length || length == 0)
+		return result;
+
+	length = std::min(length, m_length - position);
+	result.reserve(length);
+
+	auto [pieceIndex, pieceOffset] = FindPiece(position);
+	while (result.size() < length && pieceIndex < m_pieces.size())
+	{
+		const Piece& piece = m_pieces[pieceIndex];
+		const size_t offsetInPiece = position > pieceOffset ? position - pieceOffset : 0;
+		const size_t count = std::min(length - result.size(), piece.Length - offsetInPiece);
+		result.append(GetBuffer(piece.Buffer), piece.Start + offsetInPiece, count);
+
+		pieceOffset += piece.Length;
+		++pieceIndex;
+	}
+	return result;
+}
+std::string PieceTable::GetLine(size_t line) const
+{
+	const size_t start = LineStart(line);
+	return GetText(start, LineEnd(line) - start);
+}
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "topo/Core.h"
+
+
+namespace topo
+{
+// PieceTable stores a text document as a sequence of "pieces" that each reference a span of one of two
+// buffers: the original (read-only) buffer and an append-only "add" buffer that holds all inserted text.
+// Inserting/erasing never copies existing text, so edits cost the same regardless of the document size.
+//
+// Line breaks: the position of every '\n' in each buffer is recorded once (when the buffer is loaded or
+// appended to). Each piece caches how many line breaks it spans, so edits only need to recount the pieces
+// they touch. Prefix sums of piece lengths/line breaks are cached and only recomputed from the first piece
+// that changed, which lets us map between positions and lines with binary searches.
+class PieceTable
+{
+public:
+	PieceTable() noexcept = default;
+	explicit PieceTable(std::string text);
+	PieceTable(const PieceTable&) = default;
+	PieceTable(PieceTable&&) noexcept = default;
+	PieceTable& operator=(const PieceTable&) = default;
+	PieceTable& operator=(PieceTable&&) noexcept = default;
+
+	void Insert(size_t position, std::string_view text);
+	void Erase(size_t position, size_t length);
+
+	ND constexpr size_t Length() const noexcept { return m_length; }
+	ND constexpr size_t LineCount() const noexcept { return m_lineBreakCount + 1; }
+
+	ND size_t LineStart(size_t line) const noexcept;
+	ND size_t LineEnd(size_t line) const noexcept; // Position of the '\n' that ends the line (or Length() for the last line)
+	ND size_t LineFromPosition(size_t position) const noexcept;
+
+	ND char CharAt(size_t position) const noexcept;
+	ND std::string GetText(size_t position, size_t length) const;
+	ND std::string GetLine(size_t line) const;
+	ND std::string GetText() const { return GetText(0, m_length); }
+
+	ND constexpr size_t PieceCount() const noexcept { return m_pieces.size(); }
+
+private:
+	enum class BufferType : unsigned char
+	{
+		Original, Add
+	};
+	struct Piece
+	{
+		BufferType Buffer = BufferType::Original;
+		size_t Start = 0;
+		size_t Length = 0;
+		size_t LineBreakCount = 0;
+	};
+
+	ND constexpr const std::string& GetBuffer(BufferType type) const noexcept { return type == BufferType::Original ? m_original : m_add; }
+	ND constexpr const std::vector<size_t>& GetLineBreaks(BufferType type) const noexcept { return type == BufferType::Original ? m_originalLineBreaks : m_addLineBreaks; }
+
+	ND size_t CountLineBreaks(BufferType type, size_t start, size_t length) const noexcept;
+	ND Piece MakePiece(BufferType type, size_t start, size_t length) const noexcept;
+
+	// Returns the index of the piece that contains position along with the offset of that piece
+	ND std::pair<size_t, size_t> FindPiece(size_t position) const noexcept;
+	void InvalidateFrom(size_t pieceIndex) noexcept { m_validPrefixCount = std::min(m_validPrefixCount, pieceIndex); }
+	void UpdatePrefixSums() const noexcept;
+
+	std::string m_original;
+	std::string m_add;
+	std::vector<size_t> m_originalLineBreaks;
+	std::vector<size_t> m_addLineBreaks;
+
+	std::vector<Piece> m_pieces;
+	size_t m_length = 0;
+	size_t m_lineBreakCount = 0;
+
+	// m_pieceOffsets[iii] / m_pieceLineBreaks[iii] hold the character offset / number of line breaks BEFORE
+	// piece iii. Only the first m_validPrefixCount entries are valid
+	mutable std::vector<size_t> m_pieceOffsets;
+	mutable std::vector<size_t> m_pieceLineBreaks;
+	mutable size_t m_validPrefixCount = 0;
+};
+}
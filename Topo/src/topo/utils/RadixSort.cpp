@@ -0,0 +1,71 @@
+#include "pch.h"
+#include "RadixSort.h"
+#include "topo/Log.h"
+
+
+namespace topo
+{
+void RadixSort::Sort(std::span<std::uint64_t> keys, std::span<unsigned int> values)
+{
+	ASSERT(keys.size() == values.size(), "Every key must have a value");
+
+	const size_t count = keys.size();
+	if (count < 2)
+		return;
+
+	constexpr size_t DigitCount = sizeof(std::uint64_t);
+	constexpr size_t BucketCount = 256;
+
+	// Count every digit in one pass
+	std::array<std::array<size_t, BucketCount>, DigitCount> histograms = {};
+	for (std::uint64_t key : keys)
+	{
+		for (size_t digit = 0; digit < DigitCount; ++digit)
+			++histograms[digit][(key >> (digit * 8)) & 0xFF];
+	}
+
+	m_keyScratch.resize(count);
+	m_valueScratch.resize(count);
+
+	std::span<std::uint64_t> srcKeys = keys;
+	std::span<unsigned int> srcValues = values;
+	std::span<std::uint64_t> dstKeys = m_keyScratch;
+	std::span<unsigned int> dstValues = m_valueScratch;
+
+	for (size_t digit = 0; digit < DigitCount; ++digit)
+	{
+		std::array<size_t, BucketCount>& histogram = histograms[digit];
+
+		// If every key falls in the same bucket, this pass would not change the order
+		const size_t shift = digit * 8;
+		if (histogram[(srcKeys[0] >> shift) & 0xFF] == count)
+			continue;
+
+		// Turn the counts into the first output index of each bucket
+		size_t offset = 0;
+		for (size_t& bucket : histogram)
+		{
+			const size_t bucketCount = bucket;
+			bucket = offset;
+			offset += bucketCount;
+		}
+
+		for (size_t iii = 0; iii < count; ++iii)
+		{
+			const size_t destination = histogram[(srcKeys[iii] >> shift) & 0xFF]++;
+			dstKeys[destination] = srcKeys[iii];
+			dstValues[destination] = srcValues[iii];
+		}
+
+		std::swap(srcKeys, dstKeys);
+		std::swap(srcValues, dstValues);
+	}
+
+	// After an odd number of passes, the sorted data lives in the scratch space
+	if (srcKeys.data() != keys.data())
+	{
+		std::copy(srcKeys.begin(), srcKeys.end(), keys.begin());
+		std::copy(srcValues.begin(), srcValues.end(), values.begin());
+	}
+}
+}
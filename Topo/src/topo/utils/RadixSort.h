@@ -0,0 +1,29 @@
+#pragma once
+#include "topo/Core.h"
+
+
+namespace topo
+{
+// RadixSort sorts 64-bit keys (along with a value per key) in ascending order. It is a stable LSD radix sort on
+// 8-bit digits, so the cost is linear in the number of keys. The histograms of all 8 digits are built in a single
+// pass over the keys, and any digit that is the same for every key (i.e. the high bits of keys that only use part
+// of their range) is skipped instead of moving every key around for nothing.
+//
+// The scratch space is kept between calls, so sorting the same number of keys every frame does not allocate
+class RadixSort
+{
+public:
+	RadixSort() noexcept = default;
+	RadixSort(const RadixSort&) = default;
+	RadixSort(RadixSort&&) noexcept = default;
+	RadixSort& operator=(const RadixSort&) = default;
+	RadixSort& operator=(RadixSort&&) noexcept = default;
+
+	// keys and values must have the same length. values[iii] ends up next to the key it started with
+	void Sort(std::span<std::uint64_t> keys, std::span<unsigned int> values);
+
+private:
+	std::vector<std::uint64_t> m_keyScratch;
+	std::vector<unsigned int> m_valueScratch;
+};
+}
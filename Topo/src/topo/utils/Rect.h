@@ -14,6 +14,7 @@ struct Rect
 	constexpr void Width(float width) noexcept { Right = Left + width; }
 	constexpr void Height(float height) noexcept { Bottom = Top + height; }
 	ND constexpr bool ContainsPoint(float x, float y) const noexcept { return Left <= x && Right >= x && Top <= y && Bottom >= y; }
+	ND constexpr bool operator==(const Rect&) const noexcept = default;
 
 };
 }
\ No newline at end of file
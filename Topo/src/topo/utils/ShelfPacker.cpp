@@ -0,0 +1,134 @@
+#include "pch.h"
+#include "ShelfPacker.h"
+#include "topo/Log.h"
+
+
+namespace topo
+{
+ShelfPacker::ShelfPacker(unsigned int width, unsigned int height) noexcept :
+	m_width(width),
+	m_height(height)
+{
+	ASSERT(width <= 0x10000 && height <= 0x10000, "Regions store 16-bit coordinates");
+}
+
+bool ShelfPacker::FitsShelf(const Shelf& shelf, unsigned int height) const noexcept
+{
+	if (height > shelf.Height)
+		return false;
+
+	// An empty shelf takes anything that fits. Otherwise, only put rectangles on a shelf if they do not waste more
+	// than a quarter of its height, so that small rectangles do not use up the shelves of large ones
+	return shelf.RegionCount == 0 || height * 4 >= shelf.Height * 3;
+}
+
+std::optional<ShelfPacker::Region> ShelfPacker::AllocateOnShelf(Shelf& shelf, unsigned int width, unsigned int height) noexcept
+{
+	// Prefer the smallest hole the rectangle fits in
+	auto best = shelf.Holes.end();
+	for (auto iter = shelf.Holes.begin(); iter != shelf.Holes.end(); ++iter)
+	{
+		if (iter->Width >= width && (best == shelf.Holes.end() || iter->Width < best->Width))
+			best = iter;
+	}
+
+	unsigned int x = 0;
+	if (best != shelf.Holes.end())
+	{
+		x = best->X;
+		best->X += width;
+		best->Width -= width;
+		if (best->Width == 0)
+			shelf.Holes.erase(best);
+	}
+	else if (shelf.Cursor + width <= m_width)
+	{
+		x = shelf.Cursor;
+		shelf.Cursor += width;
+	}
+	else
+	{
+		return std::nullopt;
+	}
+
+	++shelf.RegionCount;
+	return Region{ static_cast<std::uint16_t>(x), static_cast<std::uint16_t>(shelf.Top), static_cast<std::uint16_t>(width), static_cast<std::uint16_t>(height) };
+}
+
+std::optional<ShelfPacker::Region> ShelfPacker::Allocate(unsigned int width, unsigned int height)
+{
+	ASSERT(width > 0 && height > 0, "Empty rectangles do not need any space");
+	if (width > m_width || height > m_height) [[unlikely]]
+		return std::nullopt;
+
+	for (Shelf& shelf : m_shelves)
+	{
+		if (!FitsShelf(shelf, height))
+			continue;
+
+		if (auto region = AllocateOnShelf(shelf, width, height))
+			return region;
+	}
+
+	// Open a new shelf. Rounding shelf heights up to a multiple of 4 lets rectangles of similar sizes share shelves
+	const unsigned int shelfHeight = std::min((height + 3) & ~3u, m_height - m_nextShelfTop);
+	if (m_nextShelfTop >= m_height || shelfHeight < height)
+		return std::nullopt;
+
+	Shelf& shelf = m_shelves.emplace_back();
+	shelf.Top = m_nextShelfTop;
+	shelf.Height = shelfHeight;
+	m_nextShelfTop += shelfHeight;
+
+	return AllocateOnShelf(shelf, width, height);
+}
+
+void ShelfPacker::Free(const Region& region) noexcept
+{
+	// Shelves are created top to bottom, so they are sorted by Top
+	auto shelfIter = std::ranges::lower_bound(m_shelves, static_cast<unsigned int>(region.Y), {}, &Shelf::Top);
+	if (shelfIter == m_shelves.end() || shelfIter->Top != region.Y) [[unlikely]]
+	{
+		LOG_WARN("ShelfPacker: Attempting to free a region that was not allocated ({0}, {1})", region.X, region.Y);
+		return;
+	}
+
+	Shelf& shelf = *shelfIter;
+	ASSERT(shelf.RegionCount > 0, "Shelf has no regions");
+	if (--shelf.RegionCount == 0)
+	{
+		shelf.Cursor = 0;
+		shelf.Holes.clear();
+		return;
+	}
+
+	// Insert the hole in x order and merge it with its neighbors
+	Hole hole{ region.X, region.Width };
+	auto iter = std::ranges::lower_bound(shelf.Holes, hole.X, {}, &Hole::X);
+	if (iter != shelf.Holes.end() && hole.X + hole.Width == iter->X)
+	{
+		hole.Width += iter->Width;
+		iter = shelf.Holes.erase(iter);
+	}
+	if (iter != shelf.Holes.begin() && std::prev(iter)->X + std::prev(iter)->Width == hole.X)
+	{
+		hole.X = std::prev(iter)->X;
+		hole.Width += std::prev(iter)->Width;
+		iter = shelf.Holes.erase(std::prev(iter));
+	}
+
+	// A hole that ends at the cursor just moves the cursor back
+	if (hole.X + hole.Width == shelf.Cursor)
+	{
+		shelf.Cursor = hole.X;
+		return;
+	}
+	shelf.Holes.insert(iter, hole);
+}
+
+void ShelfPacker::Clear() noexcept
+{
+	m_shelves.clear();
+	m_nextShelfTop = 0;
+}
+}
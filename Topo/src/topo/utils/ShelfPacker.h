@@ -0,0 +1,64 @@
+#pragma once
+#include "topo/Core.h"
+
+
+namespace topo
+{
+// ShelfPacker hands out rectangles of a fixed size 2D area. It only does the bookkeeping (the pixels live wherever
+// the caller wants them to - see GlyphAtlas and ImageAtlas).
+//
+// Rectangles are packed into shelves (rows of rectangles with similar heights) from left to right. Freeing a
+// rectangle turns its spot into a hole that any rectangle that fits can reuse, and once every rectangle on a shelf
+// is freed the whole shelf is reset. There is no compaction, so when Allocate() fails the caller is expected to free
+// rectangles it can live without and try again.
+class ShelfPacker
+{
+public:
+	struct Region
+	{
+		std::uint16_t X = 0;
+		std::uint16_t Y = 0;
+		std::uint16_t Width = 0;
+		std::uint16_t Height = 0;
+	};
+
+	ShelfPacker(unsigned int width, unsigned int height) noexcept;
+	ShelfPacker(const ShelfPacker&) = default;
+	ShelfPacker(ShelfPacker&&) noexcept = default;
+	ShelfPacker& operator=(const ShelfPacker&) = default;
+	ShelfPacker& operator=(ShelfPacker&&) noexcept = default;
+
+	// Returns std::nullopt if there is no room for a (width x height) rectangle
+	ND std::optional<Region> Allocate(unsigned int width, unsigned int height);
+	void Free(const Region& region) noexcept;
+	void Clear() noexcept;
+
+	ND constexpr unsigned int Width() const noexcept { return m_width; }
+	ND constexpr unsigned int Height() const noexcept { return m_height; }
+	ND constexpr size_t ShelfCount() const noexcept { return m_shelves.size(); }
+	ND constexpr unsigned int UsedHeight() const noexcept { return m_nextShelfTop; }
+
+private:
+	struct Hole
+	{
+		unsigned int X = 0;
+		unsigned int Width = 0;
+	};
+	struct Shelf
+	{
+		unsigned int Top = 0;
+		unsigned int Height = 0;
+		unsigned int Cursor = 0;		// Everything right of the cursor has never been used
+		unsigned int RegionCount = 0;
+		std::vector<Hole> Holes;		// Freed spots left of the cursor
+	};
+
+	ND bool FitsShelf(const Shelf& shelf, unsigned int height) const noexcept;
+	ND std::optional<Region> AllocateOnShelf(Shelf& shelf, unsigned int width, unsigned int height) noexcept;
+
+	unsigned int m_width;
+	unsigned int m_height;
+	std::vector<Shelf> m_shelves;
+	unsigned int m_nextShelfTop = 0;
+};
+}
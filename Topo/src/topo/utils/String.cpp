@@ -55,4 +55,32 @@ bool ends_with(std::string_view str, std::string_view suffix) noexcept
     return str.size() >= suffix.size() && 
         str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0; 
 }
+
+void append_utf8(std::string& str, char32_t codepoint)
+{
+    // Surrogates and anything beyond U+10FFFF cannot be encoded, so they become U+FFFD (replacement character)
+    if ((codepoint >= 0xD800 && codepoint <= 0xDFFF) || codepoint > 0x10FFFF)
+        codepoint = 0xFFFD;
+
+    if (codepoint < 0x80)
+        str.push_back(static_cast<char>(codepoint));
+    else if (codepoint < 0x800)
+    {
+        str.push_back(static_cast<char>(0xC0 | (codepoint >> 6)));
+        str.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    }
+    else if (codepoint < 0x10000)
+    {
+        str.push_back(static_cast<char>(0xE0 | (codepoint >> 12)));
+        str.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    }
+    else
+    {
+        str.push_back(static_cast<char>(0xF0 | (codepoint >> 18)));
+        str.push_back(static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F)));
+        str.push_back(static_cast<char>(0x80 | (codepoint & 0x3F)));
+    }
+}
 }
\ No newline at end of file
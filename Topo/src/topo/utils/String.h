@@ -9,4 +9,8 @@ ND std::wstring s2ws(std::string_view str) noexcept;
 ND std::string ws2s(const std::wstring& wstr) noexcept;
 ND bool ends_with(std::string_view str, std::string_view suffix) noexcept;
 
+// UTF-8
+void append_utf8(std::string& str, char32_t codepoint);
+ND constexpr bool is_utf8_continuation(char c) noexcept { return (static_cast<unsigned char>(c) & 0xC0) == 0x80; }
+
 }
\ No newline at end of file
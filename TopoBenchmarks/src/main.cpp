@@ -0,0 +1,192 @@
+#include "pch.h"
+#include "topo/rendering/UIInstanceBuilder.h"
+#include "topo/rendering/UIRenderer.h"
+#include "topo/utils/Timer.h"
+
+using topo::BasicGeometry2D;
+using topo::Color;
+using topo::LineBatch2D;
+using topo::RectangleBatch2D;
+using topo::RenderEffect2D;
+using topo::UIObjectData;
+using topo::UIRenderer;
+
+// Times the three ways of getting rectangles/lines into instance data, on the same data:
+//   - The per-object path: UpdateRectangle()/UpdateLine() for every object, which only stores the description and
+//     queues the object, and then UIRenderer::Update(), which gathers the queued objects into batches, runs the
+//     batch builders and scatters the instances back to where they live
+//   - The batch builders on their own (BuildRectangleInstances/BuildLineInstances into a scratch array), which is
+//     the floor for building the instance data
+//   - The in-place path: UpdateRectangles()/UpdateLines(), which writes each instance right where it lives, and then
+//     UIRenderer::Update() (which has nothing left to commit)
+// The renderer never gets device resources, so nothing is uploaded or drawn - only the CPU side is timed. Every
+// object moves by a pixel each iteration (outside of the timed section), so every instance actually changes.
+// NOTE: Only the numbers of Release/Dist builds mean anything
+namespace
+{
+constexpr size_t ObjectCount = 100'000;
+constexpr unsigned int WarmupIterations = 10;
+constexpr unsigned int Iterations = 120;
+
+struct Timing
+{
+	double UpdateMs = 0.0;	// The calls that describe the objects (or build the instances)
+	double CommitMs = 0.0;	// UIRenderer::Update()
+	double WorstMs = 0.0;	// Worst iteration, both parts together
+};
+
+// prepare() is not timed, update() and commit() are timed separately
+template<typename Prepare, typename Update, typename Commit>
+Timing Measure(Prepare&& prepare, Update&& update, Commit&& commit)
+{
+	using Clock = std::chrono::steady_clock;
+	const auto milliseconds = [](Clock::duration duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+
+	Timing timing;
+	for (unsigned int iteration = 0; iteration < WarmupIterations + Iterations; ++iteration)
+	{
+		prepare(iteration);
+
+		const Clock::time_point start = Clock::now();
+		update();
+		const Clock::time_point updated = Clock::now();
+		commit();
+		const Clock::time_point end = Clock::now();
+
+		if (iteration < WarmupIterations)
+			continue;
+
+		timing.UpdateMs += milliseconds(updated - start);
+		timing.CommitMs += milliseconds(end - updated);
+		timing.WorstMs = std::max(timing.WorstMs, milliseconds(end - start));
+	}
+
+	timing.UpdateMs /= Iterations;
+	timing.CommitMs /= Iterations;
+	return timing;
+}
+
+void Print(std::string_view name, const Timing& timing)
+{
+	std::println("{0:<40} {1:>8.3f}ms {2:>8.3f}ms {3:>8.3f}ms {4:>8.3f}ms", name, timing.UpdateMs, timing.CommitMs, timing.UpdateMs + timing.CommitMs, timing.WorstMs);
+}
+
+struct Rectangles
+{
+	std::vector<float> Left, Top, Right, Bottom;
+	std::vector<Color> Colors;
+
+	ND RectangleBatch2D Batch() const noexcept { return { Left, Top, Right, Bottom, Colors }; }
+	void Move(float dx) noexcept
+	{
+		for (size_t iii = 0; iii < Left.size(); ++iii)
+		{
+			Left[iii] += dx;
+			Right[iii] += dx;
+		}
+	}
+};
+struct Lines
+{
+	std::vector<float> X1, Y1, X2, Y2, Thickness;
+	std::vector<Color> Colors;
+
+	ND LineBatch2D Batch() const noexcept { return { X1, Y1, X2, Y2, Thickness, Colors }; }
+	void Move(float dx) noexcept
+	{
+		for (size_t iii = 0; iii < X1.size(); ++iii)
+		{
+			X1[iii] += dx;
+			X2[iii] += dx;
+		}
+	}
+};
+
+// A grid of 1 pixel rectangles and short diagonal lines that covers a 500 pixel wide window
+ND Rectangles MakeRectangles()
+{
+	Rectangles rectangles;
+	for (size_t iii = 0; iii < ObjectCount; ++iii)
+	{
+		const float left = static_cast<float>(iii % 500);
+		const float top = static_cast<float>(iii / 500);
+		rectangles.Left.push_back(left);
+		rectangles.Top.push_back(top);
+		rectangles.Right.push_back(left + 1.0f);
+		rectangles.Bottom.push_back(top + 1.0f);
+		rectangles.Colors.push_back({ 0.0f, static_cast<float>(iii % 256) / 255.0f, 1.0f, 1.0f });
+	}
+	return rectangles;
+}
+ND Lines MakeLines()
+{
+	Lines lines;
+	for (size_t iii = 0; iii < ObjectCount; ++iii)
+	{
+		const float x = static_cast<float>(iii % 500);
+		const float y = static_cast<float>(iii / 500);
+		lines.X1.push_back(x);
+		lines.Y1.push_back(y);
+		lines.X2.push_back(x + 3.0f);
+		lines.Y2.push_back(y + 2.0f);
+		lines.Thickness.push_back(1.0f);
+		lines.Colors.push_back({ 1.0f, static_cast<float>(iii % 256) / 255.0f, 0.0f, 1.0f });
+	}
+	return lines;
+}
+
+ND std::vector<unsigned int> RegisterObjects(UIRenderer& renderer, BasicGeometry2D geometry)
+{
+	std::vector<unsigned int> uuids(ObjectCount);
+	for (unsigned int& uuid : uuids)
+		uuid = renderer.RegisterObject(RenderEffect2D::Opaque, geometry);
+	return uuids;
+}
+}
+
+int main()
+{
+	UIRenderer renderer(500.0f, static_cast<float>(ObjectCount / 500));
+	const topo::Timer timer;
+
+	Rectangles rectangles = MakeRectangles();
+	Lines lines = MakeLines();
+	const std::vector<unsigned int> rectangleObjects = RegisterObjects(renderer, BasicGeometry2D::Rectangle);
+	const std::vector<unsigned int> lineObjects = RegisterObjects(renderer, BasicGeometry2D::Line);
+
+	// The objects get their instances when they are first committed, so every timed update below changes existing ones
+	renderer.UpdateRectangles(rectangleObjects, rectangles.Batch());
+	renderer.UpdateLines(lineObjects, lines.Batch());
+	renderer.Update(timer, 0);
+
+	std::vector<UIObjectData> scratch(ObjectCount);
+	const auto moveRectangles = [&rectangles](unsigned int iteration) { rectangles.Move(iteration % 2 == 0 ? 1.0f : -1.0f); };
+	const auto moveLines = [&lines](unsigned int iteration) { lines.Move(iteration % 2 == 0 ? 1.0f : -1.0f); };
+	const auto commit = [&renderer, &timer]() { renderer.Update(timer, 0); };
+	const auto noCommit = []() {};
+
+	std::println("{0} objects, average of {1} iterations", ObjectCount, Iterations);
+	std::println("{0:<40} {1:>10} {2:>10} {3:>10} {4:>10}", "", "update", "commit", "total", "worst");
+
+	Print("Rectangles: UpdateRectangle (per object)", Measure(moveRectangles,
+		[&]()
+		{
+			for (size_t iii = 0; iii < ObjectCount; ++iii)
+				renderer.UpdateRectangle(rectangleObjects[iii], rectangles.Left[iii], rectangles.Top[iii], rectangles.Right[iii], rectangles.Bottom[iii], rectangles.Colors[iii]);
+		},
+		commit));
+	Print("Rectangles: BuildRectangleInstances", Measure(moveRectangles, [&]() { topo::BuildRectangleInstances(rectangles.Batch(), scratch); }, noCommit));
+	Print("Rectangles: UpdateRectangles (in place)", Measure(moveRectangles, [&]() { renderer.UpdateRectangles(rectangleObjects, rectangles.Batch()); }, commit));
+
+	Print("Lines: UpdateLine (per object)", Measure(moveLines,
+		[&]()
+		{
+			for (size_t iii = 0; iii < ObjectCount; ++iii)
+				renderer.UpdateLine(lineObjects[iii], lines.X1[iii], lines.Y1[iii], lines.X2[iii], lines.Y2[iii], lines.Colors[iii], lines.Thickness[iii]);
+		},
+		commit));
+	Print("Lines: BuildLineInstances", Measure(moveLines, [&]() { topo::BuildLineInstances(lines.Batch(), scratch); }, noCommit));
+	Print("Lines: UpdateLines (in place)", Measure(moveLines, [&]() { renderer.UpdateLines(lineObjects, lines.Batch()); }, commit));
+
+	return 0;
+}
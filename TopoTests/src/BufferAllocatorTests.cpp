@@ -0,0 +1,101 @@
+#include "pch.h"
+#include "Test.h"
+#include "topo/utils/BufferAllocator.h"
+
+using topo::BufferAllocator;
+
+namespace
+{
+struct Allocation
+{
+	size_t Offset = 0;
+	size_t Size = 0;
+};
+
+// Allocations must be aligned, inside of the buffer and must not overlap each other, and GetUsed() must add up
+bool IsConsistent(const BufferAllocator& allocator, std::vector<Allocation> allocations)
+{
+	std::ranges::sort(allocations, {}, &Allocation::Offset);
+	size_t used = 0;
+	size_t end = 0;
+	for (const Allocation& allocation : allocations)
+	{
+		if (allocation.Offset % allocator.GetAlignment() != 0 || allocation.Offset < end)
+			return false;
+		end = allocation.Offset + allocator.AlignedSize(allocation.Size);
+		used += allocator.AlignedSize(allocation.Size);
+	}
+	return end <= allocator.GetCapacity() && used == allocator.GetUsed();
+}
+}
+
+TEST(BufferAllocator_AlignsAndMergesRanges)
+{
+	BufferAllocator allocator(1000, 256);
+	CHECK(allocator.GetCapacity() == 768);
+
+	const std::optional<size_t> a = allocator.Allocate(10);
+	const std::optional<size_t> b = allocator.Allocate(300);
+	CHECK(a == 0u && b == 256u);
+	CHECK(allocator.GetUsed() == 768);
+	CHECK(!allocator.Allocate(1).has_value());
+	CHECK(!allocator.Allocate(0).has_value());
+
+	// Freeing both merges them back into a single range, so the whole buffer can be allocated again
+	allocator.Free(a.value(), 10);
+	CHECK(!allocator.Allocate(512).has_value());
+	allocator.Free(b.value(), 300);
+	CHECK(allocator.GetUsed() == 0);
+	CHECK(allocator.Allocate(768) == 0u);
+}
+
+TEST(BufferAllocator_GrowKeepsAllocations)
+{
+	BufferAllocator allocator(512, 256);
+	const std::optional<size_t> a = allocator.Allocate(256);
+	const std::optional<size_t> b = allocator.Allocate(256);
+	CHECK(a.has_value() && b.has_value());
+
+	// The new space merges with the free range at the old end (if any)
+	allocator.Free(b.value(), 256);
+	allocator.Grow(1024);
+	CHECK(allocator.GetCapacity() == 1024 && allocator.GetUsed() == 256);
+	CHECK(allocator.Allocate(768) == 256u);
+
+	// Smaller capacities are ignored, and Reset frees everything
+	allocator.Grow(256);
+	CHECK(allocator.GetCapacity() == 1024);
+	allocator.Reset(2048);
+	CHECK(allocator.GetUsed() == 0 && allocator.Allocate(2048) == 0u);
+}
+
+TEST(BufferAllocator_RandomAllocationsNeverOverlap)
+{
+	topo::test::Random random(31);
+	BufferAllocator allocator(64 * 1024, 64);
+	std::vector<Allocation> allocations;
+	for (unsigned int step = 0; step < 2000; ++step)
+	{
+		if (!allocations.empty() && random.Range(0, 2) == 0)
+		{
+			const size_t index = random.Range(0, allocations.size());
+			allocator.Free(allocations[index].Offset, allocations[index].Size);
+			allocations[index] = allocations.back();
+			allocations.pop_back();
+		}
+		else
+		{
+			const size_t size = random.Range(1, 4000);
+			if (const std::optional<size_t> offset = allocator.Allocate(size))
+				allocations.push_back({ offset.value(), size });
+		}
+
+		if (step % 100 == 0)
+			CHECK(IsConsistent(allocator, allocations));
+	}
+	CHECK(IsConsistent(allocator, allocations));
+
+	for (const Allocation& allocation : allocations)
+		allocator.Free(allocation.Offset, allocation.Size);
+	CHECK(allocator.GetUsed() == 0 && allocator.Allocate(allocator.GetCapacity()) == 0u);
+}
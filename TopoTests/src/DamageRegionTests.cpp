@@ -0,0 +1,100 @@
+#include "pch.h"
+#include "Test.h"
+#include "topo/utils/DamageRegion.h"
+
+using topo::DamageRegion;
+using topo::Rect;
+
+namespace
+{
+constexpr bool Overlap(const Rect& a, const Rect& b) noexcept
+{
+	return a.Left < b.Right && b.Left < a.Right && a.Top < b.Bottom && b.Top < a.Bottom;
+}
+
+// The rects of a region must never overlap each other, and together they must cover everything that was added
+bool IsValidRegion(const DamageRegion& region, std::span<const Rect> added)
+{
+	const std::span<const Rect> rects = region.GetRects();
+	for (size_t iii = 0; iii < rects.size(); ++iii)
+	{
+		for (size_t jjj = iii + 1; jjj < rects.size(); ++jjj)
+		{
+			if (Overlap(rects[iii], rects[jjj]))
+				return false;
+		}
+	}
+
+	for (const Rect& rect : added)
+	{
+		for (float y = rect.Top + 0.5f; y < rect.Bottom; y += 1.0f)
+		{
+			for (float x = rect.Left + 0.5f; x < rect.Right; x += 1.0f)
+			{
+				if (std::ranges::none_of(rects, [x, y](const Rect& r) { return r.ContainsPoint(x, y); }))
+					return false;
+			}
+		}
+	}
+	return rects.size() <= DamageRegion::MaxRects;
+}
+}
+
+TEST(DamageRegion_MergesOverlapsAndSharedEdges)
+{
+	DamageRegion region;
+	region.Add({ 0.0f, 0.0f, 10.0f, 10.0f });
+	region.Add({ 10.0f, 0.0f, 20.0f, 10.0f });
+	CHECK(region.GetRects().size() == 1 && region.GetRects()[0] == Rect(0.0f, 0.0f, 20.0f, 10.0f));
+
+	// Apart from each other they stay separate, until a rect that overlaps both of them comes along
+	region.Add({ 40.0f, 0.0f, 50.0f, 10.0f });
+	CHECK(region.GetRects().size() == 2);
+	region.Add({ 15.0f, 5.0f, 45.0f, 8.0f });
+	CHECK(region.GetRects().size() == 1 && region.GetRects()[0] == Rect(0.0f, 0.0f, 50.0f, 10.0f));
+	CHECK(region.Area() == 500.0f);
+
+	// Empty rects are ignored
+	region.Add({ 60.0f, 60.0f, 60.0f, 70.0f });
+	CHECK(region.GetRects().size() == 1);
+	region.Clear();
+	CHECK(region.Empty());
+}
+
+TEST(DamageRegion_LimitsRectCount)
+{
+	DamageRegion region;
+	std::vector<Rect> added;
+	for (unsigned int iii = 0; iii < 3 * DamageRegion::MaxRects; ++iii)
+	{
+		const float x = static_cast<float>(iii % 6) * 20.0f;
+		const float y = static_cast<float>(iii / 6) * 20.0f;
+		added.push_back({ x, y, x + 4.0f, y + 4.0f });
+		region.Add(added.back());
+	}
+	CHECK(region.GetRects().size() <= DamageRegion::MaxRects);
+	CHECK(IsValidRegion(region, added));
+}
+
+TEST(DamageRegion_CoversEverythingAdded)
+{
+	topo::test::Random random(29);
+	for (unsigned int round = 0; round < 20; ++round)
+	{
+		DamageRegion region;
+		std::vector<Rect> added;
+		for (unsigned int iii = 0; iii < 15; ++iii)
+		{
+			const float left = static_cast<float>(random.Range(0, 60));
+			const float top = static_cast<float>(random.Range(0, 60));
+			added.push_back({ left, top, left + static_cast<float>(random.Range(1, 12)), top + static_cast<float>(random.Range(1, 12)) });
+			region.Add(added.back());
+		}
+		CHECK(IsValidRegion(region, added));
+
+		// Adding a region adds each of its rects
+		DamageRegion copy;
+		copy.Add(region);
+		CHECK(IsValidRegion(copy, added) && copy.Area() == region.Area());
+	}
+}
@@ -0,0 +1,234 @@
+#include "pch.h"
+#include "Test.h"
+#include "topo/rendering/GlyphCache.h"
+
+using topo::GlyphAtlas;
+using topo::GlyphCache;
+using topo::GlyphBitmap;
+using topo::ShapedRun;
+
+namespace
+{
+// Every glyph is GlyphSize x GlyphSize (so exactly 4 fit in the atlas) and filled with the low byte of its
+// codepoint, except for spaces, which are empty. The rasterizer counts how often each codepoint gets rasterized
+constexpr unsigned int GlyphSize = GlyphAtlas::Width / 2;
+constexpr float GlyphAdvance = 10.0f;
+
+struct RasterizerStats
+{
+	std::unordered_map<char32_t, unsigned int> Rasterized;
+	unsigned int FontsLoaded = 0;
+};
+
+class FakeRasterizer : public topo::GlyphRasterizer
+{
+public:
+	explicit FakeRasterizer(RasterizerStats& stats) noexcept : m_stats(stats) {}
+
+	unsigned int LoadFont(std::string_view family) override { return m_stats.FontsLoaded++; }
+	topo::FontMetrics GetFontMetrics(unsigned int font, float size) override { return { size, size / 4.0f, 0.0f }; }
+	void RasterizeGlyph(unsigned int font, float size, char32_t codepoint, GlyphBitmap& bitmap) override
+	{
+		++m_stats.Rasterized[codepoint];
+		const unsigned int extent = (codepoint == U' ') ? 0 : GlyphSize;
+		bitmap.Width = extent;
+		bitmap.Height = extent;
+		bitmap.Left = 0;
+		bitmap.Top = -static_cast<int>(extent);
+		bitmap.Advance = GlyphAdvance;
+		bitmap.Coverage.assign(static_cast<size_t>(extent) * extent, static_cast<std::uint8_t>(codepoint & 0xFF));
+	}
+
+private:
+	RasterizerStats& m_stats;
+};
+
+struct Fixture
+{
+	RasterizerStats Stats;
+	GlyphCache Cache{ std::make_unique<FakeRasterizer>(Stats) };
+	unsigned int Font = Cache.LoadFont("Fake");
+
+	ND std::uint64_t Key(char32_t codepoint) const noexcept { return GlyphCache::MakeGlyphKey(Font, 14.0f, codepoint); }
+};
+
+// The glyph's region of the atlas must hold its own coverage
+bool HoldsGlyph(const GlyphAtlas& atlas, const GlyphCache::Glyph& glyph, char32_t codepoint)
+{
+	const std::span<const std::uint8_t> pixels = atlas.GetPixels();
+	for (unsigned int y = glyph.Region.Y; y < glyph.Region.Y + glyph.Region.Height; y += 37)
+	{
+		for (unsigned int x = glyph.Region.X; x < glyph.Region.X + glyph.Region.Width; x += 37)
+		{
+			if (pixels[static_cast<size_t>(y) * GlyphAtlas::Width + x] != static_cast<std::uint8_t>(codepoint & 0xFF))
+				return false;
+		}
+	}
+	return true;
+}
+}
+
+TEST(GlyphCache_LoadFontOnce)
+{
+	Fixture fixture;
+	CHECK(fixture.Cache.LoadFont("Fake") == fixture.Font);
+	CHECK(fixture.Cache.LoadFont("Other") != fixture.Font);
+	CHECK(fixture.Stats.FontsLoaded == 2);
+}
+
+TEST(GlyphCache_EvictsLeastRecentlyReleased)
+{
+	Fixture fixture;
+	GlyphCache& cache = fixture.Cache;
+	for (const char32_t codepoint : std::u32string_view(U"abcd"))
+		CHECK(cache.AcquireGlyph(fixture.Key(codepoint)) != nullptr);
+	CHECK(cache.ResidentGlyphCount() == 4);
+
+	// Released in the order b, a, d, c, so b is the first to go, then a, d and c
+	for (const char32_t codepoint : std::u32string_view(U"badc"))
+		cache.ReleaseGlyph(fixture.Key(codepoint));
+
+	const GlyphCache::Glyph* e = cache.AcquireGlyph(fixture.Key(U'e'));
+	CHECK(e != nullptr);
+	CHECK(cache.ResidentGlyphCount() == 4);
+	CHECK(HoldsGlyph(cache.GetAtlas(), *e, U'e'));
+
+	// a is still resident (no rasterization), and acquiring it again pins it, which makes d the next to go
+	CHECK(cache.AcquireGlyph(fixture.Key(U'a')) != nullptr);
+	CHECK(fixture.Stats.Rasterized[U'a'] == 1);
+
+	// b was evicted, so it has to be rasterized again (and evicts d to make room)
+	const GlyphCache::Glyph* b = cache.AcquireGlyph(fixture.Key(U'b'));
+	CHECK(b != nullptr);
+	CHECK(fixture.Stats.Rasterized[U'b'] == 2);
+	CHECK(HoldsGlyph(cache.GetAtlas(), *b, U'b'));
+
+	CHECK(cache.AcquireGlyph(fixture.Key(U'c')) != nullptr);
+	CHECK(fixture.Stats.Rasterized[U'c'] == 1);
+	CHECK(cache.AcquireGlyph(fixture.Key(U'd')) == nullptr);	// a, b, c and e are all pinned now
+	CHECK(fixture.Stats.Rasterized[U'd'] == 2);
+}
+
+TEST(GlyphCache_PinnedGlyphsStay)
+{
+	Fixture fixture;
+	GlyphCache& cache = fixture.Cache;
+
+	// a is acquired twice, so a single release leaves it pinned
+	std::vector<const GlyphCache::Glyph*> glyphs;
+	for (const char32_t codepoint : std::u32string_view(U"abcd"))
+		glyphs.push_back(cache.AcquireGlyph(fixture.Key(codepoint)));
+	CHECK(cache.AcquireGlyph(fixture.Key(U'a')) == glyphs[0]);
+	cache.ReleaseGlyph(fixture.Key(U'a'));
+
+	// Nothing can be evicted, so the new glyph is not drawn, and the pinned ones are left alone
+	CHECK(cache.AcquireGlyph(fixture.Key(U'e')) == nullptr);
+	CHECK(cache.ResidentGlyphCount() == 4);
+	CHECK(HoldsGlyph(cache.GetAtlas(), *glyphs[0], U'a'));
+	CHECK(HoldsGlyph(cache.GetAtlas(), *glyphs[3], U'd'));
+
+	// Releasing c makes room for e (in c's spot), and everything else stays where it was
+	const GlyphAtlas::Region cRegion = glyphs[2]->Region;
+	cache.ReleaseGlyph(fixture.Key(U'c'));
+	const GlyphCache::Glyph* e = cache.AcquireGlyph(fixture.Key(U'e'));
+	CHECK(e != nullptr);
+	CHECK(e->Region.X == cRegion.X && e->Region.Y == cRegion.Y);
+	CHECK(HoldsGlyph(cache.GetAtlas(), *e, U'e'));
+	CHECK(HoldsGlyph(cache.GetAtlas(), *glyphs[0], U'a'));
+	CHECK(HoldsGlyph(cache.GetAtlas(), *glyphs[1], U'b'));
+	CHECK(HoldsGlyph(cache.GetAtlas(), *glyphs[3], U'd'));
+
+	// Releasing a glyph that is not acquired is ignored
+	cache.ReleaseGlyph(fixture.Key(U'z'));
+	CHECK(cache.ResidentGlyphCount() == 4);
+}
+
+TEST(GlyphCache_EmptyGlyphsTakeNoRoom)
+{
+	Fixture fixture;
+	GlyphCache& cache = fixture.Cache;
+	for (const char32_t codepoint : std::u32string_view(U"abcd"))
+		CHECK(cache.AcquireGlyph(fixture.Key(codepoint)) != nullptr);
+
+	const GlyphCache::Glyph* space = cache.AcquireGlyph(fixture.Key(U' '));
+	CHECK(space != nullptr);
+	CHECK(space->Region.Width == 0 && space->Advance == GlyphAdvance);
+	CHECK(cache.ResidentGlyphCount() == 4);
+}
+
+TEST(GlyphCache_ShapesRuns)
+{
+	Fixture fixture;
+	GlyphCache& cache = fixture.Cache;
+
+	// U+00E9 is two bytes of UTF-8, but a single glyph
+	const ShapedRun& run = cache.ShapeText("a \xC3\xA9", fixture.Font, 14.0f);
+	CHECK(run.Glyphs.size() == 3);
+	CHECK(run.Width == 3.0f * GlyphAdvance);
+	CHECK(run.Glyphs[1].Key == fixture.Key(U' ') && run.Glyphs[1].X == GlyphAdvance);
+	CHECK(run.Glyphs[2].Key == fixture.Key(U'\u00E9') && run.Glyphs[2].X == 2.0f * GlyphAdvance);
+
+	// Malformed UTF-8 shapes as U+FFFD, one byte at a time
+	const ShapedRun& malformed = cache.ShapeText("\xC3", fixture.Font, 14.0f);
+	CHECK(malformed.Glyphs.size() == 1 && malformed.Glyphs[0].Key == fixture.Key(U'\uFFFD'));
+
+	// Shaping rasterizes each glyph once, and shaping the same text again is a cache hit
+	const ShapedRun* first = &cache.ShapeText("a \xC3\xA9", fixture.Font, 14.0f);
+	CHECK(first == &run);
+	CHECK(fixture.Stats.Rasterized[U'a'] == 1);
+	CHECK(cache.CachedRunCount() == 2);
+
+	// The size is part of the key
+	const ShapedRun& larger = cache.ShapeText("a \xC3\xA9", fixture.Font, 20.0f);
+	CHECK(&larger != first);
+	CHECK(larger.Glyphs[0].Key == GlyphCache::MakeGlyphKey(fixture.Font, 20.0f, U'a'));
+	CHECK(cache.CachedRunCount() == 3);
+}
+
+TEST(GlyphCache_EvictsLeastRecentlyUsedRun)
+{
+	Fixture fixture;
+	GlyphCache& cache = fixture.Cache;
+	for (size_t iii = 0; iii < GlyphCache::MaxShapedRuns; ++iii)
+		(void)cache.ShapeText(std::to_string(iii), fixture.Font, 14.0f);
+	CHECK(cache.CachedRunCount() == GlyphCache::MaxShapedRuns);
+
+	// Using run "0" makes "1" the least recently used run, so that is the one the next run replaces
+	const ShapedRun* zero = &cache.ShapeText("0", fixture.Font, 14.0f);
+	(void)cache.ShapeText("new", fixture.Font, 14.0f);
+	CHECK(cache.CachedRunCount() == GlyphCache::MaxShapedRuns);
+	CHECK(&cache.ShapeText("0", fixture.Font, 14.0f) == zero);
+	CHECK(cache.CachedRunCount() == GlyphCache::MaxShapedRuns);
+
+	// Glyph metrics outlive the runs, so shaping an evicted run again does not rasterize anything
+	(void)cache.ShapeText("1", fixture.Font, 14.0f);
+	CHECK(fixture.Stats.Rasterized[U'1'] == 1);
+}
+
+TEST(GlyphAtlas_WritesAndTracksDirtyRows)
+{
+	GlyphAtlas atlas;
+	CHECK(atlas.TakeDirtyRows() == std::pair(0u, 0u));
+
+	const std::optional<GlyphAtlas::Region> first = atlas.Allocate(3, 2);
+	const std::optional<GlyphAtlas::Region> second = atlas.Allocate(4, 8);
+	CHECK(first.has_value() && second.has_value());
+
+	const std::array<std::uint8_t, 6> coverage = { 1, 2, 3, 4, 5, 6 };
+	atlas.Write(first.value(), coverage);
+	const std::span<const std::uint8_t> pixels = atlas.GetPixels();
+	const size_t origin = static_cast<size_t>(first->Y) * GlyphAtlas::Width + first->X;
+	CHECK(pixels[origin] == 1 && pixels[origin + 2] == 3);
+	CHECK(pixels[origin + GlyphAtlas::Width] == 4 && pixels[origin + GlyphAtlas::Width + 2] == 6);
+	CHECK(pixels[origin + 3] == 0);
+
+	std::vector<std::uint8_t> block(4 * 8, 9);
+	atlas.Write(second.value(), block);
+	const auto [firstRow, lastRow] = atlas.TakeDirtyRows();
+	CHECK(firstRow == std::min<unsigned int>(first->Y, second->Y));
+	CHECK(lastRow == std::max<unsigned int>(first->Y + first->Height, second->Y + second->Height));
+	CHECK(atlas.TakeDirtyRows() == std::pair(0u, 0u));
+
+	// Too large to ever fit
+	CHECK(!atlas.Allocate(GlyphAtlas::Width + 1, 1).has_value());
+}
@@ -0,0 +1,167 @@
+#include "pch.h"
+#include "Test.h"
+#include "topo/utils/MinMaxPyramid.h"
+
+using topo::MinMaxPyramid;
+using topo::test::Random;
+
+namespace
+{
+MinMaxPyramid::MinMax BruteForceMinMax(std::span<const float> samples, size_t first, size_t count)
+{
+	const auto [min, max] = std::minmax_element(samples.begin() + first, samples.begin() + first + count);
+	return { *min, *max };
+}
+
+// Every block of every level must hold the exact min/max of the samples it covers (the last block of a level may
+// only be partially filled)
+bool MatchesBruteForce(const MinMaxPyramid& pyramid)
+{
+	bool matches = true;
+	for (size_t level = 0; level < pyramid.LevelCount(); ++level)
+	{
+		size_t expectedFirst = 0;
+		pyramid.ForEachBlock(0, pyramid.Size(), (pyramid.Size() + (1ull << level) - 1) >> level,
+			[&](size_t firstSample, size_t sampleCount, float min, float max)
+			{
+				const MinMaxPyramid::MinMax expected = BruteForceMinMax(pyramid.GetSamples(), firstSample, sampleCount);
+				matches = matches && firstSample == expectedFirst && sampleCount > 0 && min == expected.Min && max == expected.Max;
+				expectedFirst = firstSample + sampleCount;
+			});
+		matches = matches && expectedFirst == pyramid.Size();
+	}
+	return matches;
+}
+}
+
+TEST(MinMaxPyramid_AppendOneAtATime)
+{
+	// Crosses every block boundary of the lower levels, including the ones that add a level
+	MinMaxPyramid pyramid;
+	Random random(1);
+	for (size_t iii = 0; iii < 130; ++iii)
+	{
+		const float sample = random.Float(-10.0f, 10.0f);
+		pyramid.Append({ &sample, 1 });
+		CHECK(pyramid.Size() == iii + 1);
+		CHECK(MatchesBruteForce(pyramid));
+	}
+	CHECK(pyramid.LevelCount() == 9);
+}
+
+TEST(MinMaxPyramid_AppendChunks)
+{
+	// Chunks that start and end in the middle of blocks, as well as chunks that span several blocks at once
+	for (const size_t chunk : { 2, 3, 7, 16, 33 })
+	{
+		MinMaxPyramid pyramid;
+		Random random(chunk);
+		std::vector<float> samples(chunk);
+		for (size_t iii = 0; iii < 10; ++iii)
+		{
+			for (float& sample : samples)
+				sample = random.Float(-1.0f, 1.0f);
+			pyramid.Append(samples);
+		}
+		CHECK(pyramid.Size() == chunk * 10);
+		CHECK(MatchesBruteForce(pyramid));
+	}
+}
+
+TEST(MinMaxPyramid_PeakInPartialBlock)
+{
+	// The new peak lands in a block that was already partially filled, so that block (and every block above it)
+	// has to be recomputed rather than just extended
+	MinMaxPyramid pyramid;
+	const std::vector<float> flat(5, 0.0f);
+	pyramid.Append(flat);
+
+	const float peak = 100.0f;
+	pyramid.Append({ &peak, 1 });
+	CHECK(MatchesBruteForce(pyramid));
+
+	float max = 0.0f;
+	size_t blocks = 0;
+	pyramid.ForEachBlock(0, pyramid.Size(), 1, [&](size_t, size_t, float, float blockMax) { max = blockMax; ++blocks; });
+	CHECK(blocks == 1);
+	CHECK(max == peak);
+}
+
+TEST(MinMaxPyramid_PartialRanges)
+{
+	MinMaxPyramid pyramid;
+	Random random(7);
+	std::vector<float> samples(1000);
+	for (float& sample : samples)
+		sample = random.Float(-100.0f, 100.0f);
+	pyramid.Append(samples);
+
+	for (size_t iii = 0; iii < 500; ++iii)
+	{
+		const size_t first = random.Range(0, samples.size());
+		const size_t last = random.Range(first + 1, samples.size() + 1);
+		const size_t maxBlocks = random.Range(1, 64);
+
+		// The blocks must be contiguous, cover [first, last) and hold the exact min/max of their samples. Only the
+		// blocks at either end may extend past the range
+		size_t blocks = 0;
+		size_t next = 0;
+		bool valid = true;
+		pyramid.ForEachBlock(first, last, maxBlocks, [&](size_t firstSample, size_t sampleCount, float min, float max)
+			{
+				const MinMaxPyramid::MinMax expected = BruteForceMinMax(samples, firstSample, sampleCount);
+				valid = valid && min == expected.Min && max == expected.Max;
+				valid = valid && (blocks == 0 ? firstSample <= first : firstSample == next);
+				next = firstSample + sampleCount;
+				++blocks;
+			});
+		CHECK(valid);
+		CHECK(blocks >= 1 && blocks <= maxBlocks);
+		CHECK(next >= last && next <= samples.size());
+
+		// The finest level that fits is used, so one level lower must not fit
+		const size_t level = pyramid.SelectLevel(first, last, maxBlocks);
+		if (level > 0)
+			CHECK(((last - 1) >> (level - 1)) - (first >> (level - 1)) + 1 > maxBlocks);
+	}
+}
+
+TEST(MinMaxPyramid_EmptyAndClampedRanges)
+{
+	MinMaxPyramid pyramid;
+	size_t calls = 0;
+	const auto count = [&calls](size_t, size_t, float, float) { ++calls; };
+
+	pyramid.ForEachBlock(0, 10, 4, count);
+	CHECK(calls == 0);
+
+	const std::vector<float> samples = { 3.0f, -1.0f, 4.0f, 1.0f, -5.0f };
+	pyramid.Append(samples);
+
+	pyramid.ForEachBlock(3, 3, 4, count);
+	pyramid.ForEachBlock(4, 2, 4, count);
+	pyramid.ForEachBlock(5, 100, 4, count);
+	CHECK(calls == 0);
+
+	// last is clamped to the number of samples, and a block count of 0 is treated as 1
+	float min = 0.0f;
+	float max = 0.0f;
+	pyramid.ForEachBlock(0, 100, 0, [&](size_t, size_t, float blockMin, float blockMax) { ++calls; min = blockMin; max = blockMax; });
+	CHECK(calls == 1);
+	CHECK(min == -5.0f && max == 4.0f);
+
+	// At level 0, every sample is a block of its own
+	calls = 0;
+	pyramid.ForEachBlock(1, 4, 3, [&](size_t firstSample, size_t sampleCount, float blockMin, float blockMax)
+		{
+			CHECK(firstSample == calls + 1 && sampleCount == 1 && blockMin == samples[firstSample] && blockMax == blockMin);
+			++calls;
+		});
+	CHECK(calls == 3);
+
+	pyramid.Clear();
+	CHECK(pyramid.Size() == 0 && pyramid.LevelCount() == 1);
+	calls = 0;
+	pyramid.ForEachBlock(0, 5, 4, count);
+	CHECK(calls == 0);
+}
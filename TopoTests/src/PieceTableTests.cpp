@@ -0,0 +1,98 @@
+#include "pch.h"
+#include "Test.h"
+#include "topo/utils/PieceTable.h"
+
+using topo::PieceTable;
+
+namespace
+{
+// Every query of the piece table must agree with the same question asked of a plain string
+bool MatchesText(const PieceTable& table, const std::string& text)
+{
+	if (table.Length() != text.size() || table.GetText() != text)
+		return false;
+
+	const size_t lineCount = static_cast<size_t>(std::ranges::count(text, '\n')) + 1;
+	if (table.LineCount() != lineCount)
+		return false;
+
+	size_t start = 0;
+	for (size_t line = 0; line < lineCount; ++line)
+	{
+		const size_t end = std::min(text.find('\n', start), text.size());
+		if (table.LineStart(line) != start || table.LineEnd(line) != end || table.GetLine(line) != text.substr(start, end - start))
+			return false;
+		start = end + 1;
+	}
+
+	for (size_t position = 0; position < text.size(); ++position)
+	{
+		const size_t line = static_cast<size_t>(std::count(text.begin(), text.begin() + static_cast<std::ptrdiff_t>(position), '\n'));
+		if (table.CharAt(position) != text[position] || table.LineFromPosition(position) != line)
+			return false;
+	}
+	return table.LineFromPosition(text.size()) == lineCount - 1;
+}
+}
+
+TEST(PieceTable_InsertAndErase)
+{
+	PieceTable table("hello\nworld");
+	CHECK(MatchesText(table, "hello\nworld"));
+
+	table.Insert(5, ",");
+	table.Insert(0, ">");
+	table.Insert(table.Length(), "!\n");
+	CHECK(MatchesText(table, ">hello,\nworld!\n"));
+
+	table.Erase(3, 6);
+	CHECK(MatchesText(table, ">heorld!\n"));
+	table.Erase(0, table.Length());
+	CHECK(MatchesText(table, ""));
+
+	// Out of range positions append, and erasing past the end stops at the end
+	table.Insert(100, "ab\ncd");
+	table.Erase(4, 100);
+	CHECK(MatchesText(table, "ab\nc"));
+}
+
+TEST(PieceTable_TypingExtendsThePiece)
+{
+	PieceTable table("text");
+	for (const char c : std::string_view("more\ntext"))
+		table.Insert(table.Length(), std::string_view(&c, 1));
+	CHECK(table.PieceCount() == 2);
+	CHECK(MatchesText(table, "textmore\ntext"));
+}
+
+TEST(PieceTable_MatchesStringUnderRandomEdits)
+{
+	topo::test::Random random(26);
+	std::string text = "first line\nsecond line\n\nfourth";
+	PieceTable table(text);
+
+	constexpr std::string_view alphabet = "abc\n";
+	for (unsigned int edit = 0; edit < 400; ++edit)
+	{
+		if (text.empty() || random.Range(0, 3) != 0)
+		{
+			const size_t position = random.Range(0, text.size() + 1);
+			std::string inserted;
+			for (size_t iii = random.Range(1, 6); iii > 0; --iii)
+				inserted += alphabet[random.Range(0, alphabet.size())];
+			text.insert(position, inserted);
+			table.Insert(position, inserted);
+		}
+		else
+		{
+			const size_t position = random.Range(0, text.size());
+			const size_t length = random.Range(1, 8);
+			text.erase(position, length);
+			table.Erase(position, length);
+		}
+
+		if (edit % 20 == 0)
+			CHECK(MatchesText(table, text));
+	}
+	CHECK(MatchesText(table, text));
+}
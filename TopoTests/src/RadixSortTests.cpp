@@ -0,0 +1,73 @@
+#include "pch.h"
+#include "Test.h"
+#include "topo/utils/RadixSort.h"
+
+using topo::RadixSort;
+
+namespace
+{
+// Sorts the keys with RadixSort and with std::stable_sort (the values are the keys' original indices) and compares
+bool MatchesStableSort(RadixSort& sort, std::vector<std::uint64_t> keys)
+{
+	std::vector<unsigned int> values(keys.size());
+	std::iota(values.begin(), values.end(), 0u);
+
+	std::vector<unsigned int> expected = values;
+	std::ranges::stable_sort(expected, {}, [&keys](unsigned int index) { return keys[index]; });
+
+	const std::vector<std::uint64_t> original = keys;
+	sort.Sort(keys, values);
+	if (values != expected)
+		return false;
+	for (size_t iii = 0; iii < keys.size(); ++iii)
+	{
+		if (keys[iii] != original[values[iii]])
+			return false;
+	}
+	return true;
+}
+}
+
+TEST(RadixSort_MatchesStableSort)
+{
+	topo::test::Random random(27);
+	RadixSort sort;
+
+	// Full range keys, and keys with lots of duplicates (stability)
+	std::vector<std::uint64_t> keys(1000);
+	for (std::uint64_t& key : keys)
+		key = (static_cast<std::uint64_t>(random.Next()) << 33) ^ random.Next();
+	CHECK(MatchesStableSort(sort, keys));
+
+	for (std::uint64_t& key : keys)
+		key = random.Range(0, 16) << 40;
+	CHECK(MatchesStableSort(sort, keys));
+}
+
+TEST(RadixSort_SkipsConstantDigits)
+{
+	topo::test::Random random(28);
+	RadixSort sort;
+
+	// Only one digit varies, so the sorted keys end up in the scratch space after a single pass and have to be
+	// copied back. With two varying digits they are already back in place
+	std::vector<std::uint64_t> keys(300);
+	for (std::uint64_t& key : keys)
+		key = 0xAB00000000000000ull | (random.Range(0, 256) << 16);
+	CHECK(MatchesStableSort(sort, keys));
+
+	for (std::uint64_t& key : keys)
+		key = 0xAB00000000000000ull | random.Range(0, 65536);
+	CHECK(MatchesStableSort(sort, keys));
+
+	// Keys that are all the same stay in order
+	CHECK(MatchesStableSort(sort, std::vector<std::uint64_t>(50, 42)));
+}
+
+TEST(RadixSort_TinyInputs)
+{
+	RadixSort sort;
+	CHECK(MatchesStableSort(sort, {}));
+	CHECK(MatchesStableSort(sort, { 7 }));
+	CHECK(MatchesStableSort(sort, { 9, 3 }));
+}
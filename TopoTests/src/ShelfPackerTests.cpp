@@ -0,0 +1,98 @@
+#include "pch.h"
+#include "Test.h"
+#include "topo/utils/ShelfPacker.h"
+
+using topo::ShelfPacker;
+
+namespace
+{
+// Regions must be inside of the packer's area and must not overlap each other
+bool AreDisjoint(const ShelfPacker& packer, std::span<const ShelfPacker::Region> regions)
+{
+	for (size_t iii = 0; iii < regions.size(); ++iii)
+	{
+		const ShelfPacker::Region& a = regions[iii];
+		if (a.X + a.Width > packer.Width() || a.Y + a.Height > packer.Height())
+			return false;
+
+		for (size_t jjj = iii + 1; jjj < regions.size(); ++jjj)
+		{
+			const ShelfPacker::Region& b = regions[jjj];
+			if (a.X < b.X + b.Width && b.X < a.X + a.Width && a.Y < b.Y + b.Height && b.Y < a.Y + a.Height)
+				return false;
+		}
+	}
+	return true;
+}
+}
+
+TEST(ShelfPacker_PacksShelvesByHeight)
+{
+	ShelfPacker packer(64, 64);
+
+	// Heights get rounded up to a multiple of 4, and rectangles of a similar height share a shelf
+	const std::optional<ShelfPacker::Region> a = packer.Allocate(20, 10);
+	const std::optional<ShelfPacker::Region> b = packer.Allocate(20, 11);
+	CHECK(a.has_value() && b.has_value());
+	CHECK(a->Y == b->Y && b->X == 20 && packer.ShelfCount() == 1 && packer.UsedHeight() == 12);
+
+	// Much smaller rectangles get a shelf of their own
+	const std::optional<ShelfPacker::Region> c = packer.Allocate(8, 3);
+	CHECK(c.has_value() && c->Y == 12 && packer.ShelfCount() == 2);
+
+	// Too large to ever fit, and too tall for the space that is left
+	CHECK(!packer.Allocate(65, 1).has_value());
+	CHECK(!packer.Allocate(10, 60).has_value());
+
+	packer.Clear();
+	CHECK(packer.ShelfCount() == 0 && packer.UsedHeight() == 0);
+	CHECK(packer.Allocate(64, 64).has_value());
+}
+
+TEST(ShelfPacker_ReusesFreedSpots)
+{
+	ShelfPacker packer(64, 16);
+	std::vector<ShelfPacker::Region> regions;
+	for (unsigned int iii = 0; iii < 4; ++iii)
+		regions.push_back(packer.Allocate(16, 16).value());
+	CHECK(!packer.Allocate(16, 16).has_value());
+
+	// The hole of a freed rectangle gets reused by anything that fits in it
+	packer.Free(regions[1]);
+	const std::optional<ShelfPacker::Region> small = packer.Allocate(8, 16);
+	CHECK(small.has_value() && small->X == regions[1].X);
+	const std::optional<ShelfPacker::Region> other = packer.Allocate(8, 16);
+	CHECK(other.has_value() && other->X == regions[1].X + 8);
+	CHECK(!packer.Allocate(8, 16).has_value());
+
+	// Once a shelf is empty, it takes a rectangle of any width again
+	packer.Free(regions[0]);
+	packer.Free(regions[2]);
+	packer.Free(regions[3]);
+	packer.Free(small.value());
+	packer.Free(other.value());
+	CHECK(packer.Allocate(64, 16).has_value());
+}
+
+TEST(ShelfPacker_RandomAllocationsNeverOverlap)
+{
+	topo::test::Random random(30);
+	ShelfPacker packer(256, 256);
+	std::vector<ShelfPacker::Region> regions;
+	for (unsigned int step = 0; step < 2000; ++step)
+	{
+		if (!regions.empty() && random.Range(0, 3) == 0)
+		{
+			const size_t index = random.Range(0, regions.size());
+			packer.Free(regions[index]);
+			regions[index] = regions.back();
+			regions.pop_back();
+		}
+		else if (const std::optional<ShelfPacker::Region> region = packer.Allocate(static_cast<unsigned int>(random.Range(1, 40)), static_cast<unsigned int>(random.Range(1, 40))))
+			regions.push_back(region.value());
+
+		if (step % 100 == 0)
+			CHECK(AreDisjoint(packer, regions));
+	}
+	CHECK(AreDisjoint(packer, regions));
+}
@@ -0,0 +1,205 @@
+#include "pch.h"
+#include "Test.h"
+#include "topo/rendering/SoftwareRenderer2D.h"
+
+using topo::SdfShape2D;
+using topo::SoftwarePipeline2D;
+using topo::SoftwareRenderer2D;
+using topo::UIObjectData;
+
+namespace
+{
+// Golden images live in TopoTests/golden. The path comes from this file's own location, so the tests do not depend on
+// the working directory they are run from
+std::filesystem::path GoldenPath(std::string_view name)
+{
+	return std::filesystem::path(std::source_location::current().file_name()).parent_path().parent_path() / "golden" / name;
+}
+
+// Same bit layout as PackShapeParameters/PackZOrder (UIInstanceBuilder.h), which needs DirectXMath
+constexpr unsigned int Shape(SdfShape2D shape, float cornerRadius, float borderThickness, std::uint16_t zOrder) noexcept
+{
+	return static_cast<unsigned int>(shape)
+		| (static_cast<unsigned int>(borderThickness * 4.0f) << 3)
+		| (static_cast<unsigned int>(cornerRadius * 2.0f) << 8)
+		| (static_cast<unsigned int>(zOrder) << 16);
+}
+
+// Instances are positioned in world space, so y is -top
+constexpr UIObjectData Instance(float left, float top, float width, float height, std::uint32_t color, std::uint32_t borderColor, unsigned int shape, unsigned int clip = 0, float rotation = 0.0f) noexcept
+{
+	return { { left, -top }, { width, height }, rotation, color, borderColor, shape, clip };
+}
+
+// Clip 0 is the whole frame and clip 1 a rect in the middle of it
+constexpr unsigned int FrameWidth = 96;
+constexpr unsigned int FrameHeight = 72;
+const std::array<topo::Rect, 2> ClipRects = { topo::Rect{ 0.0f, 0.0f, 96.0f, 72.0f }, topo::Rect{ 30.0f, 20.0f, 70.0f, 50.0f } };
+
+// A bit of everything: an opaque rounded box with a border, an ellipse and a polyline segment (so antialiased edges
+// over what is behind them), a transparent triangle and glyph, and a clipped overlay box that straddles a tile edge
+void DrawScene(SoftwareRenderer2D& renderer, topo::GlyphAtlas& atlas)
+{
+	const std::optional<topo::GlyphAtlas::Region> glyph = atlas.Allocate(8, 8);
+	CHECK(glyph.has_value());
+	std::array<std::uint8_t, 64> coverage = {};
+	for (unsigned int iii = 0; iii < coverage.size(); ++iii)
+		coverage[iii] = static_cast<std::uint8_t>((iii % 8 + iii / 8) * 18);
+	atlas.Write(glyph.value(), coverage);
+
+	const std::array opaque = {
+		Instance(4.0f, 4.0f, 50.0f, 36.0f, 0xFF8C5A2Eu, 0xFF20E0F0u, Shape(SdfShape2D::Box, 6.0f, 2.5f, 1)),
+		Instance(36.5f, 22.25f, 40.0f, 30.0f, 0xFFD07A3Cu, 0u, Shape(SdfShape2D::Ellipse, 0.0f, 0.0f, 2)),
+		Instance(10.0f, 60.0f, 70.0f, 5.0f, 0xFF3CC85Au, 0xFFFFFFFFu, Shape(SdfShape2D::Segment, 0.0f, 0.0f, 3), 0, 0.35f)
+	};
+	const std::array transparent = {
+		Instance(50.0f, 8.0f, 36.0f, 30.0f, 0x9050A0F0u, 0u, Shape(SdfShape2D::Triangle, 0.0f, 0.0f, 4)),
+		Instance(12.0f, 44.0f, 8.0f, 8.0f, 0xFFFFFFFFu, glyph->X | (glyph->Y << 16), Shape(SdfShape2D::Glyph, 0.0f, 0.0f, 5))
+	};
+	const std::array overlay = {
+		Instance(20.25f, 30.5f, 60.0f, 12.0f, 0x80F02080u, 0u, Shape(SdfShape2D::Box, 3.0f, 0.0f, 0), 1)
+	};
+
+	renderer.Clear({ 0.1f, 0.12f, 0.15f, 1.0f });
+	renderer.SetClipRects(ClipRects);
+	renderer.SetGlyphAtlas(&atlas);
+	renderer.Draw(opaque, SoftwarePipeline2D::Opaque);
+	renderer.Draw(opaque, SoftwarePipeline2D::OpaqueFringe);
+	renderer.Draw(transparent, SoftwarePipeline2D::Transparent);
+	renderer.Draw(overlay, SoftwarePipeline2D::Overlay);
+}
+
+// Reads a binary PPM (P6, maxval 255) as RGB bytes. Returns false if the file is missing or malformed
+bool ReadPPM(const std::filesystem::path& path, unsigned int& width, unsigned int& height, std::vector<std::uint8_t>& rgb)
+{
+	std::ifstream file(path, std::ios::binary);
+	std::string magic;
+	unsigned int maxValue = 0;
+	if (!(file >> magic >> width >> height >> maxValue) || magic != "P6" || maxValue != 255)
+		return false;
+
+	// Exactly one whitespace character separates the header from the pixels
+	file.get();
+	rgb.resize(static_cast<size_t>(width) * height * 3);
+	file.read(reinterpret_cast<char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+	return static_cast<bool>(file);
+}
+
+// Compares the frame to the golden image, allowing each channel to be off by a little (the edges depend on the
+// platform's sin/cos/sqrt). On a mismatch the frame is written next to the golden image as <name>.actual.ppm, which
+// is also how a golden image gets (re)created: check the actual image, then rename it
+bool MatchesGolden(const SoftwareRenderer2D& renderer, std::string_view name)
+{
+	constexpr int tolerance = 2;
+
+	const std::filesystem::path golden = GoldenPath(std::format("{0}.ppm", name));
+	unsigned int width = 0;
+	unsigned int height = 0;
+	std::vector<std::uint8_t> expected;
+	bool matches = ReadPPM(golden, width, height, expected) && width == renderer.GetWidth() && height == renderer.GetHeight();
+
+	size_t mismatches = 0;
+	for (size_t iii = 0; matches && iii < renderer.GetPixels().size(); ++iii)
+	{
+		const std::uint32_t pixel = renderer.GetPixels()[iii];
+		for (unsigned int channel = 0; channel < 3; ++channel)
+		{
+			const int actual = static_cast<int>((pixel >> (8 * channel)) & 0xFF);
+			if (std::abs(actual - static_cast<int>(expected[iii * 3 + channel])) > tolerance)
+			{
+				if (mismatches++ == 0)
+					std::println("    {0}: pixel ({1}, {2}) differs from the golden image", name, iii % width, iii / width);
+				break;
+			}
+		}
+	}
+
+	if (!matches || mismatches > 0)
+	{
+		renderer.WritePPM(GoldenPath(std::format("{0}.actual.ppm", name)));
+		return false;
+	}
+	return true;
+}
+}
+
+TEST(SoftwareRenderer2D_MatchesGoldenImage)
+{
+	SoftwareRenderer2D renderer(FrameWidth, FrameHeight);
+	topo::GlyphAtlas atlas;
+	DrawScene(renderer, atlas);
+	CHECK(MatchesGolden(renderer, "SoftwareRenderer2D_Scene"));
+}
+
+TEST(SoftwareRenderer2D_ParallelMatchesSerial)
+{
+	SoftwareRenderer2D parallel(FrameWidth, FrameHeight);
+	topo::GlyphAtlas parallelAtlas;
+	DrawScene(parallel, parallelAtlas);
+
+	SoftwareRenderer2D serial(FrameWidth, FrameHeight);
+	serial.SetParallel(false);
+	topo::GlyphAtlas serialAtlas;
+	DrawScene(serial, serialAtlas);
+
+	CHECK(std::ranges::equal(parallel.GetPixels(), serial.GetPixels()));
+}
+
+TEST(SoftwareRenderer2D_DepthAndClip)
+{
+	SoftwareRenderer2D renderer(16, 16);
+	const std::array<topo::Rect, 1> clip = { topo::Rect{ 0.0f, 0.0f, 8.0f, 16.0f } };
+	renderer.SetClipRects(clip);
+	renderer.Clear({ 0.0f, 0.0f, 0.0f, 1.0f });
+
+	// The closer box wins even though it is drawn first, but only in the left half of the frame that it is clipped
+	// to. Clip 1 is not in the table, so the other box is only clipped by the frame
+	const std::array opaque = {
+		Instance(0.0f, 0.0f, 16.0f, 16.0f, 0xFF00FF00u, 0u, Shape(SdfShape2D::Box, 0.0f, 0.0f, 2), 0),
+		Instance(0.0f, 0.0f, 16.0f, 16.0f, 0xFF0000FFu, 0u, Shape(SdfShape2D::Box, 0.0f, 0.0f, 1), 1)
+	};
+	renderer.Draw(opaque, SoftwarePipeline2D::Opaque);
+	CHECK(renderer.GetPixel(2, 8) == 0xFF00FF00u);
+	CHECK(renderer.GetPixel(12, 8) == 0xFF0000FFu);
+
+	// Transparent instances behind the opaque ones are hidden, overlays never are
+	const std::array behind = { Instance(0.0f, 0.0f, 16.0f, 16.0f, 0x80FF0000u, 0u, Shape(SdfShape2D::Box, 0.0f, 0.0f, 0), 1) };
+	renderer.Draw(behind, SoftwarePipeline2D::Transparent);
+	CHECK(renderer.GetPixel(12, 8) == 0xFF0000FFu);
+	renderer.Draw(behind, SoftwarePipeline2D::Overlay);
+	CHECK(renderer.GetPixel(12, 8) == 0xFF80007Fu);
+}
+
+TEST(SoftwareRenderer2D_WritesImages)
+{
+	SoftwareRenderer2D renderer(FrameWidth, FrameHeight);
+	topo::GlyphAtlas atlas;
+	DrawScene(renderer, atlas);
+
+	// The PPM holds the RGB of every pixel
+	const std::filesystem::path ppm = std::filesystem::temp_directory_path() / "topo_software_renderer.ppm";
+	renderer.WritePPM(ppm);
+	unsigned int width = 0;
+	unsigned int height = 0;
+	std::vector<std::uint8_t> rgb;
+	CHECK(ReadPPM(ppm, width, height, rgb));
+	CHECK(width == FrameWidth && height == FrameHeight);
+	bool same = rgb.size() == renderer.GetPixels().size() * 3;
+	for (size_t iii = 0; same && iii < renderer.GetPixels().size(); ++iii)
+		same = (renderer.GetPixels()[iii] & 0xFFFFFF) == (rgb[iii * 3] | (rgb[iii * 3 + 1] << 8u) | (static_cast<std::uint32_t>(rgb[iii * 3 + 2]) << 16));
+	CHECK(same);
+	std::filesystem::remove(ppm);
+
+	// The PNG starts with its signature and an IHDR chunk with the size
+	const std::filesystem::path png = std::filesystem::temp_directory_path() / "topo_software_renderer.png";
+	renderer.WritePNG(png);
+	std::ifstream file(png, std::ios::binary);
+	std::array<std::uint8_t, 24> header = {};
+	file.read(reinterpret_cast<char*>(header.data()), header.size());
+	CHECK(static_cast<bool>(file));
+	CHECK(header[0] == 0x89 && header[1] == 'P' && header[2] == 'N' && header[3] == 'G');
+	CHECK(header[12] == 'I' && header[13] == 'H' && header[14] == 'D' && header[15] == 'R');
+	CHECK(static_cast<unsigned int>(header[19]) == FrameWidth && static_cast<unsigned int>(header[23]) == FrameHeight);
+	file.close();
+	std::filesystem::remove(png);
+}
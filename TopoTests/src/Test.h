@@ -0,0 +1,52 @@
+#pragma once
+#include "topo/Core.h"
+
+
+// A minimal test harness for the parts of Topo that do not need a window or a GPU. TEST(name) defines a test and
+// registers it with the runner (see main.cpp). CHECK() records a failure and keeps going, so a single run reports
+// every expectation that does not hold
+namespace topo::test
+{
+using TestFunction = void(*)();
+
+struct TestCase
+{
+	std::string_view Name;
+	TestFunction Function = nullptr;
+};
+
+std::vector<TestCase>& Registry();
+ND size_t FailureCount() noexcept;
+void Fail(std::string_view expression, const std::source_location& location = std::source_location::current());
+
+struct Registrar
+{
+	Registrar(std::string_view name, TestFunction function) { Registry().push_back({ name, function }); }
+};
+
+// Deterministic pseudo-random numbers (a 64-bit LCG), so that failures reproduce
+class Random
+{
+public:
+	explicit constexpr Random(std::uint64_t seed) noexcept : m_state(seed) {}
+
+	constexpr std::uint32_t Next() noexcept
+	{
+		m_state = m_state * 6364136223846793005ull + 1442695040888963407ull;
+		return static_cast<std::uint32_t>(m_state >> 33);
+	}
+	// [low, high)
+	constexpr size_t Range(size_t low, size_t high) noexcept { return low + Next() % (high - low); }
+	constexpr float Float(float low, float high) noexcept { return low + (high - low) * static_cast<float>(Next()) / 2147483648.0f; }
+
+private:
+	std::uint64_t m_state;
+};
+}
+
+#define TEST(name) \
+	static void CAT(Test_, name)(); \
+	static const topo::test::Registrar CAT(Registrar_, name)(#name, &CAT(Test_, name)); \
+	static void CAT(Test_, name)()
+
+#define CHECK(x) { if (!(x)) topo::test::Fail(#x); }
@@ -0,0 +1,50 @@
+#include "pch.h"
+#include "Test.h"
+
+
+namespace topo::test
+{
+namespace
+{
+size_t g_failures = 0;
+}
+
+std::vector<TestCase>& Registry()
+{
+	// Function local, so tests can register themselves from static initializers in any translation unit
+	static std::vector<TestCase> registry;
+	return registry;
+}
+size_t FailureCount() noexcept
+{
+	return g_failures;
+}
+void Fail(std::string_view expression, const std::source_location& location)
+{
+	++g_failures;
+	std::println("    CHECK({0}) failed at {1}:{2}", expression, location.file_name(), location.line());
+}
+}
+
+// Runs every test and returns the number of tests that failed, so the runner can gate a build
+int main()
+{
+	using namespace topo::test;
+
+	int failedTests = 0;
+	for (const TestCase& test : Registry())
+	{
+		const size_t failures = FailureCount();
+		test.Function();
+		if (FailureCount() != failures)
+		{
+			++failedTests;
+			std::println("[FAILED] {0}", test.Name);
+		}
+		else
+			std::println("[PASSED] {0}", test.Name);
+	}
+
+	std::println("{0} of {1} tests passed", Registry().size() - failedTests, Registry().size());
+	return failedTests;
+}
@@ -12,6 +12,79 @@ outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
 
 startproject "Sandbox"
 
+-- Code that needs neither a window nor a GPU (logging, glyph caching, the software renderer, ...). It builds without
+-- TOPO_PLATFORM_WINDOWS, so pch.h does not pull in any of the Windows/D3D12 headers, and Topo, Sandbox and TopoTests
+-- all link it. The sources stay next to the rest of Topo's, so Topo removes them from its own project
+headlessfiles =
+{
+	"Topo/src/topo/Log.h",
+	"Topo/src/topo/Log.cpp",
+	"Topo/src/topo/rendering/GlyphCache.h",
+	"Topo/src/topo/rendering/GlyphCache.cpp",
+	"Topo/src/topo/rendering/SoftwareRenderer2D.h",
+	"Topo/src/topo/rendering/SoftwareRenderer2D.cpp",
+	"Topo/src/topo/rendering/UIObjectData.h",
+	"Topo/src/topo/utils/BufferAllocator.h",
+	"Topo/src/topo/utils/BufferAllocator.cpp",
+	"Topo/src/topo/utils/DamageRegion.h",
+	"Topo/src/topo/utils/DamageRegion.cpp",
+	"Topo/src/topo/utils/GlyphAtlas.h",
+	"Topo/src/topo/utils/GlyphAtlas.cpp",
+	"Topo/src/topo/utils/MinMaxPyramid.h",
+	"Topo/src/topo/utils/MinMaxPyramid.cpp",
+	"Topo/src/topo/utils/PieceTable.h",
+	"Topo/src/topo/utils/PieceTable.cpp",
+	"Topo/src/topo/utils/RadixSort.h",
+	"Topo/src/topo/utils/RadixSort.cpp",
+	"Topo/src/topo/utils/Rect.h",
+	"Topo/src/topo/utils/Rect.cpp",
+	"Topo/src/topo/utils/ShelfPacker.h",
+	"Topo/src/topo/utils/ShelfPacker.cpp"
+}
+
+project "TopoHeadless"
+	location "TopoHeadless"
+	kind "StaticLib"
+	language "C++"
+	cppdialect "C++latest"
+	staticruntime "on"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")	
+	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+	files (headlessfiles)
+
+	includedirs
+	{
+		"Topo/src"
+	}
+
+	defines
+	{
+		"TOPO_CORE"
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+
+	filter "configurations:Debug"
+		defines 
+		{
+			"TOPO_DEBUG",
+			"TOPO_ENABLE_ASSERTS"
+		}
+		symbols "on"
+
+	filter "configurations:Release"
+		defines "TOPO_RELEASE"
+		optimize "on"
+
+	filter "configurations:Dist"
+		defines "TOPO_DIST"
+		optimize "on"
+
+
+
 project "Topo"
 	location "Topo"
 	kind "StaticLib"
@@ -33,11 +106,18 @@ project "Topo"
 		"%{prj.name}/src/**.hlsli"
 	}
 
+	removefiles (headlessfiles)
+
 	includedirs
 	{
 		"%{prj.name}/src"
 	}
 
+	links
+	{
+		"TopoHeadless"
+	}
+
 	defines
 	{
 		"TOPO_CORE",
@@ -114,7 +194,119 @@ project "Sandbox"
 
 	links
 	{
-		"Topo"
+		"Topo",
+		"TopoHeadless"
+	}
+
+	defines
+	{
+		"DIRECTX12"
+	}
+	
+	filter "system:windows"
+		systemversion "latest"
+		defines
+		{
+			"TOPO_PLATFORM_WINDOWS"
+		}
+
+	filter "configurations:Debug"
+		defines 
+		{
+			"TOPO_DEBUG",
+			"TOPO_ENABLE_ASSERTS"
+		}
+		symbols "on"
+
+	filter "configurations:Release"
+		defines "TOPO_RELEASE"
+		optimize "on"
+
+	filter "configurations:Dist"
+		defines "TOPO_DIST"
+		optimize "on"
+
+
+project "TopoTests"
+	location "TopoTests"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++latest"
+	staticruntime "on"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")	
+	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+	-- The tests only cover code that needs neither a window nor a GPU (see TopoHeadless)
+	files
+	{
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp"
+	}
+
+	includedirs
+	{
+		"Topo/src",
+		"%{prj.name}/src"
+	}
+
+	links
+	{
+		"TopoHeadless"
+	}
+
+	-- Run the tests after every build, so a failing test fails the build
+	postbuildcommands
+	{
+		("\"%{cfg.buildtarget.abspath}\"")
+	}
+
+	filter "system:windows"
+		systemversion "latest"
+
+	filter "configurations:Debug"
+		defines 
+		{
+			"TOPO_DEBUG",
+			"TOPO_ENABLE_ASSERTS"
+		}
+		symbols "on"
+
+	filter "configurations:Release"
+		defines "TOPO_RELEASE"
+		optimize "on"
+
+	filter "configurations:Dist"
+		defines "TOPO_DIST"
+		optimize "on"
+
+
+project "TopoBenchmarks"
+	location "TopoBenchmarks"
+	kind "ConsoleApp"
+	language "C++"
+	cppdialect "C++latest"
+	staticruntime "on"
+
+	targetdir ("bin/" .. outputdir .. "/%{prj.name}")	
+	objdir ("bin-int/" .. outputdir .. "/%{prj.name}")
+
+	-- Times the renderer's CPU side without a window (see src/main.cpp). Only Release/Dist numbers mean anything
+	files
+	{
+		"%{prj.name}/src/**.h",
+		"%{prj.name}/src/**.cpp"
+	}
+
+	includedirs
+	{
+		"Topo/src"
+	}
+
+	links
+	{
+		"Topo",
+		"TopoHeadless"
 	}
 
 	defines
@@ -143,4 +335,4 @@ project "Sandbox"
 
 	filter "configurations:Dist"
 		defines "TOPO_DIST"
-		optimize "on"
\ No newline at end of file
+		optimize "on"
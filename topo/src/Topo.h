@@ -7,12 +7,30 @@
 #include "topo/Layout.h"
 #include "topo/TopoException.h"
 
+#include "topo/rendering/AnimationSystem.h"
 #include "topo/rendering/Camera.h"
+#include "topo/rendering/DrawList2D.h"
+#include "topo/rendering/GlyphCache.h"
+#include "topo/rendering/ImageAtlas.h"
+#include "topo/rendering/SoftwareRenderer2D.h"
+#include "topo/rendering/UIInstanceBuilder.h"
 
 
 // Controls
 #include "topo/controls/Control.h"
+#include "topo/controls/ControlPool.h"
 #include "topo/controls/Button.h"
+#include "topo/controls/ItemsControl.h"
+#include "topo/controls/TextBox.h"
+
+// Utils
+#include "topo/utils/BufferAllocator.h"
+#include "topo/utils/DamageRegion.h"
+#include "topo/utils/GlyphAtlas.h"
+#include "topo/utils/MinMaxPyramid.h"
+#include "topo/utils/RadixSort.h"
+#include "topo/utils/ShelfPacker.h"
+#include "topo/utils/ObservableCollection.h"
 
 
 // Entry point ---------------------
@@ -9,11 +9,17 @@ Application* Application::s_application = nullptr;
 Application::Application(const WindowProperties& mainWindowProperties) noexcept :
 	m_applicationShutdownRequested(false),
 	m_window(mainWindowProperties),
-	m_timer()
+	m_timer(),
+	m_shutdownEvent(CreateEvent(nullptr, TRUE, FALSE, nullptr))
 {
 	ASSERT(s_application == nullptr, "Not allowed to create a second instance of Application");
 	s_application = this;
 }
+Application::~Application() noexcept
+{
+	if (m_shutdownEvent != nullptr)
+		CloseHandle(m_shutdownEvent);
+}
 
 int Application::Run()
 {
@@ -44,8 +50,19 @@ int Application::Run()
 				return *ecode;
 			}
 
-			m_window.Render(m_timer);
-			m_window.Present();
+			if (m_window.NeedsRender())
+			{
+				m_window.Render(m_timer);
+				m_window.Present();
+			}
+			else
+			{
+				// Nothing needs to be redrawn, so skip the frame. Only block until there is something to process if
+				// there are no changes waiting for the next update either
+				m_window.SkipFrame();
+				if (!m_window.NeedsUpdate())
+					m_window.WaitForMessages();
+			}
 		}
 	}
 #ifndef TOPO_DIST
@@ -82,6 +99,10 @@ void Application::TerminateAllChildWindows() noexcept
 	// When termination is requested, set this flag to true so that all child windows will know to exit
 	m_applicationShutdownRequested = true;
 
+	// Wake up any child windows that are blocked waiting for messages
+	if (m_shutdownEvent != nullptr)
+		SetEvent(m_shutdownEvent);
+
 	// Join all child threads before exiting
 	for (auto& thread : m_childWindowThreads)
 		thread.join();
@@ -12,7 +12,7 @@ class Application
 {
 public:
 	Application(const WindowProperties& mainWindowProperties) noexcept;
-	virtual ~Application() noexcept {}
+	virtual ~Application() noexcept;
 	int Run();
 		
 	ND constexpr bool ApplicationShutdownRequested() const noexcept { return m_applicationShutdownRequested; }
@@ -37,6 +37,10 @@ private:
 	std::vector<std::thread> m_childWindowThreads;
 	bool m_applicationShutdownRequested;
 
+	// Manual-reset event that gets signaled when shutdown is requested. Child windows that render on demand 
+	// will be blocked waiting for messages, so they also wait on this event so they can wake up and exit
+	HANDLE m_shutdownEvent;
+
 	// Pointer to singleton
 	static Application* s_application;
 };
@@ -80,8 +84,19 @@ bool Application::LaunchWindow(const WindowProperties& props) noexcept
 							return;
 						}
 
-						window.Render(m_timer);
-						window.Present();
+						if (window.NeedsRender())
+						{
+							window.Render(m_timer);
+							window.Present();
+						}
+						else
+						{
+							// Nothing needs to be redrawn, so skip the frame. Only block until there is something to process if
+							// there are no changes waiting for the next update either
+							window.SkipFrame();
+							if (!window.NeedsUpdate())
+								window.WaitForMessages(m_shutdownEvent);
+						}
 					}
 				}
 #ifndef TOPO_DIST
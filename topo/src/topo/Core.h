@@ -8,8 +8,15 @@
 #define STRINGIFY2(X) #X
 #define STRINGIFY(X) STRINGIFY2(X)
 
+// __debugbreak is MSVC only - the headless code (see TopoHeadless in premake5.lua) also builds with GCC/Clang
+#if defined(_MSC_VER)
+#define DEBUG_BREAK() __debugbreak()
+#else
+#define DEBUG_BREAK() __builtin_trap()
+#endif
+
 #ifdef TOPO_ENABLE_ASSERTS
-#define ASSERT(x, ...) { if (!(x)) { LOG_ERROR("Assertion Failed: {0}", __VA_ARGS__); __debugbreak(); } }
+#define ASSERT(x, ...) { if (!(x)) { LOG_ERROR("Assertion Failed: {0}", __VA_ARGS__); DEBUG_BREAK(); } }
 #else
 #define ASSERT(x, ...)
 #endif